@@ -0,0 +1,897 @@
+/******************************************************************************
+* File Name: autobaud.c
+*
+* Description: This file contains the automatic baud-rate detection. It times
+*              the edges of a character on UART RX and picks the closest standard
+*              rate, and runs the loopback benchmark of the detection
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "autobaud.h"
+#include "stats.h"
+
+#if (AUTOBAUD != 0u)
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Edges timed per measurement, enough for two characters */
+#define AUTOBAUD_EDGES              (24u)
+
+/* Longest character: start bit, 8 data bits, parity and 2 stop bits. A
+ * longer run is idle, or a line held low. */
+#define AUTOBAUD_CHAR_BITS          (12u)
+
+/* Fewest bit-times a rate is taken from */
+#define AUTOBAUD_MIN_BITS           (4u)
+
+#define AUTOBAUD_NO_REQUEST         (0xFFFFFFFFu)
+
+
+/*******************************************************************************
+*            Enumerated Types and Structures
+*******************************************************************************/
+/* Detection state of a bridge port. armed is set by the main loop and
+ * cleared by autobaud_isr once it has a rate, which then sets done. */
+typedef struct
+{
+    GPIO_PRT_Type *gpio;            /* UART RX pin */
+    uint32_t pin;
+    volatile bool armed;
+    volatile bool done;
+    uint32_t rate;                  /* Detected rate, valid while done is set */
+    uint32_t end;                   /* stats_now() at the end of the detection */
+    volatile uint32_t request;      /* AUTOBAUD_DETECT, _BENCH or _CANCEL from the host */
+} autobaud_port_t;
+
+/* Edges of one measurement */
+typedef struct
+{
+    uint32_t cycles;                /* Duration of the bit-times counted */
+    uint32_t bits;                  /* Bit-times counted */
+    uint32_t resolution;            /* Sampling period of the pin in CPU cycles */
+    uint32_t elapsed;               /* Duration of the measurement in CPU cycles */
+} autobaud_measurement_t;
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+/* SysTick time base of main.c */
+extern volatile uint32_t tick_count;
+
+volatile autobaud_report_t autobaud_report;
+
+/* Copy of autobaud_report for the AUTOBAUD_VENDOR_REQ_RESULT data stage */
+static autobaud_report_t autobaud_copy;
+
+static autobaud_port_t autobaud_ports[BRIDGE_PORTS];
+
+static uint32_t autobaud_clk_hz;
+static uint32_t autobaud_cycles_per_us;
+
+/* One and AUTOBAUD_CHAR_BITS bit-times at AUTOBAUD_MIN_RATE, in CPU cycles */
+static uint32_t autobaud_min_bit;
+static uint32_t autobaud_max_run;
+
+/* Benchmark step that has not run */
+static const autobaud_bench_t autobaud_bench_none;
+
+/* Rates a measurement is rounded to, and that the benchmark steps through */
+static const uint32_t autobaud_rates[AUTOBAUD_RATE_COUNT] =
+{
+    1200u, 2400u, 4800u, 9600u, 14400u, 19200u, 38400u, 57600u, 115200u, 230400u, 250000u, 460800u, 500000u,
+    921600u, 1000000u, 1500000u, 2000000u, 3000000u
+};
+
+
+/*******************************************************************************
+* Function Name: autobaud_init
+********************************************************************************
+*
+* Summary:
+*  Initializes the detection. Must be called once the SysTick time base has
+*  been started.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void autobaud_init(void)
+{
+    uint32_t index;
+
+    autobaud_clk_hz = Cy_SysClk_ClkSysGetFrequency();
+    autobaud_cycles_per_us = autobaud_clk_hz / 1000000u;
+    autobaud_min_bit = autobaud_clk_hz / AUTOBAUD_MIN_RATE;
+    autobaud_max_run = autobaud_min_bit * AUTOBAUD_CHAR_BITS;
+
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        autobaud_ports[index].request = AUTOBAUD_NO_REQUEST;
+    }
+}
+
+/*******************************************************************************
+* Function Name: autobaud_request
+********************************************************************************
+*
+* Summary:
+*  Requests the main loop to start or cancel a detection or the benchmark.
+*  Called from the USB interrupt.
+*
+* Parameters:
+*  index: bridge port
+*  mode: AUTOBAUD_DETECT, AUTOBAUD_BENCH or AUTOBAUD_CANCEL
+*
+* Return:
+*  bool: false if the port or the mode is not supported
+*
+*******************************************************************************/
+bool autobaud_request(uint32_t index, uint32_t mode)
+{
+    /* The benchmark sends on UART TX of port 0, wired to its RX */
+    if ((index >= BRIDGE_PORTS) || (mode > AUTOBAUD_BENCH) || ((mode == AUTOBAUD_BENCH) && (index != 0u)))
+    {
+        return false;
+    }
+
+    autobaud_ports[index].request = mode;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_take_request
+********************************************************************************
+*
+* Summary:
+*  Returns and clears the pending request of a port.
+*
+* Parameters:
+*  index: bridge port
+*  mode: returns the requested mode
+*
+* Return:
+*  bool: true if a request was pending
+*
+*******************************************************************************/
+bool autobaud_take_request(uint32_t index, uint32_t *mode)
+{
+    autobaud_port_t *ab = &autobaud_ports[index];
+    uint32_t int_state;
+
+    if (ab->request == AUTOBAUD_NO_REQUEST)
+    {
+        return false;
+    }
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    *mode = ab->request;
+    ab->request = AUTOBAUD_NO_REQUEST;
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_arm
+********************************************************************************
+*
+* Summary:
+*  Waits for the next character on the UART RX pin of a port. Its start bit
+*  raises the GPIO interrupt that runs autobaud_isr. A result that was not
+*  taken yet is dropped.
+*
+* Parameters:
+*  index: bridge port
+*  gpio: port of the UART RX pin
+*  pin: UART RX pin
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void autobaud_arm(uint32_t index, GPIO_PRT_Type *gpio, uint32_t pin)
+{
+    autobaud_port_t *ab = &autobaud_ports[index];
+
+    ab->gpio = gpio;
+    ab->pin = pin;
+    ab->done = false;
+    Cy_GPIO_ClearInterrupt(gpio, pin);
+    ab->armed = true;
+    autobaud_report.port[index].armed = 1u;
+    Cy_GPIO_SetInterruptEdge(gpio, pin, CY_GPIO_INTR_FALLING);
+}
+
+/*******************************************************************************
+* Function Name: autobaud_disarm
+********************************************************************************
+*
+* Summary:
+*  Stops waiting for a character on a port and drops a result that was not
+*  taken yet.
+*
+* Parameters:
+*  index: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void autobaud_disarm(uint32_t index)
+{
+    autobaud_port_t *ab = &autobaud_ports[index];
+
+    if (ab->gpio != NULL)
+    {
+        Cy_GPIO_SetInterruptEdge(ab->gpio, ab->pin, CY_GPIO_INTR_DISABLE);
+    }
+    ab->armed = false;
+    ab->done = false;
+    autobaud_report.port[index].armed = 0u;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_armed
+********************************************************************************
+*
+* Summary:
+*  Tells whether a port waits for a character to measure.
+*
+* Parameters:
+*  index: bridge port
+*
+* Return:
+*  bool: true while the port is armed
+*
+*******************************************************************************/
+bool autobaud_armed(uint32_t index)
+{
+    return autobaud_ports[index].armed;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_take_result
+********************************************************************************
+*
+* Summary:
+*  Returns and clears the rate detected on a port.
+*
+* Parameters:
+*  index: bridge port
+*  rate: returns the detected rate
+*
+* Return:
+*  bool: true if a detection has completed since the last call
+*
+*******************************************************************************/
+bool autobaud_take_result(uint32_t index, uint32_t *rate)
+{
+    autobaud_port_t *ab = &autobaud_ports[index];
+
+    if (!ab->done)
+    {
+        return false;
+    }
+
+    *rate = ab->rate;
+    ab->done = false;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_estimate
+********************************************************************************
+*
+* Summary:
+*  Finds the bit time from the edges of a measurement. The runs between the
+*  edges are counted in bit-times of the shortest run, and counted again
+*  against the mean bit time that gives. The edges are rejected if a run is
+*  off its count by more than a quarter bit plus the sampling period, for
+*  example because the character has no single bit between two edges. The
+*  runs end at the first one longer than a character, the idle line.
+*
+* Parameters:
+*  edges: edge times in CPU cycles
+*  count: number of edges
+*  m: measurement, returns the bit-times counted and their duration
+*
+* Return:
+*  bool: true if the edges give a consistent bit time
+*
+*******************************************************************************/
+static bool autobaud_estimate(const uint32_t *edges, uint32_t count, autobaud_measurement_t *m)
+{
+    uint32_t shortest = UINT32_MAX;
+    uint32_t runs;
+    uint32_t index;
+    uint32_t pass;
+    uint64_t run;
+    uint64_t bits;
+    uint64_t cycles;
+    uint64_t sum;
+    uint64_t off;
+
+    if (count < 2u)
+    {
+        return false;
+    }
+
+    for (index = 1u; index < count; index++)
+    {
+        if ((edges[index] - edges[index - 1u]) < shortest)
+        {
+            shortest = edges[index] - edges[index - 1u];
+        }
+    }
+    if (shortest == 0u)
+    {
+        return false;
+    }
+
+    for (runs = 1u; (runs < count) && ((edges[runs] - edges[runs - 1u]) < (shortest * (AUTOBAUD_CHAR_BITS - 1u)));
+         runs++)
+    {
+    }
+    cycles = edges[runs - 1u] - edges[0];
+
+    /* Bit-times of the shortest run first, then of the mean bit time */
+    bits = 0u;
+    for (index = 1u; index < runs; index++)
+    {
+        bits += ((2u * (uint64_t) (edges[index] - edges[index - 1u])) + shortest) / (2u * (uint64_t) shortest);
+    }
+    for (pass = 0u; (pass < 2u) && (bits != 0u); pass++)
+    {
+        sum = 0u;
+        for (index = 1u; index < runs; index++)
+        {
+            sum += ((2u * (uint64_t) (edges[index] - edges[index - 1u]) * bits) + cycles) / (2u * cycles);
+        }
+        bits = sum;
+    }
+    if (bits < AUTOBAUD_MIN_BITS)
+    {
+        return false;
+    }
+
+    for (index = 1u; index < runs; index++)
+    {
+        run = (uint64_t) (edges[index] - edges[index - 1u]) * bits;
+        sum = ((2u * run) + cycles) / (2u * cycles);
+        off = (run > (sum * cycles)) ? (run - (sum * cycles)) : ((sum * cycles) - run);
+        if ((sum == 0u) || ((4u * off) > (cycles + (4u * (uint64_t) m->resolution * bits))))
+        {
+            return false;
+        }
+    }
+
+    m->cycles = (uint32_t) cycles;
+    m->bits = (uint32_t) bits;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_add_ticks
+********************************************************************************
+*
+* Summary:
+*  Adds the SysTick wraps counted by a measurement to tick_count, so that
+*  stats_now() stays right in the interrupts served during the measurement.
+*  The SysTick interrupt that is pending adds one tick for all the wraps.
+*  Called with interrupts masked.
+*
+* Parameters:
+*  wraps: wraps counted so far
+*  ticked: wraps already added, updated
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void autobaud_add_ticks(uint32_t wraps, uint32_t *ticked)
+{
+    if (wraps > (*ticked + 1u))
+    {
+        tick_count += wraps - (*ticked + 1u);
+        *ticked = wraps - 1u;
+    }
+}
+
+/*******************************************************************************
+* Function Name: autobaud_measure
+********************************************************************************
+*
+* Summary:
+*  Times the edges on the UART RX pin from the start bit that raised the
+*  interrupt until the line has been idle for longer than a character, or
+*  AUTOBAUD_EDGES edges have been seen. The pin is sampled with interrupts
+*  masked in a loop that also watches the SysTick wrap flag, and the time of
+*  an edge is taken from the SysTick down-counter and the wraps counted.
+*  About once a bit-time at AUTOBAUD_MIN_RATE, or once a SysTick period if
+*  that is longer, interrupts are unmasked between two samples so that the
+*  USB, DMA and UART interrupts are served. The measurement is dropped if the
+*  pin changed meanwhile, because that edge can no longer be timed. The
+*  measurement ends after two characters at AUTOBAUD_MIN_RATE at the latest.
+*  The start bit itself is not timed, because the interrupt is taken some
+*  time after its edge.
+*
+* Parameters:
+*  ab: port to measure
+*  m: returns the measurement
+*
+* Return:
+*  bool: true if the edges give a consistent bit time
+*
+*******************************************************************************/
+static bool autobaud_measure(const autobaud_port_t *ab, autobaud_measurement_t *m)
+{
+    uint32_t edges[AUTOBAUD_EDGES];
+    uint32_t period = Cy_SysTick_GetReload() + 1u;
+    uint32_t limit = autobaud_max_run;
+    uint32_t shortest = UINT32_MAX;
+    uint32_t count = 0u;
+    uint32_t wraps = 0u;
+    uint32_t loops = 0u;
+    uint32_t now = 0u;
+    uint32_t last = 0u;
+    uint32_t opened = 0u;
+    uint32_t ticked = 0u;
+    uint32_t int_state;
+    uint32_t base;
+    uint32_t value;
+    uint32_t ctrl;
+    uint32_t level;
+    uint32_t sample;
+    bool late;
+    bool interrupted = false;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+
+    /* Start with the wrap flag cleared. SysTick registers are read directly
+     * to keep the sampling loop short. */
+    do
+    {
+        (void) SysTick->CTRL;
+        base = SysTick->VAL;
+    } while (0u != (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk));
+
+    level = Cy_GPIO_Read(ab->gpio, ab->pin);
+    for (;;)
+    {
+        /* Wait for an edge or a wrap. Reading CTRL clears the wrap flag. */
+        do
+        {
+            sample = Cy_GPIO_Read(ab->gpio, ab->pin);
+            ctrl = SysTick->CTRL;
+            loops++;
+        } while ((sample == level) && (0u == (ctrl & SysTick_CTRL_COUNTFLAG_Msk)));
+
+        value = SysTick->VAL;
+        if (0u != (ctrl & SysTick_CTRL_COUNTFLAG_Msk))
+        {
+            wraps++;
+        }
+
+        /* A wrap after the CTRL read belongs to this time if VAL has
+         * already been reloaded */
+        late = (0u != (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk));
+        if (late && (value > (period / 2u)))
+        {
+            wraps++;
+            late = false;
+        }
+        now = (wraps * period) + base - value;
+        if (late)
+        {
+            wraps++;
+        }
+
+        if (sample != level)
+        {
+            level = sample;
+            if ((count != 0u) && ((now - last) < shortest))
+            {
+                shortest = now - last;
+                if ((shortest * AUTOBAUD_CHAR_BITS) < limit)
+                {
+                    limit = shortest * AUTOBAUD_CHAR_BITS;
+                }
+            }
+            edges[count] = now;
+            count++;
+            last = now;
+            if (count == AUTOBAUD_EDGES)
+            {
+                break;
+            }
+        }
+        else if ((now - last) > limit)
+        {
+            break;
+        }
+
+        if (now > (2u * autobaud_max_run))
+        {
+            break;
+        }
+
+        /* SysTick has the priority of this interrupt and stays pending, and
+         * its wrap flag is kept for the next CTRL read */
+        if ((now - opened) >= autobaud_min_bit)
+        {
+            autobaud_add_ticks(wraps, &ticked);
+            Cy_SysLib_ExitCriticalSection(int_state);
+            int_state = Cy_SysLib_EnterCriticalSection();
+            if (Cy_GPIO_Read(ab->gpio, ab->pin) != level)
+            {
+                interrupted = true;
+                break;
+            }
+            opened = now;
+        }
+    }
+
+    autobaud_add_ticks(wraps, &ticked);
+
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    m->elapsed = now;
+    m->resolution = (now + loops - 1u) / loops;
+    m->cycles = 0u;
+    m->bits = 0u;
+
+    return (!interrupted) && autobaud_estimate(edges, count, m);
+}
+
+/*******************************************************************************
+* Function Name: autobaud_choose
+********************************************************************************
+*
+* Summary:
+*  Picks the rate of a measurement: the closest standard rate whose bit time
+*  is within AUTOBAUD_SNAP_PPM plus the sampling error, or else the measured
+*  rate if it is precise enough for the UART.
+*
+* Parameters:
+*  m: measurement
+*  measured_rate: rate of the measurement
+*
+* Return:
+*  uint32_t: rate to use, 0 if the measurement is not precise enough
+*
+*******************************************************************************/
+static uint32_t autobaud_choose(const autobaud_measurement_t *m, uint32_t measured_rate)
+{
+    uint32_t best = 0u;
+    uint64_t best_ppm = UINT64_MAX;
+    uint64_t expected;
+    uint64_t off;
+    uint64_t ppm;
+    uint32_t index;
+
+    for (index = 0u; index < AUTOBAUD_RATE_COUNT; index++)
+    {
+        /* Cycles the counted bit-times take at the standard rate */
+        expected = ((uint64_t) autobaud_clk_hz * m->bits) / autobaud_rates[index];
+        off = (m->cycles > expected) ? (m->cycles - expected) : (expected - m->cycles);
+        ppm = (off * 1000000u) / expected;
+        if ((off <= ((2u * (uint64_t) m->resolution) + ((expected * AUTOBAUD_SNAP_PPM) / 1000000u))) &&
+            (ppm < best_ppm))
+        {
+            best = autobaud_rates[index];
+            best_ppm = ppm;
+        }
+    }
+    if (best != 0u)
+    {
+        return best;
+    }
+
+    /* Each end of the counted bit-times is off by up to one sampling period */
+    if (((2u * (uint64_t) m->resolution * 1000000u) / m->cycles) <= (UART_BAUD_TOLERANCE_PPM / 2u))
+    {
+        return measured_rate;
+    }
+
+    return 0u;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_error_ppm
+********************************************************************************
+*
+* Summary:
+*  Returns the deviation of a measured rate from a reference rate.
+*
+* Parameters:
+*  measured: measured rate
+*  reference: reference rate, not 0
+*
+* Return:
+*  int32_t: deviation in parts per million
+*
+*******************************************************************************/
+static int32_t autobaud_error_ppm(uint32_t measured, uint32_t reference)
+{
+    return (int32_t) ((((int64_t) measured - (int64_t) reference) * 1000000) / (int64_t) reference);
+}
+
+/*******************************************************************************
+* Function Name: autobaud_edge
+********************************************************************************
+*
+* Summary:
+*  Measures the character whose start bit raised the interrupt of an armed
+*  port. A rate ends the detection. Otherwise the port stays armed for the
+*  next start bit.
+*
+* Parameters:
+*  index: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void autobaud_edge(uint32_t index)
+{
+    autobaud_port_t *ab = &autobaud_ports[index];
+    volatile autobaud_port_report_t *report = &autobaud_report.port[index];
+    autobaud_measurement_t m;
+    uint32_t measured_rate = 0u;
+    uint32_t rate = 0u;
+
+    if (autobaud_measure(ab, &m))
+    {
+        measured_rate = (uint32_t) ((((uint64_t) autobaud_clk_hz * m.bits) + (m.cycles / 2u)) / m.cycles);
+        rate = autobaud_choose(&m, measured_rate);
+    }
+
+    /* Drop the edges of the measured character */
+    Cy_GPIO_ClearInterrupt(ab->gpio, ab->pin);
+
+    report->measured_rate = measured_rate;
+    report->bits = m.bits;
+    report->resolution_ns = (m.resolution * 1000u) / autobaud_cycles_per_us;
+    report->measure_us = m.elapsed / autobaud_cycles_per_us;
+    if (rate == 0u)
+    {
+        report->rejects++;
+        return;
+    }
+
+    Cy_GPIO_SetInterruptEdge(ab->gpio, ab->pin, CY_GPIO_INTR_DISABLE);
+    ab->rate = rate;
+    ab->end = stats_now();
+    ab->armed = false;
+    ab->done = true;
+
+    report->armed = 0u;
+    report->rate = rate;
+    report->error_ppm = autobaud_error_ppm(measured_rate, rate);
+    report->detections++;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_isr
+********************************************************************************
+*
+* Summary:
+*  GPIO interrupt handler of the UART RX pins. Measures the character on each
+*  armed port whose pin raised the interrupt, and acknowledges the others.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void autobaud_isr(void)
+{
+    autobaud_port_t *ab;
+    uint32_t index;
+
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        ab = &autobaud_ports[index];
+        if ((ab->gpio == NULL) || (0u == Cy_GPIO_GetInterruptStatus(ab->gpio, ab->pin)))
+        {
+            continue;
+        }
+
+        if (ab->armed)
+        {
+            autobaud_edge(index);
+        }
+        else
+        {
+            Cy_GPIO_ClearInterrupt(ab->gpio, ab->pin);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: autobaud_bench_rate
+********************************************************************************
+*
+* Summary:
+*  Returns the rate of a benchmark step: the standard rates from
+*  AUTOBAUD_MIN_RATE up.
+*
+* Parameters:
+*  step: benchmark step, from 0
+*
+* Return:
+*  uint32_t: rate, 0 after the last step
+*
+*******************************************************************************/
+uint32_t autobaud_bench_rate(uint32_t step)
+{
+    uint32_t index;
+
+    for (index = 0u; index < AUTOBAUD_RATE_COUNT; index++)
+    {
+        if (autobaud_rates[index] >= AUTOBAUD_MIN_RATE)
+        {
+            if (step == 0u)
+            {
+                return autobaud_rates[index];
+            }
+            step--;
+        }
+    }
+
+    return 0u;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_bench_begin
+********************************************************************************
+*
+* Summary:
+*  Clears the benchmark results.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void autobaud_bench_begin(void)
+{
+    uint32_t index;
+
+    for (index = 0u; index < AUTOBAUD_RATE_COUNT; index++)
+    {
+        autobaud_report.bench[index] = autobaud_bench_none;
+    }
+    autobaud_report.bench_steps = 0u;
+    autobaud_report.bench_passed = 0u;
+    autobaud_report.bench_running = 1u;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_bench_record
+********************************************************************************
+*
+* Summary:
+*  Records the result of a benchmark step on port 0.
+*
+* Parameters:
+*  step: benchmark step
+*  rate: standard rate of the step
+*  actual_rate: rate the SCB produced, 0 if it cannot produce the rate
+*  detected_rate: rate detected, 0 if the detection timed out
+*  start: stats_now() when the character was written to the TX FIFO
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void autobaud_bench_record(uint32_t step, uint32_t rate, uint32_t actual_rate, uint32_t detected_rate,
+                           uint32_t start)
+{
+    volatile autobaud_bench_t *entry = &autobaud_report.bench[step];
+
+    entry->rate = rate;
+    entry->actual_rate = actual_rate;
+    entry->detected_rate = detected_rate;
+    if (detected_rate != 0u)
+    {
+        entry->measured_rate = autobaud_report.port[0].measured_rate;
+        entry->error_ppm = autobaud_error_ppm(entry->measured_rate, actual_rate);
+        entry->measure_us = autobaud_report.port[0].measure_us;
+        entry->detect_us = (autobaud_ports[0].end - start) / autobaud_cycles_per_us;
+    }
+    if (detected_rate == rate)
+    {
+        autobaud_report.bench_passed++;
+    }
+    autobaud_report.bench_steps = step + 1u;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_bench_end
+********************************************************************************
+*
+* Summary:
+*  Marks the benchmark as finished.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void autobaud_bench_end(void)
+{
+    autobaud_report.bench_running = 0u;
+}
+
+/*******************************************************************************
+* Function Name: autobaud_snapshot
+********************************************************************************
+*
+* Summary:
+*  Returns a copy of autobaud_report for the AUTOBAUD_VENDOR_REQ_RESULT data
+*  stage. Called from the USB interrupt.
+*
+* Parameters:
+*  length: returns the size of the copy in bytes
+*
+* Return:
+*  const uint8_t *: the copy
+*
+*******************************************************************************/
+const uint8_t *autobaud_snapshot(uint32_t *length)
+{
+    autobaud_copy = autobaud_report;
+    *length = sizeof(autobaud_copy);
+
+    return (const uint8_t *) &autobaud_copy;
+}
+
+#endif /* AUTOBAUD */
@@ -0,0 +1,133 @@
+/******************************************************************************
+* File Name: autobaud.h
+*
+* Description: This file contains the interface of the automatic baud-rate
+*              detection on UART RX and of the vendor requests that control it
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef AUTOBAUD_H_
+#define AUTOBAUD_H_
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+
+
+/*******************************************************************************
+*        Macros
+*******************************************************************************/
+/* Vendor requests on EP0, recipient device.
+ * AUTOBAUD_VENDOR_REQ_START (host to device, no data): wValue AUTOBAUD_DETECT
+ * starts a detection on the bridge port in wIndex, AUTOBAUD_BENCH starts the
+ * loopback benchmark on port 0 and AUTOBAUD_CANCEL stops either one.
+ * AUTOBAUD_VENDOR_REQ_RESULT (device to host): returns autobaud_report_t,
+ * truncated to wLength. */
+#define AUTOBAUD_VENDOR_REQ_START   (0x08u)
+#define AUTOBAUD_VENDOR_REQ_RESULT  (0x09u)
+
+#define AUTOBAUD_CANCEL             (0u)
+#define AUTOBAUD_DETECT             (1u)
+#define AUTOBAUD_BENCH              (2u)
+
+/* Character sent by the benchmark. Its bits alternate, so every bit is
+ * bounded by two edges. */
+#define AUTOBAUD_SYNC_CHAR          (0x55u)
+
+/* Standard rates of autobaud_rates */
+#define AUTOBAUD_RATE_COUNT         (18u)
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Last measurement of a bridge port */
+typedef struct
+{
+    uint32_t armed;             /* 1 while the port waits for a character to measure */
+    uint32_t rate;              /* Rate of the last detection */
+    uint32_t measured_rate;     /* Rate measured from the edges of the last character */
+    int32_t error_ppm;          /* measured_rate against rate */
+    uint32_t bits;              /* Bit-times the measurement spans */
+    uint32_t resolution_ns;     /* Sampling period of the edges */
+    uint32_t measure_us;        /* Duration of the measurement */
+    uint32_t detections;        /* Characters that gave a rate */
+    uint32_t rejects;           /* Characters that gave no rate */
+} autobaud_port_report_t;
+
+/* One step of the loopback benchmark: the UART sends AUTOBAUD_SYNC_CHAR at
+ * rate and the detection measures it on UART RX */
+typedef struct
+{
+    uint32_t rate;              /* Standard rate requested from the SCB */
+    uint32_t actual_rate;       /* Rate the SCB clock divider produces */
+    uint32_t detected_rate;     /* Rate the detection chose, 0 if it timed out */
+    uint32_t measured_rate;     /* Rate measured from the edges */
+    int32_t error_ppm;          /* measured_rate against actual_rate */
+    uint32_t measure_us;        /* Duration of the measurement */
+    uint32_t detect_us;         /* Time from the character being written to the TX FIFO to the result */
+} autobaud_bench_t;
+
+/* Results, sent to the host as 32-bit little-endian words */
+typedef struct
+{
+    autobaud_port_report_t port[BRIDGE_PORTS];
+    uint32_t bench_running;     /* 1 while the benchmark runs */
+    uint32_t bench_steps;       /* Entries of bench filled */
+    uint32_t bench_passed;      /* Steps whose detected_rate equals rate */
+    autobaud_bench_t bench[AUTOBAUD_RATE_COUNT];
+} autobaud_report_t;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void autobaud_init(void);
+bool autobaud_request(uint32_t index, uint32_t mode);
+bool autobaud_take_request(uint32_t index, uint32_t *mode);
+void autobaud_arm(uint32_t index, GPIO_PRT_Type *gpio, uint32_t pin);
+void autobaud_disarm(uint32_t index);
+bool autobaud_armed(uint32_t index);
+bool autobaud_take_result(uint32_t index, uint32_t *rate);
+void autobaud_isr(void);
+uint32_t autobaud_bench_rate(uint32_t step);
+void autobaud_bench_begin(void);
+void autobaud_bench_record(uint32_t step, uint32_t rate, uint32_t actual_rate, uint32_t detected_rate,
+                           uint32_t start);
+void autobaud_bench_end(void);
+const uint8_t *autobaud_snapshot(uint32_t *length);
+
+extern volatile autobaud_report_t autobaud_report;
+
+
+#endif /* AUTOBAUD_H_ */
@@ -0,0 +1,405 @@
+/******************************************************************************
+* File Name: bench.c
+*
+* Description: This file contains the optional on-target benchmark that measures
+*              the throughput, latency and interrupt load of the bridge
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "bench.h"
+
+#if (BRIDGE_BENCH != 0u)
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Number of queued IN chunks whose timestamps are tracked. When more chunks
+ * are waiting, new bytes share the timestamp of the newest tracked chunk. */
+#define BENCH_IN_STAMPS         (32u)
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+volatile bench_report_t bench_report;
+
+static uint32_t bench_cycles_per_us;
+static uint64_t bench_elapsed_cycles;
+static uint32_t bench_last_report;
+
+static uint32_t bench_out_total;
+static uint32_t bench_in_total;
+static uint32_t bench_isr_total[STATS_ISR_COUNT];
+
+/* Byte-weighted latency histograms, BENCH_LATENCY_BUCKET_US per bucket. The
+ * last bucket also holds all longer latencies. */
+static uint32_t bench_out_hist[BENCH_LATENCY_BUCKETS];
+static uint32_t bench_in_hist[BENCH_LATENCY_BUCKETS];
+
+/* FIFO of the chunks waiting in rx_queue, in queue order */
+static uint32_t bench_in_stamp[BENCH_IN_STAMPS];
+static uint32_t bench_in_stamp_bytes[BENCH_IN_STAMPS];
+static uint32_t bench_in_stamp_read;
+static uint32_t bench_in_stamp_count;
+
+
+/*******************************************************************************
+* Function Name: bench_add_latency
+********************************************************************************
+*
+* Summary:
+*  Adds bytes with the given latency to a histogram.
+*
+* Parameters:
+*  hist: histogram to update
+*  latency: latency in CPU cycles
+*  bytes: number of bytes with this latency
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bench_add_latency(uint32_t *hist, uint32_t latency, uint32_t bytes)
+{
+    uint32_t bucket = (latency / bench_cycles_per_us) / BENCH_LATENCY_BUCKET_US;
+
+    if (bucket >= BENCH_LATENCY_BUCKETS)
+    {
+        bucket = BENCH_LATENCY_BUCKETS - 1u;
+    }
+    hist[bucket] += bytes;
+}
+
+/*******************************************************************************
+* Function Name: bench_percentile
+********************************************************************************
+*
+* Summary:
+*  Returns the upper edge of the histogram bucket that holds the given
+*  percentile of the bytes.
+*
+* Parameters:
+*  hist: histogram to evaluate
+*  percent: percentile, 1 to 100
+*
+* Return:
+*  uint32_t: latency in microseconds, 0 if the histogram is empty
+*
+*******************************************************************************/
+static uint32_t bench_percentile(const uint32_t *hist, uint32_t percent)
+{
+    uint64_t total = 0u;
+    uint64_t target;
+    uint64_t sum = 0u;
+    uint32_t bucket;
+
+    for (bucket = 0u; bucket < BENCH_LATENCY_BUCKETS; bucket++)
+    {
+        total += hist[bucket];
+    }
+    if (total == 0u)
+    {
+        return 0u;
+    }
+
+    target = ((total * percent) + 99u) / 100u;
+    for (bucket = 0u; bucket < (BENCH_LATENCY_BUCKETS - 1u); bucket++)
+    {
+        sum += hist[bucket];
+        if (sum >= target)
+        {
+            break;
+        }
+    }
+
+    return (bucket + 1u) * BENCH_LATENCY_BUCKET_US;
+}
+
+/*******************************************************************************
+* Function Name: bench_init
+********************************************************************************
+*
+* Summary:
+*  Initializes the benchmark. Must be called after the SysTick time base has
+*  been started.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bench_init(void)
+{
+    bench_cycles_per_us = Cy_SysClk_ClkSysGetFrequency() / 1000000u;
+    bench_reset();
+}
+
+/*******************************************************************************
+* Function Name: bench_reset
+********************************************************************************
+*
+* Summary:
+*  Clears all measurements and starts a new measurement window.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bench_reset(void)
+{
+    uint32_t int_state;
+    uint32_t index;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+
+    bench_out_total = 0u;
+    bench_in_total = 0u;
+    for (index = 0u; index < STATS_ISR_COUNT; index++)
+    {
+        bench_isr_total[index] = 0u;
+    }
+    for (index = 0u; index < BENCH_LATENCY_BUCKETS; index++)
+    {
+        bench_out_hist[index] = 0u;
+        bench_in_hist[index] = 0u;
+    }
+
+    /* Chunks still in rx_queue keep their timestamps */
+    bench_elapsed_cycles = 0u;
+    bench_last_report = stats_now();
+
+    Cy_SysLib_ExitCriticalSection(int_state);
+}
+
+/*******************************************************************************
+* Function Name: bench_task
+********************************************************************************
+*
+* Summary:
+*  Refreshes bench_report every BENCH_REPORT_PERIOD_MS. Called from the main
+*  loop.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bench_task(void)
+{
+    uint32_t int_state;
+    uint32_t now;
+    uint32_t out_bytes;
+    uint32_t in_bytes;
+    uint32_t isr_sum = 0u;
+    uint32_t index;
+    uint64_t elapsed;
+
+    now = stats_now();
+    if ((now - bench_last_report) < (BENCH_REPORT_PERIOD_MS * 1000u * bench_cycles_per_us))
+    {
+        return;
+    }
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    bench_elapsed_cycles += now - bench_last_report;
+    bench_last_report = now;
+    out_bytes = bench_out_total;
+    in_bytes = bench_in_total;
+    for (index = 0u; index < STATS_ISR_COUNT; index++)
+    {
+        bench_report.isr_count[index] = bench_isr_total[index];
+        isr_sum += bench_isr_total[index];
+    }
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    elapsed = bench_elapsed_cycles;
+
+    bench_report.elapsed_ms = (uint32_t) (elapsed / (1000u * bench_cycles_per_us));
+    bench_report.out_bytes = out_bytes;
+    bench_report.in_bytes = in_bytes;
+    bench_report.out_bytes_per_s = (uint32_t) (((uint64_t) out_bytes * 1000000u * bench_cycles_per_us) / elapsed);
+    bench_report.in_bytes_per_s = (uint32_t) (((uint64_t) in_bytes * 1000000u * bench_cycles_per_us) / elapsed);
+    bench_report.isr_per_kb = ((out_bytes + in_bytes) == 0u) ? 0u :
+                              (uint32_t) (((uint64_t) isr_sum * 1024u) / (out_bytes + in_bytes));
+
+    /* The histograms are read while the ISRs keep updating them; the few
+     * bytes added meanwhile do not move the percentiles noticeably. */
+    bench_report.out_latency_p50_us = bench_percentile(bench_out_hist, 50u);
+    bench_report.out_latency_p99_us = bench_percentile(bench_out_hist, 99u);
+    bench_report.in_latency_p50_us = bench_percentile(bench_in_hist, 50u);
+    bench_report.in_latency_p99_us = bench_percentile(bench_in_hist, 99u);
+}
+
+/*******************************************************************************
+* Function Name: bench_isr
+********************************************************************************
+*
+* Summary:
+*  Counts one invocation of an interrupt handler. Called from
+*  stats_isr_done; each handler only updates its own counter.
+*
+* Parameters:
+*  isr: interrupt handler
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bench_isr(stats_isr_t isr)
+{
+    bench_isr_total[isr]++;
+}
+
+/*******************************************************************************
+* Function Name: bench_out_latency
+********************************************************************************
+*
+* Summary:
+*  Records the time from the arrival of an OUT packet to UART_TX_DMA writing
+*  its last byte to the TX FIFO. Called from dma_work_isr.
+*
+* Parameters:
+*  latency: latency in CPU cycles
+*  length: packet length
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bench_out_latency(uint32_t latency, uint32_t length)
+{
+    bench_add_latency(bench_out_hist, latency, length);
+    bench_out_total += length;
+}
+
+/*******************************************************************************
+* Function Name: bench_in_queued
+********************************************************************************
+*
+* Summary:
+*  Records UART RX bytes appended to rx_queue. Must be called from
+*  dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  length: number of bytes appended
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bench_in_queued(uint32_t length)
+{
+    uint32_t index;
+
+    if (length == 0u)
+    {
+        return;
+    }
+
+    if (bench_in_stamp_count < BENCH_IN_STAMPS)
+    {
+        index = (bench_in_stamp_read + bench_in_stamp_count) % BENCH_IN_STAMPS;
+        bench_in_stamp[index] = stats_now();
+        bench_in_stamp_bytes[index] = length;
+        bench_in_stamp_count++;
+    }
+    else
+    {
+        index = (bench_in_stamp_read + BENCH_IN_STAMPS - 1u) % BENCH_IN_STAMPS;
+        bench_in_stamp_bytes[index] += length;
+    }
+}
+
+/*******************************************************************************
+* Function Name: bench_in_sent
+********************************************************************************
+*
+* Summary:
+*  Records UART RX bytes loaded into EP2. Bytes loaded directly have no
+*  latency; bytes taken from rx_queue are charged with the time they waited
+*  there. Must be called from dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  length: number of bytes loaded
+*  from_queue: true if the bytes were taken from rx_queue
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void bench_in_sent(uint32_t length, bool from_queue)
+{
+    uint32_t now;
+    uint32_t part;
+    uint32_t remaining = length;
+
+    bench_in_total += length;
+
+    if (!from_queue)
+    {
+        bench_add_latency(bench_in_hist, 0u, length);
+        return;
+    }
+
+    now = stats_now();
+    while ((remaining != 0u) && (bench_in_stamp_count != 0u))
+    {
+        part = bench_in_stamp_bytes[bench_in_stamp_read];
+        if (part > remaining)
+        {
+            part = remaining;
+        }
+
+        bench_add_latency(bench_in_hist, now - bench_in_stamp[bench_in_stamp_read], part);
+        remaining -= part;
+
+        bench_in_stamp_bytes[bench_in_stamp_read] -= part;
+        if (bench_in_stamp_bytes[bench_in_stamp_read] == 0u)
+        {
+            bench_in_stamp_read = (bench_in_stamp_read + 1u) % BENCH_IN_STAMPS;
+            bench_in_stamp_count--;
+        }
+    }
+}
+
+#endif /* BRIDGE_BENCH */
@@ -0,0 +1,99 @@
+/******************************************************************************
+* File Name: bench.h
+*
+* Description: This file contains the interface of the optional on-target
+*              throughput and latency benchmark instrumentation
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "stats.h"
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Benchmark results, refreshed by bench_task every BENCH_REPORT_PERIOD_MS.
+ * OUT is host to UART, IN is UART to host. Latencies are byte-weighted
+ * percentiles in microseconds; a value of BENCH_LATENCY_BUCKETS times
+ * BENCH_LATENCY_BUCKET_US or more means "at least". */
+typedef struct
+{
+    uint32_t elapsed_ms;
+    uint32_t out_bytes;
+    uint32_t in_bytes;
+    uint32_t out_bytes_per_s;
+    uint32_t in_bytes_per_s;
+    uint32_t out_latency_p50_us;
+    uint32_t out_latency_p99_us;
+    uint32_t in_latency_p50_us;
+    uint32_t in_latency_p99_us;
+    uint32_t isr_count[STATS_ISR_COUNT];
+    uint32_t isr_per_kb;
+} bench_report_t;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+#if (BRIDGE_BENCH != 0u)
+
+void bench_init(void);
+void bench_reset(void);
+void bench_task(void);
+void bench_isr(stats_isr_t isr);
+void bench_out_latency(uint32_t latency, uint32_t length);
+void bench_in_queued(uint32_t length);
+void bench_in_sent(uint32_t length, bool from_queue);
+
+extern volatile bench_report_t bench_report;
+
+#else
+
+#define bench_init()                        ((void) 0)
+#define bench_reset()                       ((void) 0)
+#define bench_task()                        ((void) 0)
+#define bench_isr(isr)                      ((void) (isr))
+#define bench_out_latency(latency, length)  ((void) (latency), (void) (length))
+#define bench_in_queued(length)             ((void) (length))
+#define bench_in_sent(length, from_queue)   ((void) (length), (void) (from_queue))
+
+#endif /* BRIDGE_BENCH */
+
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,205 @@
+/******************************************************************************
+* File Name: dma_alloc.c
+*
+* Description: This file contains the DMA channel allocator. The bridge ports
+*              claim their channels here, which assigns the channel priorities and
+*              tells dma_isr which port and path a channel belongs to
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "dma_alloc.h"
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+/* Priority of each role, 0 being the highest. A UART RX FIFO overflows if its
+ * request waits, the host retries an endpoint that is not ready, and a late
+ * UART TX request only leaves the line idle for a moment. Channels of equal
+ * priority are served in channel order. The USBFS driver initializes the
+ * endpoint channels itself, from design.modus, which must use the priorities
+ * given here. */
+static const uint32_t dma_role_priority[DMA_ROLE_COUNT] =
+{
+    [DMA_ROLE_UART_RX] = 0u,
+    [DMA_ROLE_USB_OUT] = 1u,
+    [DMA_ROLE_USB_IN] = 1u,
+    [DMA_ROLE_UART_TX] = 2u
+};
+
+/* Claimed channels, one bit per channel, with their role and owner */
+static uint32_t dma_alloc_claimed;
+static dma_role_t dma_alloc_roles[DMA_ALLOC_CHANNELS];
+static uint32_t dma_alloc_owners[DMA_ALLOC_CHANNELS];
+
+
+/*******************************************************************************
+* Function Name: dma_alloc_init
+********************************************************************************
+*
+* Summary:
+*  Releases all channels. Called once before the ports claim theirs.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void dma_alloc_init(void)
+{
+    dma_alloc_claimed = 0u;
+}
+
+/*******************************************************************************
+* Function Name: dma_alloc_claim
+********************************************************************************
+*
+* Summary:
+*  Claims a channel for a role of a port. The channel numbers come from
+*  design.modus, where the trigger of each channel is routed, so a claim
+*  fails if two paths were given the same channel.
+*
+* Parameters:
+*  channel: DMA channel
+*  role: use of the channel
+*  owner: index of the bridge port
+*
+* Return:
+*  bool: false if the channel does not exist or is already claimed
+*
+*******************************************************************************/
+bool dma_alloc_claim(uint32_t channel, dma_role_t role, uint32_t owner)
+{
+    if ((channel >= DMA_ALLOC_CHANNELS) || (0u != (dma_alloc_claimed & (1UL << channel))))
+    {
+        return false;
+    }
+
+    dma_alloc_claimed |= (1UL << channel);
+    dma_alloc_roles[channel] = role;
+    dma_alloc_owners[channel] = owner;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: dma_alloc_priority
+********************************************************************************
+*
+* Summary:
+*  Returns the priority of a claimed channel, which overrides the priority of
+*  its channel configuration in design.modus.
+*
+* Parameters:
+*  channel: claimed DMA channel
+*
+* Return:
+*  uint32_t: channel priority, 0 being the highest
+*
+*******************************************************************************/
+uint32_t dma_alloc_priority(uint32_t channel)
+{
+    return dma_role_priority[dma_alloc_roles[channel]];
+}
+
+/*******************************************************************************
+* Function Name: dma_alloc_role
+********************************************************************************
+*
+* Summary:
+*  Returns the role a channel was claimed for.
+*
+* Parameters:
+*  channel: claimed DMA channel
+*
+* Return:
+*  dma_role_t: role of the channel
+*
+*******************************************************************************/
+dma_role_t dma_alloc_role(uint32_t channel)
+{
+    return dma_alloc_roles[channel];
+}
+
+/*******************************************************************************
+* Function Name: dma_alloc_owner
+********************************************************************************
+*
+* Summary:
+*  Returns the port a channel was claimed by.
+*
+* Parameters:
+*  channel: claimed DMA channel
+*
+* Return:
+*  uint32_t: index of the bridge port
+*
+*******************************************************************************/
+uint32_t dma_alloc_owner(uint32_t channel)
+{
+    return dma_alloc_owners[channel];
+}
+
+/*******************************************************************************
+* Function Name: dma_alloc_mask
+********************************************************************************
+*
+* Summary:
+*  Returns the channels claimed for a role, in the bit layout of the DMAC
+*  interrupt registers.
+*
+* Parameters:
+*  role: use of the channels
+*
+* Return:
+*  uint32_t: one bit per channel
+*
+*******************************************************************************/
+uint32_t dma_alloc_mask(dma_role_t role)
+{
+    uint32_t mask = 0u;
+    uint32_t channel;
+
+    for (channel = 0u; channel < DMA_ALLOC_CHANNELS; channel++)
+    {
+        if ((0u != (dma_alloc_claimed & (1UL << channel))) && (dma_alloc_roles[channel] == role))
+        {
+            mask |= (1UL << channel);
+        }
+    }
+
+    return mask;
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+* File Name: dma_alloc.h
+*
+* Description: This file contains the interface of the DMA channel allocator
+*              that assigns the channels and priorities of the bridge ports
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef DMA_ALLOC_H_
+#define DMA_ALLOC_H_
+
+#include "cy_pdl.h"
+
+
+/*******************************************************************************
+*        Macros
+*******************************************************************************/
+/* Channels of the DMAC */
+#define DMA_ALLOC_CHANNELS      (16u)
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Use of a DMA channel. The role sets the channel priority. */
+typedef enum
+{
+    DMA_ROLE_UART_RX,       /* UART_RX_DMA of a port */
+    DMA_ROLE_UART_TX,       /* UART_TX_DMA of a port */
+    DMA_ROLE_USB_OUT,       /* Automatic DMA of an OUT endpoint of a port */
+    DMA_ROLE_USB_IN,        /* Automatic DMA of an IN endpoint of a port */
+    DMA_ROLE_COUNT
+} dma_role_t;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void dma_alloc_init(void);
+bool dma_alloc_claim(uint32_t channel, dma_role_t role, uint32_t owner);
+uint32_t dma_alloc_priority(uint32_t channel);
+dma_role_t dma_alloc_role(uint32_t channel);
+uint32_t dma_alloc_owner(uint32_t channel);
+uint32_t dma_alloc_mask(dma_role_t role);
+
+
+#endif /* DMA_ALLOC_H_ */
@@ -0,0 +1,327 @@
+/******************************************************************************
+* File Name: frame.c
+*
+* Description: This file contains the SLIP (RFC 1055) and COBS encoder for the
+*              OUT path and decoder for the IN path of the frame-aware
+*              forwarding mode
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "frame.h"
+
+#if (FRAME_MODE != FRAME_MODE_NONE)
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* SLIP escape sequences. FRAME_DELIMITER takes the place of END. */
+#define SLIP_ESC                (0xDBu)
+#define SLIP_ESC_END            (0xDCu)
+#define SLIP_ESC_ESC            (0xDDu)
+
+
+/*******************************************************************************
+* Function Name: frame_reset_encoder
+********************************************************************************
+*
+* Summary:
+*  Discards the frame being encoded, for example after the OUT path has been
+*  flushed.
+*
+* Parameters:
+*  encoder: encoder state of the port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void frame_reset_encoder(frame_encoder_t *encoder)
+{
+    encoder->open = false;
+#if (FRAME_MODE == FRAME_MODE_COBS)
+    encoder->cobs_block_length = 0u;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: frame_reset_decoder
+********************************************************************************
+*
+* Summary:
+*  Discards the frame being decoded. Bytes up to the next delimiter are
+*  decoded as a new frame.
+*
+* Parameters:
+*  decoder: decoder state of the port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void frame_reset_decoder(frame_decoder_t *decoder)
+{
+    decoder->data = false;
+    decoder->error = false;
+#if (FRAME_MODE == FRAME_MODE_SLIP)
+    decoder->slip_escaped = false;
+#else
+    decoder->cobs_remaining = 0u;
+    decoder->cobs_zero_pending = false;
+#endif
+}
+
+#if (FRAME_MODE == FRAME_MODE_COBS)
+/*******************************************************************************
+* Function Name: cobs_emit_block
+********************************************************************************
+*
+* Summary:
+*  Writes the current COBS block, its code byte first, with every byte XORed
+*  with FRAME_DELIMITER.
+*
+* Parameters:
+*  encoder: encoder state of the port
+*  out: buffer to write to
+*
+* Return:
+*  uint32_t: number of bytes written
+*
+*******************************************************************************/
+static uint32_t cobs_emit_block(frame_encoder_t *encoder, uint8_t *out)
+{
+    uint32_t index;
+
+    out[0] = (uint8_t) ((encoder->cobs_block_length + 1u) ^ FRAME_DELIMITER);
+    for (index = 0u; index < encoder->cobs_block_length; index++)
+    {
+        out[index + 1u] = (uint8_t) (encoder->cobs_block[index] ^ FRAME_DELIMITER);
+    }
+    encoder->cobs_block_length = 0u;
+
+    return index + 1u;
+}
+#endif
+
+/*******************************************************************************
+* Function Name: frame_encode
+********************************************************************************
+*
+* Summary:
+*  Encodes the next bytes of an OUT frame for UART TX. A SLIP frame starts and
+*  ends with FRAME_DELIMITER. A COBS frame ends with it; its bytes are held
+*  until the COBS block they belong to is complete. Empty frames are not sent.
+*
+* Parameters:
+*  encoder: encoder state of the port
+*  data: bytes of the frame
+*  length: number of bytes
+*  end: true if these are the last bytes of the frame
+*  out: buffer of at least FRAME_OUT_MAX_BYTES for the encoded bytes, when
+*       length is at most USB_EP_PACKET_SIZE
+*
+* Return:
+*  uint32_t: number of bytes written to out
+*
+*******************************************************************************/
+uint32_t frame_encode(frame_encoder_t *encoder, const uint8_t *data, uint32_t length, bool end, uint8_t *out)
+{
+    uint32_t count = 0u;
+    uint32_t index;
+
+    if (length != 0u)
+    {
+#if (FRAME_MODE == FRAME_MODE_SLIP)
+        /* A leading delimiter ends any noise the receiver has picked up */
+        if (!encoder->open)
+        {
+            out[count++] = FRAME_DELIMITER;
+        }
+#endif
+        encoder->open = true;
+    }
+
+    for (index = 0u; index < length; index++)
+    {
+#if (FRAME_MODE == FRAME_MODE_SLIP)
+        if (data[index] == FRAME_DELIMITER)
+        {
+            out[count++] = SLIP_ESC;
+            out[count++] = SLIP_ESC_END;
+        }
+        else if (data[index] == SLIP_ESC)
+        {
+            out[count++] = SLIP_ESC;
+            out[count++] = SLIP_ESC_ESC;
+        }
+        else
+        {
+            out[count++] = data[index];
+        }
+#else
+        if (data[index] == 0u)
+        {
+            count += cobs_emit_block(encoder, &out[count]);
+        }
+        else
+        {
+            encoder->cobs_block[encoder->cobs_block_length++] = data[index];
+            if (encoder->cobs_block_length == FRAME_COBS_BLOCK_MAX)
+            {
+                count += cobs_emit_block(encoder, &out[count]);
+            }
+        }
+#endif
+    }
+
+    if (end && encoder->open)
+    {
+#if (FRAME_MODE == FRAME_MODE_COBS)
+        count += cobs_emit_block(encoder, &out[count]);
+#endif
+        out[count++] = FRAME_DELIMITER;
+        encoder->open = false;
+    }
+
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: frame_decode
+********************************************************************************
+*
+* Summary:
+*  Decodes UART RX bytes up to the end of the current frame. Empty frames
+*  between two delimiters are skipped. A frame that breaks the encoding rules
+*  is still ended, with the bytes decoded from it.
+*
+* Parameters:
+*  decoder: decoder state of the port
+*  data: received bytes
+*  length: number of received bytes
+*  used: returns the number of bytes consumed from data
+*  out: buffer of at least length bytes for the decoded bytes
+*  out_length: returns the number of bytes written to out
+*
+* Return:
+*  frame_event_t: FRAME_EVENT_END or FRAME_EVENT_ERROR if the frame ended at
+*  data[*used - 1], FRAME_EVENT_NONE if all of data was consumed
+*
+*******************************************************************************/
+frame_event_t frame_decode(frame_decoder_t *decoder, const uint8_t *data, uint32_t length, uint32_t *used,
+                           uint8_t *out, uint32_t *out_length)
+{
+    frame_event_t event;
+    uint32_t count = 0u;
+    uint32_t index;
+    uint32_t byte;
+
+    for (index = 0u; index < length; index++)
+    {
+        byte = data[index];
+
+        if (byte == FRAME_DELIMITER)
+        {
+#if (FRAME_MODE == FRAME_MODE_SLIP)
+            decoder->error = decoder->error || decoder->slip_escaped;
+#else
+            /* The zero that would follow the last block is not part of the frame */
+            decoder->error = decoder->error || (decoder->cobs_remaining != 0u);
+#endif
+            if (decoder->data || decoder->error)
+            {
+                event = decoder->error ? FRAME_EVENT_ERROR : FRAME_EVENT_END;
+                frame_reset_decoder(decoder);
+                *used = index + 1u;
+                *out_length = count;
+                return event;
+            }
+            frame_reset_decoder(decoder);
+            continue;
+        }
+
+#if (FRAME_MODE == FRAME_MODE_SLIP)
+        if (decoder->slip_escaped)
+        {
+            decoder->slip_escaped = false;
+            if (byte == SLIP_ESC_END)
+            {
+                byte = FRAME_DELIMITER;
+            }
+            else if (byte == SLIP_ESC_ESC)
+            {
+                byte = SLIP_ESC;
+            }
+            else
+            {
+                /* Keep the byte, as most SLIP receivers do */
+                decoder->error = true;
+            }
+        }
+        else if (byte == SLIP_ESC)
+        {
+            decoder->slip_escaped = true;
+            continue;
+        }
+        out[count++] = (uint8_t) byte;
+        decoder->data = true;
+#else
+        byte ^= FRAME_DELIMITER;
+        if (decoder->cobs_remaining == 0u)
+        {
+            /* Code byte: length of the next block */
+            if (decoder->cobs_zero_pending)
+            {
+                out[count++] = 0u;
+            }
+            decoder->cobs_remaining = byte - 1u;
+            decoder->cobs_zero_pending = (byte != 0xFFu);
+        }
+        else
+        {
+            out[count++] = (uint8_t) byte;
+            decoder->cobs_remaining--;
+        }
+        decoder->data = decoder->data || (count != 0u);
+#endif
+    }
+
+    *used = length;
+    *out_length = count;
+
+    return FRAME_EVENT_NONE;
+}
+
+#endif /* FRAME_MODE */
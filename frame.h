@@ -0,0 +1,107 @@
+/******************************************************************************
+* File Name: frame.h
+*
+* Description: This file contains the interface of the SLIP and COBS framing
+*              engine of the frame-aware forwarding mode
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+
+
+/*******************************************************************************
+*        Macros
+*******************************************************************************/
+/* Most data bytes in a COBS block, sent with code 0xFF */
+#define FRAME_COBS_BLOCK_MAX    (254u)
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Result of frame_decode */
+typedef enum
+{
+    FRAME_EVENT_NONE,           /* All input consumed, the frame continues */
+    FRAME_EVENT_END,            /* A frame with at least one byte has ended */
+    FRAME_EVENT_ERROR           /* A frame has ended but was not encoded correctly */
+} frame_event_t;
+
+/* Encoder state of one bridge port. open is set once a frame has started on
+ * UART TX. With COBS, the data bytes of the current block wait in cobs_block
+ * until the block length, which is sent first, is known. */
+typedef struct
+{
+    bool open;
+#if (FRAME_MODE == FRAME_MODE_COBS)
+    uint8_t cobs_block[FRAME_COBS_BLOCK_MAX];
+    uint32_t cobs_block_length;
+#endif
+} frame_encoder_t;
+
+/* Decoder state of one bridge port. data is set once the current frame has
+ * produced a byte, error once it has broken the encoding rules. With COBS,
+ * cobs_remaining counts the data bytes left in the current block, and
+ * cobs_zero_pending tells whether the block ends in a zero that is only
+ * written once another block follows. */
+typedef struct
+{
+    bool data;
+    bool error;
+#if (FRAME_MODE == FRAME_MODE_SLIP)
+    bool slip_escaped;
+#else
+    uint32_t cobs_remaining;
+    bool cobs_zero_pending;
+#endif
+} frame_decoder_t;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+#if (FRAME_MODE != FRAME_MODE_NONE)
+void frame_reset_encoder(frame_encoder_t *encoder);
+void frame_reset_decoder(frame_decoder_t *decoder);
+uint32_t frame_encode(frame_encoder_t *encoder, const uint8_t *data, uint32_t length, bool end, uint8_t *out);
+frame_event_t frame_decode(frame_decoder_t *decoder, const uint8_t *data, uint32_t length, uint32_t *used,
+                           uint8_t *out, uint32_t *out_length);
+#endif /* FRAME_MODE */
+
+
+#endif /* FRAME_H_ */
@@ -51,18 +51,391 @@
 #include "cy_usb_dev_cdc.h"
 #include "cycfg_usbdev.h"
 
+#include "usb_uart_config.h"
 #include "usb_uart_dma.h"
-#include "cy_trigmux.h"
+#include "rx_queue.h"
+#include "stats.h"
+#include "bench.h"
+#include "selftest.h"
+#include "frame.h"
+#include "trace.h"
+#include "work.h"
+#include "dma_alloc.h"
+#include "sniffer.h"
+#include "pool.h"
+#include "autobaud.h"
 
 /*******************************************************************************
  * Macros
  ********************************************************************************/
-#define USB_BUFFER_SIZE (16u)
-#define PING_PONG_BUF_SIZE (8u)
-#define USB_COM_PORT    (0u)
+/* Data endpoints of the CDC interface of port 0 */
 #define USB_EP_3_OUT    (3u)
 #define USB_EP_2_IN     (2u)
 
+/* DMA channel that design.modus assigns to the automatic DMA of a USB
+ * endpoint: EP2 on channel 9, EP3 on channel 10 */
+#define USB_EP_DMA_CHANNEL(endpoint)    ((endpoint) + 7u)
+
+/* Endpoint number of an endpoint address reported by the USBFS driver */
+#define USB_EP_NUMBER(address)      ((address) & 0x0Fu)
+
+/* Index of a bridge port in bridge_ports */
+#define PORT_INDEX(port)            ((uint32_t) ((port) - bridge_ports))
+
+/* SysTick ticks per bus activity sample and per sleep statistics window */
+#define USB_ACTIVITY_CHECK_TICKS    (1000u / TICK_PERIOD_US)
+#define SLEEP_STATS_WINDOW_TICKS    (1000000u / TICK_PERIOD_US)
+
+/* Vendor request that sets the IN coalescing timeout of the port in wIndex
+ * to wValue microseconds */
+#define VENDOR_REQ_SET_IN_COALESCE  (0x03u)
+
+/* CDC SEND_BREAK class request. wValue is the break length in milliseconds,
+ * CDC_BREAK_UNTIL_STOPPED holds the break until a request with 0 ends it. */
+#define CDC_REQ_SEND_BREAK          (0x23u)
+#define CDC_BREAK_UNTIL_STOPPED     (0xFFFFu)
+
+/* UART state bits of the CDC SERIAL_STATE notification. DCD, DSR and RING
+ * are not available on this bridge. */
+#define SERIAL_STATE_BREAK          (0x04u)
+#define SERIAL_STATE_FRAMING        (0x10u)
+#define SERIAL_STATE_PARITY         (0x20u)
+#define SERIAL_STATE_OVERRUN        (0x40u)
+
+/* UART RX conditions reported to the host as SERIAL_STATE */
+#define UART_RX_LINE_ERRORS         (CY_SCB_UART_RX_ERR_FRAME | CY_SCB_UART_RX_ERR_PARITY | CY_SCB_UART_RX_BREAK_DETECT)
+
+/* UART_TX_DMA descriptor that sends a tx_ring slot */
+#if (OUT_DMA_CHAIN != 0u)
+#define TX_SLOT_DESCRIPTOR(slot)    ((0u != ((slot) & 1u)) ? CY_DMAC_DESCRIPTOR_PONG : CY_DMAC_DESCRIPTOR_PING)
+#else
+#define TX_SLOT_DESCRIPTOR(slot)    (CY_DMAC_DESCRIPTOR_PING)
+#endif
+
+/* True while the tx_ring of a port has room for the slots of one more OUT
+ * packet */
+#define TX_RING_HAS_ROOM(port)      (((port)->tx_ring_count + OUT_PACKET_SLOTS) <= OUT_RING_SLOTS)
+
+/* Buffer OUT packets of a port are read into. In FRAME_MODE they are encoded
+ * into tx_ring from ep3_packet. With OUT_ZERO_COPY, ep3_capture leaves the
+ * buffer untouched. */
+#if (FRAME_MODE != FRAME_MODE_NONE)
+#define EP3_READ_BUFFER(port)       (ep3_packet)
+#elif (OUT_ZERO_COPY != 0u)
+#define EP3_READ_BUFFER(port)       (ep3_discard)
+#else
+#define EP3_READ_BUFFER(port)       ((port)->tx_ring[(port)->tx_ring_head])
+#endif
+
+/* True while the OUT packets of a port are read into ep3_discard and dropped:
+ * always in SNIFFER_MODE, otherwise while the self-test owns tx_ring */
+#define OUT_DISCARDED(port)         ((SNIFFER_MODE != 0u) || (port)->selftest_owns_tx)
+
+#if (AUTOBAUD != 0u)
+/* autobaud_bench_step while the loopback benchmark does not run */
+#define AUTOBAUD_BENCH_IDLE         (0xFFFFFFFFu)
+
+/* AUTOBAUD_BENCH_TIMEOUT_MS in ticks */
+#define AUTOBAUD_BENCH_TIMEOUT_TICKS    (((AUTOBAUD_BENCH_TIMEOUT_MS * 1000u) + TICK_PERIOD_US - 1u) / TICK_PERIOD_US)
+
+/* True while a detection or the benchmark decides the rate of a port, so
+ * that line coding changes from the host wait */
+#define AUTOBAUD_BUSY(port)         (autobaud_armed(PORT_INDEX(port)) || \
+                                     ((port)->autobaud_bench_step != AUTOBAUD_BENCH_IDLE))
+#endif
+
+/* COM port whose line coding the UART of a port follows. In SNIFFER_MODE both
+ * channels monitor the same line and follow port 0. */
+#define LINE_CODING_COM_PORT(port)  ((SNIFFER_MODE != 0u) ? 0u : (port)->hw->com_port)
+
+#if (UART_FLOW_CONTROL != 0u) && (!defined(CYBSP_UART_CTS_PORT) || !defined(CYBSP_UART_RTS_PORT))
+#error "UART_FLOW_CONTROL requires the CYBSP_UART_CTS and CYBSP_UART_RTS pins in design.modus"
+#endif
+
+#if (UART_RS485 != 0u) && !defined(CYBSP_UART_DE_PORT)
+#error "UART_RS485 requires the CYBSP_UART_DE pin in design.modus"
+#endif
+
+#if (BRIDGE_PORTS > 1u)
+#if !defined(CYBSP_UART1_HW) || !defined(UART1_TX_DMA_CHANNEL) || !defined(UART1_RX_DMA_CHANNEL)
+#error "BRIDGE_PORTS of 2 requires CYBSP_UART1 with the UART1_TX_DMA and UART1_RX_DMA channels in design.modus"
+#endif
+
+#if (UART_FLOW_CONTROL != 0u) && (!defined(CYBSP_UART1_CTS_PORT) || !defined(CYBSP_UART1_RTS_PORT))
+#error "UART_FLOW_CONTROL requires the CYBSP_UART1_CTS and CYBSP_UART1_RTS pins in design.modus"
+#endif
+
+#if (UART_RS485 != 0u) && !defined(CYBSP_UART1_DE_PORT)
+#error "UART_RS485 requires the CYBSP_UART1_DE pin in design.modus"
+#endif
+
+#if ((AUTOBAUD != 0u) || (USB_SUSPEND_DEEP_SLEEP != 0u)) && !defined(CYBSP_UART1_RX_PORT)
+#error "AUTOBAUD and USB_SUSPEND_DEEP_SLEEP require the CYBSP_UART1_RX pin with its GPIO interrupt in design.modus"
+#endif
+#endif /* BRIDGE_PORTS */
+
+/* In RS-485 mode uart_isr releases the driver at the end of a transmission.
+ * It then runs above the USB interrupts, so that the bus is handed back with
+ * the interrupt entry latency only. Otherwise it runs with dma_isr, above the
+ * bottom half in dma_work_isr. */
+#if (UART_RS485 != 0u)
+#define UART_INTR_PRIORITY          (0U)
+#else
+#define UART_INTR_PRIORITY          (2U)
+#endif
+
+/* UART_RX_DMA completions that dma_isr can record ahead of dma_work_isr, one
+ * per ping/pong buffer */
+#define RX_DONE_SLOTS               (2u)
+
+/*******************************************************************************
+ * Enumerated Types and Structures
+ ********************************************************************************/
+/* Hardware of a bridge port: the SCB and its interrupt, the DMA channels of
+ * the UART data path, the pins and the CDC interface with its data endpoints,
+ * all from design.modus and design.cyusbdev. Pins a port does not have are
+ * NULL. */
+typedef struct
+{
+    uart_hw_t uart;                         /* SCB and its clock divider */
+    const cy_stc_scb_uart_config_t *uart_config; /* UART configuration in design.modus */
+    uint32_t baud_rate;                     /* Baud rate of uart_config */
+    cy_stc_sysint_t uart_intr_cfg;          /* SCB interrupt */
+    cy_israddress uart_isr;                 /* Handler of the SCB interrupt */
+    uart_dma_t tx_dma;                      /* UART_TX_DMA */
+    uart_dma_t rx_dma;                      /* UART_RX_DMA */
+    GPIO_PRT_Type *tx_port;                 /* UART TX pin, driven low as a GPIO for a break */
+    uint32_t tx_pin;
+    en_hsiom_sel_t tx_hsiom;                /* HSIOM setting that connects the pin to the SCB */
+    GPIO_PRT_Type *rx_port;                 /* UART RX pin, with AUTOBAUD or USB_SUSPEND_DEEP_SLEEP */
+    uint32_t rx_pin;
+    cy_stc_sysint_t rx_intr_cfg;            /* GPIO interrupt of the UART RX pin */
+    GPIO_PRT_Type *de_port;                 /* RS-485 driver enable, with UART_RS485 */
+    uint32_t de_pin;
+    GPIO_PRT_Type *dtr_port;                /* DTR output */
+    uint32_t dtr_pin;
+    GPIO_PRT_Type *rts_port;                /* RTS output, unless the SCB drives it */
+    uint32_t rts_pin;
+    uint32_t com_port;                      /* COM port of the CDC class */
+    uint32_t comm_interface;                /* CDC communication interface, wIndex of its requests */
+    uint32_t ep_in;                         /* Bulk IN endpoint */
+    uint32_t ep_out;                        /* Bulk OUT endpoint */
+} bridge_port_hw_t;
+
+/* Number of recoveries per fault class */
+typedef struct
+{
+    uint32_t uart_rx_overflow;  /* RX FIFO overflow, received bytes were lost */
+    uint32_t rx_path_reset;     /* UART RX FIFO and UART_RX_DMA re-initialized */
+    uint32_t tx_path_reset;     /* UART TX FIFO, UART_TX_DMA and tx_ring re-initialized */
+    uint32_t ep3_read_error;    /* EP3 read failed, EP3 re-armed */
+    uint32_t ep2_load_error;    /* EP2 load failed, RX buffer dropped */
+    uint32_t rx_queue_overrun;  /* rx_queue full while EP2 was stalled, received bytes dropped */
+} fault_counters_t;
+
+/* State of a bridge port, one CDC interface bridged to one SCB. EP2 and EP3
+ * in the comments below stand for the IN and OUT endpoints of the port. */
+typedef struct
+{
+    const bridge_port_hw_t *hw;
+
+    /* Ring of slots containing the data bytes received from host. Each slot
+     * is a pool block, taken by tx_ring_reserve or selftest_fill and returned
+     * once UART_TX_DMA has sent it, NULL meanwhile. With OUT_ZERO_COPY the
+     * single slot only tracks the packet held in the EP3 buffer of the driver. */
+    uint8_t *tx_ring[OUT_RING_SLOTS];
+    uint32_t tx_ring_len[OUT_RING_SLOTS];
+
+    /* Data sent for each slot: the slot itself, or with OUT_ZERO_COPY the EP3
+     * buffer of the driver */
+    const uint8_t *tx_ring_src[OUT_RING_SLOTS];
+
+    /* tx_ring_head: next slot filled from EP3. tx_ring_tail: slot owned by UART_TX_DMA.
+     * Only modified from dma_work_isr, so no further locking is needed. */
+    uint32_t tx_ring_head;
+    uint32_t tx_ring_tail;
+    uint32_t tx_ring_count;
+
+    /* Flags for UART_TX_DMA activity and for EP3 held off because the ring is full */
+    bool tx_dma_busy;
+    bool ep3_out_paused;
+
+    /* Set while an OUT packet waits in the EP3 buffer for tx_ring room or a
+     * pool block. EP3 NAKs further packets until out_resume reads it. */
+    bool ep3_out_waiting;
+
+#if (OUT_DMA_CHAIN != 0u)
+    /* Set while the slot after tx_ring_tail is loaded into the idle descriptor */
+    bool tx_dma_chained;
+#endif
+
+    /* Set from the start of a self-test until its data has left tx_ring. OUT
+     * packets from the host are read into ep3_discard and dropped meanwhile,
+     * and UART RX data goes to the self-test checker instead of EP2. Only
+     * port 0 runs the self-test. */
+    bool selftest_owns_tx;
+
+#if (FRAME_MODE != FRAME_MODE_NONE)
+    /* SLIP or COBS state of UART TX and UART RX */
+    frame_encoder_t frame_encoder;
+    frame_decoder_t frame_decoder;
+#endif
+
+    /* UART context */
+    cy_stc_scb_uart_context_t uart_context;
+
+    /* Active UART configuration and baud rate. Start from design.modus and
+     * follow the host's CDC line coding. */
+    cy_stc_scb_uart_config_t uart_config;
+    uint32_t uart_baud_rate;
+
+    /* CDC SET_LINE_CODING handling. A request is latched into pending_uart_config
+     * and applied once the OUT path has drained at the old rate. */
+    cy_stc_scb_uart_config_t pending_uart_config;
+    uint32_t pending_uart_divider;
+    uint32_t pending_uart_rate;
+    bool line_coding_pending;
+
+    /* Set when the CDC class reported a line coding change that is not latched yet */
+    bool line_coding_changed;
+
+    /* DTR and RTS states last requested by the host with SET_CONTROL_LINE_STATE */
+    uint32_t line_control_state;
+
+    /* Set while a line coding change drains the OUT path. EP3 is held off and
+     * the slots already queued are sent at the old rate. */
+    bool tx_quiesce;
+
+    /* CDC SEND_BREAK handling. cdc_request_received latches the request with its
+     * length in milliseconds. send_break_task drives UART TX low once the OUT
+     * path has drained, for break_ticks, or until stopped if break_ticks is 0. */
+    volatile bool break_requested;
+    volatile uint32_t break_request_ms;
+    bool break_pending;
+    volatile bool break_active;
+    uint32_t break_start_tick;
+    uint32_t break_ticks;
+
+    /* Last line coding request the UART could not follow: requested baud rate,
+     * closest achievable rate (0 if none) and number of rejected requests. */
+    uint32_t line_coding_rejected_rate;
+    uint32_t line_coding_closest_rate;
+    uint32_t line_coding_reject_count;
+
+#if (AUTOBAUD != 0u)
+    /* Set from the start of a baud-rate detection until the UART runs at the
+     * detected rate. Received bytes and line errors are dropped meanwhile. */
+    bool autobaud_discard;
+
+    /* Detected rate, used instead of the host's until the host sets a line
+     * coding again, or 0 */
+    uint32_t autobaud_rate;
+
+    /* Loopback benchmark of the detection on port 0: current step, or
+     * AUTOBAUD_BENCH_IDLE, and whether its character has been sent, when
+     * and in which tick */
+    uint32_t autobaud_bench_step;
+    bool autobaud_bench_sent;
+    uint32_t autobaud_bench_start;
+    uint32_t autobaud_bench_tick;
+#endif
+
+    uint8_t rx_buffer_ping[PING_PONG_BUF_SIZE];
+    uint8_t rx_buffer_pong[PING_PONG_BUF_SIZE];
+
+    /* Number of leading bytes of the ping (index 0) and pong (index 1) buffers
+     * already sent to the host by an idle flush. */
+    uint32_t rx_flush_offset[2];
+
+    /* Receive-idle timeout state */
+    uint32_t rx_idle_timeout_ticks;
+    uint32_t rx_idle_last_position;
+    uint32_t rx_idle_last_change;
+
+    /* UART RX data waiting for EP2 */
+    rx_queue_t rx_queue;
+
+    /* Set while the UART peer is throttled because rx_queue is nearly full */
+    bool rx_throttled;
+
+#if (UART_RS485 != 0u)
+    /* Set while the DE pin enables the RS-485 driver. Cleared by uart_isr. */
+    volatile bool rs485_driving;
+
+    /* Bytes handed to UART_TX_DMA whose echo has not come back on UART RX yet */
+    uint32_t rs485_echo_pending;
+
+    /* UART_RS485_GUARD_BITS at the current baud rate, in CPU cycles */
+    uint32_t rs485_guard_cycles;
+
+    /* Set from the end of a transmission until the guard time has passed and
+     * systick_isr releases the driver. rs485_done_at is stats_now() at the
+     * UART TX done interrupt. */
+    volatile bool rs485_guard;
+    uint32_t rs485_done_at;
+#endif
+
+    /* IN packet coalescing. A partial packet, or the ZLP owed after a full packet,
+     * is held from in_hold_tick until the next SOF or until in_coalesce_ticks have
+     * passed. in_sof_flush is set by the SOF callback while a packet is held. */
+    uint32_t in_coalesce_ticks;
+    bool in_hold;
+    uint32_t in_hold_tick;
+    volatile bool in_sof_flush;
+    bool in_zlp_pending;
+
+    /* Set while EP2 or EP3 is halted, to count each halt once */
+    bool ep_stalled;
+
+    /* Incremented by dma_isr on every UART_RX_DMA descriptor completion */
+    volatile uint32_t rx_descr_done_count;
+
+    /* Completed UART_RX_DMA descriptors and their responses. dma_isr advances
+     * rx_done_head, dma_work_isr advances rx_done_tail. */
+    cy_en_dmac_descriptor_t rx_done_descr[RX_DONE_SLOTS];
+    cy_en_dmac_response_t rx_done_response[RX_DONE_SLOTS];
+    volatile uint32_t rx_done_head;
+    volatile uint32_t rx_done_tail;
+
+#if (SNIFFER_MODE != 0u)
+    /* sniff_now() time of each completed descriptor in rx_done_descr */
+    uint32_t rx_done_time[RX_DONE_SLOTS];
+
+    /* Receive time of the last of the bytes passed to rx_forward */
+    uint32_t sniff_time;
+
+    /* Set when bytes were captured since the last idle record */
+    bool sniff_active;
+#endif
+
+    /* CDC SERIAL_STATE notification. uart_isr and rx_forward collect line events
+     * in line_events, with the number of UART RX bytes received up to the latest
+     * one and the time of the first one. Once dma_work_isr has forwarded these
+     * bytes, the events move to serial_state, and serial_state_mark counts the
+     * rx_queue bytes that still go to EP2 ahead of the notification. The bytes
+     * behind it are held from serial_state_tick for serial_state_hold_ticks at
+     * most. */
+    volatile uint32_t line_events;
+    volatile uint32_t line_event_position;
+    uint32_t line_event_time;
+    uint32_t rx_forwarded_bytes;
+    uint32_t serial_state;
+    uint32_t serial_state_mark;
+    uint32_t serial_state_time;
+    uint32_t serial_state_tick;
+
+    /* Flag for error status of DMA, UART, USB. These are recovered from in the
+     * main loop by recover_errors(). */
+    bool ep3_read_error;
+    bool tx_dma_error;
+    bool rx_dma_error;
+    bool ep2_load_error;
+    bool rx_queue_overrun;
+    bool uart_rx_overflow;
+    bool uart_rx_underflow;
+    bool uart_tx_overflow;
+} bridge_port_t;
+
 /*******************************************************************************
  * Function Prototypes
  ********************************************************************************/
@@ -70,7 +443,98 @@ static void usb_high_isr(void);
 static void usb_medium_isr(void);
 static void usb_low_isr(void);
 static void dma_isr(void);
-static void uart_isr(void);
+static void dma_rx_done(bridge_port_t *port);
+static void dma_work_isr(void);
+static void out_work(uint32_t index);
+static void rx_work(uint32_t index);
+static void tx_done_work(uint32_t index);
+static void in_work(uint32_t index);
+static void uart0_isr(void);
+#if (BRIDGE_PORTS > 1u)
+static void uart1_isr(void);
+#endif
+static void uart_isr(bridge_port_t *port);
+static void start_tx_slot(bridge_port_t *port, uint32_t slot);
+static void feed_tx_dma(bridge_port_t *port);
+static bool tx_ring_reserve(bridge_port_t *port);
+static void tx_ring_release(bridge_port_t *port, uint32_t slot);
+static void out_resume(bridge_port_t *port);
+static void out_pool_retry(void);
+static void selftest_fill(bridge_port_t *port);
+static void selftest_control_task(void);
+#if (FRAME_MODE != FRAME_MODE_NONE)
+static void tx_ring_encode(bridge_port_t *port, const uint8_t *data, uint32_t length, bool end);
+static void rx_decode(bridge_port_t *port, const uint8_t *data, uint32_t length);
+#endif
+#if (SNIFFER_MODE != 0u)
+static void sniff_forward(bridge_port_t *port, const uint8_t *data, uint32_t length);
+static void sniff_idle_check(bridge_port_t *port);
+#endif
+#if (OUT_ZERO_COPY != 0u)
+static uint8_t *ep3_capture(uint8_t *dest, const uint8_t *src, uint32_t size);
+#endif
+#if (UART_RS485 != 0u)
+static void rs485_drive(bridge_port_t *port, uint32_t length);
+static void rs485_arm_release(bridge_port_t *port);
+static void rs485_release(bridge_port_t *port);
+static void rs485_tx_done(bridge_port_t *port, uint32_t isr_start);
+static void rs485_guard_check(bridge_port_t *port);
+#endif
+static void rx_forward(bridge_port_t *port, uint8_t *data, uint32_t length);
+static void rx_drain(bridge_port_t *port);
+static uint32_t rx_received_bytes(bridge_port_t *port);
+static void line_event(bridge_port_t *port, uint32_t state, uint32_t position);
+#if (SNIFFER_MODE == 0u)
+static bool serial_state_drain(bridge_port_t *port);
+#endif
+static void update_rx_throttle(bridge_port_t *port);
+static void ep_in_callback(USBFS_Type *base, uint32_t endpointAddr, uint32_t errorType,
+                           cy_stc_usbfs_dev_drv_context_t *context);
+static void usb_sof_callback(USBFS_Type *base, cy_stc_usbfs_dev_drv_context_t *context);
+static void in_coalesce_set(bridge_port_t *port, uint32_t timeout_us);
+static void in_coalesce_check(bridge_port_t *port);
+static bool rx_dma_held(bridge_port_t *port);
+static void systick_isr(void);
+static void rx_idle_check(bridge_port_t *port);
+static void rx_idle_flush(bridge_port_t *port);
+static uint32_t rx_idle_timeout_to_ticks(uint32_t timeout_bits, uint32_t baud_rate);
+static void line_coding_task(bridge_port_t *port);
+static uint32_t line_coding_rate(const bridge_port_t *port);
+static void control_line_update(bridge_port_t *port);
+static void send_break_task(bridge_port_t *port);
+static void break_end(bridge_port_t *port);
+static void tx_resume(bridge_port_t *port);
+#if (AUTOBAUD != 0u)
+static void autobaud_task(bridge_port_t *port);
+static void autobaud_start(bridge_port_t *port);
+static void autobaud_bench_task(bridge_port_t *port);
+static void line_coding_report_rate(const bridge_port_t *port, uint32_t rate);
+static void rx_edge_isr(void);
+#endif
+static cy_en_usb_dev_status_t cdc_request_received(cy_stc_usb_dev_control_transfer_t *transfer, void *classContext,
+                                                   cy_stc_usb_dev_context_t *devContext);
+static void endpoint_stall_check(bridge_port_t *port);
+static cy_en_usb_dev_status_t vendor_request_received(cy_stc_usb_dev_control_transfer_t *transfer,
+                                                      cy_stc_usb_dev_context_t *context);
+static void cpu_sleep(uint32_t last_tick);
+static void sleep_stats_task(void);
+static void usb_suspend_task(void);
+static cy_en_usb_dev_status_t usb_events_callback(cy_en_usb_dev_callback_events_t event, uint32_t wValue,
+                                                  uint32_t wIndex, cy_stc_usb_dev_context_t *devContext);
+static void usb_link_down(void);
+static void usb_port_resync(bridge_port_t *port);
+#if (USB_SUSPEND_DEEP_SLEEP != 0u)
+static void usb_suspend(void);
+static void wakeup_isr(void);
+#endif
+static void bridge_port_init(bridge_port_t *port, const bridge_port_hw_t *hw);
+static bool build_uart_config(bridge_port_t *port, cy_stc_scb_uart_config_t *config, uint32_t *divider,
+                              uint32_t *actual_rate);
+static bool apply_line_coding(bridge_port_t *port);
+static bool dma_response_is_fatal(cy_en_dmac_response_t response);
+static void recover_errors(void);
+static void recover_rx_path(bridge_port_t *port);
+static void recover_tx_path(bridge_port_t *port);
 void handle_error(void);
 
 /*******************************************************************************
@@ -98,36 +562,177 @@ const cy_stc_sysint_t usb_low_interrupt_cfg =
 const cy_stc_sysint_t dma_intr_cfg =
 {
     .intrSrc = (IRQn_Type)cpuss_interrupt_dma_IRQn,
+    .intrPriority = 2U,
+};
+
+/* Bottom half of the DMA interrupt, below all other interrupts */
+const cy_stc_sysint_t dma_work_intr_cfg =
+{
+    .intrSrc = PendSV_IRQn,
     .intrPriority = 3U,
 };
 
-/* UART Interrupt Configuration */
-const cy_stc_sysint_t UART_INT_cfg =
+/* dma_work_isr handler of each work_t */
+const work_handler_t dma_work_handlers[WORK_COUNT] =
+{
+    [WORK_RX] = &rx_work,
+    [WORK_TX_DONE] = &tx_done_work,
+    [WORK_OUT] = &out_work,
+    [WORK_IN] = &in_work
+};
+
+/* Hardware of each bridge port. Port 0 is CYBSP_UART on the first CDC
+ * interface, port 1 CYBSP_UART1 on the second one. */
+const bridge_port_hw_t bridge_port_hw[BRIDGE_PORTS] =
+{
+    {
+        .uart = { .base = CYBSP_UART_HW, .clk_type = CYBSP_UART_CLK_HW, .clk_num = CYBSP_UART_CLK_NUM },
+        .uart_config = &CYBSP_UART_config,
+        .baud_rate = UART_BAUD_RATE,
+        .uart_intr_cfg = { .intrSrc = (IRQn_Type)CYBSP_UART_IRQ, .intrPriority = UART_INTR_PRIORITY },
+        .uart_isr = &uart0_isr,
+        .tx_dma = { .base = UART_TX_DMA_HW, .channel = UART_TX_DMA_CHANNEL, .ping_config = &UART_TX_DMA_ping_config,
+                    .pong_config = NULL, .channel_config = &UART_TX_DMA_channel_config },
+        .rx_dma = { .base = UART_RX_DMA_HW, .channel = UART_RX_DMA_CHANNEL, .ping_config = &UART_RX_DMA_ping_config,
+                    .pong_config = &UART_RX_DMA_pong_config, .channel_config = &UART_RX_DMA_channel_config },
+        .tx_port = CYBSP_UART_TX_PORT,
+        .tx_pin = CYBSP_UART_TX_PIN,
+        .tx_hsiom = CYBSP_UART_TX_HSIOM,
+#if (AUTOBAUD != 0u) || (USB_SUSPEND_DEEP_SLEEP != 0u)
+        .rx_port = CYBSP_UART_RX_PORT,
+        .rx_pin = CYBSP_UART_RX_PIN,
+        .rx_intr_cfg = { .intrSrc = (IRQn_Type)CYBSP_UART_RX_IRQ, .intrPriority = 3U },
+#endif
+#if (UART_RS485 != 0u)
+        .de_port = CYBSP_UART_DE_PORT,
+        .de_pin = CYBSP_UART_DE_PIN,
+#endif
+#if defined(CYBSP_UART_DTR_PORT)
+        .dtr_port = CYBSP_UART_DTR_PORT,
+        .dtr_pin = CYBSP_UART_DTR_PIN,
+#endif
+#if (UART_FLOW_CONTROL == 0u) && defined(CYBSP_UART_RTS_PORT)
+        .rts_port = CYBSP_UART_RTS_PORT,
+        .rts_pin = CYBSP_UART_RTS_PIN,
+#endif
+        .com_port = 0u,
+        .comm_interface = 0u,
+        .ep_in = USB_EP_2_IN,
+        .ep_out = USB_EP_3_OUT
+    },
+#if (BRIDGE_PORTS > 1u)
+    {
+        .uart = { .base = CYBSP_UART1_HW, .clk_type = CYBSP_UART1_CLK_HW, .clk_num = CYBSP_UART1_CLK_NUM },
+        .uart_config = &CYBSP_UART1_config,
+        .baud_rate = UART1_BAUD_RATE,
+        .uart_intr_cfg = { .intrSrc = (IRQn_Type)CYBSP_UART1_IRQ, .intrPriority = UART_INTR_PRIORITY },
+        .uart_isr = &uart1_isr,
+        .tx_dma = { .base = UART1_TX_DMA_HW, .channel = UART1_TX_DMA_CHANNEL, .ping_config = &UART1_TX_DMA_ping_config,
+                    .pong_config = NULL, .channel_config = &UART1_TX_DMA_channel_config },
+        .rx_dma = { .base = UART1_RX_DMA_HW, .channel = UART1_RX_DMA_CHANNEL, .ping_config = &UART1_RX_DMA_ping_config,
+                    .pong_config = &UART1_RX_DMA_pong_config, .channel_config = &UART1_RX_DMA_channel_config },
+        .tx_port = CYBSP_UART1_TX_PORT,
+        .tx_pin = CYBSP_UART1_TX_PIN,
+        .tx_hsiom = CYBSP_UART1_TX_HSIOM,
+#if (AUTOBAUD != 0u) || (USB_SUSPEND_DEEP_SLEEP != 0u)
+        .rx_port = CYBSP_UART1_RX_PORT,
+        .rx_pin = CYBSP_UART1_RX_PIN,
+        .rx_intr_cfg = { .intrSrc = (IRQn_Type)CYBSP_UART1_RX_IRQ, .intrPriority = 3U },
+#endif
+#if (UART_RS485 != 0u)
+        .de_port = CYBSP_UART1_DE_PORT,
+        .de_pin = CYBSP_UART1_DE_PIN,
+#endif
+#if defined(CYBSP_UART1_DTR_PORT)
+        .dtr_port = CYBSP_UART1_DTR_PORT,
+        .dtr_pin = CYBSP_UART1_DTR_PIN,
+#endif
+#if (UART_FLOW_CONTROL == 0u) && defined(CYBSP_UART1_RTS_PORT)
+        .rts_port = CYBSP_UART1_RTS_PORT,
+        .rts_pin = CYBSP_UART1_RTS_PIN,
+#endif
+        .com_port = 1u,
+        .comm_interface = BRIDGE_PORT1_COMM_INTERFACE,
+        .ep_in = BRIDGE_PORT1_EP_IN,
+        .ep_out = BRIDGE_PORT1_EP_OUT
+    },
+#endif
+};
+
+#if (USB_SUSPEND_DEEP_SLEEP != 0u)
+/* GPIO interrupt of D+ that wakes the device from Deep Sleep during USB
+ * suspend, as do the UART RX pins of the ports */
+const cy_stc_sysint_t usb_dp_wakeup_cfg =
 {
-    .intrSrc = (IRQn_Type)CYBSP_UART_IRQ,
+    .intrSrc = (IRQn_Type)CYBSP_USB_DP_IRQ,
     .intrPriority = 3U,
 };
+#endif
 
 /* USBDEV context variables */
 cy_stc_usbfs_dev_drv_context_t usb_drvContext;
 cy_stc_usb_dev_context_t usb_devContext;
 cy_stc_usb_dev_cdc_context_t usb_cdcContext;
 
-/* UART context variables */
-cy_stc_scb_uart_context_t uart_Context;
+/* Bridge ports */
+bridge_port_t bridge_ports[BRIDGE_PORTS];
 
-/* Array containing the data bytes received from host */
-uint8_t tx_buffer[USB_BUFFER_SIZE];
-uint8_t rx_buffer_ping[8];
-uint8_t rx_buffer_pong[8];
+/* DMA channels whose completion interrupts dma_isr dispatches */
+uint32_t dma_intr_mask;
 
-/* Flag for error status of DMA, UART, USB */
-bool dma_chan_10_error;
-bool dma_chan_0_error;
-bool dma_chan_1_error;
-bool dma_chan_9_error;
-bool cdc_error;
-bool uart_error;
+#if (OUT_ZERO_COPY != 0u)
+/* EP3 buffer of the driver, reported by ep3_capture for the packet that
+ * out_work has just read */
+const uint8_t *ep3_buffer;
+#endif
+
+/* OUT packets are read into ep3_discard and dropped while OUT_DISCARDED, in
+ * SNIFFER_MODE or while the self-test owns tx_ring. A packet without a free
+ * tx_ring slot stays in EP3 until out_resume posts WORK_OUT again. Also the
+ * source of the UART_TX_DMA descriptors before their first slot. */
+uint8_t ep3_discard[USB_BUFFER_SIZE];
+
+#if (FRAME_MODE != FRAME_MODE_NONE)
+/* Last OUT packet and its encoded bytes, copied from frame_out into tx_ring.
+ * Shared by the ports, as they are only used within out_work. */
+CY_ALIGN(4) uint8_t ep3_packet[USB_BUFFER_SIZE];
+CY_ALIGN(4) uint8_t frame_out[FRAME_OUT_MAX_BYTES];
+#endif
+
+/* SysTick time base and receive-idle timeout */
+volatile uint32_t tick_count;
+uint32_t rx_idle_timeout_bits = RX_IDLE_TIMEOUT_BITS;
+
+/* SERIAL_STATE_HOLD_US in ticks */
+uint32_t serial_state_hold_ticks;
+
+/* Sleep statistics: CPU cycles spent in Sleep during the current window, the
+ * share of the last complete window spent in Sleep in 1/1000, and the number
+ * of Deep Sleep entries during USB suspend. Time in Deep Sleep is not part of
+ * the windows because SysTick stops there. */
+uint32_t sleep_cycles;
+uint32_t sleep_window_start;
+uint32_t sleep_permille;
+uint32_t deep_sleep_count;
+
+/* USB suspend detection: tick of the last bus activity sample and number of
+ * consecutive milliseconds without activity */
+uint32_t usb_activity_tick;
+uint32_t usb_idle_ms;
+
+/* Set while the host has the device configured, by usb_events_callback */
+bool usb_configured;
+
+/* Set by the ISRs together with any of the fault flags of a port, so that the
+ * main loop only runs recover_errors() after a fault */
+volatile bool fault_pending;
+
+/* Flag for a DMA bus, alignment or descriptor fetch error. These point at
+ * corrupted descriptors or memory and are not recovered from. */
+bool dma_fatal_error;
+
+/* Number of recoveries per fault class, all ports together */
+fault_counters_t fault_count;
 
 /* Variable for USBFS Device Driver return codes.*/
 cy_en_usbfs_dev_drv_status_t dev_drv_status;
@@ -152,7 +757,8 @@ int main(void)
 
     cy_rslt_t result;
     cy_en_usb_dev_status_t status;
-    cy_en_scb_uart_status_t uart_status;
+    uint32_t last_tick;
+    uint32_t index;
 
     /* Initialize the device and board peripherals */
     result = cybsp_init();
@@ -178,59 +784,203 @@ int main(void)
         CY_ASSERT(0);
     }
 
-    /* Initialize and enable UART operation */
-    uart_status = Cy_SCB_UART_Init(CYBSP_UART_HW, &CYBSP_UART_config, &uart_Context);
-    if (uart_status != CY_SCB_UART_SUCCESS )
+    /* Serve the CDC SEND_BREAK request, the CDC class handles the others */
+    Cy_USB_Dev_CDC_RegisterUserCallback(&cdc_request_received, NULL, &usb_cdcContext);
+
+    /* Serve the statistics vendor requests on EP0 */
+    Cy_USB_Dev_RegisterVendorCallbacks(&vendor_request_received, NULL, &usb_devContext);
+
+    /* Follow the enumeration, bus resets and reconfigurations */
+    Cy_USB_Dev_RegisterEventsCallback(&usb_events_callback, &usb_devContext);
+
+    /* Get notified of IN completions to drain rx_queue */
+    for (index = 0u; index < BRIDGE_PORTS; index++)
     {
-        CY_ASSERT(0);
+        Cy_USBFS_Dev_Drv_RegisterEndpointCallback(CYBSP_USB_HW, bridge_port_hw[index].ep_in, &ep_in_callback,
+                                                  &usb_drvContext);
     }
-    Cy_SCB_UART_Enable(CYBSP_UART_HW);
 
-    /* Configure UART_TX_DMA and UART_RX_DMA channels for operation */
-    configure_tx_dma(tx_buffer, (void *) &(CYBSP_UART_HW->TX_FIFO_WR));
-    configure_rx_dma((void *) &(CYBSP_UART_HW->RX_FIFO_RD), rx_buffer_ping, rx_buffer_pong);
+    /* Flush partial IN packets on SOF */
+    Cy_USBFS_Dev_Drv_RegisterSofCallback(CYBSP_USB_HW, &usb_sof_callback, &usb_drvContext);
+
+    /* Record which port and path owns each DMA channel. The channels and
+     * their triggers come from design.modus. */
+    dma_alloc_init();
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        const bridge_port_hw_t *hw = &bridge_port_hw[index];
+
+        if (!dma_alloc_claim(hw->rx_dma.channel, DMA_ROLE_UART_RX, index) ||
+            !dma_alloc_claim(hw->tx_dma.channel, DMA_ROLE_UART_TX, index) ||
+            !dma_alloc_claim(USB_EP_DMA_CHANNEL(hw->ep_out), DMA_ROLE_USB_OUT, index) ||
+            !dma_alloc_claim(USB_EP_DMA_CHANNEL(hw->ep_in), DMA_ROLE_USB_IN, index))
+        {
+            /* Two paths share a channel */
+            handle_error();
+        }
+    }
+
+    /* Start the SysTick time base for the receive-idle timeout and the
+     * statistics before any interrupt is timed */
+    serial_state_hold_ticks = ((SERIAL_STATE_HOLD_US + TICK_PERIOD_US - 1u) / TICK_PERIOD_US) + 1u;
+    Cy_SysTick_Init(CY_SYSTICK_CLOCK_SOURCE_CLK_CPU, ((Cy_SysClk_ClkSysGetFrequency() / 1000000u) * TICK_PERIOD_US) - 1u);
+    Cy_SysTick_SetCallback(0u, &systick_isr);
+
+    pool_init();
+    stats_init();
+    bench_init();
+    selftest_init();
+    trace_init();
+#if (SNIFFER_MODE != 0u)
+    sniff_init();
+#endif
+
+    /* Initialize and enable the UART and its DMA channels on every port */
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        bridge_port_init(&bridge_ports[index], &bridge_port_hw[index]);
+    }
+#if (AUTOBAUD != 0u)
+    autobaud_init();
+#endif
 
     /* Initialize interrupts */
     Cy_SysInt_Init(&usb_high_interrupt_cfg, &usb_high_isr);
     Cy_SysInt_Init(&usb_medium_interrupt_cfg, &usb_medium_isr);
     Cy_SysInt_Init(&usb_low_interrupt_cfg, &usb_low_isr);
     Cy_SysInt_Init(&dma_intr_cfg,   &dma_isr);
-    Cy_SysInt_Init(&UART_INT_cfg, &uart_isr);
+    work_init(dma_work_handlers);
+    Cy_SysInt_Init(&dma_work_intr_cfg, &dma_work_isr);
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        Cy_SysInt_Init(&bridge_port_hw[index].uart_intr_cfg, bridge_port_hw[index].uart_isr);
+    }
+#if (USB_SUSPEND_DEEP_SLEEP != 0u)
+    Cy_SysInt_Init(&usb_dp_wakeup_cfg, &wakeup_isr);
+#endif
+#if (AUTOBAUD != 0u) || (USB_SUSPEND_DEEP_SLEEP != 0u)
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+#if (AUTOBAUD != 0u)
+        Cy_SysInt_Init(&bridge_port_hw[index].rx_intr_cfg, &rx_edge_isr);
+#else
+        Cy_SysInt_Init(&bridge_port_hw[index].rx_intr_cfg, &wakeup_isr);
+#endif
+    }
+#endif
 
     /* Enable interrupts */
     NVIC_EnableIRQ(usb_high_interrupt_cfg.intrSrc);
     NVIC_EnableIRQ(usb_medium_interrupt_cfg.intrSrc);
     NVIC_EnableIRQ(usb_low_interrupt_cfg.intrSrc);
     NVIC_EnableIRQ(dma_intr_cfg.intrSrc);
-    NVIC_EnableIRQ(UART_INT_cfg.intrSrc);
-
-    /* Make device appear on the bus. This function call is blocking,
-     * it waits until the device enumerates */
-    Cy_USB_Dev_Connect(true, CY_USB_DEV_WAIT_FOREVER, &usb_devContext);
-
-    /* Enable Interrupt for DMA channels. Must come after Cy_USB_Dev_Connect */
-    /* CY_DMAC_INTR_CHAN_0:
-     * Interrupt for DMA Channel 0 between user SRAM TX Buffer and UART TX FIFO
-     *
-     * CY_DMAC_INTR_CHAN_1:
-     * Interrupt for DMA Channel 1 between UART RX FIFO and user SRAM RX Ping and Pong Buffers
-     *
-     * CY_DMAC_INTR_CHAN_10:
-     * Interrupt for DMA Channel 10 between Out EP3 in USBFS Block and EP3 Buffer in Driver SRAM buffer
-     *
-     */
-    Cy_DMAC_SetInterruptMask(DMAC, CY_DMAC_INTR_CHAN_1 | CY_DMAC_INTR_CHAN_10 | CY_DMAC_INTR_CHAN_0);
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        NVIC_EnableIRQ(bridge_port_hw[index].uart_intr_cfg.intrSrc);
+    }
+#if (USB_SUSPEND_DEEP_SLEEP != 0u)
+    NVIC_EnableIRQ(usb_dp_wakeup_cfg.intrSrc);
+#endif
+#if (AUTOBAUD != 0u) || (USB_SUSPEND_DEEP_SLEEP != 0u)
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        NVIC_EnableIRQ(bridge_port_hw[index].rx_intr_cfg.intrSrc);
+    }
+#endif
+
+    /* Enable the completion interrupts of the UART_TX_DMA, UART_RX_DMA and
+     * OUT endpoint channels of all ports. The UARTs run from here on, and
+     * usb_events_callback applies the mask again whenever the host
+     * configures the device. */
+    dma_intr_mask = dma_alloc_mask(DMA_ROLE_UART_RX) | dma_alloc_mask(DMA_ROLE_UART_TX) |
+                    dma_alloc_mask(DMA_ROLE_USB_OUT);
+    Cy_DMAC_SetInterruptMask(DMAC, dma_intr_mask);
+
+    /* Make device appear on the bus without waiting for the enumeration.
+     * Received UART data is queued until the host configures the device,
+     * and usb_events_callback then sets up the data endpoints. */
+    Cy_USB_Dev_Connect(false, CY_USB_DEV_WAIT_FOREVER, &usb_devContext);
 
+    last_tick = tick_count;
+    sleep_window_start = tick_count;
+    usb_activity_tick = tick_count;
+
+#if (SELFTEST_BOOT_PRBS != 0u)
+    /* Start the loopback self-test without waiting for the host */
+    (void) selftest_request(SELFTEST_BOOT_PRBS);
+#endif
+#if (AUTOBAUD != 0u) && (AUTOBAUD_BOOT != 0u)
+    /* Detect the rate of every UART peer without waiting for the host */
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        (void) autobaud_request(index, AUTOBAUD_DETECT);
+    }
+#endif
 
     for (;;)
     {
-        /* Check if there are any errors */
-        if (uart_error | cdc_error | dma_chan_10_error | dma_chan_0_error | dma_chan_1_error)
+        /* Only DMA bus errors are unrecoverable */
+        if (dma_fatal_error)
         {
             /* If error condition turn on LED3 and halt processor */
             handle_error();
         }
 
+        /* Recover from any other error */
+        if (fault_pending)
+        {
+            fault_pending = false;
+            recover_errors();
+        }
+
+        /* Check once per tick whether UART RX has gone idle with a partial buffer */
+        if (tick_count != last_tick)
+        {
+            last_tick = tick_count;
+            for (index = 0u; index < BRIDGE_PORTS; index++)
+            {
+                rx_idle_check(&bridge_ports[index]);
+#if (SNIFFER_MODE != 0u)
+                sniff_idle_check(&bridge_ports[index]);
+#endif
+                in_coalesce_check(&bridge_ports[index]);
+                endpoint_stall_check(&bridge_ports[index]);
+            }
+#if (SNIFFER_MODE != 0u)
+            if (sniff_time_task(&bridge_ports[0].rx_queue))
+            {
+                work_post(WORK_IN, 0u);
+            }
+#endif
+            sleep_stats_task();
+            usb_suspend_task();
+        }
+
+        for (index = 0u; index < BRIDGE_PORTS; index++)
+        {
+#if (AUTOBAUD != 0u)
+            /* Detect the UART rate on request and run the loopback benchmark */
+            autobaud_task(&bridge_ports[index]);
+#endif
+
+            /* Follow CDC SET_LINE_CODING requests from the host */
+            line_coding_task(&bridge_ports[index]);
+
+            /* Send CDC SEND_BREAK requests from the host on UART TX */
+            send_break_task(&bridge_ports[index]);
+        }
+
+        /* Apply a statistics reset requested by the host */
+        stats_task();
+
+        /* Refresh bench_report when the benchmark is built in */
+        bench_task();
+
+        /* Start, stop and report the loopback self-test */
+        selftest_control_task();
+
+        /* Wait for the next interrupt */
+        cpu_sleep(last_tick);
     }
 
 }
@@ -240,20 +990,20 @@ int main(void)
 ********************************************************************************
 *
 * Summary:
-*  Interrupt Handler for DMA channels 10, 1, and 0.
-*
-*  DMA Channel 10:
-*  Initiates data transfer from driver SRAM Endpoint buffer (OUT) to user SRAM tx_buffer.
-*  Triggers UART_TX_DMA DMA channel to initiate data transfer to UART TX FIFO.
+*  Top half of the interrupt handler for the DMA channels of all ports. Only
+*  acknowledges the channels and posts their work to dma_work_isr, so its
+*  execution time does not depend on the traffic. The port and path of each
+*  channel come from dma_alloc.
 *
-*  DMA Channel 1:
-*  If current active descriptor is pong, initiate data transfer from ping buffer to driver SRAM Endpoint buffer (IN).
-*  If current active descriptor is ping, initiate data transfer from pong buffer instead.
-*  Note that this is because upon DMA transfer completion, the active descriptor is flipped if flipping is enabled.
-*
-*  DMA Channel 0:
-*  Handles data transfer from SRAM tx_buffer to UART TX FIFO. DMA Channel 0 is triggered by DMA Channel 10 data transfer completion.
+*  UART_RX_DMA:
+*  Records which of the ping and pong buffers has completed. Upon DMA transfer
+*  completion the active descriptor is flipped, so the completed buffer is the
+*  one that is no longer active. The buffer must be forwarded before the
+*  channel wraps back to it, so it cannot wait for the bottom half to find out.
 *
+*  UART_TX_DMA and OUT endpoint channels:
+*  Post WORK_TX_DONE and WORK_OUT. The endpoint is not re-armed and no new slot
+*  is started before the bottom half has run, so neither can complete twice.
 *
 * Parameters:
 *  None
@@ -264,186 +1014,3598 @@ int main(void)
 *******************************************************************************/
 static void dma_isr(void)
 {
+    uint32_t channel;
+    uint32_t channel_mask;
+    uint32_t index;
 
-    cy_en_dmac_descriptor_t descriptor;
-    cy_en_dmac_response_t dmac_response;
-
-    /* Stores number of data bytes received from host */
-    uint32_t ep_out_num_bytes;
+    uint32_t isr_start = stats_isr_start(STATS_ISR_DMA);
 
     /* Get interrupt source. */
-    uint32_t dma_intr_src = Cy_DMAC_GetInterruptStatusMasked(DMAC);
+    uint32_t dma_intr_src = Cy_DMAC_GetInterruptStatusMasked(DMAC) & dma_intr_mask;
 
-    /* Check if interrupt was triggered for DMAC Channel 10 */
-    if (dma_intr_src & CY_DMAC_INTR_CHAN_10)
+    /* Serve the channels in channel order */
+    for (channel = 0u; dma_intr_src != 0u; channel++)
     {
-        /* Initiate DMA data transfer from Driver SRAM Endpoint buffer (out) to tx_buffer.
-         * Max number of bytes transferable in a single descriptor is 16 bytes.
-         * Number of bytes actually transferred is stored in ep_out_num_bytes */
-        dev_drv_status = Cy_USBFS_Dev_Drv_ReadOutEndpoint(CYBSP_USB_HW, 3, tx_buffer, USB_BUFFER_SIZE, &ep_out_num_bytes, &usb_drvContext);
+        channel_mask = 1UL << channel;
 
-        /* Status is checked to ensure data was transferred successfully. */
-        if (dev_drv_status != CY_USBFS_DEV_DRV_SUCCESS)
+        if (0u == (dma_intr_src & channel_mask))
         {
-            dma_chan_10_error = true;
+            continue;
         }
+        dma_intr_src &= ~channel_mask;
+        index = dma_alloc_owner(channel);
 
-        /* Set data size of UART_TX_DMA descriptor based on the number of actual transferred bytes */
-        Cy_DMAC_Descriptor_SetDataCount(UART_TX_DMA_HW, UART_TX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING, ep_out_num_bytes);
+        switch (dma_alloc_role(channel))
+        {
+            case DMA_ROLE_UART_RX:
+                dma_rx_done(&bridge_ports[index]);
 
-        /* Validate the PING descriptor */
-        Cy_DMAC_Descriptor_SetState(UART_TX_DMA_HW, UART_TX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING, true);
+                /* Clear UART_RX_DMA Interrupt */
+                Cy_DMAC_ClearInterrupt(DMAC, channel_mask);
+                work_post(WORK_RX, index);
+                break;
 
-        /* Enable TxDma channel */
-        Cy_DMAC_Channel_Enable(UART_TX_DMA_HW, UART_TX_DMA_CHANNEL);
+            case DMA_ROLE_UART_TX:
+                /* Clear UART_TX_DMA Interrupt */
+                Cy_DMAC_ClearInterrupt(DMAC, channel_mask);
+                work_post(WORK_TX_DONE, index);
+                break;
 
-        /* Clear DMAC Channel 10 Interrupt */
-        Cy_DMAC_ClearInterrupt(DMAC, CY_DMAC_INTR_CHAN_10);
+            default:
+                /* Clear OUT endpoint channel Interrupt */
+                Cy_DMAC_ClearInterrupt(DMAC, channel_mask);
+                work_post(WORK_OUT, index);
+                break;
+        }
     }
 
-    /* Check if interrupt was triggered for DMAC Channel 1 */
-    if (dma_intr_src & CY_DMAC_INTR_CHAN_1)
-    {
-
-        /* Find what the current active descriptor is for UART_RX_DMA channel
-         * Note that upon DMA transfer completion, the descriptor is flipped if flipping is enabled. */
-        descriptor = Cy_DMAC_Channel_GetCurrentDescriptor(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL);
-
-        /* Check if the UART_RX_DMA channel response is successful for current transfer */
-        dmac_response = Cy_DMAC_Descriptor_GetResponse(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL,
-                       ((descriptor == CY_DMAC_DESCRIPTOR_PING) ? CY_DMAC_DESCRIPTOR_PONG : CY_DMAC_DESCRIPTOR_PING));
-
-        if(dmac_response == CY_DMAC_DONE)
-        {
-
-            /* Check if the COM port (CDC data interface) is ready to transmit data */
-            if (1u == Cy_USB_Dev_CDC_IsReady(USB_COM_PORT, &usb_cdcContext))
-            {
+    stats_isr_done(STATS_ISR_DMA, isr_start);
+}
 
-                /* If active descriptor is pong that means current transfer is ping and that we wish to transfer data from ping buffer.
-                 * Note that this is because upon DMA transfer completion, the active descriptor is flipped if flipping is enabled. */
-                if (descriptor == CY_DMAC_DESCRIPTOR_PONG)
-                {
-                    /* Initiate DMA data transfer from ping buffer to Driver SRAM Endpoint buffer (in). */
-                    dev_drv_status = Cy_USBFS_Dev_Drv_LoadInEndpoint(CYBSP_USB_HW, 2, rx_buffer_ping, PING_PONG_BUF_SIZE, &usb_drvContext);
-                }
-                else
-                {
-                    /* Initiate DMA data transfer from pong buffer to Driver SRAM Endpoint buffer (in). */
-                    dev_drv_status = Cy_USBFS_Dev_Drv_LoadInEndpoint(CYBSP_USB_HW, 2, rx_buffer_pong, PING_PONG_BUF_SIZE, &usb_drvContext);
-                }
+/*******************************************************************************
+* Function Name: dma_rx_done
+********************************************************************************
+*
+* Summary:
+*  Called by dma_isr on a UART_RX_DMA completion of a port. Records the
+*  completed descriptor and its response for rx_work.
+*
+* Parameters:
+*  port: bridge port whose UART_RX_DMA completed
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void dma_rx_done(bridge_port_t *port)
+{
+    const uart_dma_t *dma = &port->hw->rx_dma;
+    cy_en_dmac_descriptor_t descriptor;
 
-                /* Status is checked to ensure data was transferred successfully. */
-                if (dev_drv_status != CY_USBFS_DEV_DRV_SUCCESS)
-                {
-                    dma_chan_9_error = true;
-                }
-            }
-            /* If COM port is not ready, error flag is raised. */
-            else
-            {
-                cdc_error = true;
-            }
-        }
-        /* If current transfer did not return done response, error flag is raised */
-        else
-        {
-            dma_chan_1_error = true;
-        }
+    descriptor = Cy_DMAC_Channel_GetCurrentDescriptor(dma->base, dma->channel);
+    descriptor = (descriptor == CY_DMAC_DESCRIPTOR_PING) ? CY_DMAC_DESCRIPTOR_PONG : CY_DMAC_DESCRIPTOR_PING;
 
-        /* Clear DMAC Channel 1 Interrupt */
-        Cy_DMAC_ClearInterrupt(DMAC, CY_DMAC_INTR_CHAN_1);
+    if ((port->rx_done_head - port->rx_done_tail) < RX_DONE_SLOTS)
+    {
+        port->rx_done_descr[port->rx_done_head % RX_DONE_SLOTS] = descriptor;
+        port->rx_done_response[port->rx_done_head % RX_DONE_SLOTS] =
+            Cy_DMAC_Descriptor_GetResponse(dma->base, dma->channel, descriptor);
+#if (SNIFFER_MODE != 0u)
+        port->rx_done_time[port->rx_done_head % RX_DONE_SLOTS] = sniff_now();
+#endif
+        port->rx_done_head++;
     }
-
-    /* Check if interrupt was triggered for DMAC Channel 0 */
-    if (dma_intr_src & CY_DMAC_INTR_CHAN_0)
+    else
     {
+        /* Both buffers are waiting, so the channel is already refilling
+         * the older one */
+        port->rx_dma_error = true;
+        fault_pending = true;
+        trace_event(TRACE_FAULT, TRACE_FAULT_RX_DMA, 0u);
+    }
 
-        /* Check if UART_TX_DMA channel response is successful for current transfer. Note that
-         * current descriptor is set to invalid after completion. */
-        dmac_response = Cy_DMAC_Descriptor_GetResponse(UART_TX_DMA_HW, UART_TX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING);
-        if (dmac_response != CY_DMAC_DONE && dmac_response != CY_DMAC_INVALID_DESCR)
-        {
-            dma_chan_0_error = true;
-        }
+    port->rx_descr_done_count++;
+}
 
-        /* Clear DMAC Channel 0 Interrupt */
-        Cy_DMAC_ClearInterrupt(DMAC, CY_DMAC_INTR_CHAN_0);
-    }
+/*******************************************************************************
+* Function Name: dma_work_isr
+********************************************************************************
+*
+* Summary:
+*  PendSV handler. Bottom half of dma_isr, runs the posted work items at the
+*  lowest interrupt priority, so that dma_isr and uart_isr can preempt it.
+*  The data path state (tx_ring, rx_queue, the endpoints) is only changed
+*  here and in the main loop with interrupts masked.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void dma_work_isr(void)
+{
+    uint32_t isr_start = stats_isr_start(STATS_ISR_DMA_WORK);
 
+    work_run();
 
+    stats_isr_done(STATS_ISR_DMA_WORK, isr_start);
 }
 
 /*******************************************************************************
-* Function Name: uart_isr
+* Function Name: out_work
 ********************************************************************************
 *
 * Summary:
-* Handles Rx Overflow, Rx Underflow, and Tx Overflow conditions. These conditions
-* must never occur. Also handles a Tx Done condition which triggers the
-* re-enable of USB Endpoint 3 (out).
+*  WORK_OUT handler. Initiates data transfer from driver SRAM Endpoint buffer
+*  (OUT) to the next free tx_ring slot. Triggers UART_TX_DMA if it is idle,
+*  and re-enables Endpoint 3 while a slot is free.
 *
 * Parameters:
-*  None
+*  index: index of the bridge port the work was posted for
 *
 * Return:
 *  None
 *
 *******************************************************************************/
-static void uart_isr(void)
+static void out_work(uint32_t index)
 {
-    /* Get RX and TX interrupt sources */
-    uint32_t rx_intr_src =  Cy_SCB_UART_GetRxFifoStatus(CYBSP_UART_HW);
-    uint32_t tx_intr_src = Cy_SCB_UART_GetTxFifoStatus(CYBSP_UART_HW);
+    bridge_port_t *port = &bridge_ports[index];
+
+    /* Stores number of data bytes received from host */
+    uint32_t ep_out_num_bytes;
+
+    bool discard = OUT_DISCARDED(port);
 
-    if (tx_intr_src & CY_SCB_UART_TX_DONE)
+    /* EP3 is only re-enabled with the slots of the next packet reserved, but
+     * the middleware also arms it on SET_CONFIGURATION. A packet that finds
+     * no room is left in the endpoint buffer, and out_resume posts this work
+     * again once the slots are reserved. */
+    if (!discard && !tx_ring_reserve(port))
     {
-        /* After UART TX is done, re-enable USB Endpoint 3 */
-        Cy_USBFS_Dev_Drv_EnableOutEndpoint(CYBSP_USB_HW, USB_EP_3_OUT, &usb_drvContext);
+        port->ep3_out_waiting = true;
+        port->ep3_out_paused = true;
+        stats_out_paused(PORT_INDEX(port));
+        return;
     }
 
-    if (rx_intr_src & CY_SCB_UART_RX_OVERFLOW)
+    /* Initiate DMA data transfer from Driver SRAM Endpoint buffer (out) to the head slot of tx_ring.
+     * Max number of bytes transferable in a single descriptor is USB_BUFFER_SIZE bytes.
+     * Number of bytes actually transferred is stored in ep_out_num_bytes */
+    ep_out_num_bytes = 0u;
+    dev_drv_status = Cy_USBFS_Dev_Drv_ReadOutEndpoint(CYBSP_USB_HW, port->hw->ep_out,
+                                                      discard ? ep3_discard : EP3_READ_BUFFER(port),
+                                                      USB_BUFFER_SIZE, &ep_out_num_bytes, &usb_drvContext);
+
+    /* Status is checked to ensure data was transferred successfully. */
+    if (dev_drv_status != CY_USBFS_DEV_DRV_SUCCESS)
     {
-        uart_error = true;
+        port->ep3_read_error = true;
+        fault_pending = true;
+        trace_event(TRACE_FAULT, TRACE_FAULT_EP3_READ, 0u);
     }
-    if (rx_intr_src & CY_SCB_UART_RX_UNDERFLOW)
+#if (FRAME_MODE != FRAME_MODE_NONE)
+    else if (!discard)
     {
-        uart_error = true;
+        /* A short or zero-length packet ends the OUT transfer and with it the frame */
+        tx_ring_encode(port, ep3_packet, ep_out_num_bytes, (ep_out_num_bytes < USB_EP_PACKET_SIZE));
+
+        /* Start UART_TX_DMA if it is not already draining an older slot */
+        feed_tx_dma(port);
     }
-    if (tx_intr_src & CY_SCB_UART_TX_OVERFLOW)
+#else
+    else if ((ep_out_num_bytes != 0u) && !discard)
     {
-        uart_error = true;
+        /* Commit the slot to the ring */
+        port->tx_ring_len[port->tx_ring_head] = ep_out_num_bytes;
+#if (OUT_ZERO_COPY != 0u)
+        port->tx_ring_src[port->tx_ring_head] = ep3_buffer;
+#else
+        port->tx_ring_src[port->tx_ring_head] = port->tx_ring[port->tx_ring_head];
+#endif
+        port->tx_ring_count++;
+        stats_out_received(PORT_INDEX(port), port->tx_ring_head, ep_out_num_bytes, port->tx_ring_count);
+        port->tx_ring_head = (port->tx_ring_head + 1u) % OUT_RING_SLOTS;
+
+        /* Start UART_TX_DMA if it is not already draining an older slot */
+        feed_tx_dma(port);
     }
+#endif
 
-    Cy_SCB_UART_ClearRxFifoStatus(CYBSP_UART_HW, rx_intr_src);
-    Cy_SCB_UART_ClearTxFifoStatus(CYBSP_UART_HW, tx_intr_src);
+    /* Re-enable USB Endpoint 3 right away while the ring has room for
+     * another packet, otherwise hold it off until UART_TX_DMA releases
+     * slots, until the pool has blocks again or until a line coding change
+     * has completed. */
+    if (!port->tx_quiesce && tx_ring_reserve(port))
+    {
+        Cy_USBFS_Dev_Drv_EnableOutEndpoint(CYBSP_USB_HW, port->hw->ep_out, &usb_drvContext);
+        trace_event(TRACE_EP3_ENABLE, 0u, 0u);
+    }
+    else
+    {
+        port->ep3_out_paused = true;
+        stats_out_paused(PORT_INDEX(port));
+    }
 }
 
-
-/***************************************************************************
- * Function Name: usb_high_isr
- ********************************************************************************
- * Summary:
- *  This function processes the high priority USB interrupts.
- *
- ***************************************************************************/
-static void usb_high_isr(void)
+/*******************************************************************************
+* Function Name: rx_work
+********************************************************************************
+*
+* Summary:
+*  WORK_RX handler. Forwards the ping and pong buffers recorded by dma_isr, in
+*  the order they completed. Only the bytes not already sent by an idle flush
+*  are forwarded.
+*
+* Parameters:
+*  index: index of the bridge port the work was posted for
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rx_work(uint32_t index)
 {
-    /* Call interrupt processing */
-    Cy_USBFS_Dev_Drv_Interrupt(CYBSP_USB_HW, Cy_USBFS_Dev_Drv_GetInterruptCauseHi(CYBSP_USB_HW), &usb_drvContext);
-}
+    bridge_port_t *port = &bridge_ports[index];
+    cy_en_dmac_descriptor_t descriptor;
+    cy_en_dmac_response_t dmac_response;
+    uint8_t *buffer;
 
-/***************************************************************************
- * Function Name: usb_medium_isr
- ********************************************************************************
- * Summary:
- *  This function processes the medium priority USB interrupts.
- *
- ***************************************************************************/
+    while (port->rx_done_tail != port->rx_done_head)
+    {
+        descriptor = port->rx_done_descr[port->rx_done_tail % RX_DONE_SLOTS];
+        dmac_response = port->rx_done_response[port->rx_done_tail % RX_DONE_SLOTS];
+
+        if (dmac_response == CY_DMAC_DONE)
+        {
+            buffer = (descriptor == CY_DMAC_DESCRIPTOR_PING) ? port->rx_buffer_ping : port->rx_buffer_pong;
+
+            trace_event(TRACE_RX_DESCR_DONE, descriptor, PING_PONG_BUF_SIZE - port->rx_flush_offset[descriptor]);
+#if (SNIFFER_MODE != 0u)
+            port->sniff_time = port->rx_done_time[port->rx_done_tail % RX_DONE_SLOTS];
+#endif
+            rx_forward(port, &buffer[port->rx_flush_offset[descriptor]],
+                       PING_PONG_BUF_SIZE - port->rx_flush_offset[descriptor]);
+            port->rx_flush_offset[descriptor] = 0u;
+        }
+        /* If current transfer did not return done response, error flag is raised */
+        else if (dma_response_is_fatal(dmac_response))
+        {
+            dma_fatal_error = true;
+            fault_pending = true;
+            trace_event(TRACE_FAULT, TRACE_FAULT_DMA_FATAL, 0u);
+        }
+        else
+        {
+            port->rx_dma_error = true;
+            fault_pending = true;
+            trace_event(TRACE_FAULT, TRACE_FAULT_RX_DMA, 0u);
+        }
+
+        port->rx_done_tail++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: tx_done_work
+********************************************************************************
+*
+* Summary:
+*  WORK_TX_DONE handler. Releases the tx_ring slots that UART_TX_DMA has
+*  written to the UART TX FIFO, starts the next queued slot and resumes
+*  Endpoint 3 if it was held off by a full ring.
+*
+* Parameters:
+*  index: index of the bridge port the work was posted for
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void tx_done_work(uint32_t index)
+{
+    bridge_port_t *port = &bridge_ports[index];
+    const uart_dma_t *tx_dma = &port->hw->tx_dma;
+    cy_en_dmac_response_t dmac_response;
+
+    /* Check if UART_TX_DMA channel response is successful for current transfer. Note that
+     * current descriptor is set to invalid after completion. */
+    dmac_response = Cy_DMAC_Descriptor_GetResponse(tx_dma->base, tx_dma->channel,
+                                                   TX_SLOT_DESCRIPTOR(port->tx_ring_tail));
+    if (dma_response_is_fatal(dmac_response))
+    {
+        dma_fatal_error = true;
+        fault_pending = true;
+        trace_event(TRACE_FAULT, TRACE_FAULT_DMA_FATAL, 0u);
+    }
+    else if (dmac_response != CY_DMAC_DONE && dmac_response != CY_DMAC_INVALID_DESCR)
+    {
+        port->tx_dma_error = true;
+        fault_pending = true;
+        trace_event(TRACE_FAULT, TRACE_FAULT_TX_DMA, 0u);
+    }
+#if (OUT_DMA_CHAIN != 0u)
+    else if (port->tx_dma_busy)
+    {
+        /* The channel flips to the other descriptor when a slot is done, so
+         * every slot whose descriptor is no longer current is in the UART TX
+         * FIFO. Both owned slots may have completed before this interrupt. */
+        while (port->tx_dma_busy && (Cy_DMAC_Channel_GetCurrentDescriptor(tx_dma->base, tx_dma->channel) !=
+                                     TX_SLOT_DESCRIPTOR(port->tx_ring_tail)))
+        {
+            if (!port->selftest_owns_tx)
+            {
+                stats_out_sent(PORT_INDEX(port), port->tx_ring_tail);
+            }
+            tx_ring_release(port, port->tx_ring_tail);
+            port->tx_ring_tail = (port->tx_ring_tail + 1u) % OUT_RING_SLOTS;
+            port->tx_ring_count--;
+            port->tx_dma_busy = port->tx_dma_chained;
+            port->tx_dma_chained = false;
+        }
+
+        /* Refill the ring with self-test data */
+        selftest_fill(port);
+
+        /* Restart UART_TX_DMA or chain the next queued slot */
+        feed_tx_dma(port);
+#else
+    else if (port->tx_dma_busy)
+    {
+        /* The tail slot is now in the UART TX FIFO, release it */
+        if (!port->selftest_owns_tx)
+        {
+            stats_out_sent(PORT_INDEX(port), port->tx_ring_tail);
+        }
+        tx_ring_release(port, port->tx_ring_tail);
+        port->tx_ring_tail = (port->tx_ring_tail + 1u) % OUT_RING_SLOTS;
+        port->tx_ring_count--;
+        port->tx_dma_busy = false;
+
+        /* Refill the ring with self-test data */
+        selftest_fill(port);
+
+        /* Chain UART_TX_DMA to the next queued slot */
+        feed_tx_dma(port);
+#endif
+
+#if (UART_RS485 != 0u)
+        /* The last queued byte is in the UART TX FIFO, release the driver
+         * once it has been sent */
+        if (!port->tx_dma_busy)
+        {
+            rs485_arm_release(port);
+        }
+#endif
+
+        /* A slot is free again, so resume USB Endpoint 3 if it was held off,
+         * also on the ports that were waiting for a pool block */
+        out_resume(port);
+        out_pool_retry();
+    }
+}
+
+/*******************************************************************************
+* Function Name: in_work
+********************************************************************************
+*
+* Summary:
+*  WORK_IN handler. Starts filling the ring when a self-test has been started
+*  or has waited for a line coding change, and loads queued UART RX data into
+*  EP2 if it is free.
+*
+* Parameters:
+*  index: index of the bridge port the work was posted for
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void in_work(uint32_t index)
+{
+    bridge_port_t *port = &bridge_ports[index];
+
+    selftest_fill(port);
+    rx_drain(port);
+}
+
+/*******************************************************************************
+* Function Name: start_tx_slot
+********************************************************************************
+*
+* Summary:
+*  Points the UART_TX_DMA descriptor of a tx_ring slot at its data and starts
+*  the transfer to the UART TX FIFO. With OUT_DMA_CHAIN this also queues a slot
+*  behind the active one. Called from dma_work_isr only.
+*
+* Parameters:
+*  port: bridge port
+*  slot: index of the tx_ring slot to transmit
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void start_tx_slot(bridge_port_t *port, uint32_t slot)
+{
+    const uart_dma_t *tx_dma = &port->hw->tx_dma;
+    cy_en_dmac_descriptor_t descriptor = TX_SLOT_DESCRIPTOR(slot);
+
+    /* Set source and data size of UART_TX_DMA descriptor based on the number of bytes in the slot */
+    Cy_DMAC_Descriptor_SetSrcAddress(tx_dma->base, tx_dma->channel, descriptor, (const void *) port->tx_ring_src[slot]);
+    Cy_DMAC_Descriptor_SetDataCount(tx_dma->base, tx_dma->channel, descriptor, port->tx_ring_len[slot]);
+
+    /* Validate the descriptor */
+    Cy_DMAC_Descriptor_SetState(tx_dma->base, tx_dma->channel, descriptor, true);
+
+    port->tx_dma_busy = true;
+    trace_event(TRACE_TX_START, slot, port->tx_ring_len[slot]);
+
+#if (UART_RS485 != 0u)
+    /* Set after tx_dma_busy, which keeps uart_isr from releasing the driver */
+    rs485_drive(port, port->tx_ring_len[slot]);
+#endif
+
+    /* Enable TxDma channel. With OUT_DMA_CHAIN this also restarts a channel
+     * that reached the descriptor before it was validated. */
+    Cy_DMAC_Channel_Enable(tx_dma->base, tx_dma->channel);
+}
+
+/*******************************************************************************
+* Function Name: feed_tx_dma
+********************************************************************************
+*
+* Summary:
+*  Hands queued tx_ring slots to UART_TX_DMA. Starts the tail slot when the
+*  channel is idle and, with OUT_DMA_CHAIN, loads the slot after it into the
+*  idle descriptor. Called from dma_work_isr only.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void feed_tx_dma(bridge_port_t *port)
+{
+    if (!port->tx_dma_busy && (port->tx_ring_count != 0u))
+    {
+        start_tx_slot(port, port->tx_ring_tail);
+    }
+
+#if (OUT_DMA_CHAIN != 0u)
+    if (port->tx_dma_busy && !port->tx_dma_chained && (port->tx_ring_count > 1u))
+    {
+        port->tx_dma_chained = true;
+        start_tx_slot(port, (port->tx_ring_tail + 1u) % OUT_RING_SLOTS);
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: tx_ring_reserve
+********************************************************************************
+*
+* Summary:
+*  Checks that tx_ring has room for one more OUT packet and takes the pool
+*  blocks of the OUT_PACKET_SLOTS slots it will be read or encoded into, so
+*  that out_work never waits for one. Blocks that a slot already holds are
+*  kept, also when the pool runs out. With OUT_ZERO_COPY the packet stays in
+*  the EP3 buffer and needs no block. Called from dma_work_isr or with
+*  interrupts masked.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  bool: true if EP3 may be armed
+*
+*******************************************************************************/
+static bool tx_ring_reserve(bridge_port_t *port)
+{
+#if (OUT_ZERO_COPY == 0u)
+    uint32_t index;
+    uint32_t slot;
+#endif
+
+    if (!TX_RING_HAS_ROOM(port))
+    {
+        return false;
+    }
+
+#if (OUT_ZERO_COPY == 0u)
+    for (index = 0u; index < OUT_PACKET_SLOTS; index++)
+    {
+        slot = (port->tx_ring_head + index) % OUT_RING_SLOTS;
+        if (port->tx_ring[slot] == NULL)
+        {
+            port->tx_ring[slot] = pool_get(POOL_OUT);
+            if (port->tx_ring[slot] == NULL)
+            {
+                return false;
+            }
+        }
+    }
+#endif
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: tx_ring_release
+********************************************************************************
+*
+* Summary:
+*  Returns the pool block of a tx_ring slot that UART_TX_DMA has sent or that
+*  is dropped. Called from dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  port: bridge port
+*  slot: index of the tx_ring slot
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void tx_ring_release(bridge_port_t *port, uint32_t slot)
+{
+    if (port->tx_ring[slot] != NULL)
+    {
+        pool_put(POOL_OUT, port->tx_ring[slot]);
+        port->tx_ring[slot] = NULL;
+    }
+}
+
+/*******************************************************************************
+* Function Name: out_resume
+********************************************************************************
+*
+* Summary:
+*  Re-enables USB Endpoint 3 if it was held off, as soon as no line coding
+*  change or break holds off the OUT path and the slots of the next packet
+*  are reserved. A packet waiting in the endpoint buffer is read first.
+*  Called from dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void out_resume(bridge_port_t *port)
+{
+    if (port->ep3_out_paused && !port->tx_quiesce && tx_ring_reserve(port))
+    {
+        port->ep3_out_paused = false;
+        if (port->ep3_out_waiting)
+        {
+            /* out_work re-arms EP3 after reading the packet */
+            port->ep3_out_waiting = false;
+            work_post(WORK_OUT, PORT_INDEX(port));
+        }
+        else
+        {
+            Cy_USBFS_Dev_Drv_EnableOutEndpoint(CYBSP_USB_HW, port->hw->ep_out, &usb_drvContext);
+            trace_event(TRACE_EP3_ENABLE, 0u, 0u);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: out_pool_retry
+********************************************************************************
+*
+* Summary:
+*  Retries the OUT paths that were refused a pool block, once blocks may have
+*  come back from either direction. Called from dma_work_isr or with
+*  interrupts masked.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void out_pool_retry(void)
+{
+    uint32_t index;
+
+    if (!pool_take_starved(POOL_OUT))
+    {
+        return;
+    }
+
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        selftest_fill(&bridge_ports[index]);
+        out_resume(&bridge_ports[index]);
+    }
+}
+
+/*******************************************************************************
+* Function Name: selftest_fill
+********************************************************************************
+*
+* Summary:
+*  Fills the free tx_ring slots with self-test data and hands them to
+*  UART_TX_DMA. Once a stopped self-test has drained from the ring, the ring
+*  is given back to EP3. Called from dma_work_isr only.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void selftest_fill(bridge_port_t *port)
+{
+    /* The self-test only runs on the port it was started on */
+    if (!port->selftest_owns_tx)
+    {
+        return;
+    }
+
+    if (!selftest_running())
+    {
+        if (port->tx_ring_count == 0u)
+        {
+            port->selftest_owns_tx = false;
+        }
+        return;
+    }
+
+    /* A line coding change waits for the ring to drain */
+    if (port->tx_quiesce)
+    {
+        return;
+    }
+
+    while (port->tx_ring_count < OUT_RING_SLOTS)
+    {
+        /* Without a block the ring is refilled from the next tx_done_work */
+        if (port->tx_ring[port->tx_ring_head] == NULL)
+        {
+            port->tx_ring[port->tx_ring_head] = pool_get(POOL_OUT);
+            if (port->tx_ring[port->tx_ring_head] == NULL)
+            {
+                break;
+            }
+        }
+        selftest_generate(port->tx_ring[port->tx_ring_head], USB_BUFFER_SIZE);
+        port->tx_ring_len[port->tx_ring_head] = USB_BUFFER_SIZE;
+        port->tx_ring_src[port->tx_ring_head] = port->tx_ring[port->tx_ring_head];
+        port->tx_ring_count++;
+        port->tx_ring_head = (port->tx_ring_head + 1u) % OUT_RING_SLOTS;
+    }
+
+    feed_tx_dma(port);
+}
+
+/*******************************************************************************
+* Function Name: selftest_control_task
+********************************************************************************
+*
+* Summary:
+*  Starts and stops the loopback self-test on request, restarts it after a
+*  line coding change and refreshes its report. The self-test runs on port 0.
+*  Called from the main loop.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void selftest_control_task(void)
+{
+    bridge_port_t *port = &bridge_ports[0];
+    uint32_t order;
+    uint32_t int_state;
+
+    if (!selftest_take_request(&order))
+    {
+        /* Results at the old rate do not describe the new one */
+        if (!selftest_running() || (selftest_report.baud_rate == port->uart_baud_rate))
+        {
+            selftest_task();
+            return;
+        }
+        order = selftest_report.order;
+    }
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    if (order == 0u)
+    {
+        selftest_stop();
+    }
+    else
+    {
+        port->selftest_owns_tx = true;
+        selftest_start(order, port->uart_baud_rate);
+    }
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    /* dma_work_isr fills the ring, or returns it to EP3 once it has drained */
+    work_post(WORK_IN, PORT_INDEX(port));
+}
+
+#if (FRAME_MODE != FRAME_MODE_NONE)
+/*******************************************************************************
+* Function Name: tx_ring_encode
+********************************************************************************
+*
+* Summary:
+*  Encodes the bytes of an OUT packet as part of a frame and queues the result
+*  in as many tx_ring slots as it needs. TX_RING_HAS_ROOM guarantees that
+*  they are free. Called from dma_work_isr only.
+*
+* Parameters:
+*  port: bridge port
+*  data: bytes of the packet
+*  length: number of bytes
+*  end: true if the packet ends the OUT transfer
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void tx_ring_encode(bridge_port_t *port, const uint8_t *data, uint32_t length, bool end)
+{
+    uint32_t count = frame_encode(&port->frame_encoder, data, length, end, frame_out);
+    uint32_t offset;
+    uint32_t chunk;
+
+    for (offset = 0u; offset < count; offset += chunk)
+    {
+        chunk = ((count - offset) < USB_BUFFER_SIZE) ? (count - offset) : USB_BUFFER_SIZE;
+
+        (void) usb_ep_memcpy(port->tx_ring[port->tx_ring_head], &frame_out[offset], chunk);
+        port->tx_ring_len[port->tx_ring_head] = chunk;
+        port->tx_ring_src[port->tx_ring_head] = port->tx_ring[port->tx_ring_head];
+        port->tx_ring_count++;
+        stats_out_received(PORT_INDEX(port), port->tx_ring_head, chunk, port->tx_ring_count);
+        port->tx_ring_head = (port->tx_ring_head + 1u) % OUT_RING_SLOTS;
+    }
+
+    /* Empty transfers do not produce a frame */
+    if (end && (count != 0u))
+    {
+        stats_out_frame();
+    }
+}
+
+/*******************************************************************************
+* Function Name: rx_decode
+********************************************************************************
+*
+* Summary:
+*  Decodes UART RX bytes into rx_queue and marks the end of every complete
+*  frame, then lets rx_drain send what is ready. A frame whose end cannot be
+*  marked is merged with the next one. Called from rx_forward only.
+*
+* Parameters:
+*  port: bridge port
+*  data: received bytes
+*  length: number of received bytes
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rx_decode(bridge_port_t *port, const uint8_t *data, uint32_t length)
+{
+    uint8_t decoded[USB_EP_PACKET_SIZE];
+    frame_event_t event;
+    uint32_t used;
+    uint32_t count;
+    bool marked;
+
+    while (length != 0u)
+    {
+        event = frame_decode(&port->frame_decoder, data, (length < sizeof(decoded)) ? length : sizeof(decoded), &used,
+                             decoded, &count);
+
+        if (rx_queue_put(&port->rx_queue, decoded, count) != count)
+        {
+            port->rx_queue_overrun = true;
+            fault_pending = true;
+            trace_event(TRACE_FAULT, TRACE_FAULT_RX_QUEUE_OVERRUN, 0u);
+            line_event(port, SERIAL_STATE_OVERRUN, port->rx_forwarded_bytes);
+        }
+        stats_in_queued(PORT_INDEX(port), count, rx_queue_count(&port->rx_queue));
+
+        if (event != FRAME_EVENT_NONE)
+        {
+            marked = rx_queue_mark_frame(&port->rx_queue);
+            stats_in_frame((event == FRAME_EVENT_END) && marked);
+        }
+
+        data += used;
+        length -= used;
+    }
+
+    rx_drain(port);
+}
+#endif /* FRAME_MODE */
+
+#if (SNIFFER_MODE != 0u)
+/*******************************************************************************
+* Function Name: sniff_forward
+********************************************************************************
+*
+* Summary:
+*  Records captured UART RX bytes in the IN stream of port 0, with the channel
+*  of the port and the receive time of the last byte. Line events of the port
+*  that were received before the last of these bytes are recorded at their
+*  place, which splits the bytes into two data records. Must be called from
+*  dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  port: bridge port that captured the bytes
+*  data: captured bytes
+*  length: number of bytes, 0 to record pending line events only
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void sniff_forward(bridge_port_t *port, const uint8_t *data, uint32_t length)
+{
+    rx_queue_t *stream = &bridge_ports[0].rx_queue;
+    uint32_t int_state;
+    uint32_t events = 0u;
+    uint32_t behind = 0u;
+    uint32_t ahead;
+
+    /* rx_forward has already counted the bytes in rx_forwarded_bytes */
+    int_state = Cy_SysLib_EnterCriticalSection();
+    if ((port->line_events != 0u) && ((int32_t) (port->line_event_position - port->rx_forwarded_bytes) <= 0))
+    {
+        events = port->line_events;
+        behind = port->rx_forwarded_bytes - port->line_event_position;
+        port->line_events = 0u;
+    }
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    ahead = (behind < length) ? (length - behind) : 0u;
+    if (ahead != 0u)
+    {
+        (void) sniff_record(stream, PORT_INDEX(port), SNIFF_REC_DATA, 0u, port->sniff_time, data, ahead);
+    }
+    if (events != 0u)
+    {
+        (void) sniff_record(stream, PORT_INDEX(port), SNIFF_REC_LINE, events, port->sniff_time, NULL, 0u);
+    }
+    if (ahead < length)
+    {
+        (void) sniff_record(stream, PORT_INDEX(port), SNIFF_REC_DATA, 0u, port->sniff_time, &data[ahead],
+                            length - ahead);
+    }
+
+    if (length != 0u)
+    {
+        port->sniff_active = true;
+    }
+    rx_drain(&bridge_ports[0]);
+}
+
+/*******************************************************************************
+* Function Name: sniff_idle_check
+********************************************************************************
+*
+* Summary:
+*  Called once per tick after rx_idle_check. Once UART RX of the port has been
+*  quiet for the receive-idle timeout and all its bytes have been recorded,
+*  records the line events still pending and an idle marker for the gap.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void sniff_idle_check(bridge_port_t *port)
+{
+    uint32_t int_state;
+
+    if ((port->rx_idle_timeout_ticks == 0u) ||
+        ((tick_count - port->rx_idle_last_change) < port->rx_idle_timeout_ticks) ||
+        ((port->line_events == 0u) && !port->sniff_active))
+    {
+        return;
+    }
+
+    /* Masking interrupts also keeps dma_work_isr away from rx_queue */
+    int_state = Cy_SysLib_EnterCriticalSection();
+    if (port->rx_forwarded_bytes == port->rx_idle_last_position)
+    {
+        port->sniff_time = sniff_now();
+        sniff_forward(port, NULL, 0u);
+
+        if (port->sniff_active)
+        {
+            (void) sniff_record(&bridge_ports[0].rx_queue, PORT_INDEX(port), SNIFF_REC_IDLE, 0u, port->sniff_time,
+                                NULL, 0u);
+            port->sniff_active = false;
+            rx_drain(&bridge_ports[0]);
+        }
+    }
+    Cy_SysLib_ExitCriticalSection(int_state);
+}
+#endif /* SNIFFER_MODE */
+
+#if (OUT_ZERO_COPY != 0u)
+/*******************************************************************************
+* Function Name: ep3_capture
+********************************************************************************
+*
+* Summary:
+*  Copy function installed for EP3 with OUT_ZERO_COPY. Called from
+*  Cy_USBFS_Dev_Drv_ReadOutEndpoint, it records where the driver holds the
+*  packet instead of copying it. The buffer belongs to UART_TX_DMA until EP3
+*  is re-enabled.
+*
+* Parameters:
+*  dest: application buffer, left untouched
+*  src: EP3 buffer of the driver
+*  size: number of bytes in the packet
+*
+* Return:
+*  uint8_t *: dest
+*
+*******************************************************************************/
+static uint8_t *ep3_capture(uint8_t *dest, const uint8_t *src, uint32_t size)
+{
+    (void) size;
+
+    ep3_buffer = src;
+
+    return dest;
+}
+#endif
+
+#if (UART_RS485 != 0u)
+/*******************************************************************************
+* Function Name: rs485_drive
+********************************************************************************
+*
+* Summary:
+*  Enables the RS-485 driver before UART_TX_DMA starts on a slot, and cancels
+*  a pending release. Called from start_tx_slot only, after tx_dma_busy is
+*  set.
+*
+* Parameters:
+*  port: bridge port
+*  length: number of bytes in the slot, whose echo is dropped from UART RX
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rs485_drive(bridge_port_t *port, uint32_t length)
+{
+#if (UART_RS485_ECHO != 0u)
+    port->rs485_echo_pending += length;
+#else
+    (void) length;
+#endif
+
+    Cy_SCB_SetTxInterruptMask(port->hw->uart.base, port->uart_config.txFifoIntEnableMask);
+    port->rs485_guard = false;
+
+    if (!port->rs485_driving)
+    {
+        port->rs485_driving = true;
+        Cy_GPIO_Write(port->hw->de_port, port->hw->de_pin, UART_RS485_DE_ACTIVE);
+    }
+}
+
+/*******************************************************************************
+* Function Name: rs485_arm_release
+********************************************************************************
+*
+* Summary:
+*  Enables the UART TX done interrupt once UART_TX_DMA has run out of slots,
+*  so that uart_isr releases the driver after the last stop bit. Called from
+*  dma_work_isr only.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rs485_arm_release(bridge_port_t *port)
+{
+    Cy_SCB_UART_ClearTxFifoStatus(port->hw->uart.base, CY_SCB_UART_TX_DONE);
+    Cy_SCB_SetTxInterruptMask(port->hw->uart.base, port->uart_config.txFifoIntEnableMask | CY_SCB_UART_TX_DONE);
+
+    /* The last stop bit may have gone out before the status was cleared */
+    if (Cy_SCB_UART_IsTxComplete(port->hw->uart.base))
+    {
+        NVIC_SetPendingIRQ(port->hw->uart_intr_cfg.intrSrc);
+    }
+}
+
+/*******************************************************************************
+* Function Name: rs485_release
+********************************************************************************
+*
+* Summary:
+*  Disables the RS-485 driver and the UART TX done interrupt. Must be called
+*  from uart_isr or with interrupts masked.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rs485_release(bridge_port_t *port)
+{
+    Cy_GPIO_Write(port->hw->de_port, port->hw->de_pin, (UART_RS485_DE_ACTIVE != 0u) ? 0u : 1u);
+    port->rs485_driving = false;
+    port->rs485_guard = false;
+    Cy_SCB_SetTxInterruptMask(port->hw->uart.base, port->uart_config.txFifoIntEnableMask);
+}
+
+/*******************************************************************************
+* Function Name: rs485_tx_done
+********************************************************************************
+*
+* Summary:
+*  Releases the RS-485 driver once UART TX is complete and no slot is queued,
+*  or starts the guard time that rs485_guard_check counts. uart_isr may
+*  interrupt dma_work_isr, so a slot started in the meantime is detected
+*  through tx_dma_busy. A break keeps the driver enabled until break_end.
+*  Called from uart_isr only.
+*
+* Parameters:
+*  port: bridge port
+*  isr_start: stats_now() on entry to uart_isr
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rs485_tx_done(bridge_port_t *port, uint32_t isr_start)
+{
+    if (port->rs485_guard || port->tx_dma_busy || port->break_active ||
+        !Cy_SCB_UART_IsTxComplete(port->hw->uart.base))
+    {
+        return;
+    }
+
+    if (port->rs485_guard_cycles == 0u)
+    {
+        rs485_release(port);
+        stats_rs485_turnaround(isr_start);
+        return;
+    }
+
+    /* This interrupt runs at priority 0, so the guard time is not waited
+     * here. TX done stays set and is masked meanwhile. */
+    Cy_SCB_SetTxInterruptMask(port->hw->uart.base, port->uart_config.txFifoIntEnableMask);
+    port->rs485_done_at = isr_start;
+    port->rs485_guard = true;
+}
+
+/*******************************************************************************
+* Function Name: rs485_guard_check
+********************************************************************************
+*
+* Summary:
+*  Releases the RS-485 driver once the guard time started by rs485_tx_done
+*  has passed. Called from systick_isr, so the driver is released up to one
+*  tick after the guard time.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rs485_guard_check(bridge_port_t *port)
+{
+    uint32_t int_state;
+
+    /* rs485_drive cancels the guard time from a higher priority */
+    int_state = Cy_SysLib_EnterCriticalSection();
+    if (port->rs485_guard && ((stats_now() - port->rs485_done_at) >= port->rs485_guard_cycles))
+    {
+        rs485_release(port);
+        stats_rs485_turnaround(port->rs485_done_at);
+    }
+    Cy_SysLib_ExitCriticalSection(int_state);
+}
+#endif /* UART_RS485 */
+
+/*******************************************************************************
+* Function Name: rx_forward
+********************************************************************************
+*
+* Summary:
+*  Forwards UART RX bytes towards the host. Up to one packet is loaded
+*  straight into EP2 when EP2 is free, nothing is queued or notified and
+*  packets are not coalesced. Other bytes are appended to rx_queue for
+*  rx_drain, and those that do not fit are reported as an overrun. FRAME_MODE
+*  decodes the bytes with rx_decode and SNIFFER_MODE records them with
+*  sniff_forward. Must be called from dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  port: bridge port
+*  data: received bytes
+*  length: number of received bytes
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rx_forward(bridge_port_t *port, uint8_t *data, uint32_t length)
+{
+#if (FRAME_MODE == FRAME_MODE_NONE) && (SNIFFER_MODE == 0u)
+    uint32_t queued;
+#endif
+#if (UART_RS485 != 0u) && (UART_RS485_ECHO != 0u)
+    uint32_t echo;
+#endif
+
+    /* Position of these bytes in the UART RX stream, for line_event */
+    port->rx_forwarded_bytes += length;
+
+#if (UART_RS485 != 0u) && (UART_RS485_ECHO != 0u)
+    /* The echo of our own bytes arrives before any reply, because the peer
+     * only starts sending once the driver has been released. The self-test
+     * checks it, otherwise it is dropped. */
+    echo = (length < port->rs485_echo_pending) ? length : port->rs485_echo_pending;
+    port->rs485_echo_pending -= echo;
+    if (!port->selftest_owns_tx)
+    {
+        stats_rs485_echo(echo);
+        data += echo;
+        length -= echo;
+        if (length == 0u)
+        {
+            return;
+        }
+    }
+#endif
+
+#if (AUTOBAUD != 0u)
+    /* Bytes received at the old rate while the rate is being detected */
+    if (port->autobaud_discard)
+    {
+        return;
+    }
+#endif
+
+    /* The looped-back self-test data is checked, not sent to the host */
+    if (port->selftest_owns_tx)
+    {
+        selftest_check(data, length);
+        return;
+    }
+
+#if (SNIFFER_MODE != 0u)
+    sniff_forward(port, data, length);
+#elif (FRAME_MODE != FRAME_MODE_NONE)
+    rx_decode(port, data, length);
+#else
+    if ((length <= USB_EP_PACKET_SIZE) && (port->in_coalesce_ticks == 0u) &&
+        (rx_queue_count(&port->rx_queue) == 0u) && (port->line_events == 0u) && (port->serial_state == 0u) &&
+        (1u == Cy_USB_Dev_CDC_IsReady(port->hw->com_port, &usb_cdcContext)))
+    {
+        /* Initiate DMA data transfer from the RX buffer to Driver SRAM Endpoint buffer (in). */
+        dev_drv_status = Cy_USBFS_Dev_Drv_LoadInEndpoint(CYBSP_USB_HW, port->hw->ep_in, data, length, &usb_drvContext);
+
+        /* Status is checked to ensure data was transferred successfully. */
+        if (dev_drv_status != CY_USBFS_DEV_DRV_SUCCESS)
+        {
+            port->ep2_load_error = true;
+            fault_pending = true;
+            trace_event(TRACE_FAULT, TRACE_FAULT_EP2_LOAD, 0u);
+        }
+        stats_in_sent(PORT_INDEX(port), length, false);
+        port->in_zlp_pending = (length == USB_EP_PACKET_SIZE);
+    }
+    else
+    {
+        /* EP2 is busy, older data or a notification is waiting or packets
+         * are coalesced: keep the order through rx_queue */
+        queued = rx_queue_put(&port->rx_queue, data, length);
+        if (queued != length)
+        {
+            port->rx_queue_overrun = true;
+            fault_pending = true;
+            trace_event(TRACE_FAULT, TRACE_FAULT_RX_QUEUE_OVERRUN, 0u);
+
+            /* The bytes are lost after the ones just queued */
+            line_event(port, SERIAL_STATE_OVERRUN, port->rx_forwarded_bytes);
+        }
+        stats_in_queued(PORT_INDEX(port), queued, rx_queue_count(&port->rx_queue));
+        rx_drain(port);
+    }
+#endif
+
+    update_rx_throttle(port);
+}
+
+/*******************************************************************************
+* Function Name: rx_drain
+********************************************************************************
+*
+* Summary:
+*  Loads the oldest rx_queue bytes, up to one packet, into EP2 if it is free.
+*  A full packet is loaded right away. A partial packet, or the zero-length
+*  packet that ends a transfer after a full one, is held until the next SOF or
+*  until the coalescing timeout has passed. In FRAME_MODE the packet that ends
+*  a frame is loaded as soon as the frame is complete, and a partial packet of
+*  an incomplete frame is held until more bytes arrive. The bytes ahead of a
+*  SERIAL_STATE notification are loaded without holding them, and the bytes
+*  behind it wait until it has been sent. Must be called from dma_work_isr or
+*  with interrupts masked.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rx_drain(bridge_port_t *port)
+{
+    uint8_t *data;
+    uint32_t count;
+    uint32_t length;
+
+    /* In SNIFFER_MODE line events are records in the stream instead */
+#if (SNIFFER_MODE == 0u)
+    if (!serial_state_drain(port))
+    {
+        return;
+    }
+#endif
+
+    count = rx_queue_count(&port->rx_queue);
+    if (((count == 0u) && !port->in_zlp_pending) || (1u != Cy_USB_Dev_CDC_IsReady(port->hw->com_port, &usb_cdcContext)))
+    {
+        return;
+    }
+
+#if (FRAME_MODE != FRAME_MODE_NONE)
+    /* An IN transfer carries one frame. Its full packets are loaded as soon
+     * as they are queued, the short or zero-length packet that ends it once
+     * the frame is complete. */
+    if (rx_queue_frame_length(&port->rx_queue, &length) && (length < USB_EP_PACKET_SIZE))
+    {
+        rx_queue_frame_sent(&port->rx_queue);
+    }
+    else if (count >= USB_EP_PACKET_SIZE)
+    {
+        length = USB_EP_PACKET_SIZE;
+    }
+    else
+    {
+        return;
+    }
+    (void) rx_queue_peek(&port->rx_queue, &data);
+#else
+    /* The bytes ahead of a SERIAL_STATE notification are not held */
+    if ((count < USB_EP_PACKET_SIZE) && (port->in_coalesce_ticks != 0u) && (port->serial_state == 0u))
+    {
+        if (!port->in_hold)
+        {
+            /* Start holding, the SOF callback or in_coalesce_check releases it */
+            port->in_hold = true;
+            port->in_hold_tick = tick_count;
+            port->in_sof_flush = false;
+            return;
+        }
+        if (!port->in_sof_flush && ((tick_count - port->in_hold_tick) < port->in_coalesce_ticks))
+        {
+            return;
+        }
+    }
+    port->in_hold = false;
+    length = rx_queue_peek(&port->rx_queue, &data);
+
+    /* Stop at the notification. A length of 0 ends the transfer ahead of it. */
+    if ((port->serial_state != 0u) && ((port->serial_state_mark != 0u) || port->in_zlp_pending))
+    {
+        if (length > port->serial_state_mark)
+        {
+            length = port->serial_state_mark;
+        }
+        port->serial_state_mark -= length;
+    }
+#endif
+
+    /* A length of 0 sends the zero-length packet. The driver copies the bytes
+     * into its endpoint buffer, so they can be released right away. */
+    dev_drv_status = Cy_USBFS_Dev_Drv_LoadInEndpoint(CYBSP_USB_HW, port->hw->ep_in, data, length, &usb_drvContext);
+    if (dev_drv_status != CY_USBFS_DEV_DRV_SUCCESS)
+    {
+        port->ep2_load_error = true;
+        fault_pending = true;
+        trace_event(TRACE_FAULT, TRACE_FAULT_EP2_LOAD, 0u);
+    }
+    stats_in_sent(PORT_INDEX(port), length, true);
+    rx_queue_drop(&port->rx_queue, length);
+    port->in_zlp_pending = (length == USB_EP_PACKET_SIZE);
+
+    update_rx_throttle(port);
+
+    /* The pages sent may let a held-off OUT path go on */
+    out_pool_retry();
+}
+
+/*******************************************************************************
+* Function Name: rx_received_bytes
+********************************************************************************
+*
+* Summary:
+*  Counts the bytes UART RX has received since boot, including those still in
+*  the RX FIFO. A descriptor completion that dma_isr has not counted yet is
+*  added, so the count stays right when called from uart_isr.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  uint32_t: number of received bytes, wraps around
+*
+*******************************************************************************/
+static uint32_t rx_received_bytes(bridge_port_t *port)
+{
+    const uart_dma_t *rx_dma = &port->hw->rx_dma;
+    cy_en_dmac_descriptor_t descriptor;
+    uint32_t done = port->rx_descr_done_count;
+
+    if (0u != (Cy_DMAC_GetInterruptStatus(DMAC) & (1UL << rx_dma->channel)))
+    {
+        done++;
+    }
+
+    descriptor = Cy_DMAC_Channel_GetCurrentDescriptor(rx_dma->base, rx_dma->channel);
+
+    return ((done * PING_PONG_BUF_SIZE) +
+            Cy_DMAC_Descriptor_GetCurrentIndex(rx_dma->base, rx_dma->channel, descriptor) +
+            Cy_SCB_UART_GetNumInRxFifo(port->hw->uart.base));
+}
+
+/*******************************************************************************
+* Function Name: line_event
+********************************************************************************
+*
+* Summary:
+*  Records line events for the next SERIAL_STATE notification. Events that
+*  come in before the notification has been taken by dma_work_isr are merged
+*  into it, and it follows the bytes received up to the latest of them.
+*  Called from uart_isr and dma_work_isr.
+*
+* Parameters:
+*  port: bridge port
+*  state: SERIAL_STATE bits of the events
+*  position: number of UART RX bytes received before the notification
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void line_event(bridge_port_t *port, uint32_t state, uint32_t position)
+{
+    uint32_t int_state;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    if (port->line_events == 0u)
+    {
+        port->line_event_time = stats_now();
+        port->line_event_position = position;
+    }
+    else if ((int32_t) (position - port->line_event_position) > 0)
+    {
+        port->line_event_position = position;
+    }
+    port->line_events |= state;
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    trace_event(TRACE_LINE_EVENT, state, 0u);
+    work_post(WORK_IN, PORT_INDEX(port));
+}
+
+#if (SNIFFER_MODE == 0u)
+/*******************************************************************************
+* Function Name: serial_state_drain
+********************************************************************************
+*
+* Summary:
+*  Sends the CDC SERIAL_STATE notification on the interrupt endpoint at its
+*  place in the IN stream. The line events are taken once the bytes received
+*  before them have been forwarded. The rx_queue bytes ahead of them are
+*  marked, and the notification is sent once these bytes, and the zero-length
+*  packet that may end their transfer, have been loaded into EP2. In
+*  FRAME_MODE rx_queue holds decoded frames, so the notification is sent
+*  right away. Called from rx_drain only.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  bool: false while the bytes behind the notification must wait
+*
+*******************************************************************************/
+static bool serial_state_drain(bridge_port_t *port)
+{
+    uint32_t int_state;
+    uint32_t behind = 0u;
+    uint32_t count;
+
+    if (port->serial_state == 0u)
+    {
+        int_state = Cy_SysLib_EnterCriticalSection();
+        if ((port->line_events != 0u) && ((int32_t) (port->line_event_position - port->rx_forwarded_bytes) <= 0))
+        {
+            port->serial_state = port->line_events;
+            port->serial_state_time = port->line_event_time;
+            port->serial_state_tick = tick_count;
+            behind = port->rx_forwarded_bytes - port->line_event_position;
+            port->line_events = 0u;
+        }
+        Cy_SysLib_ExitCriticalSection(int_state);
+
+        if (port->serial_state == 0u)
+        {
+            return true;
+        }
+
+        /* The bytes forwarded after the events are at the end of rx_queue */
+        count = rx_queue_count(&port->rx_queue);
+        port->serial_state_mark = ((FRAME_MODE == FRAME_MODE_NONE) && (behind < count)) ? (count - behind) : 0u;
+    }
+
+    if ((port->serial_state_mark != 0u) || ((FRAME_MODE == FRAME_MODE_NONE) && port->in_zlp_pending))
+    {
+        return true;
+    }
+
+    if (CY_USB_DEV_SUCCESS == Cy_USB_Dev_CDC_SendSerialState(port->hw->com_port, port->serial_state, &usb_cdcContext))
+    {
+        trace_event(TRACE_SERIAL_STATE, port->serial_state, 0u);
+        stats_serial_state_sent(port->serial_state_time);
+        port->serial_state = 0u;
+        return true;
+    }
+
+    /* The interrupt endpoint still holds the last notification and is retried
+     * on every SOF. If the host does not poll it, the data moves on after
+     * SERIAL_STATE_HOLD_US and the notification follows it. */
+    return ((tick_count - port->serial_state_tick) >= serial_state_hold_ticks);
+}
+#endif /* SNIFFER_MODE */
+
+/*******************************************************************************
+* Function Name: update_rx_throttle
+********************************************************************************
+*
+* Summary:
+*  Throttles the UART peer when rx_queue reaches RX_QUEUE_THROTTLE_LEVEL and
+*  releases it once the queue has drained to RX_QUEUE_RELEASE_LEVEL. With
+*  UART_FLOW_CONTROL, UART_RX_DMA is paused so that the RX FIFO fills up and
+*  the SCB deasserts RTS. Without flow control the peer cannot be stopped and
+*  bytes that do not fit into rx_queue are dropped.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void update_rx_throttle(bridge_port_t *port)
+{
+    uint32_t count = rx_queue_count(&port->rx_queue);
+
+    if (!port->rx_throttled && (count >= RX_QUEUE_THROTTLE_LEVEL))
+    {
+        port->rx_throttled = true;
+    }
+    else if (port->rx_throttled && (count <= RX_QUEUE_RELEASE_LEVEL))
+    {
+        port->rx_throttled = false;
+    }
+    else
+    {
+        return;
+    }
+
+#if (UART_FLOW_CONTROL != 0u)
+    /* A paused channel keeps its descriptor position */
+    if (port->rx_throttled)
+    {
+        Cy_DMAC_Channel_Disable(port->hw->rx_dma.base, port->hw->rx_dma.channel);
+    }
+    else
+    {
+        Cy_DMAC_Channel_Enable(port->hw->rx_dma.base, port->hw->rx_dma.channel);
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: rx_dma_held
+********************************************************************************
+*
+* Summary:
+*  Tells whether UART_RX_DMA is paused by update_rx_throttle and must stay
+*  disabled when another routine restarts it.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  bool: true if UART_RX_DMA must stay disabled
+*
+*******************************************************************************/
+static bool rx_dma_held(bridge_port_t *port)
+{
+    return ((UART_FLOW_CONTROL != 0u) && port->rx_throttled);
+}
+
+/*******************************************************************************
+* Function Name: ep_in_callback
+********************************************************************************
+*
+* Summary:
+*  Called by the USBFS driver when a bulk IN transfer completes. Posts WORK_IN
+*  for the port of the endpoint so that dma_work_isr, which owns rx_queue,
+*  loads the next packet.
+*
+* Parameters:
+*  base: USBFS base address
+*  endpointAddr: endpoint address
+*  errorType: transfer error type
+*  context: USBFS driver context
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void ep_in_callback(USBFS_Type *base, uint32_t endpointAddr, uint32_t errorType,
+                           cy_stc_usbfs_dev_drv_context_t *context)
+{
+    uint32_t index;
+
+    (void) base;
+    (void) errorType;
+    (void) context;
+
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        if (bridge_port_hw[index].ep_in == USB_EP_NUMBER(endpointAddr))
+        {
+            work_post(WORK_IN, index);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: usb_sof_callback
+********************************************************************************
+*
+* Summary:
+*  Called by the USBFS driver on every SOF. Releases the held IN packets and
+*  retries the SERIAL_STATE notifications of all ports by posting WORK_IN.
+*
+* Parameters:
+*  base: USBFS base address
+*  context: USBFS driver context
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void usb_sof_callback(USBFS_Type *base, cy_stc_usbfs_dev_drv_context_t *context)
+{
+    bridge_port_t *port;
+
+    (void) base;
+    (void) context;
+
+    for (port = bridge_ports; port < &bridge_ports[BRIDGE_PORTS]; port++)
+    {
+        if (port->in_hold)
+        {
+            port->in_sof_flush = true;
+            work_post(WORK_IN, PORT_INDEX(port));
+        }
+        else if (port->serial_state != 0u)
+        {
+            work_post(WORK_IN, PORT_INDEX(port));
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: in_coalesce_set
+********************************************************************************
+*
+* Summary:
+*  Sets the time a partial IN packet may be held, rounded up to whole ticks.
+*  0 loads received data into EP2 right away.
+*
+* Parameters:
+*  port: bridge port
+*  timeout_us: coalescing timeout in microseconds
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void in_coalesce_set(bridge_port_t *port, uint32_t timeout_us)
+{
+    port->in_coalesce_ticks = (timeout_us + TICK_PERIOD_US - 1u) / TICK_PERIOD_US;
+}
+
+/*******************************************************************************
+* Function Name: in_coalesce_check
+********************************************************************************
+*
+* Summary:
+*  Called once per tick. Pends the DMA interrupt when a held IN packet has
+*  reached the coalescing timeout, so that dma_work_isr loads it into EP2.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void in_coalesce_check(bridge_port_t *port)
+{
+    if (port->in_hold && ((tick_count - port->in_hold_tick) >= port->in_coalesce_ticks))
+    {
+        work_post(WORK_IN, PORT_INDEX(port));
+    }
+}
+
+/*******************************************************************************
+* Function Name: systick_isr
+********************************************************************************
+*
+* Summary:
+*  SysTick callback. Advances the time base used by the receive-idle timeout,
+*  and ends the RS-485 guard times.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void systick_isr(void)
+{
+#if (UART_RS485 != 0u)
+    bridge_port_t *port;
+#endif
+
+    tick_count++;
+
+#if (UART_RS485 != 0u)
+    for (port = bridge_ports; port < &bridge_ports[BRIDGE_PORTS]; port++)
+    {
+        if (port->rs485_guard)
+        {
+            rs485_guard_check(port);
+        }
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: endpoint_stall_check
+********************************************************************************
+*
+* Summary:
+*  Counts halts of the data endpoints set by the host with
+*  SET_FEATURE(ENDPOINT_HALT). The endpoint states are sampled once per tick.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void endpoint_stall_check(bridge_port_t *port)
+{
+    bool stalled;
+
+    stalled = (Cy_USBFS_Dev_Drv_GetEndpointState(CYBSP_USB_HW, port->hw->ep_in, &usb_drvContext) ==
+               CY_USB_DEV_EP_STALLED) ||
+              (Cy_USBFS_Dev_Drv_GetEndpointState(CYBSP_USB_HW, port->hw->ep_out, &usb_drvContext) ==
+               CY_USB_DEV_EP_STALLED);
+
+    if (stalled && !port->ep_stalled)
+    {
+        stats_ep_stall();
+    }
+    port->ep_stalled = stalled;
+}
+
+/*******************************************************************************
+* Function Name: vendor_request_received
+********************************************************************************
+*
+* Summary:
+*  Handles the vendor requests on EP0. Called by the USB device middleware
+*  from the USB interrupt.
+*
+* Parameters:
+*  transfer: control transfer of the request
+*  context: USB device context
+*
+* Return:
+*  cy_en_usb_dev_status_t: CY_USB_DEV_REQUEST_NOT_HANDLED stalls the request
+*
+*******************************************************************************/
+static cy_en_usb_dev_status_t vendor_request_received(cy_stc_usb_dev_control_transfer_t *transfer,
+                                                      cy_stc_usb_dev_context_t *context)
+{
+    cy_en_usb_dev_status_t status = CY_USB_DEV_REQUEST_NOT_HANDLED;
+    uint32_t length;
+
+    (void) context;
+
+    if (transfer->setup.bmRequestType.recipient != CY_USB_DEV_RECIPIENT_DEVICE)
+    {
+        return status;
+    }
+
+    switch (transfer->setup.bRequest)
+    {
+        case STATS_VENDOR_REQ_GET:
+            if (transfer->setup.bmRequestType.direction == CY_USB_DEV_DIR_DEVICE_TO_HOST)
+            {
+                transfer->ptr = (uint8_t *) stats_snapshot(&length);
+                transfer->remaining = (length < transfer->setup.wLength) ? length : transfer->setup.wLength;
+                status = CY_USB_DEV_SUCCESS;
+            }
+            break;
+
+        case STATS_VENDOR_REQ_RESET:
+            if ((transfer->setup.bmRequestType.direction == CY_USB_DEV_DIR_HOST_TO_DEVICE) &&
+                (transfer->setup.wLength == 0u))
+            {
+                stats_request_reset();
+                status = CY_USB_DEV_SUCCESS;
+            }
+            break;
+
+        case SELFTEST_VENDOR_REQ_START:
+            if ((transfer->setup.bmRequestType.direction == CY_USB_DEV_DIR_HOST_TO_DEVICE) &&
+                (transfer->setup.wLength == 0u) && selftest_request(transfer->setup.wValue))
+            {
+                status = CY_USB_DEV_SUCCESS;
+            }
+            break;
+
+        case SELFTEST_VENDOR_REQ_RESULT:
+            if (transfer->setup.bmRequestType.direction == CY_USB_DEV_DIR_DEVICE_TO_HOST)
+            {
+                transfer->ptr = (uint8_t *) selftest_snapshot(&length);
+                transfer->remaining = (length < transfer->setup.wLength) ? length : transfer->setup.wLength;
+                status = CY_USB_DEV_SUCCESS;
+            }
+            break;
+
+        case VENDOR_REQ_SET_IN_COALESCE:
+            if ((transfer->setup.bmRequestType.direction == CY_USB_DEV_DIR_HOST_TO_DEVICE) &&
+                (transfer->setup.wLength == 0u) && (transfer->setup.wIndex < BRIDGE_PORTS))
+            {
+                in_coalesce_set(&bridge_ports[transfer->setup.wIndex], transfer->setup.wValue);
+                status = CY_USB_DEV_SUCCESS;
+            }
+            break;
+
+#if (TRACE_ENABLE != 0u)
+        case TRACE_VENDOR_REQ_CONTROL:
+            if ((transfer->setup.bmRequestType.direction == CY_USB_DEV_DIR_HOST_TO_DEVICE) &&
+                (transfer->setup.wLength == 0u))
+            {
+                trace_control(transfer->setup.wValue != 0u);
+                status = CY_USB_DEV_SUCCESS;
+            }
+            break;
+
+        case TRACE_VENDOR_REQ_READ:
+            if (transfer->setup.bmRequestType.direction == CY_USB_DEV_DIR_DEVICE_TO_HOST)
+            {
+                transfer->ptr = (uint8_t *) trace_snapshot(&length);
+                transfer->remaining = (length < transfer->setup.wLength) ? length : transfer->setup.wLength;
+                status = CY_USB_DEV_SUCCESS;
+            }
+            break;
+#endif
+
+#if (AUTOBAUD != 0u)
+        case AUTOBAUD_VENDOR_REQ_START:
+            if ((transfer->setup.bmRequestType.direction == CY_USB_DEV_DIR_HOST_TO_DEVICE) &&
+                (transfer->setup.wLength == 0u) && autobaud_request(transfer->setup.wIndex, transfer->setup.wValue))
+            {
+                status = CY_USB_DEV_SUCCESS;
+            }
+            break;
+
+        case AUTOBAUD_VENDOR_REQ_RESULT:
+            if (transfer->setup.bmRequestType.direction == CY_USB_DEV_DIR_DEVICE_TO_HOST)
+            {
+                transfer->ptr = (uint8_t *) autobaud_snapshot(&length);
+                transfer->remaining = (length < transfer->setup.wLength) ? length : transfer->setup.wLength;
+                status = CY_USB_DEV_SUCCESS;
+            }
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+* Function Name: cpu_sleep
+********************************************************************************
+*
+* Summary:
+*  Puts the CPU into Sleep until the next interrupt, unless a fault or a tick
+*  is already waiting for the main loop. DMA, SCB and USB keep running in
+*  Sleep. Interrupts are masked around the check, so an interrupt that comes
+*  in after it stays pending and ends the Sleep at once. Work that does not
+*  come with an interrupt of its own, such as waiting for the UART to finish
+*  before a line coding change, is picked up on the next tick at the latest.
+*
+* Parameters:
+*  last_tick: tick last handled by the main loop
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void cpu_sleep(uint32_t last_tick)
+{
+#if (LOW_POWER_SLEEP != 0u)
+    uint32_t int_state;
+    uint32_t reload;
+    uint32_t start;
+    uint32_t end;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+
+    if (!fault_pending && (tick_count == last_tick) && (0u == (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)))
+    {
+        reload = Cy_SysTick_GetReload();
+        start = Cy_SysTick_GetValue();
+
+        Cy_SysPm_CpuEnterSleep();
+
+        /* SysTick is masked here and ends the Sleep, so it wrapped at most once */
+        end = Cy_SysTick_GetValue();
+        if (0u != (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+        {
+            sleep_cycles += (start + reload + 1u) - end;
+        }
+        else
+        {
+            sleep_cycles += start - end;
+        }
+    }
+
+    Cy_SysLib_ExitCriticalSection(int_state);
+#else
+    (void) last_tick;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: sleep_stats_task
+********************************************************************************
+*
+* Summary:
+*  Publishes the share of time spent in Sleep in sleep_permille once per
+*  second of Active and Sleep time.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void sleep_stats_task(void)
+{
+    uint32_t window = tick_count - sleep_window_start;
+
+    if (window >= SLEEP_STATS_WINDOW_TICKS)
+    {
+        sleep_permille = (uint32_t) (((uint64_t) sleep_cycles * 1000u) /
+                                     ((uint64_t) window * (Cy_SysTick_GetReload() + 1u)));
+        sleep_cycles = 0u;
+        sleep_window_start = tick_count;
+    }
+}
+
+/*******************************************************************************
+* Function Name: usb_events_callback
+********************************************************************************
+*
+* Summary:
+*  Called by the USB device middleware from usb_low_isr on a bus reset,
+*  SET_CONFIGURATION and SET_INTERFACE. The middleware has just set up the
+*  data endpoints, and the host sends nothing on them before the status stage
+*  of the request. The bridge ports are re-synchronized here, so no packet of
+*  the new session can arrive before. A bus reset or SET_CONFIGURATION 0 is
+*  recorded as a link down.
+*
+* Parameters:
+*  event: bus reset, SET_CONFIGURATION or SET_INTERFACE
+*  wValue: configuration, or alternate setting of SET_INTERFACE
+*  wIndex: interface of SET_INTERFACE
+*  devContext: USB device context
+*
+* Return:
+*  cy_en_usb_dev_status_t: CY_USB_DEV_SUCCESS, the request is always accepted
+*
+*******************************************************************************/
+static cy_en_usb_dev_status_t usb_events_callback(cy_en_usb_dev_callback_events_t event, uint32_t wValue,
+                                                  uint32_t wIndex, cy_stc_usb_dev_context_t *devContext)
+{
+    uint32_t int_state;
+    bridge_port_t *port;
+
+    (void) devContext;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+
+    switch (event)
+    {
+        case CY_USB_DEV_EVENT_SET_CONFIG:
+            /* The session with the host ends, a new configuration starts
+             * another */
+            usb_link_down();
+            trace_event(TRACE_USB_CONFIG, wValue, 0u);
+            if (wValue != 0u)
+            {
+                usb_configured = true;
+                stats_usb_configured();
+                for (port = bridge_ports; port < &bridge_ports[BRIDGE_PORTS]; port++)
+                {
+                    usb_port_resync(port);
+                }
+                Cy_DMAC_SetInterruptMask(DMAC, dma_intr_mask);
+            }
+            break;
+
+        case CY_USB_DEV_EVENT_SET_INTERFACE:
+            /* Only the endpoints of the data interface named were set up */
+            for (port = bridge_ports; port < &bridge_ports[BRIDGE_PORTS]; port++)
+            {
+                if (usb_configured && (wIndex == (port->hw->comm_interface + 1u)))
+                {
+                    usb_port_resync(port);
+                }
+            }
+            Cy_DMAC_SetInterruptMask(DMAC, dma_intr_mask);
+            break;
+
+        default:
+            if (usb_configured)
+            {
+                trace_event(TRACE_USB_CONFIG, 0u, 0u);
+            }
+            usb_link_down();
+            break;
+    }
+
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    return CY_USB_DEV_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: usb_link_down
+********************************************************************************
+*
+* Summary:
+*  Ends the session with the host, if the device was configured. Must be
+*  called with interrupts masked.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void usb_link_down(void)
+{
+    if (usb_configured)
+    {
+        usb_configured = false;
+        stats_usb_link_down();
+    }
+}
+
+/*******************************************************************************
+* Function Name: usb_port_resync
+********************************************************************************
+*
+* Summary:
+*  Re-synchronizes a bridge port with its freshly configured data endpoints.
+*  The driver's memcpy is replaced again, and the OUT path is reset as on a
+*  fault, because the middleware has re-armed the OUT endpoint and the OUT
+*  packets queued before belong to the old session. rx_queue keeps the UART
+*  data received meanwhile, which is sent to the host from now on. Must be
+*  called with interrupts masked.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void usb_port_resync(bridge_port_t *port)
+{
+    const bridge_port_hw_t *hw = port->hw;
+
+    /* Replace the byte-wise memcpy of the driver for the data endpoints.
+     * With OUT_ZERO_COPY, OUT packets are not copied at all and
+     * UART_TX_DMA reads them from the driver's endpoint buffer. */
+#if (OUT_ZERO_COPY != 0u)
+    Cy_USBFS_Dev_Drv_OverwriteMemcpy(CYBSP_USB_HW, hw->ep_out, &ep3_capture, &usb_drvContext);
+#else
+    Cy_USBFS_Dev_Drv_OverwriteMemcpy(CYBSP_USB_HW, hw->ep_out, &usb_ep_memcpy, &usb_drvContext);
+#endif
+    Cy_USBFS_Dev_Drv_OverwriteMemcpy(CYBSP_USB_HW, hw->ep_in, &usb_ep_memcpy, &usb_drvContext);
+
+    /* Drop an OUT packet of the old session that has not been read yet */
+    Cy_DMAC_ClearInterrupt(DMAC, (1UL << USB_EP_DMA_CHANNEL(hw->ep_out)));
+    work_cancel(WORK_OUT, PORT_INDEX(port));
+    port->ep3_out_waiting = false;
+    recover_tx_path(port);
+
+    /* The IN transfer in progress was lost with the old session */
+    port->in_zlp_pending = false;
+    port->ep_stalled = false;
+
+#if (SNIFFER_MODE != 0u)
+    /* Once the old session has read from the record stream, the new one may
+     * start in the middle of a record, so the stream starts afresh. The
+     * records captured before the first configuration are kept. */
+    if (port->rx_queue.read != 0u)
+    {
+        rx_queue_reset(&port->rx_queue);
+        port->in_hold = false;
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: usb_suspend_task
+********************************************************************************
+*
+* Summary:
+*  Samples USB bus activity once per millisecond. When a configured device
+*  sees no activity for USB_SUSPEND_TIMEOUT_MS and no UART has anything left
+*  to send, the device is suspended through usb_suspend.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void usb_suspend_task(void)
+{
+#if (USB_SUSPEND_DEEP_SLEEP != 0u)
+    bridge_port_t *port;
+
+    if ((tick_count - usb_activity_tick) < USB_ACTIVITY_CHECK_TICKS)
+    {
+        return;
+    }
+    usb_activity_tick = tick_count;
+
+    if (Cy_USBFS_Dev_Drv_CheckActivity(CYBSP_USB_HW) || (0u == Cy_USB_Dev_GetConfiguration(&usb_devContext)))
+    {
+        usb_idle_ms = 0u;
+        return;
+    }
+
+    if (usb_idle_ms < USB_SUSPEND_TIMEOUT_MS)
+    {
+        usb_idle_ms++;
+        return;
+    }
+
+    /* Deep Sleep stops the SCBs and the DMA, so let every UART finish first */
+    for (port = bridge_ports; port < &bridge_ports[BRIDGE_PORTS]; port++)
+    {
+        if ((port->tx_ring_count != 0u) || port->tx_dma_busy || !Cy_SCB_UART_IsTxComplete(port->hw->uart.base) ||
+            (0u != Cy_SCB_UART_GetNumInRxFifo(port->hw->uart.base)))
+        {
+            return;
+        }
+    }
+
+    usb_suspend();
+    usb_idle_ms = 0u;
+#endif
+}
+
+#if (USB_SUSPEND_DEEP_SLEEP != 0u)
+/*******************************************************************************
+* Function Name: usb_suspend
+********************************************************************************
+*
+* Summary:
+*  Suspends the USB block and enters Deep Sleep. Resume signaling and bus
+*  reset pull D+ low, and a start bit pulls UART RX low, so a falling edge on
+*  D+ or on the UART RX pin of any port wakes the device up. The character
+*  whose start bit woke the device is lost because the SCB is not clocked in
+*  Deep Sleep.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void usb_suspend(void)
+{
+    const bridge_port_hw_t *hw;
+    uint32_t int_state;
+    uint32_t dp_drive_mode;
+    uint32_t index;
+
+    Cy_USBFS_Dev_Drv_Suspend(CYBSP_USB_HW, &usb_drvContext);
+
+    /* D+ is an analog pin with its input buffer off, which cannot raise an
+     * edge interrupt. It is a digital input while suspended. */
+    dp_drive_mode = Cy_GPIO_GetDrivemode(CYBSP_USB_DP_PORT, CYBSP_USB_DP_PIN);
+    Cy_GPIO_SetDrivemode(CYBSP_USB_DP_PORT, CYBSP_USB_DP_PIN, CY_GPIO_DM_HIGHZ);
+
+    Cy_GPIO_ClearInterrupt(CYBSP_USB_DP_PORT, CYBSP_USB_DP_PIN);
+    Cy_GPIO_SetInterruptEdge(CYBSP_USB_DP_PORT, CYBSP_USB_DP_PIN, CY_GPIO_INTR_FALLING);
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        hw = &bridge_port_hw[index];
+        Cy_GPIO_ClearInterrupt(hw->rx_port, hw->rx_pin);
+        Cy_GPIO_SetInterruptEdge(hw->rx_port, hw->rx_pin, CY_GPIO_INTR_FALLING);
+    }
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    Cy_SysPm_CpuEnterDeepSleep();
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    Cy_GPIO_SetInterruptEdge(CYBSP_USB_DP_PORT, CYBSP_USB_DP_PIN, CY_GPIO_INTR_DISABLE);
+    Cy_GPIO_SetDrivemode(CYBSP_USB_DP_PORT, CYBSP_USB_DP_PIN, dp_drive_mode);
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+#if (AUTOBAUD != 0u)
+        /* A detection waiting on the port keeps the edge */
+        if (autobaud_armed(index))
+        {
+            continue;
+        }
+#endif
+        Cy_GPIO_SetInterruptEdge(bridge_port_hw[index].rx_port, bridge_port_hw[index].rx_pin, CY_GPIO_INTR_DISABLE);
+    }
+
+    Cy_USBFS_Dev_Drv_Resume(CYBSP_USB_HW, &usb_drvContext);
+
+    deep_sleep_count++;
+}
+
+/*******************************************************************************
+* Function Name: wakeup_isr
+********************************************************************************
+*
+* Summary:
+*  Handles the D+ and UART RX edge interrupts that end Deep Sleep during USB
+*  suspend. The edge of a port that waits for a baud-rate detection is left
+*  to autobaud_isr.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void wakeup_isr(void)
+{
+    uint32_t index;
+
+    Cy_GPIO_ClearInterrupt(CYBSP_USB_DP_PORT, CYBSP_USB_DP_PIN);
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+#if (AUTOBAUD != 0u)
+        if (autobaud_armed(index))
+        {
+            continue;
+        }
+#endif
+        Cy_GPIO_ClearInterrupt(bridge_port_hw[index].rx_port, bridge_port_hw[index].rx_pin);
+    }
+}
+#endif /* USB_SUSPEND_DEEP_SLEEP */
+
+/*******************************************************************************
+* Function Name: rx_idle_timeout_to_ticks
+********************************************************************************
+*
+* Summary:
+*  Converts a receive-idle timeout in UART bit-times to SysTick ticks. One
+*  tick is added because the line may go idle at any point within a tick.
+*
+* Parameters:
+*  timeout_bits: timeout in bit-times, 0 disables the idle flush
+*  baud_rate: current UART baud rate
+*
+* Return:
+*  uint32_t: timeout in ticks, 0 if disabled
+*
+*******************************************************************************/
+static uint32_t rx_idle_timeout_to_ticks(uint32_t timeout_bits, uint32_t baud_rate)
+{
+    uint32_t timeout_us;
+
+    if (timeout_bits == 0u)
+    {
+        return 0u;
+    }
+
+    timeout_us = (uint32_t)(((uint64_t)timeout_bits * 1000000u + baud_rate - 1u) / baud_rate);
+
+    return ((timeout_us + TICK_PERIOD_US - 1u) / TICK_PERIOD_US) + 1u;
+}
+
+/*******************************************************************************
+* Function Name: rx_idle_check
+********************************************************************************
+*
+* Summary:
+*  Samples the UART_RX_DMA write position once per tick. When it has not moved
+*  for rx_idle_timeout_ticks and the current descriptor holds bytes that were
+*  not yet sent to the host, the descriptor is flushed. While a line event
+*  waits for the bytes received before it, they are flushed at once.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rx_idle_check(bridge_port_t *port)
+{
+    const uart_dma_t *rx_dma = &port->hw->rx_dma;
+    cy_en_dmac_descriptor_t descriptor;
+    uint32_t index;
+    uint32_t position;
+
+    if ((port->rx_idle_timeout_ticks == 0u) && (port->line_events == 0u))
+    {
+        return;
+    }
+
+    descriptor = Cy_DMAC_Channel_GetCurrentDescriptor(rx_dma->base, rx_dma->channel);
+    index = Cy_DMAC_Descriptor_GetCurrentIndex(rx_dma->base, rx_dma->channel, descriptor);
+    position = (port->rx_descr_done_count * PING_PONG_BUF_SIZE) + index;
+
+    if (position != port->rx_idle_last_position)
+    {
+        /* A byte arrived since the last tick, restart the timeout */
+        port->rx_idle_last_position = position;
+        port->rx_idle_last_change = tick_count;
+    }
+
+    if ((index > port->rx_flush_offset[descriptor]) &&
+        ((port->line_events != 0u) ||
+         ((port->rx_idle_timeout_ticks != 0u) &&
+          ((tick_count - port->rx_idle_last_change) >= port->rx_idle_timeout_ticks))))
+    {
+        rx_idle_flush(port);
+    }
+}
+
+/*******************************************************************************
+* Function Name: rx_idle_flush
+********************************************************************************
+*
+* Summary:
+*  Forwards the bytes of the active UART_RX_DMA descriptor that have already
+*  been written to SRAM to EP2 with their real byte count.
+*
+*  The descriptor is left running. Its current element index only counts
+*  completed elements, so an element still in flight is never sent, and the
+*  flushed offset makes the completion in dma_work_isr send only the rest of
+*  the buffer. Interrupts are masked so dma_work_isr cannot interleave, and the
+*  flush is skipped if a descriptor completion is pending or not yet
+*  forwarded, keeping the bytes in order on EP2.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rx_idle_flush(bridge_port_t *port)
+{
+    const uart_dma_t *rx_dma = &port->hw->rx_dma;
+    cy_en_dmac_descriptor_t descriptor;
+    uint32_t index;
+    uint32_t offset;
+    uint8_t *buffer;
+    uint32_t int_state;
+
+    /* Masking interrupts also keeps dma_work_isr away from rx_queue */
+    int_state = Cy_SysLib_EnterCriticalSection();
+
+    descriptor = Cy_DMAC_Channel_GetCurrentDescriptor(rx_dma->base, rx_dma->channel);
+    index = Cy_DMAC_Descriptor_GetCurrentIndex(rx_dma->base, rx_dma->channel, descriptor);
+    offset = port->rx_flush_offset[descriptor];
+
+    if (((Cy_DMAC_GetInterruptStatus(DMAC) & (1UL << rx_dma->channel)) == 0u) &&
+        (port->rx_done_head == port->rx_done_tail) && (index > offset) && (index < PING_PONG_BUF_SIZE))
+    {
+        buffer = (descriptor == CY_DMAC_DESCRIPTOR_PING) ? port->rx_buffer_ping : port->rx_buffer_pong;
+
+        trace_event(TRACE_RX_IDLE_FLUSH, descriptor, index - offset);
+#if (SNIFFER_MODE != 0u)
+        /* The last byte arrived during the tick the position last moved */
+        port->sniff_time = port->rx_idle_last_change * TICK_PERIOD_US;
+#endif
+        rx_forward(port, &buffer[offset], index - offset);
+        stats_idle_flush();
+
+        port->rx_flush_offset[descriptor] = index;
+    }
+
+    Cy_SysLib_ExitCriticalSection(int_state);
+}
+
+/*******************************************************************************
+* Function Name: line_coding_task
+********************************************************************************
+*
+* Summary:
+*  Applies CDC SET_LINE_CODING requests to the UART. The CDC class stores the
+*  line coding sent by the host in usb_cdcContext and reports the change through
+*  Cy_USB_Dev_CDC_IsLineChanged. SET_CONTROL_LINE_STATE changes reported there
+*  are passed on to control_line_update.
+*
+*  A request the UART can follow is latched and EP3 is held off. The slots
+*  already in tx_ring are sent at the old rate, then the UART is reconfigured
+*  and EP3 is resumed. A request that cannot be met within
+*  UART_BAUD_TOLERANCE_PPM is recorded in line_coding_rejected_rate,
+*  line_coding_closest_rate and line_coding_reject_count, and the UART keeps
+*  its current settings.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void line_coding_task(bridge_port_t *port)
+{
+    uint32_t changed;
+#if (SNIFFER_MODE != 0u)
+    uint32_t index;
+#endif
+
+    /* The change flags are cleared on read, so both kinds are taken here */
+    changed = Cy_USB_Dev_CDC_IsLineChanged(port->hw->com_port, &usb_cdcContext);
+    if (0u != (changed & CY_USB_DEV_CDC_LINE_CONTROL_CHANGED))
+    {
+        control_line_update(port);
+    }
+    if (0u != (changed & CY_USB_DEV_CDC_LINE_CODING_CHANGED))
+    {
+#if (SNIFFER_MODE != 0u)
+        /* Both channels follow the line coding of port 0 */
+        for (index = 0u; index < BRIDGE_PORTS; index++)
+        {
+            bridge_ports[index].line_coding_changed = true;
+        }
+#else
+        port->line_coding_changed = true;
+#endif
+#if (AUTOBAUD != 0u)
+        port->autobaud_rate = 0u;
+#endif
+    }
+
+    if (!port->line_coding_pending)
+    {
+        if (!port->line_coding_changed)
+        {
+            return;
+        }
+#if (AUTOBAUD != 0u)
+        /* The line coding is applied once the rate has been detected */
+        if (AUTOBAUD_BUSY(port))
+        {
+            return;
+        }
+#endif
+        port->line_coding_changed = false;
+
+        if (!build_uart_config(port, &port->pending_uart_config, &port->pending_uart_divider, &port->pending_uart_rate))
+        {
+            port->line_coding_rejected_rate = line_coding_rate(port);
+            port->line_coding_closest_rate = port->pending_uart_rate;
+            port->line_coding_reject_count++;
+#if (AUTOBAUD != 0u)
+            port->autobaud_discard = false;
+#endif
+            return;
+        }
+
+        /* Hold off EP3 and let the queued slots drain at the old rate */
+        port->tx_quiesce = true;
+        port->line_coding_pending = true;
+    }
+
+    /* Wait for the OUT path and the UART shifter to be empty, and for a
+     * break to end */
+    if ((port->tx_ring_count != 0u) || port->tx_dma_busy || !Cy_SCB_UART_IsTxComplete(port->hw->uart.base) ||
+        port->break_active)
+    {
+        return;
+    }
+
+    if (!apply_line_coding(port))
+    {
+        /* UART RX is busy, retry on the next pass */
+        return;
+    }
+
+    port->line_coding_pending = false;
+#if (AUTOBAUD != 0u)
+    if (!autobaud_armed(PORT_INDEX(port)))
+    {
+        port->autobaud_discard = false;
+    }
+#endif
+    tx_resume(port);
+}
+
+/*******************************************************************************
+* Function Name: line_coding_rate
+********************************************************************************
+*
+* Summary:
+*  Returns the baud rate the UART of a port is set to: the detected rate, or
+*  the rate of the line coding the CDC class keeps for the port.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  uint32_t: baud rate
+*
+*******************************************************************************/
+static uint32_t line_coding_rate(const bridge_port_t *port)
+{
+#if (AUTOBAUD != 0u)
+    if (port->autobaud_rate != 0u)
+    {
+        return port->autobaud_rate;
+    }
+#endif
+
+    return Cy_USB_Dev_CDC_GetDTERate(LINE_CODING_COM_PORT(port), &usb_cdcContext);
+}
+
+/*******************************************************************************
+* Function Name: control_line_update
+********************************************************************************
+*
+* Summary:
+*  Reflects the DTR and RTS states requested by the host on the DTR and RTS
+*  pins of the port, when the BSP provides them. Both
+*  outputs are active low. With UART_FLOW_CONTROL the RTS pin is driven by
+*  the SCB and the host request is only recorded.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void control_line_update(bridge_port_t *port)
+{
+    port->line_control_state = Cy_USB_Dev_CDC_GetLineControl(port->hw->com_port, &usb_cdcContext);
+
+    if (NULL != port->hw->dtr_port)
+    {
+        Cy_GPIO_Write(port->hw->dtr_port, port->hw->dtr_pin,
+                      (0u != (port->line_control_state & CY_USB_DEV_CDC_LINE_CONTROL_DTR)) ? 0u : 1u);
+    }
+
+    if (NULL != port->hw->rts_port)
+    {
+        Cy_GPIO_Write(port->hw->rts_port, port->hw->rts_pin,
+                      (0u != (port->line_control_state & CY_USB_DEV_CDC_LINE_CONTROL_RTS)) ? 0u : 1u);
+    }
+}
+
+/*******************************************************************************
+* Function Name: send_break_task
+********************************************************************************
+*
+* Summary:
+*  Sends the break requested with CDC SEND_BREAK. EP3 is held off and the
+*  slots already in tx_ring are sent first, then the UART TX pin is switched
+*  from the SCB to a GPIO driven low. The break ends after the requested
+*  length, or on a request of length 0 if the host asked for a break until
+*  stopped. A new request during a break restarts it with the new length. In
+*  RS-485 mode the driver is enabled for the break.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void send_break_task(bridge_port_t *port)
+{
+    uint32_t int_state;
+    uint32_t length_ms;
+
+    if (port->break_requested)
+    {
+        int_state = Cy_SysLib_EnterCriticalSection();
+        length_ms = port->break_request_ms;
+        port->break_requested = false;
+        Cy_SysLib_ExitCriticalSection(int_state);
+
+        if (length_ms == 0u)
+        {
+            /* End the break, or drop it if it has not started yet */
+            if (port->break_active)
+            {
+                break_end(port);
+            }
+            port->break_pending = false;
+            tx_resume(port);
+            return;
+        }
+
+        port->break_ticks = (length_ms == CDC_BREAK_UNTIL_STOPPED) ? 0u :
+                      (((length_ms * 1000u) + TICK_PERIOD_US - 1u) / TICK_PERIOD_US);
+        port->break_start_tick = tick_count;
+        if (!port->break_active)
+        {
+            /* Hold off EP3 and let the queued slots drain */
+            port->tx_quiesce = true;
+            port->break_pending = true;
+        }
+    }
+
+    if (port->break_pending)
+    {
+        /* Wait for the OUT path and the UART shifter to be empty, and for a
+         * line coding change to be applied */
+        if ((port->tx_ring_count != 0u) || port->tx_dma_busy || !Cy_SCB_UART_IsTxComplete(port->hw->uart.base) ||
+            port->line_coding_pending)
+        {
+            return;
+        }
+
+        int_state = Cy_SysLib_EnterCriticalSection();
+#if (UART_RS485 != 0u)
+        rs485_drive(port, 0u);
+#endif
+        Cy_GPIO_Clr(port->hw->tx_port, port->hw->tx_pin);
+        Cy_GPIO_SetHSIOM(port->hw->tx_port, port->hw->tx_pin, HSIOM_SEL_GPIO);
+        port->break_active = true;
+        Cy_SysLib_ExitCriticalSection(int_state);
+
+        port->break_pending = false;
+        port->break_start_tick = tick_count;
+        stats_break_sent();
+        trace_event(TRACE_LINE_BREAK, 1u, 0u);
+    }
+    else if (port->break_active && (port->break_ticks != 0u) &&
+             ((tick_count - port->break_start_tick) >= port->break_ticks))
+    {
+        break_end(port);
+        tx_resume(port);
+    }
+}
+
+/*******************************************************************************
+* Function Name: break_end
+********************************************************************************
+*
+* Summary:
+*  Ends a break by handing the UART TX pin back to the SCB, which holds it at
+*  the idle level. In RS-485 mode the driver is released.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void break_end(bridge_port_t *port)
+{
+    uint32_t int_state;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    Cy_GPIO_SetHSIOM(port->hw->tx_port, port->hw->tx_pin, port->hw->tx_hsiom);
+#if (UART_RS485 != 0u)
+    rs485_release(port);
+#endif
+    port->break_active = false;
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    trace_event(TRACE_LINE_BREAK, 0u, 0u);
+}
+
+/*******************************************************************************
+* Function Name: tx_resume
+********************************************************************************
+*
+* Summary:
+*  Resumes USB Endpoint 3 once neither a line coding change, a break nor the
+*  baud-rate detection benchmark holds off the OUT path.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void tx_resume(bridge_port_t *port)
+{
+    uint32_t int_state;
+
+    if (port->line_coding_pending || port->break_pending || port->break_active)
+    {
+        return;
+    }
+#if (AUTOBAUD != 0u)
+    if (port->autobaud_bench_step != AUTOBAUD_BENCH_IDLE)
+    {
+        return;
+    }
+#endif
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    port->tx_quiesce = false;
+    out_resume(port);
+    Cy_SysLib_ExitCriticalSection(int_state);
+}
+
+#if (AUTOBAUD != 0u)
+/*******************************************************************************
+* Function Name: autobaud_task
+********************************************************************************
+*
+* Summary:
+*  Starts and cancels baud-rate detections and the loopback benchmark on
+*  request. A detected rate replaces the baud rate of the host's line coding
+*  until the host sets one again. It is reported to the host through
+*  GET_LINE_CODING, and applied by line_coding_task like a change from the
+*  host, with the data bits, parity and stop bits the host has set. Any
+*  request ends a running benchmark.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void autobaud_task(bridge_port_t *port)
+{
+    uint32_t index = PORT_INDEX(port);
+    uint32_t mode;
+    uint32_t rate;
+
+    if (autobaud_take_request(index, &mode))
+    {
+        if (port->autobaud_bench_step != AUTOBAUD_BENCH_IDLE)
+        {
+            autobaud_disarm(index);
+            autobaud_bench_end();
+            port->autobaud_bench_step = AUTOBAUD_BENCH_IDLE;
+            port->line_coding_changed = true;
+        }
+
+        if (mode == AUTOBAUD_DETECT)
+        {
+            autobaud_start(port);
+        }
+        else if ((mode == AUTOBAUD_BENCH) && !port->selftest_owns_tx)
+        {
+            autobaud_disarm(index);
+            autobaud_bench_begin();
+            port->autobaud_discard = true;
+            port->autobaud_bench_step = 0u;
+            port->autobaud_bench_sent = false;
+            port->tx_quiesce = true;
+        }
+        else
+        {
+            autobaud_disarm(index);
+            if (!port->line_coding_changed && !port->line_coding_pending)
+            {
+                port->autobaud_discard = false;
+            }
+        }
+    }
+
+    if (port->autobaud_bench_step != AUTOBAUD_BENCH_IDLE)
+    {
+        autobaud_bench_task(port);
+    }
+    else if (autobaud_take_result(index, &rate))
+    {
+        port->autobaud_rate = rate;
+        line_coding_report_rate(port, rate);
+        port->line_coding_changed = true;
+    }
+}
+
+/*******************************************************************************
+* Function Name: autobaud_start
+********************************************************************************
+*
+* Summary:
+*  Waits for the next character on UART RX to detect its rate. The UART keeps
+*  running at the old rate, and what it receives is dropped.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void autobaud_start(bridge_port_t *port)
+{
+    port->autobaud_discard = true;
+    autobaud_arm(PORT_INDEX(port), port->hw->rx_port, port->hw->rx_pin);
+}
+
+/*******************************************************************************
+* Function Name: autobaud_bench_task
+********************************************************************************
+*
+* Summary:
+*  Runs the loopback benchmark of the detection on port 0, with UART TX wired
+*  to RX. EP3 is held off and the slots already in tx_ring are sent. Then, for
+*  each standard rate, the UART is set to the rate and sends
+*  AUTOBAUD_SYNC_CHAR, and the detection times it on UART RX. The host's line
+*  coding is applied again at the end.
+*
+* Parameters:
+*  port: bridge port 0
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void autobaud_bench_task(bridge_port_t *port)
+{
+    uint32_t rate = autobaud_bench_rate(port->autobaud_bench_step);
+    uint32_t oversample = 0u;
+    uint32_t detected;
+
+    if (!port->autobaud_bench_sent)
+    {
+        if (rate == 0u)
+        {
+            autobaud_bench_end();
+            port->autobaud_bench_step = AUTOBAUD_BENCH_IDLE;
+            port->line_coding_changed = true;
+            return;
+        }
+
+        /* Wait for the OUT path and the UART shifter to be empty */
+        if ((port->tx_ring_count != 0u) || port->tx_dma_busy || !Cy_SCB_UART_IsTxComplete(port->hw->uart.base) ||
+            port->line_coding_pending || port->break_active)
+        {
+            return;
+        }
+
+        port->pending_uart_config = port->uart_config;
+        if (!calc_uart_clock(rate, &port->pending_uart_divider, &oversample, &port->pending_uart_rate))
+        {
+            /* The UART clock cannot produce the rate */
+            autobaud_bench_record(port->autobaud_bench_step, rate, 0u, 0u, 0u);
+            port->autobaud_bench_step++;
+            return;
+        }
+        port->pending_uart_config.oversample = oversample;
+        if (!apply_line_coding(port))
+        {
+            return;
+        }
+
+        autobaud_arm(PORT_INDEX(port), port->hw->rx_port, port->hw->rx_pin);
+        port->autobaud_bench_sent = true;
+        port->autobaud_bench_tick = tick_count;
+        port->autobaud_bench_start = stats_now();
+        (void) Cy_SCB_UART_Put(port->hw->uart.base, AUTOBAUD_SYNC_CHAR);
+        return;
+    }
+
+    if (!autobaud_take_result(PORT_INDEX(port), &detected))
+    {
+        if ((tick_count - port->autobaud_bench_tick) < AUTOBAUD_BENCH_TIMEOUT_TICKS)
+        {
+            return;
+        }
+        autobaud_disarm(PORT_INDEX(port));
+        detected = 0u;
+    }
+
+    autobaud_bench_record(port->autobaud_bench_step, rate, port->uart_baud_rate, detected,
+                          port->autobaud_bench_start);
+    port->autobaud_bench_step++;
+    port->autobaud_bench_sent = false;
+}
+
+/*******************************************************************************
+* Function Name: line_coding_report_rate
+********************************************************************************
+*
+* Summary:
+*  Writes a detected rate into the line coding that the CDC class keeps for a
+*  port, so that GET_LINE_CODING returns the rate the UART runs at. The CDC
+*  class has no function to set the line coding, and answers GET_LINE_CODING
+*  from usb_cdcContext.linesCoding without asking cdc_request_received, so
+*  the field is written directly. It holds the 7-byte CDC line coding of each
+*  COM port, with dwDTERate first, little-endian.
+*
+* Parameters:
+*  port: bridge port
+*  rate: baud rate
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void line_coding_report_rate(const bridge_port_t *port, uint32_t rate)
+{
+    uint8_t *coding = usb_cdcContext.linesCoding[LINE_CODING_COM_PORT(port)];
+    uint32_t int_state;
+
+    /* The USB interrupt writes the line coding on SET_LINE_CODING */
+    int_state = Cy_SysLib_EnterCriticalSection();
+    coding[0] = (uint8_t) rate;
+    coding[1] = (uint8_t) (rate >> 8u);
+    coding[2] = (uint8_t) (rate >> 16u);
+    coding[3] = (uint8_t) (rate >> 24u);
+    Cy_SysLib_ExitCriticalSection(int_state);
+}
+
+/*******************************************************************************
+* Function Name: rx_edge_isr
+********************************************************************************
+*
+* Summary:
+*  Handles the GPIO interrupts of the UART RX pins: the start bits the
+*  detection times and, during USB suspend, the wake-up of port 0.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rx_edge_isr(void)
+{
+    autobaud_isr();
+#if (USB_SUSPEND_DEEP_SLEEP != 0u)
+    wakeup_isr();
+#endif
+}
+#endif /* AUTOBAUD */
+
+/*******************************************************************************
+* Function Name: cdc_request_received
+********************************************************************************
+*
+* Summary:
+*  Handles the CDC class requests that the CDC class leaves to the
+*  application. SEND_BREAK is latched for send_break_task of the port whose
+*  communication interface is in wIndex. Called by the USB device middleware
+*  from the USB interrupt.
+*
+* Parameters:
+*  transfer: control transfer of the request
+*  classContext: CDC class context
+*  devContext: USB device context
+*
+* Return:
+*  cy_en_usb_dev_status_t: CY_USB_DEV_REQUEST_NOT_HANDLED stalls the request
+*
+*******************************************************************************/
+static cy_en_usb_dev_status_t cdc_request_received(cy_stc_usb_dev_control_transfer_t *transfer, void *classContext,
+                                                   cy_stc_usb_dev_context_t *devContext)
+{
+    bridge_port_t *port;
+
+    (void) classContext;
+    (void) devContext;
+
+    if ((transfer->setup.bRequest == CDC_REQ_SEND_BREAK) &&
+        (transfer->setup.bmRequestType.direction == CY_USB_DEV_DIR_HOST_TO_DEVICE) &&
+        (transfer->setup.wLength == 0u))
+    {
+        for (port = bridge_ports; port < &bridge_ports[BRIDGE_PORTS]; port++)
+        {
+            if (port->hw->comm_interface == transfer->setup.wIndex)
+            {
+                port->break_request_ms = transfer->setup.wValue;
+                port->break_requested = true;
+                return CY_USB_DEV_SUCCESS;
+            }
+        }
+    }
+
+    return CY_USB_DEV_REQUEST_NOT_HANDLED;
+}
+
+/*******************************************************************************
+* Function Name: bridge_port_init
+********************************************************************************
+*
+* Summary:
+*  Initializes and enables the UART of a bridge port with its design.modus
+*  configuration, and configures its UART_TX_DMA and UART_RX_DMA channels.
+*
+* Parameters:
+*  port: bridge port
+*  hw: hardware of the port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void bridge_port_init(bridge_port_t *port, const bridge_port_hw_t *hw)
+{
+    cy_en_scb_uart_status_t uart_status;
+
+    port->hw = hw;
+#if (AUTOBAUD != 0u)
+    port->autobaud_bench_step = AUTOBAUD_BENCH_IDLE;
+#endif
+
+    /* Initialize and enable UART operation */
+    port->uart_config = *hw->uart_config;
+    port->uart_baud_rate = hw->baud_rate;
+    /* Framing, parity and break conditions are reported to the host */
+    port->uart_config.rxFifoIntEnableMask |= UART_RX_LINE_ERRORS;
+#if (UART_FLOW_CONTROL != 0u)
+    port->uart_config.enableCts = true;
+    port->uart_config.ctsPolarity = CY_SCB_UART_ACTIVE_LOW;
+    port->uart_config.rtsRxFifoLevel = UART_RTS_RX_FIFO_LEVEL;
+    port->uart_config.rtsPolarity = CY_SCB_UART_ACTIVE_LOW;
+#endif
+#if (UART_RS485 != 0u)
+    Cy_GPIO_Write(hw->de_port, hw->de_pin, (UART_RS485_DE_ACTIVE != 0u) ? 0u : 1u);
+#endif
+    uart_status = Cy_SCB_UART_Init(hw->uart.base, &port->uart_config, &port->uart_context);
+    if (uart_status != CY_SCB_UART_SUCCESS )
+    {
+        CY_ASSERT(0);
+    }
+    Cy_SCB_UART_Enable(hw->uart.base);
+
+    /* Configure UART_TX_DMA and UART_RX_DMA channels for operation */
+    configure_tx_dma(&hw->tx_dma, ep3_discard, (void *) &(hw->uart.base->TX_FIFO_WR));
+    configure_rx_dma(&hw->rx_dma, (void *) &(hw->uart.base->RX_FIFO_RD), port->rx_buffer_ping, port->rx_buffer_pong);
+
+    port->rx_idle_timeout_ticks = rx_idle_timeout_to_ticks(rx_idle_timeout_bits, port->uart_baud_rate);
+#if (UART_RS485 != 0u)
+    port->rs485_guard_cycles = ((UART_RS485_GUARD_BITS * Cy_SysClk_ClkSysGetFrequency()) + port->uart_baud_rate - 1u) /
+                               port->uart_baud_rate;
+#endif
+    in_coalesce_set(port, IN_COALESCE_US);
+}
+
+/*******************************************************************************
+* Function Name: build_uart_config
+********************************************************************************
+*
+* Summary:
+*  Translates the line coding stored by the CDC class, with the baud rate
+*  from line_coding_rate, into a UART configuration and clock divider.
+*
+* Parameters:
+*  port: bridge port
+*  config: returns the UART configuration
+*  divider: returns the divide ratio of the UART clock of the port
+*  actual_rate: returns the closest achievable baud rate, 0 if none
+*
+* Return:
+*  bool: true if the UART supports the requested line coding
+*
+*******************************************************************************/
+static bool build_uart_config(bridge_port_t *port, cy_stc_scb_uart_config_t *config, uint32_t *divider,
+                              uint32_t *actual_rate)
+{
+    uint32_t oversample = 0u;
+    uint32_t data_bits = Cy_USB_Dev_CDC_GetDataBits(LINE_CODING_COM_PORT(port), &usb_cdcContext);
+
+    *config = port->uart_config;
+    *actual_rate = 0u;
+
+    if (!calc_uart_clock(line_coding_rate(port), divider, &oversample, actual_rate))
+    {
+        return false;
+    }
+    config->oversample = oversample;
+
+    /* The SCB supports 5 to 8 data bits for this bridge */
+    if ((data_bits < 5u) || (data_bits > 8u))
+    {
+        return false;
+    }
+    config->dataWidth = data_bits;
+
+    switch (Cy_USB_Dev_CDC_GetCharFormat(LINE_CODING_COM_PORT(port), &usb_cdcContext))
+    {
+        case CY_USB_DEV_CDC_STOPBIT_1:
+            config->stopBits = CY_SCB_UART_STOP_BITS_1;
+            break;
+        case CY_USB_DEV_CDC_STOPBITS_1_5:
+            config->stopBits = CY_SCB_UART_STOP_BITS_1_5;
+            break;
+        case CY_USB_DEV_CDC_STOPBITS_2:
+            config->stopBits = CY_SCB_UART_STOP_BITS_2;
+            break;
+        default:
+            return false;
+    }
+
+    /* Mark and space parity are not supported by the SCB */
+    switch (Cy_USB_Dev_CDC_GetParityType(LINE_CODING_COM_PORT(port), &usb_cdcContext))
+    {
+        case CY_USB_DEV_CDC_PARITY_NONE:
+            config->parity = CY_SCB_UART_PARITY_NONE;
+            break;
+        case CY_USB_DEV_CDC_PARITY_ODD:
+            config->parity = CY_SCB_UART_PARITY_ODD;
+            break;
+        case CY_USB_DEV_CDC_PARITY_EVEN:
+            config->parity = CY_SCB_UART_PARITY_EVEN;
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: apply_line_coding
+********************************************************************************
+*
+* Summary:
+*  Reconfigures the UART with the latched line coding. UART_RX_DMA is paused
+*  while the SCB is re-initialized; its descriptors keep their position, so
+*  bytes already received stay in the ping/pong buffers and are forwarded as
+*  usual once the channel is re-enabled. UART_TX_DMA is idle at this point and
+*  is restarted by the next queued slot.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  bool: false if UART RX still had data in flight and the change was deferred
+*
+*******************************************************************************/
+static bool apply_line_coding(bridge_port_t *port)
+{
+    const uart_dma_t *rx_dma = &port->hw->rx_dma;
+    uint32_t int_state;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+
+    /* Pause UART_RX_DMA and wait for an element in flight to land */
+    Cy_DMAC_Channel_Disable(rx_dma->base, rx_dma->channel);
+    while (0u != (Cy_DMAC_GetActiveChannel(rx_dma->base) & (1UL << rx_dma->channel)))
+    {
+    }
+
+    /* Re-initialization clears the RX FIFO, so defer while it holds data */
+    if (0u != Cy_SCB_UART_GetNumInRxFifo(port->hw->uart.base))
+    {
+        if (!rx_dma_held(port))
+        {
+            Cy_DMAC_Channel_Enable(rx_dma->base, rx_dma->channel);
+        }
+        Cy_SysLib_ExitCriticalSection(int_state);
+        return false;
+    }
+
+    reconfigure_uart(&port->hw->uart, &port->pending_uart_config, port->pending_uart_divider, &port->uart_context);
+    port->uart_config = port->pending_uart_config;
+    port->uart_baud_rate = port->pending_uart_rate;
+
+    /* The idle timeout is expressed in bit-times of the new rate */
+    port->rx_idle_timeout_ticks = rx_idle_timeout_to_ticks(rx_idle_timeout_bits, port->uart_baud_rate);
+
+#if (UART_RS485 != 0u)
+    port->rs485_guard_cycles = ((UART_RS485_GUARD_BITS * Cy_SysClk_ClkSysGetFrequency()) + port->uart_baud_rate - 1u) /
+                               port->uart_baud_rate;
+
+    /* Re-initialization restored the TX interrupt mask. UART TX is complete,
+     * so release the driver if uart_isr has not done so yet. */
+    if (port->rs485_driving)
+    {
+        rs485_release(port);
+    }
+#endif
+
+    if (!rx_dma_held(port))
+    {
+        Cy_DMAC_Channel_Enable(rx_dma->base, rx_dma->channel);
+    }
+
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: dma_response_is_fatal
+********************************************************************************
+*
+* Summary:
+*  Tells whether a DMA descriptor response indicates a bus, alignment or
+*  descriptor fetch error. These can only be caused by corrupted descriptors
+*  or memory, so the bridge does not try to recover from them.
+*
+* Parameters:
+*  response: descriptor response returned by Cy_DMAC_Descriptor_GetResponse
+*
+* Return:
+*  bool: true if the error is unrecoverable
+*
+*******************************************************************************/
+static bool dma_response_is_fatal(cy_en_dmac_response_t response)
+{
+    return ((response == CY_DMAC_SRC_BUS_ERROR) || (response == CY_DMAC_DST_BUS_ERROR) ||
+            (response == CY_DMAC_SRC_MISAL) || (response == CY_DMAC_DST_MISAL) ||
+            (response == CY_DMAC_CURR_PTR_NULL) || (response == CY_DMAC_DESCR_BUS_ERROR));
+}
+
+/*******************************************************************************
+* Function Name: recover_errors
+********************************************************************************
+*
+* Summary:
+*  Recovers from the error flags raised by the DMA and UART handlers on every
+*  port, per fault class:
+*  - RX FIFO overflow: the bytes are already lost and UART_RX_DMA is still in
+*    step with the FIFO, so the event is only counted.
+*  - RX FIFO underflow or a bad UART_RX_DMA response: the RX FIFO is flushed and
+*    UART_RX_DMA is re-initialized through configure_rx_dma.
+*  - TX FIFO overflow or a bad UART_TX_DMA response: the TX FIFO is flushed,
+*    tx_ring is emptied, UART_TX_DMA is re-initialized through configure_tx_dma
+*    and EP3 is re-armed.
+*  - EP3 read failure: dma_work_isr drops the packet and re-arms EP3, the event is counted.
+*  - EP2 load failure or rx_queue overrun: the RX bytes were dropped, the event is counted.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void recover_errors(void)
+{
+    bridge_port_t *port;
+    uint32_t int_state;
+    bool rx_reset;
+    bool tx_reset;
+    bool ep3_error;
+    bool overflow;
+
+    for (port = bridge_ports; port < &bridge_ports[BRIDGE_PORTS]; port++)
+    {
+        int_state = Cy_SysLib_EnterCriticalSection();
+
+        rx_reset = port->uart_rx_underflow || port->rx_dma_error;
+        tx_reset = port->uart_tx_overflow || port->tx_dma_error;
+        ep3_error = port->ep3_read_error;
+        overflow = port->uart_rx_overflow || port->ep2_load_error || port->rx_queue_overrun;
+
+        if (port->uart_rx_overflow)
+        {
+            fault_count.uart_rx_overflow++;
+        }
+        if (port->ep2_load_error)
+        {
+            fault_count.ep2_load_error++;
+        }
+        if (port->rx_queue_overrun)
+        {
+            fault_count.rx_queue_overrun++;
+        }
+
+        port->uart_rx_overflow = false;
+        port->uart_rx_underflow = false;
+        port->uart_tx_overflow = false;
+        port->tx_dma_error = false;
+        port->rx_dma_error = false;
+        port->ep2_load_error = false;
+        port->ep3_read_error = false;
+        port->rx_queue_overrun = false;
+
+        /* Only the ports that raised a flag are recovered */
+        if (!rx_reset && !tx_reset && !ep3_error && !overflow)
+        {
+            Cy_SysLib_ExitCriticalSection(int_state);
+            continue;
+        }
+
+        trace_event(TRACE_RECOVER, (rx_reset ? 1u : 0u) | (tx_reset ? 2u : 0u), 0u);
+
+        if (rx_reset)
+        {
+            recover_rx_path(port);
+            fault_count.rx_path_reset++;
+        }
+
+        if (tx_reset)
+        {
+            /* Also re-arms EP3 */
+            recover_tx_path(port);
+            fault_count.tx_path_reset++;
+        }
+
+        /* dma_work_isr has already dropped the failed packet and re-armed EP3 */
+        if (ep3_error)
+        {
+            fault_count.ep3_read_error++;
+        }
+
+        Cy_SysLib_ExitCriticalSection(int_state);
+    }
+}
+
+/*******************************************************************************
+* Function Name: recover_rx_path
+********************************************************************************
+*
+* Summary:
+*  Flushes the UART RX FIFO and restarts UART_RX_DMA on the ping buffer. Bytes
+*  not yet sent to the host are dropped. Must be called with interrupts masked.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void recover_rx_path(bridge_port_t *port)
+{
+    const uart_dma_t *rx_dma = &port->hw->rx_dma;
+
+    Cy_DMAC_Channel_Disable(rx_dma->base, rx_dma->channel);
+    while (0u != (Cy_DMAC_GetActiveChannel(rx_dma->base) & (1UL << rx_dma->channel)))
+    {
+    }
+
+    Cy_SCB_UART_ClearRxFifo(port->hw->uart.base);
+
+    port->rx_flush_offset[CY_DMAC_DESCRIPTOR_PING] = 0u;
+    port->rx_flush_offset[CY_DMAC_DESCRIPTOR_PONG] = 0u;
+
+    /* The bytes dropped here are never forwarded. A pending line event
+     * follows the bytes forwarded so far. */
+    port->rx_forwarded_bytes = port->rx_descr_done_count * PING_PONG_BUF_SIZE;
+    if ((int32_t) (port->line_event_position - port->rx_forwarded_bytes) > 0)
+    {
+        port->line_event_position = port->rx_forwarded_bytes;
+    }
+#if (UART_RS485 != 0u)
+    /* Echo bytes may have been lost with the FIFO. Passing a late echo on to
+     * the host is safer than dropping a reply. */
+    port->rs485_echo_pending = 0u;
+#endif
+
+    /* Drop completions of the old descriptors that have not been handled yet */
+    Cy_DMAC_ClearInterrupt(DMAC, (1UL << rx_dma->channel));
+    port->rx_done_tail = port->rx_done_head;
+    work_cancel(WORK_RX, PORT_INDEX(port));
+
+    configure_rx_dma(rx_dma, (void *) &(port->hw->uart.base->RX_FIFO_RD), port->rx_buffer_ping,
+                     port->rx_buffer_pong);
+
+    /* rx_queue keeps its data, so a throttled peer stays throttled */
+    if (rx_dma_held(port))
+    {
+        Cy_DMAC_Channel_Disable(rx_dma->base, rx_dma->channel);
+    }
+}
+
+/*******************************************************************************
+* Function Name: recover_tx_path
+********************************************************************************
+*
+* Summary:
+*  Flushes the UART TX FIFO, empties tx_ring, re-initializes UART_TX_DMA and
+*  re-arms EP3. Queued OUT packets are dropped. Must be called with interrupts
+*  masked.
+*
+* Parameters:
+*  port: bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void recover_tx_path(bridge_port_t *port)
+{
+    const uart_dma_t *tx_dma = &port->hw->tx_dma;
+    uint32_t slot;
+
+    Cy_DMAC_Channel_Disable(tx_dma->base, tx_dma->channel);
+    while (0u != (Cy_DMAC_GetActiveChannel(tx_dma->base) & (1UL << tx_dma->channel)))
+    {
+    }
+
+    Cy_SCB_UART_ClearTxFifo(port->hw->uart.base);
+
+    for (slot = 0u; slot < OUT_RING_SLOTS; slot++)
+    {
+        tx_ring_release(port, slot);
+    }
+    port->tx_ring_head = 0u;
+    port->tx_ring_tail = 0u;
+    port->tx_ring_count = 0u;
+    port->tx_dma_busy = false;
+#if (OUT_DMA_CHAIN != 0u)
+    port->tx_dma_chained = false;
+#endif
+#if (FRAME_MODE != FRAME_MODE_NONE)
+    frame_reset_encoder(&port->frame_encoder);
+#endif
+#if (UART_RS485 != 0u)
+    /* Nothing is left to send, so hand the bus back. The echo of the
+     * flushed bytes will not come. */
+    rs485_release(port);
+    port->rs485_echo_pending = 0u;
+#endif
+
+    /* Drop a completion of the old descriptor that has not been handled yet */
+    Cy_DMAC_ClearInterrupt(DMAC, (1UL << tx_dma->channel));
+    work_cancel(WORK_TX_DONE, PORT_INDEX(port));
+
+    /* start_tx_slot sets the source of every slot */
+    configure_tx_dma(tx_dma, ep3_discard, (void *) &(port->hw->uart.base->TX_FIFO_WR));
+
+    /* Re-arm EP3 unless a line coding change holds it off, and let the
+     * ports waiting for a pool block have the ones just released */
+    port->ep3_out_paused = true;
+    out_resume(port);
+    out_pool_retry();
+
+    /* Let dma_work_isr refill the ring if a self-test runs */
+    work_post(WORK_IN, PORT_INDEX(port));
+}
+
+/*******************************************************************************
+* Function Name: uart_isr
+********************************************************************************
+*
+* Summary:
+* Flags Rx Overflow, Rx Underflow, and Tx Overflow conditions for recovery in
+* the main loop. Rx Overflow and the framing, parity and break conditions are
+* recorded for a SERIAL_STATE notification that follows the bytes received
+* so far. USB Endpoint 3 (out) is re-enabled from dma_work_isr as tx_ring
+* slots free up. Tx Done is only enabled in RS-485 mode, to release the
+* driver at the end of a transmission.
+*
+* Parameters:
+*  port: bridge port whose SCB raised the interrupt
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void uart_isr(bridge_port_t *port)
+{
+    uint32_t isr_start = stats_isr_start(STATS_ISR_UART);
+    uint32_t state = 0u;
+
+    /* Get RX and TX interrupt sources */
+    uint32_t rx_intr_src =  Cy_SCB_UART_GetRxFifoStatus(port->hw->uart.base);
+    uint32_t tx_intr_src = Cy_SCB_UART_GetTxFifoStatus(port->hw->uart.base);
+
+#if (UART_RS485 != 0u)
+    if (port->rs485_driving)
+    {
+        rs485_tx_done(port, isr_start);
+    }
+#endif
+
+    if (rx_intr_src & CY_SCB_UART_RX_OVERFLOW)
+    {
+        port->uart_rx_overflow = true;
+        fault_pending = true;
+        trace_event(TRACE_FAULT, TRACE_FAULT_UART_RX_OVERFLOW, 0u);
+        stats_rx_fifo_overflow();
+    }
+    if (rx_intr_src & CY_SCB_UART_RX_UNDERFLOW)
+    {
+        port->uart_rx_underflow = true;
+        fault_pending = true;
+        trace_event(TRACE_FAULT, TRACE_FAULT_UART_RX_UNDERFLOW, 0u);
+    }
+    if (tx_intr_src & CY_SCB_UART_TX_OVERFLOW)
+    {
+        port->uart_tx_overflow = true;
+        fault_pending = true;
+        trace_event(TRACE_FAULT, TRACE_FAULT_UART_TX_OVERFLOW, 0u);
+    }
+
+    /* A break also ends with a framing error, which is not reported */
+    if (0u != (rx_intr_src & CY_SCB_UART_RX_BREAK_DETECT))
+    {
+        state |= SERIAL_STATE_BREAK;
+    }
+    else if (0u != (rx_intr_src & CY_SCB_UART_RX_ERR_FRAME))
+    {
+        state |= SERIAL_STATE_FRAMING;
+    }
+    if (0u != (rx_intr_src & CY_SCB_UART_RX_ERR_PARITY))
+    {
+        state |= SERIAL_STATE_PARITY;
+    }
+#if (UART_RS485 != 0u) && (UART_RS485_ECHO != 0u)
+    /* The echo of our own break is not an event on the bus */
+    if (port->break_active)
+    {
+        state = 0u;
+    }
+#endif
+#if (AUTOBAUD != 0u)
+    /* Characters at an unknown rate are expected to be malformed */
+    if (port->autobaud_discard)
+    {
+        state = 0u;
+    }
+#endif
+    if (state != 0u)
+    {
+        stats_rx_line_error(rx_intr_src);
+    }
+    if (0u != (rx_intr_src & CY_SCB_UART_RX_OVERFLOW))
+    {
+        state |= SERIAL_STATE_OVERRUN;
+    }
+    if (state != 0u)
+    {
+        line_event(port, state, rx_received_bytes(port));
+    }
+
+    Cy_SCB_UART_ClearRxFifoStatus(port->hw->uart.base, rx_intr_src);
+    Cy_SCB_UART_ClearTxFifoStatus(port->hw->uart.base, tx_intr_src);
+
+    stats_isr_done(STATS_ISR_UART, isr_start);
+}
+
+/*******************************************************************************
+* Function Name: uart0_isr
+********************************************************************************
+*
+* Summary:
+*  Interrupt handler of the SCB of port 0.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void uart0_isr(void)
+{
+    uart_isr(&bridge_ports[0]);
+}
+
+#if (BRIDGE_PORTS > 1u)
+/*******************************************************************************
+* Function Name: uart1_isr
+********************************************************************************
+*
+* Summary:
+*  Interrupt handler of the SCB of port 1.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void uart1_isr(void)
+{
+    uart_isr(&bridge_ports[1]);
+}
+#endif
+
+
+/***************************************************************************
+ * Function Name: usb_high_isr
+ ********************************************************************************
+ * Summary:
+ *  This function processes the high priority USB interrupts.
+ *
+ ***************************************************************************/
+static void usb_high_isr(void)
+{
+    uint32_t isr_start = stats_isr_start(STATS_ISR_USB_HIGH);
+
+    /* Call interrupt processing */
+    Cy_USBFS_Dev_Drv_Interrupt(CYBSP_USB_HW, Cy_USBFS_Dev_Drv_GetInterruptCauseHi(CYBSP_USB_HW), &usb_drvContext);
+
+    stats_isr_done(STATS_ISR_USB_HIGH, isr_start);
+}
+
+/***************************************************************************
+ * Function Name: usb_medium_isr
+ ********************************************************************************
+ * Summary:
+ *  This function processes the medium priority USB interrupts.
+ *
+ ***************************************************************************/
 static void usb_medium_isr(void)
 {
+    uint32_t isr_start = stats_isr_start(STATS_ISR_USB_MEDIUM);
+
     /* Call interrupt processing */
     Cy_USBFS_Dev_Drv_Interrupt(CYBSP_USB_HW, Cy_USBFS_Dev_Drv_GetInterruptCauseMed(CYBSP_USB_HW), &usb_drvContext);
+
+    stats_isr_done(STATS_ISR_USB_MEDIUM, isr_start);
 }
 
 /***************************************************************************
@@ -455,15 +4617,20 @@ static void usb_medium_isr(void)
  **************************************************************************/
 static void usb_low_isr(void)
 {
+    uint32_t isr_start = stats_isr_start(STATS_ISR_USB_LOW);
+
     /* Call interrupt processing */
     Cy_USBFS_Dev_Drv_Interrupt(CYBSP_USB_HW, Cy_USBFS_Dev_Drv_GetInterruptCauseLo(CYBSP_USB_HW), &usb_drvContext);
+
+    stats_isr_done(STATS_ISR_USB_LOW, isr_start);
 }
 
 /*******************************************************************************
 * Function Name: handle_error
 ********************************************************************************
 * Summary:
-* User defined error handling function
+* Handles unrecoverable errors: initialization failures and DMA bus errors.
+* Recoverable errors are handled by recover_errors() instead.
 *
 * Parameters:
 *  void
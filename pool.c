@@ -0,0 +1,229 @@
+/******************************************************************************
+* File Name: pool.c
+*
+* Description: This file contains the fixed-block buffer pool shared by the OUT
+*              and IN data paths, with a quota per direction
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "pool.h"
+#include "stats.h"
+
+
+/*******************************************************************************
+*            Enumerated Types and Structures
+*******************************************************************************/
+/* A block. A free block holds the next free one, so the free list costs no
+ * memory. The pointer member also word-aligns the data for usb_ep_memcpy. */
+typedef union pool_block
+{
+    union pool_block *next;
+    uint8_t data[POOL_BLOCK_SIZE];
+} pool_block_t;
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+static pool_block_t pool_blocks[POOL_BLOCKS];
+
+static const uint32_t pool_quota[POOL_DIRS] = { POOL_OUT_QUOTA, POOL_IN_QUOTA };
+
+/* Free blocks and the number of blocks held per direction. The Cortex-M0 has
+ * no exclusive load and store, so pool_get and pool_put mask interrupts for
+ * the few instructions that update them. */
+static pool_block_t *pool_free_list;
+static uint32_t pool_free_count;
+static uint32_t pool_used[POOL_DIRS];
+
+/* Set when a direction was refused a block, see pool_take_starved */
+static volatile bool pool_starved[POOL_DIRS];
+
+
+/*******************************************************************************
+* Function Name: pool_init
+********************************************************************************
+*
+* Summary:
+*  Puts all blocks on the free list. Must be called before the data paths
+*  start.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void pool_init(void)
+{
+    uint32_t index;
+
+    pool_free_list = NULL;
+    for (index = POOL_BLOCKS; index > 0u; index--)
+    {
+        pool_blocks[index - 1u].next = pool_free_list;
+        pool_free_list = &pool_blocks[index - 1u];
+    }
+    pool_free_count = POOL_BLOCKS;
+
+    for (index = 0u; index < (uint32_t) POOL_DIRS; index++)
+    {
+        pool_used[index] = 0u;
+        pool_starved[index] = false;
+    }
+}
+
+/*******************************************************************************
+* Function Name: pool_get
+********************************************************************************
+*
+* Summary:
+*  Takes a block for a direction. Can be called from any interrupt priority
+*  and from the main loop.
+*
+* Parameters:
+*  dir: direction the block is used for
+*
+* Return:
+*  uint8_t *: POOL_BLOCK_SIZE bytes, or NULL if the pool is empty or the
+*  direction holds its quota
+*
+*******************************************************************************/
+uint8_t *pool_get(pool_dir_t dir)
+{
+    pool_block_t *block = NULL;
+    uint32_t int_state;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    if ((pool_free_list != NULL) && (pool_used[dir] < pool_quota[dir]))
+    {
+        block = pool_free_list;
+        pool_free_list = block->next;
+        pool_free_count--;
+        pool_used[dir]++;
+        stats_pool_level(dir, pool_used[dir]);
+    }
+    else
+    {
+        pool_starved[dir] = true;
+        stats_pool_denied(dir);
+    }
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    return (block != NULL) ? block->data : NULL;
+}
+
+/*******************************************************************************
+* Function Name: pool_put
+********************************************************************************
+*
+* Summary:
+*  Returns a block taken by pool_get. Can be called from any interrupt
+*  priority and from the main loop.
+*
+* Parameters:
+*  dir: direction the block was taken for
+*  block: the block
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void pool_put(pool_dir_t dir, uint8_t *block)
+{
+    pool_block_t *free_block = (pool_block_t *) (void *) block;
+    uint32_t int_state;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    free_block->next = pool_free_list;
+    pool_free_list = free_block;
+    pool_free_count++;
+    pool_used[dir]--;
+    stats_pool_level(dir, pool_used[dir]);
+    Cy_SysLib_ExitCriticalSection(int_state);
+}
+
+/*******************************************************************************
+* Function Name: pool_available
+********************************************************************************
+*
+* Summary:
+*  Returns the number of blocks a direction could take now. Only stays valid
+*  while nothing else takes blocks, so the caller must run in dma_work_isr or
+*  with interrupts masked.
+*
+* Parameters:
+*  dir: direction
+*
+* Return:
+*  uint32_t: free blocks within the quota of the direction
+*
+*******************************************************************************/
+uint32_t pool_available(pool_dir_t dir)
+{
+    uint32_t within_quota = pool_quota[dir] - pool_used[dir];
+
+    return (within_quota < pool_free_count) ? within_quota : pool_free_count;
+}
+
+/*******************************************************************************
+* Function Name: pool_take_starved
+********************************************************************************
+*
+* Summary:
+*  Returns and clears whether a direction was refused a block since the last
+*  call, so that the waiting path can be retried once blocks have come back.
+*
+* Parameters:
+*  dir: direction
+*
+* Return:
+*  bool: true if pool_get failed for the direction
+*
+*******************************************************************************/
+bool pool_take_starved(pool_dir_t dir)
+{
+    bool starved;
+    uint32_t int_state;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    starved = pool_starved[dir];
+    pool_starved[dir] = false;
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    return starved;
+}
@@ -0,0 +1,69 @@
+/******************************************************************************
+* File Name: pool.h
+*
+* Description: This file contains the interface of the fixed-block buffer pool
+*              that tx_ring and rx_queue draw their memory from
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Direction a block is taken for. Each one is limited by its quota. */
+typedef enum
+{
+    POOL_OUT,               /* tx_ring slots, POOL_OUT_QUOTA */
+    POOL_IN,                /* rx_queue pages, POOL_IN_QUOTA */
+    POOL_DIRS
+} pool_dir_t;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void pool_init(void);
+uint8_t *pool_get(pool_dir_t dir);
+void pool_put(pool_dir_t dir, uint8_t *block);
+uint32_t pool_available(pool_dir_t dir);
+bool pool_take_starved(pool_dir_t dir);
+
+
+#endif /* POOL_H_ */
@@ -0,0 +1,396 @@
+/******************************************************************************
+* File Name: rx_queue.c
+*
+* Description: This file contains the elastic byte queue that buffers UART RX
+*              data between UART_RX_DMA and the USB IN endpoint
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "rx_queue.h"
+#include "pool.h"
+
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Page holding the byte at a read or write counter */
+#define RX_QUEUE_PAGE(counter)      (((counter) / POOL_BLOCK_SIZE) % RX_QUEUE_PAGES)
+
+/* Offset of that byte in its page */
+#define RX_QUEUE_OFFSET(counter)    ((counter) % POOL_BLOCK_SIZE)
+
+
+/*******************************************************************************
+*            Function Prototypes
+*******************************************************************************/
+static void rx_queue_release(rx_queue_t *queue, uint32_t page);
+
+
+/*******************************************************************************
+* Function Name: rx_queue_put
+********************************************************************************
+*
+* Summary:
+* Appends bytes to the queue, taking pool blocks for the pages it fills. The
+* caller must serialize access to the queue.
+*
+* Parameters:
+*  queue: queue to append to
+*  data: bytes to append
+*  length: number of bytes to append
+*
+* Return:
+*  uint32_t: number of bytes appended, less than length if the queue is full
+*  or the pool has no block left for the IN path
+*
+*******************************************************************************/
+uint32_t rx_queue_put(rx_queue_t *queue, const uint8_t *data, uint32_t length)
+{
+    uint32_t free_space = RX_QUEUE_SIZE - (queue->write - queue->read);
+    uint32_t index;
+    uint8_t **page;
+
+    if (length > free_space)
+    {
+        length = free_space;
+    }
+
+    for (index = 0u; index < length; index++)
+    {
+        page = &queue->page[RX_QUEUE_PAGE(queue->write)];
+        if (*page == NULL)
+        {
+            *page = pool_get(POOL_IN);
+            if (*page == NULL)
+            {
+                break;
+            }
+        }
+        (*page)[RX_QUEUE_OFFSET(queue->write)] = data[index];
+        queue->write++;
+    }
+
+    return index;
+}
+
+
+/*******************************************************************************
+* Function Name: rx_queue_peek
+********************************************************************************
+*
+* Summary:
+* Returns the oldest bytes in the queue without removing them. At most
+* USB_EP_PACKET_SIZE bytes are returned so the result can be loaded into the
+* IN endpoint as is.
+*
+* Parameters:
+*  queue: queue to read
+*  data: returns a pointer to the oldest byte
+*
+* Return:
+*  uint32_t: number of bytes at data
+*
+*******************************************************************************/
+uint32_t rx_queue_peek(rx_queue_t *queue, uint8_t **data)
+{
+    uint32_t offset = RX_QUEUE_OFFSET(queue->read);
+    uint32_t length = queue->write - queue->read;
+    uint32_t index;
+
+    if (length > USB_EP_PACKET_SIZE)
+    {
+        length = USB_EP_PACKET_SIZE;
+    }
+
+    if (length == 0u)
+    {
+        *data = queue->packet;
+    }
+    else if (length <= (POOL_BLOCK_SIZE - offset))
+    {
+        *data = &queue->page[RX_QUEUE_PAGE(queue->read)][offset];
+    }
+    else
+    {
+        /* The packet continues on the next page */
+        for (index = 0u; index < length; index++)
+        {
+            queue->packet[index] = queue->page[RX_QUEUE_PAGE(queue->read + index)][RX_QUEUE_OFFSET(queue->read + index)];
+        }
+        *data = queue->packet;
+    }
+
+    return length;
+}
+
+
+/*******************************************************************************
+* Function Name: rx_queue_drop
+********************************************************************************
+*
+* Summary:
+* Removes the oldest bytes from the queue and returns the pages it has read
+* to the pool. The page of the next byte is kept while bytes are queued in it.
+*
+* Parameters:
+*  queue: queue to remove the bytes from
+*  length: number of bytes to remove, at most rx_queue_count()
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void rx_queue_drop(rx_queue_t *queue, uint32_t length)
+{
+    uint32_t step = POOL_BLOCK_SIZE - RX_QUEUE_OFFSET(queue->read);
+    uint32_t page_start;
+
+    while (length >= step)
+    {
+        /* Once the queue has wrapped around, the start of the page holds the
+         * newest bytes and it is kept until they have been read */
+        page_start = queue->read - RX_QUEUE_OFFSET(queue->read);
+        if ((queue->write - page_start) <= RX_QUEUE_SIZE)
+        {
+            rx_queue_release(queue, RX_QUEUE_PAGE(queue->read));
+        }
+        queue->read += step;
+        length -= step;
+        step = POOL_BLOCK_SIZE;
+    }
+    queue->read += length;
+
+    if (queue->read == queue->write)
+    {
+        rx_queue_release(queue, RX_QUEUE_PAGE(queue->read));
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: rx_queue_count
+********************************************************************************
+*
+* Summary:
+* Returns the number of bytes in the queue.
+*
+* Parameters:
+*  queue: queue to read
+*
+* Return:
+*  uint32_t: number of queued bytes
+*
+*******************************************************************************/
+uint32_t rx_queue_count(const rx_queue_t *queue)
+{
+    return queue->write - queue->read;
+}
+
+
+/*******************************************************************************
+* Function Name: rx_queue_room
+********************************************************************************
+*
+* Summary:
+* Returns the number of bytes that can be appended to the queue, limited by
+* its size and by the blocks the pool can still give to the IN path. Only
+* stays valid while nothing else takes blocks, so the caller must run in
+* dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  queue: queue to read
+*
+* Return:
+*  uint32_t: number of bytes rx_queue_put accepts at least
+*
+*******************************************************************************/
+uint32_t rx_queue_room(const rx_queue_t *queue)
+{
+    uint32_t free_space = RX_QUEUE_SIZE - (queue->write - queue->read);
+    uint32_t offset = RX_QUEUE_OFFSET(queue->write);
+    uint32_t room = pool_available(POOL_IN) * POOL_BLOCK_SIZE;
+
+    /* The page being written is filled from offset on, whether it is held
+     * already or still has to be taken */
+    if (queue->page[RX_QUEUE_PAGE(queue->write)] != NULL)
+    {
+        room += POOL_BLOCK_SIZE - offset;
+    }
+    else if (room != 0u)
+    {
+        room -= offset;
+    }
+
+    return (room < free_space) ? room : free_space;
+}
+
+
+/*******************************************************************************
+* Function Name: rx_queue_reset
+********************************************************************************
+*
+* Summary:
+* Discards the queued bytes and returns all pages to the pool.
+*
+* Parameters:
+*  queue: queue to empty
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void rx_queue_reset(rx_queue_t *queue)
+{
+    uint32_t page;
+
+    for (page = 0u; page < RX_QUEUE_PAGES; page++)
+    {
+        rx_queue_release(queue, page);
+    }
+    queue->read = 0u;
+    queue->write = 0u;
+#if (FRAME_MODE != FRAME_MODE_NONE)
+    queue->frames = 0u;
+#endif
+}
+
+
+/*******************************************************************************
+* Function Name: rx_queue_release
+********************************************************************************
+*
+* Summary:
+* Returns a page to the pool if the queue holds it.
+*
+* Parameters:
+*  queue: queue the page belongs to
+*  page: index of the page
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void rx_queue_release(rx_queue_t *queue, uint32_t page)
+{
+    if (queue->page[page] != NULL)
+    {
+        pool_put(POOL_IN, queue->page[page]);
+        queue->page[page] = NULL;
+    }
+}
+
+#if (FRAME_MODE != FRAME_MODE_NONE)
+/*******************************************************************************
+* Function Name: rx_queue_mark_frame
+********************************************************************************
+*
+* Summary:
+* Marks the end of the queued bytes as the end of a frame. The caller must
+* serialize access to the queue.
+*
+* Parameters:
+*  queue: queue to mark
+*
+* Return:
+*  bool: false if FRAME_RX_QUEUE_DEPTH frames are already queued, in which
+*  case the frame is merged with the next one
+*
+*******************************************************************************/
+bool rx_queue_mark_frame(rx_queue_t *queue)
+{
+    if (queue->frames == FRAME_RX_QUEUE_DEPTH)
+    {
+        return false;
+    }
+
+    queue->frame_end[(queue->frame_first + queue->frames) % FRAME_RX_QUEUE_DEPTH] = queue->write;
+    queue->frames++;
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: rx_queue_frame_length
+********************************************************************************
+*
+* Summary:
+* Returns the number of queued bytes up to the end of the oldest complete
+* frame.
+*
+* Parameters:
+*  queue: queue to read
+*  length: returns the number of bytes, 0 if they have all been sent and only
+*          the end of the frame is left
+*
+* Return:
+*  bool: false if no complete frame is queued
+*
+*******************************************************************************/
+bool rx_queue_frame_length(const rx_queue_t *queue, uint32_t *length)
+{
+    if (queue->frames == 0u)
+    {
+        return false;
+    }
+
+    *length = queue->frame_end[queue->frame_first] - queue->read;
+
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: rx_queue_frame_sent
+********************************************************************************
+*
+* Summary:
+* Removes the end mark of the oldest frame once its last packet has been
+* loaded into EP2.
+*
+* Parameters:
+*  queue: queue to update
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void rx_queue_frame_sent(rx_queue_t *queue)
+{
+    queue->frame_first = (queue->frame_first + 1u) % FRAME_RX_QUEUE_DEPTH;
+    queue->frames--;
+}
+#endif /* FRAME_MODE */
@@ -0,0 +1,87 @@
+/******************************************************************************
+* File Name: rx_queue.h
+*
+* Description: This file contains the interface of the elastic byte queue that
+*              buffers UART RX data while the USB IN endpoint is busy
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef RX_QUEUE_H_
+#define RX_QUEUE_H_
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Queue of one bridge port. read and write are free-running byte counters, so
+ * the position of a byte is the counter modulo RX_QUEUE_SIZE. The queue is
+ * split into RX_QUEUE_PAGES pages of POOL_BLOCK_SIZE bytes, each one a pool
+ * block taken when the first byte is written into it and returned once the
+ * last byte has been read. An IN packet that spans two pages is copied into
+ * packet, so it is always contiguous. */
+typedef struct
+{
+    uint8_t *page[RX_QUEUE_PAGES];
+    uint8_t packet[USB_EP_PACKET_SIZE];
+    uint32_t read;
+    uint32_t write;
+#if (FRAME_MODE != FRAME_MODE_NONE)
+    /* write at the end of each complete frame, oldest first */
+    uint32_t frame_end[FRAME_RX_QUEUE_DEPTH];
+    uint32_t frame_first;
+    uint32_t frames;
+#endif
+} rx_queue_t;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+uint32_t rx_queue_put(rx_queue_t *queue, const uint8_t *data, uint32_t length);
+uint32_t rx_queue_peek(rx_queue_t *queue, uint8_t **data);
+void rx_queue_drop(rx_queue_t *queue, uint32_t length);
+uint32_t rx_queue_count(const rx_queue_t *queue);
+uint32_t rx_queue_room(const rx_queue_t *queue);
+void rx_queue_reset(rx_queue_t *queue);
+#if (FRAME_MODE != FRAME_MODE_NONE)
+bool rx_queue_mark_frame(rx_queue_t *queue);
+bool rx_queue_frame_length(const rx_queue_t *queue, uint32_t *length);
+void rx_queue_frame_sent(rx_queue_t *queue);
+#endif
+
+
+#endif /* RX_QUEUE_H_ */
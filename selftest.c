@@ -0,0 +1,518 @@
+/******************************************************************************
+* File Name: selftest.c
+*
+* Description: This file contains the PRBS loopback self-test, which sends a
+*              pseudo-random sequence through UART_TX_DMA and checks it on
+*              UART_RX_DMA
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "stats.h"
+#include "selftest.h"
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Error-free bits the checker must see before it counts errors */
+#define SELFTEST_SYNC_BITS          (64u)
+
+/* Interval at which selftest_report is refreshed while the test runs */
+#define SELFTEST_REPORT_PERIOD_MS   (1000u)
+
+/* Value of selftest_pending while no request is pending */
+#define SELFTEST_NO_REQUEST         (0xFFFFFFFFu)
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+volatile selftest_report_t selftest_report;
+
+/* Copy of selftest_report handed to the USB device middleware */
+static selftest_report_t selftest_copy;
+
+/* Order requested from the USB interrupt, applied by the main loop */
+static volatile uint32_t selftest_pending = SELFTEST_NO_REQUEST;
+
+static bool selftest_active;
+static uint32_t selftest_order;
+static uint32_t selftest_tap;
+static uint32_t selftest_step;
+
+/* Last 64 bits of the sent and of the received sequence. Bits are sent LSB
+ * first, so the most recent bit is bit 63. */
+static uint64_t selftest_tx_window;
+static uint64_t selftest_rx_window;
+
+static bool selftest_locked;
+static uint32_t selftest_sync_bits;
+static uint32_t selftest_tx_bytes;
+static uint32_t selftest_rx_bytes;
+static uint32_t selftest_checked_bytes;
+static uint32_t selftest_bit_errors;
+
+/* Loop latency probe: stream offset and time of the first byte of a
+ * generated block, pending until that byte is received */
+static bool selftest_probe_pending;
+static uint32_t selftest_probe_offset;
+static uint32_t selftest_probe_time;
+static uint32_t selftest_latency_min;
+static uint32_t selftest_latency_max;
+
+static uint32_t selftest_cycles_per_us;
+static uint64_t selftest_elapsed_cycles;
+static uint32_t selftest_last_report;
+
+/* Number of set bits in a nibble */
+static const uint8_t selftest_nibble_bits[16] =
+{
+    0u, 1u, 1u, 2u, 1u, 2u, 2u, 3u, 1u, 2u, 2u, 3u, 2u, 3u, 3u, 4u
+};
+
+
+/*******************************************************************************
+* Function Name: selftest_feedback_tap
+********************************************************************************
+*
+* Summary:
+*  Returns the second feedback tap of the PRBS polynomial of an order. The
+*  polynomials are x^7 + x^6 + 1, x^15 + x^14 + 1 and x^31 + x^28 + 1.
+*
+* Parameters:
+*  order: PRBS order
+*
+* Return:
+*  uint32_t: feedback tap, 0 for an unsupported order
+*
+*******************************************************************************/
+static uint32_t selftest_feedback_tap(uint32_t order)
+{
+    uint32_t tap = 0u;
+
+    switch (order)
+    {
+        case 7u:
+            tap = 6u;
+            break;
+
+        case 15u:
+            tap = 14u;
+            break;
+
+        case 31u:
+            tap = 28u;
+            break;
+
+        default:
+            break;
+    }
+
+    return tap;
+}
+
+/*******************************************************************************
+* Function Name: selftest_update_report
+********************************************************************************
+*
+* Summary:
+*  Copies the counters of the running test into selftest_report.
+*
+* Parameters:
+*  now: current stats_now() time
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void selftest_update_report(uint32_t now)
+{
+    uint32_t int_state;
+    uint32_t rx_bytes;
+    uint32_t latency_min;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    selftest_elapsed_cycles += now - selftest_last_report;
+    selftest_last_report = now;
+    rx_bytes = selftest_rx_bytes;
+    latency_min = selftest_latency_min;
+    selftest_report.tx_bytes = selftest_tx_bytes;
+    selftest_report.rx_bytes = rx_bytes;
+    selftest_report.locked = selftest_locked ? 1u : 0u;
+    selftest_report.checked_bytes = selftest_checked_bytes;
+    selftest_report.bit_errors = selftest_bit_errors;
+    selftest_report.latency_max_us = selftest_latency_max / selftest_cycles_per_us;
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    selftest_report.elapsed_ms = (uint32_t) (selftest_elapsed_cycles / (1000u * selftest_cycles_per_us));
+    selftest_report.bytes_per_s = (selftest_elapsed_cycles == 0u) ? 0u :
+        (uint32_t) (((uint64_t) rx_bytes * 1000000u * selftest_cycles_per_us) / selftest_elapsed_cycles);
+    selftest_report.latency_min_us = (latency_min == 0xFFFFFFFFu) ? 0u : (latency_min / selftest_cycles_per_us);
+}
+
+/*******************************************************************************
+* Function Name: selftest_init
+********************************************************************************
+*
+* Summary:
+*  Initializes the self-test. Must be called after the SysTick time base has
+*  been started.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void selftest_init(void)
+{
+    selftest_cycles_per_us = Cy_SysClk_ClkSysGetFrequency() / 1000000u;
+}
+
+/*******************************************************************************
+* Function Name: selftest_request
+********************************************************************************
+*
+* Summary:
+*  Requests the main loop to start a self-test, or to stop the running one.
+*  Called from the USB interrupt.
+*
+* Parameters:
+*  order: PRBS order 7, 15 or 31, or 0 to stop
+*
+* Return:
+*  bool: false if the order is not supported
+*
+*******************************************************************************/
+bool selftest_request(uint32_t order)
+{
+    if ((order != 0u) && (selftest_feedback_tap(order) == 0u))
+    {
+        return false;
+    }
+
+    selftest_pending = order;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: selftest_take_request
+********************************************************************************
+*
+* Summary:
+*  Returns and clears the pending start or stop request.
+*
+* Parameters:
+*  order: returns the requested PRBS order, 0 to stop
+*
+* Return:
+*  bool: true if a request was pending
+*
+*******************************************************************************/
+bool selftest_take_request(uint32_t *order)
+{
+    uint32_t int_state;
+
+    if (selftest_pending == SELFTEST_NO_REQUEST)
+    {
+        return false;
+    }
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    *order = selftest_pending;
+    selftest_pending = SELFTEST_NO_REQUEST;
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: selftest_start
+********************************************************************************
+*
+* Summary:
+*  Clears all results and starts generating and checking a PRBS sequence.
+*  Must be called with interrupts masked.
+*
+* Parameters:
+*  order: PRBS order 7, 15 or 31
+*  baud_rate: UART baud rate, for the report
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void selftest_start(uint32_t order, uint32_t baud_rate)
+{
+    selftest_order = order;
+    selftest_tap = selftest_feedback_tap(order);
+
+    /* Bits whose feedback taps are all in the past can be produced at once */
+    selftest_step = (selftest_tap >= 8u) ? 8u : 4u;
+
+    selftest_tx_window = 0xFFFFFFFFFFFFFFFFu;
+    selftest_rx_window = 0u;
+    selftest_locked = false;
+    selftest_sync_bits = 0u;
+    selftest_tx_bytes = 0u;
+    selftest_rx_bytes = 0u;
+    selftest_checked_bytes = 0u;
+    selftest_bit_errors = 0u;
+    selftest_probe_pending = false;
+    selftest_latency_min = 0xFFFFFFFFu;
+    selftest_latency_max = 0u;
+    selftest_elapsed_cycles = 0u;
+    selftest_last_report = stats_now();
+
+    selftest_report.order = order;
+    selftest_report.running = 1u;
+    selftest_report.baud_rate = baud_rate;
+    selftest_update_report(selftest_last_report);
+
+    selftest_active = true;
+}
+
+/*******************************************************************************
+* Function Name: selftest_stop
+********************************************************************************
+*
+* Summary:
+*  Stops generating data and publishes the final results. Must be called with
+*  interrupts masked.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void selftest_stop(void)
+{
+    if (selftest_active)
+    {
+        selftest_active = false;
+        selftest_update_report(stats_now());
+        selftest_report.running = 0u;
+    }
+}
+
+/*******************************************************************************
+* Function Name: selftest_running
+********************************************************************************
+*
+* Summary:
+*  Returns whether a self-test is generating data.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool: true while the test runs
+*
+*******************************************************************************/
+bool selftest_running(void)
+{
+    return selftest_active;
+}
+
+/*******************************************************************************
+* Function Name: selftest_generate
+********************************************************************************
+*
+* Summary:
+*  Fills a buffer with the next bytes of the PRBS sequence. Must be called
+*  from dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  data: buffer to fill
+*  length: number of bytes
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void selftest_generate(uint8_t *data, uint32_t length)
+{
+    uint64_t window = selftest_tx_window;
+    uint32_t mask = (1UL << selftest_step) - 1u;
+    uint32_t index;
+    uint32_t shift;
+    uint32_t bits;
+    uint32_t byte;
+
+    if (!selftest_probe_pending)
+    {
+        selftest_probe_pending = true;
+        selftest_probe_offset = selftest_tx_bytes;
+        selftest_probe_time = stats_now();
+    }
+
+    for (index = 0u; index < length; index++)
+    {
+        byte = 0u;
+        for (shift = 0u; shift < 8u; shift += selftest_step)
+        {
+            bits = (uint32_t) ((window >> (64u - selftest_order)) ^ (window >> (64u - selftest_tap))) & mask;
+            window = (window >> selftest_step) | ((uint64_t) bits << (64u - selftest_step));
+            byte |= bits << shift;
+        }
+        data[index] = (uint8_t) byte;
+    }
+
+    selftest_tx_window = window;
+    selftest_tx_bytes += length;
+}
+
+/*******************************************************************************
+* Function Name: selftest_check
+********************************************************************************
+*
+* Summary:
+*  Checks received bytes against the PRBS recurrence. Each bit is predicted
+*  from the bits received before it, so the checker synchronizes by itself
+*  and recovers from lost bytes. Must be called from dma_work_isr or with
+*  interrupts masked.
+*
+* Parameters:
+*  data: received bytes
+*  length: number of bytes
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void selftest_check(const uint8_t *data, uint32_t length)
+{
+    uint64_t window = selftest_rx_window;
+    uint32_t index;
+    uint32_t diff;
+    uint32_t errors;
+    uint32_t latency;
+
+    for (index = 0u; index < length; index++)
+    {
+        window = (window >> 8u) | ((uint64_t) data[index] << 56u);
+        diff = ((uint32_t) ((window >> (56u - selftest_order)) ^ (window >> (56u - selftest_tap))) ^ data[index]) & 0xFFu;
+        errors = (uint32_t) selftest_nibble_bits[diff & 0x0Fu] + selftest_nibble_bits[diff >> 4u];
+
+        if (selftest_locked)
+        {
+            selftest_checked_bytes++;
+            selftest_bit_errors += errors;
+        }
+        else if (errors == 0u)
+        {
+            selftest_sync_bits += 8u;
+            selftest_locked = (selftest_sync_bits >= SELFTEST_SYNC_BITS);
+        }
+        else
+        {
+            selftest_sync_bits = 0u;
+        }
+    }
+
+    selftest_rx_window = window;
+    selftest_rx_bytes += length;
+
+    if (selftest_probe_pending && (selftest_rx_bytes > selftest_probe_offset))
+    {
+        selftest_probe_pending = false;
+        latency = stats_now() - selftest_probe_time;
+        if (latency < selftest_latency_min)
+        {
+            selftest_latency_min = latency;
+        }
+        if (latency > selftest_latency_max)
+        {
+            selftest_latency_max = latency;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: selftest_task
+********************************************************************************
+*
+* Summary:
+*  Refreshes selftest_report every SELFTEST_REPORT_PERIOD_MS while the test
+*  runs. Called from the main loop.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void selftest_task(void)
+{
+    uint32_t now;
+
+    if (!selftest_active)
+    {
+        return;
+    }
+
+    now = stats_now();
+    if ((now - selftest_last_report) >= (SELFTEST_REPORT_PERIOD_MS * 1000u * selftest_cycles_per_us))
+    {
+        selftest_update_report(now);
+    }
+}
+
+/*******************************************************************************
+* Function Name: selftest_snapshot
+********************************************************************************
+*
+* Summary:
+*  Returns a copy of selftest_report for the SELFTEST_VENDOR_REQ_RESULT data
+*  stage. Called from the USB interrupt.
+*
+* Parameters:
+*  length: returns the size of the copy in bytes
+*
+* Return:
+*  const uint8_t *: the copy
+*
+*******************************************************************************/
+const uint8_t *selftest_snapshot(uint32_t *length)
+{
+    selftest_copy = selftest_report;
+    *length = sizeof(selftest_copy);
+
+    return (const uint8_t *) &selftest_copy;
+}
@@ -0,0 +1,99 @@
+/******************************************************************************
+* File Name: selftest.h
+*
+* Description: This file contains the interface of the PRBS loopback self-test
+*              and of the vendor requests that control it
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SELFTEST_H_
+#define SELFTEST_H_
+
+#include "cy_pdl.h"
+
+
+/*******************************************************************************
+*        Macros
+*******************************************************************************/
+/* Vendor requests on EP0, recipient device.
+ * SELFTEST_VENDOR_REQ_START (host to device, no data): starts the self-test
+ * with the PRBS order in wValue (7, 15 or 31), or stops it if wValue is 0.
+ * SELFTEST_VENDOR_REQ_RESULT (device to host): returns selftest_report_t,
+ * truncated to wLength. */
+#define SELFTEST_VENDOR_REQ_START   (0x04u)
+#define SELFTEST_VENDOR_REQ_RESULT  (0x05u)
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Self-test results, refreshed by selftest_task while the test runs. All
+ * fields are 32-bit little-endian words, which is also the layout sent to the
+ * host. Bit errors are counted by a self-synchronizing checker, so a single
+ * flipped bit on the line is counted three times. */
+typedef struct
+{
+    uint32_t order;             /* PRBS order, 0 while no test has run */
+    uint32_t running;           /* 1 while the test runs */
+    uint32_t baud_rate;         /* UART baud rate of the test */
+    uint32_t locked;            /* 1 once the checker has synchronized to the received sequence */
+    uint32_t elapsed_ms;        /* Time since the test started */
+    uint32_t tx_bytes;          /* Bytes handed to UART_TX_DMA */
+    uint32_t rx_bytes;          /* Bytes received by UART_RX_DMA */
+    uint32_t checked_bytes;     /* Bytes checked since the checker synchronized */
+    uint32_t bit_errors;        /* Bit errors in the checked bytes */
+    uint32_t bytes_per_s;       /* Average receive rate */
+    uint32_t latency_min_us;    /* Time from a byte being queued for UART_TX_DMA to its reception */
+    uint32_t latency_max_us;
+} selftest_report_t;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void selftest_init(void);
+bool selftest_request(uint32_t order);
+bool selftest_take_request(uint32_t *order);
+void selftest_start(uint32_t order, uint32_t baud_rate);
+void selftest_stop(void);
+bool selftest_running(void);
+void selftest_generate(uint8_t *data, uint32_t length);
+void selftest_check(const uint8_t *data, uint32_t length);
+void selftest_task(void);
+const uint8_t *selftest_snapshot(uint32_t *length);
+
+extern volatile selftest_report_t selftest_report;
+
+
+#endif /* SELFTEST_H_ */
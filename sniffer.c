@@ -0,0 +1,233 @@
+/******************************************************************************
+* File Name: sniffer.c
+*
+* Description: This file contains the record encoder of the sniffer mode. It
+*              timestamps the captured UART bytes and line events, and accounts
+*              for the records dropped while the host falls behind
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "sniffer.h"
+#include "stats.h"
+
+#if (SNIFFER_MODE != 0u)
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* SNIFF_TIME_PERIOD_MS in microseconds */
+#define SNIFF_TIME_PERIOD_US        (SNIFF_TIME_PERIOD_MS * 1000u)
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+/* SysTick time base of main.c */
+extern volatile uint32_t tick_count;
+
+static uint32_t sniff_cycles_per_us;
+
+/* Time of the last record written */
+static uint32_t sniff_last_time;
+
+/* Records dropped per channel since its last SNIFF_REC_DROP record */
+static sniff_drop_t sniff_drop[SNIFF_CHANNELS];
+
+
+/*******************************************************************************
+* Function Name: sniff_init
+********************************************************************************
+*
+* Summary:
+*  Initializes the sniffer. Must be called once the SysTick time base has
+*  been started.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void sniff_init(void)
+{
+    sniff_cycles_per_us = Cy_SysClk_ClkSysGetFrequency() / 1000000u;
+    sniff_last_time = sniff_now();
+}
+
+/*******************************************************************************
+* Function Name: sniff_now
+********************************************************************************
+*
+* Summary:
+*  Returns the record time base in microseconds, built from the SysTick tick
+*  count and the SysTick down-counter. It wraps after 2^32 microseconds.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t: current time in microseconds
+*
+*******************************************************************************/
+uint32_t sniff_now(void)
+{
+    uint32_t reload = Cy_SysTick_GetReload();
+    uint32_t ticks;
+    uint32_t value;
+
+    /* Retry if the tick count advanced while the counter was read */
+    do
+    {
+        ticks = tick_count;
+        value = Cy_SysTick_GetValue();
+    } while (ticks != tick_count);
+
+    return (ticks * TICK_PERIOD_US) + ((reload - value) / sniff_cycles_per_us);
+}
+
+/*******************************************************************************
+* Function Name: sniff_record
+********************************************************************************
+*
+* Summary:
+*  Appends a record to the IN stream. A record that does not fit into the
+*  queue is dropped whole and counted for its channel, except for
+*  SNIFF_REC_TIME. The next record of the
+*  channel that fits is preceded by a SNIFF_REC_DROP record with the count.
+*  Must be called from dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  queue: rx_queue of the port that carries the IN stream
+*  channel: bridge port whose UART RX captured the record
+*  type: SNIFF_REC_DATA ... SNIFF_REC_TIME
+*  info: header info byte
+*  time: sniff_now() time of the record
+*  data: payload
+*  length: payload bytes, at most 255
+*
+* Return:
+*  bool: false if the record was dropped
+*
+*******************************************************************************/
+bool sniff_record(rx_queue_t *queue, uint32_t channel, uint32_t type, uint32_t info, uint32_t time,
+                  const uint8_t *data, uint32_t length)
+{
+    sniff_drop_t *drop = &sniff_drop[channel];
+    sniff_header_t header;
+    uint32_t needed = sizeof(header) + length;
+
+    if (drop->records != 0u)
+    {
+        needed += sizeof(header) + sizeof(*drop);
+    }
+
+    if (needed > rx_queue_room(queue))
+    {
+        /* A time record is retried on the next tick */
+        if (type == SNIFF_REC_TIME)
+        {
+            return false;
+        }
+        drop->bytes += (type == SNIFF_REC_DATA) ? length : 0u;
+        drop->records++;
+        stats_sniff_dropped((type == SNIFF_REC_DATA) ? length : 0u);
+        return false;
+    }
+
+    header.channel = (uint8_t) channel;
+    header.time_us = time;
+
+    if (drop->records != 0u)
+    {
+        header.type = SNIFF_REC_DROP;
+        header.length = (uint8_t) sizeof(*drop);
+        header.info = 0u;
+        (void) rx_queue_put(queue, (const uint8_t *) &header, sizeof(header));
+        (void) rx_queue_put(queue, (const uint8_t *) drop, sizeof(*drop));
+        drop->bytes = 0u;
+        drop->records = 0u;
+    }
+
+    header.type = (uint8_t) type;
+    header.length = (uint8_t) length;
+    header.info = (uint8_t) info;
+    (void) rx_queue_put(queue, (const uint8_t *) &header, sizeof(header));
+    if (length != 0u)
+    {
+        (void) rx_queue_put(queue, data, length);
+    }
+
+    sniff_last_time = time;
+    stats_sniffed((type == SNIFF_REC_DATA) ? length : 0u);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: sniff_time_task
+********************************************************************************
+*
+* Summary:
+*  Called once per tick from the main loop. Writes a SNIFF_REC_TIME record
+*  when no record was written for SNIFF_TIME_PERIOD_MS, so that the host sees
+*  every wrap of the timestamps.
+*
+* Parameters:
+*  queue: rx_queue of the port that carries the IN stream
+*
+* Return:
+*  bool: true if a record was written and the IN endpoint must be refilled
+*
+*******************************************************************************/
+bool sniff_time_task(rx_queue_t *queue)
+{
+    uint32_t int_state;
+    uint32_t now;
+    bool written = false;
+
+    /* Masking interrupts keeps dma_work_isr away from rx_queue */
+    int_state = Cy_SysLib_EnterCriticalSection();
+    now = sniff_now();
+    if ((now - sniff_last_time) >= SNIFF_TIME_PERIOD_US)
+    {
+        written = sniff_record(queue, 0u, SNIFF_REC_TIME, 0u, now, NULL, 0u);
+    }
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    return written;
+}
+
+#endif /* SNIFFER_MODE */
@@ -0,0 +1,100 @@
+/******************************************************************************
+* File Name: sniffer.h
+*
+* Description: This file contains the record format and the interface of the
+*              sniffer mode, which streams the captured UART bytes to the host
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SNIFFER_H_
+#define SNIFFER_H_
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "rx_queue.h"
+
+
+/*******************************************************************************
+*        Macros
+*******************************************************************************/
+/* Record types. Each record is a sniff_header_t followed by length payload
+ * bytes. Records are never split or interleaved, and the stream starts at a
+ * record every time the host configures the device. */
+#define SNIFF_REC_DATA              (1u)    /* Payload: bytes received, time: the last one was received */
+#define SNIFF_REC_IDLE              (2u)    /* The line has been quiet for the receive-idle timeout */
+#define SNIFF_REC_LINE              (3u)    /* info: SERIAL_STATE bits of a line error at this place */
+#define SNIFF_REC_DROP              (4u)    /* Payload: sniff_drop_t, records lost before this one */
+#define SNIFF_REC_TIME              (5u)    /* Written when no record was sent for SNIFF_TIME_PERIOD_MS */
+
+/* Channels: the UART RX of port 0, and of port 1 with BRIDGE_PORTS=2 */
+#define SNIFF_CHANNELS              (BRIDGE_PORTS)
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Record header. All fields are little-endian. time_us comes from the
+ * SysTick time base and wraps after about 71 minutes; SNIFF_REC_TIME
+ * records let the host extend it. */
+typedef struct
+{
+    uint8_t type;                   /* SNIFF_REC_DATA ... SNIFF_REC_TIME */
+    uint8_t channel;                /* Bridge port whose UART RX captured the line */
+    uint8_t length;                 /* Payload bytes after the header */
+    uint8_t info;                   /* SNIFF_REC_LINE: SERIAL_STATE bits, otherwise 0 */
+    uint32_t time_us;
+} sniff_header_t;
+
+/* Payload of SNIFF_REC_DROP. The records of the channel were dropped because
+ * the host did not read the IN endpoint fast enough. */
+typedef struct
+{
+    uint32_t bytes;                 /* Received bytes lost */
+    uint32_t records;               /* Records lost, the DATA records included */
+} sniff_drop_t;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+#if (SNIFFER_MODE != 0u)
+void sniff_init(void);
+uint32_t sniff_now(void);
+bool sniff_record(rx_queue_t *queue, uint32_t channel, uint32_t type, uint32_t info, uint32_t time,
+                  const uint8_t *data, uint32_t length);
+bool sniff_time_task(rx_queue_t *queue);
+#endif /* SNIFFER_MODE */
+
+
+#endif /* SNIFFER_H_ */
@@ -0,0 +1,958 @@
+/******************************************************************************
+* File Name: stats.c
+*
+* Description: This file contains the runtime statistics of the bridge: traffic
+*              counters, buffer high-water marks, interrupt execution times and
+*              the USB to UART latency
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "stats.h"
+#include "bench.h"
+#include "trace.h"
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* SysTick ticks per throughput window of the per-port rates */
+#define STATS_RATE_WINDOW_TICKS     (1000000u / TICK_PERIOD_US)
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+/* SysTick time base of main.c */
+extern volatile uint32_t tick_count;
+
+/* Live statistics. Every field has a single writer: one ISR, or code that
+ * runs with interrupts masked, so the counters need no locks. */
+bridge_stats_t stats;
+
+/* Copy sent to the host by STATS_VENDOR_REQ_GET */
+static bridge_stats_t stats_copy;
+
+/* Set by STATS_VENDOR_REQ_RESET, applied by stats_task */
+static volatile bool stats_reset_pending;
+
+/* Arrival time of the packet in each tx_ring slot of each port */
+static uint32_t stats_out_stamp[BRIDGE_PORTS][TX_RING_SLOTS];
+static uint32_t stats_out_length[BRIDGE_PORTS][TX_RING_SLOTS];
+
+/* Start of the current throughput window: tick_count and the byte counters
+ * of each port */
+static uint32_t stats_rate_start;
+static uint32_t stats_rate_out_bytes[BRIDGE_PORTS];
+static uint32_t stats_rate_in_bytes[BRIDGE_PORTS];
+
+/* Connection timing being filled in, and the tick_count it counts from */
+static stats_connect_t *stats_connect = &stats.boot;
+static uint32_t stats_connect_start;
+
+
+/*******************************************************************************
+* Function Name: stats_timing_add
+********************************************************************************
+*
+* Summary:
+*  Adds one sample to a timing record.
+*
+* Parameters:
+*  timing: timing record to update
+*  cycles: sample in CPU cycles
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void stats_timing_add(stats_timing_t *timing, uint32_t cycles)
+{
+    timing->count++;
+    timing->total_cycles += cycles;
+    if (cycles < timing->min_cycles)
+    {
+        timing->min_cycles = cycles;
+    }
+    if (cycles > timing->max_cycles)
+    {
+        timing->max_cycles = cycles;
+    }
+}
+
+/*******************************************************************************
+* Function Name: stats_connect_time
+********************************************************************************
+*
+* Summary:
+*  Returns the time since the start of the current connection timing, rounded
+*  up to the next tick so that an event is never reported as 0.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t: time in microseconds
+*
+*******************************************************************************/
+static uint32_t stats_connect_time(void)
+{
+    return ((tick_count - stats_connect_start) + 1u) * TICK_PERIOD_US;
+}
+
+/*******************************************************************************
+* Function Name: stats_reset
+********************************************************************************
+*
+* Summary:
+*  Clears all statistics. Must be called with interrupts masked.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void stats_reset(void)
+{
+    uint32_t index;
+
+    stats.out_bytes = 0u;
+    stats.out_packets = 0u;
+    stats.out_naks = 0u;
+    stats.in_bytes = 0u;
+    stats.in_packets = 0u;
+    stats.in_naks = 0u;
+    stats.ep_stalls = 0u;
+    stats.rx_fifo_overflows = 0u;
+    stats.idle_flushes = 0u;
+    stats.tx_ring_high_water = 0u;
+    stats.rx_queue_high_water = 0u;
+    stats.in_zlps = 0u;
+    stats.out_frames = 0u;
+    stats.in_frames = 0u;
+    stats.in_frame_errors = 0u;
+    stats.rs485_echo_bytes = 0u;
+    stats.rx_frame_errors = 0u;
+    stats.rx_parity_errors = 0u;
+    stats.rx_breaks = 0u;
+    stats.serial_states = 0u;
+    stats.breaks_sent = 0u;
+    stats.sniff_records = 0u;
+    stats.sniff_bytes = 0u;
+    stats.sniff_dropped_records = 0u;
+    stats.sniff_dropped_bytes = 0u;
+    stats.usb_link_downs = 0u;
+
+    for (index = 0u; index < (uint32_t) POOL_DIRS; index++)
+    {
+        stats.pool[index].high_water = stats.pool[index].in_use;
+        stats.pool[index].denied = 0u;
+    }
+
+    for (index = 0u; index < STATS_ISR_COUNT; index++)
+    {
+        stats.isr[index].count = 0u;
+        stats.isr[index].min_cycles = UINT32_MAX;
+        stats.isr[index].max_cycles = 0u;
+        stats.isr[index].total_cycles = 0u;
+    }
+
+    stats.out_latency.count = 0u;
+    stats.out_latency.min_cycles = UINT32_MAX;
+    stats.out_latency.max_cycles = 0u;
+    stats.out_latency.total_cycles = 0u;
+
+    stats.rs485_turnaround.count = 0u;
+    stats.rs485_turnaround.min_cycles = UINT32_MAX;
+    stats.rs485_turnaround.max_cycles = 0u;
+    stats.rs485_turnaround.total_cycles = 0u;
+
+    stats.work_latency.count = 0u;
+    stats.work_latency.min_cycles = UINT32_MAX;
+    stats.work_latency.max_cycles = 0u;
+    stats.work_latency.total_cycles = 0u;
+
+    stats.serial_state_latency.count = 0u;
+    stats.serial_state_latency.min_cycles = UINT32_MAX;
+    stats.serial_state_latency.max_cycles = 0u;
+    stats.serial_state_latency.total_cycles = 0u;
+
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        stats.port[index].out_bytes = 0u;
+        stats.port[index].out_packets = 0u;
+        stats.port[index].out_naks = 0u;
+        stats.port[index].in_bytes = 0u;
+        stats.port[index].in_packets = 0u;
+        stats.port[index].in_naks = 0u;
+        stats.port[index].out_bytes_per_s = 0u;
+        stats.port[index].in_bytes_per_s = 0u;
+        stats_rate_out_bytes[index] = 0u;
+        stats_rate_in_bytes[index] = 0u;
+    }
+    stats_rate_start = tick_count;
+}
+
+/*******************************************************************************
+* Function Name: stats_init
+********************************************************************************
+*
+* Summary:
+*  Initializes the statistics. Must be called once the SysTick time base has
+*  been started and before the interrupts are enabled.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_init(void)
+{
+    stats.version = STATS_VERSION;
+    stats.cycles_per_us = Cy_SysClk_ClkSysGetFrequency() / 1000000u;
+    stats.ports = BRIDGE_PORTS;
+    stats.pool_blocks = POOL_BLOCKS;
+    stats.pool_block_size = POOL_BLOCK_SIZE;
+    stats.pool[POOL_OUT].quota = POOL_OUT_QUOTA;
+    stats.pool[POOL_IN].quota = POOL_IN_QUOTA;
+    stats_reset();
+}
+
+/*******************************************************************************
+* Function Name: stats_task
+********************************************************************************
+*
+* Summary:
+*  Applies a reset requested by the host and updates the throughput of each
+*  port once per second. Called from the main loop.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_task(void)
+{
+    uint32_t int_state;
+    uint32_t window;
+    uint32_t index;
+    uint32_t bytes;
+
+    if (stats_reset_pending)
+    {
+        int_state = Cy_SysLib_EnterCriticalSection();
+        stats_reset_pending = false;
+        stats_reset();
+        Cy_SysLib_ExitCriticalSection(int_state);
+    }
+
+    window = tick_count - stats_rate_start;
+    if (window < STATS_RATE_WINDOW_TICKS)
+    {
+        return;
+    }
+
+    /* The counters are written by dma_work_isr, a 32-bit read is atomic */
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        bytes = stats.port[index].out_bytes;
+        stats.port[index].out_bytes_per_s = (uint32_t) (((uint64_t) (bytes - stats_rate_out_bytes[index]) * 1000000u) /
+                                                        ((uint64_t) window * TICK_PERIOD_US));
+        stats_rate_out_bytes[index] = bytes;
+
+        bytes = stats.port[index].in_bytes;
+        stats.port[index].in_bytes_per_s = (uint32_t) (((uint64_t) (bytes - stats_rate_in_bytes[index]) * 1000000u) /
+                                                       ((uint64_t) window * TICK_PERIOD_US));
+        stats_rate_in_bytes[index] = bytes;
+    }
+    stats_rate_start += window;
+}
+
+/*******************************************************************************
+* Function Name: stats_now
+********************************************************************************
+*
+* Summary:
+*  Returns a CPU cycle timestamp built from the SysTick tick count and the
+*  SysTick down-counter. The Cortex-M0 has no cycle counter of its own. The
+*  timestamp wraps after 2^32 cycles, so only differences of less than that
+*  are meaningful. In a handler that blocks the SysTick interrupt, the
+*  counter can reload before tick_count is incremented; the pending SysTick
+*  interrupt stands for that tick.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t: current time in CPU cycles
+*
+*******************************************************************************/
+uint32_t stats_now(void)
+{
+    uint32_t reload = Cy_SysTick_GetReload();
+    uint32_t ticks;
+    uint32_t value;
+    bool pending;
+
+    /* Retry if the tick count advanced while the counter was read */
+    do
+    {
+        ticks = tick_count;
+        value = Cy_SysTick_GetValue();
+        pending = (0u != (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk));
+        if (pending)
+        {
+            /* Read again, the reload may have come after the first read */
+            value = Cy_SysTick_GetValue();
+        }
+    } while (ticks != tick_count);
+
+    if (pending)
+    {
+        ticks++;
+    }
+
+    return (ticks * (reload + 1u)) + (reload - value);
+}
+
+/*******************************************************************************
+* Function Name: stats_isr_start
+********************************************************************************
+*
+* Summary:
+*  Returns the entry timestamp of an interrupt handler for stats_isr_done().
+*  Called first in the handler.
+*
+* Parameters:
+*  isr: interrupt handler
+*
+* Return:
+*  uint32_t: current time in CPU cycles
+*
+*******************************************************************************/
+uint32_t stats_isr_start(stats_isr_t isr)
+{
+    trace_event(TRACE_ISR_ENTER, isr, 0u);
+
+    return stats_now();
+}
+
+/*******************************************************************************
+* Function Name: stats_isr_done
+********************************************************************************
+*
+* Summary:
+*  Records the execution time of an interrupt handler. Called at the end of
+*  the handler. The time includes preemption by higher priority handlers.
+*
+* Parameters:
+*  isr: interrupt handler
+*  start: stats_now() at the entry of the handler
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_isr_done(stats_isr_t isr, uint32_t start)
+{
+    stats_timing_add(&stats.isr[isr], stats_now() - start);
+    bench_isr(isr);
+    trace_event(TRACE_ISR_EXIT, isr, 0u);
+}
+
+/*******************************************************************************
+* Function Name: stats_out_received
+********************************************************************************
+*
+* Summary:
+*  Records an OUT packet committed to a tx_ring slot. Called from dma_work_isr.
+*
+* Parameters:
+*  port: index of the bridge port
+*  slot: tx_ring slot
+*  length: packet length
+*  slots_used: tx_ring slots in use, including this one
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_out_received(uint32_t port, uint32_t slot, uint32_t length, uint32_t slots_used)
+{
+    stats_out_stamp[port][slot] = stats_now();
+    stats_out_length[port][slot] = length;
+    trace_event(TRACE_EP3_READ, slot, length);
+
+    stats.out_bytes += length;
+    stats.out_packets++;
+    stats.port[port].out_bytes += length;
+    stats.port[port].out_packets++;
+    if ((stats_connect->first_out_us == 0u) && (length != 0u))
+    {
+        stats_connect->first_out_us = stats_connect_time();
+    }
+    if (slots_used > stats.tx_ring_high_water)
+    {
+        stats.tx_ring_high_water = slots_used;
+    }
+}
+
+/*******************************************************************************
+* Function Name: stats_out_sent
+********************************************************************************
+*
+* Summary:
+*  Records that UART_TX_DMA has written a tx_ring slot to the TX FIFO. Called
+*  from dma_work_isr.
+*
+* Parameters:
+*  port: index of the bridge port
+*  slot: tx_ring slot
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_out_sent(uint32_t port, uint32_t slot)
+{
+    uint32_t latency = stats_now() - stats_out_stamp[port][slot];
+
+    stats_timing_add(&stats.out_latency, latency);
+    bench_out_latency(latency, stats_out_length[port][slot]);
+    trace_event(TRACE_TX_DONE, slot, stats_out_length[port][slot]);
+}
+
+/*******************************************************************************
+* Function Name: stats_out_paused
+********************************************************************************
+*
+* Summary:
+*  Records that EP3 is held off, so the host is NAKed until a slot is free.
+*  Called from dma_work_isr.
+*
+* Parameters:
+*  port: index of the bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_out_paused(uint32_t port)
+{
+    stats.out_naks++;
+    stats.port[port].out_naks++;
+    trace_event(TRACE_EP3_PAUSE, 0u, 0u);
+}
+
+/*******************************************************************************
+* Function Name: stats_in_queued
+********************************************************************************
+*
+* Summary:
+*  Records received bytes that found EP2 busy and were appended to rx_queue.
+*  Must be called from dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  port: index of the bridge port
+*  length: number of bytes appended
+*  queue_level: bytes in rx_queue after the append
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_in_queued(uint32_t port, uint32_t length, uint32_t queue_level)
+{
+    stats.in_naks++;
+    stats.port[port].in_naks++;
+    if (queue_level > stats.rx_queue_high_water)
+    {
+        stats.rx_queue_high_water = queue_level;
+    }
+    bench_in_queued(length);
+}
+
+/*******************************************************************************
+* Function Name: stats_in_sent
+********************************************************************************
+*
+* Summary:
+*  Records bytes loaded into EP2. Must be called from dma_work_isr or with
+*  interrupts masked.
+*
+* Parameters:
+*  port: index of the bridge port
+*  length: number of bytes loaded
+*  from_queue: true if the bytes were taken from rx_queue
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_in_sent(uint32_t port, uint32_t length, bool from_queue)
+{
+    stats.in_bytes += length;
+    stats.in_packets++;
+    stats.port[port].in_bytes += length;
+    stats.port[port].in_packets++;
+    if (length == 0u)
+    {
+        stats.in_zlps++;
+    }
+    else if (stats_connect->first_in_us == 0u)
+    {
+        stats_connect->first_in_us = stats_connect_time();
+    }
+    bench_in_sent(length, from_queue);
+    trace_event(TRACE_EP2_LOAD, from_queue ? 1u : 0u, length);
+}
+
+/*******************************************************************************
+* Function Name: stats_ep_stall
+********************************************************************************
+*
+* Summary:
+*  Records that the host has halted EP2 or EP3. Called from the main loop.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_ep_stall(void)
+{
+    stats.ep_stalls++;
+}
+
+/*******************************************************************************
+* Function Name: stats_rx_fifo_overflow
+********************************************************************************
+*
+* Summary:
+*  Records a UART RX FIFO overflow. Called from uart_isr.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_rx_fifo_overflow(void)
+{
+    stats.rx_fifo_overflows++;
+}
+
+/*******************************************************************************
+* Function Name: stats_idle_flush
+********************************************************************************
+*
+* Summary:
+*  Records a partial RX buffer sent on receive idle. Called with interrupts
+*  masked.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_idle_flush(void)
+{
+    stats.idle_flushes++;
+}
+
+/*******************************************************************************
+* Function Name: stats_out_frame
+********************************************************************************
+*
+* Summary:
+*  Records a frame encoded onto UART TX. Called from dma_work_isr.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_out_frame(void)
+{
+    stats.out_frames++;
+}
+
+/*******************************************************************************
+* Function Name: stats_in_frame
+********************************************************************************
+*
+* Summary:
+*  Records a frame decoded from UART RX. Must be called from dma_work_isr or
+*  with interrupts masked.
+*
+* Parameters:
+*  valid: false if the frame was malformed or could not be kept apart from
+*         the next one
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_in_frame(bool valid)
+{
+    stats.in_frames++;
+    if (!valid)
+    {
+        stats.in_frame_errors++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: stats_rs485_echo
+********************************************************************************
+*
+* Summary:
+*  Records echo bytes dropped from UART RX. Must be called from dma_work_isr or
+*  with interrupts masked.
+*
+* Parameters:
+*  length: number of bytes dropped
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_rs485_echo(uint32_t length)
+{
+    stats.rs485_echo_bytes += length;
+}
+
+/*******************************************************************************
+* Function Name: stats_rs485_turnaround
+********************************************************************************
+*
+* Summary:
+*  Records the time from the UART TX done interrupt to the release of the
+*  RS-485 driver. Called from uart_isr.
+*
+* Parameters:
+*  start: stats_now() on entry to uart_isr
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_rs485_turnaround(uint32_t start)
+{
+    stats_timing_add(&stats.rs485_turnaround, stats_now() - start);
+}
+
+/*******************************************************************************
+* Function Name: stats_work_latency
+********************************************************************************
+*
+* Summary:
+*  Records how long a work item waited for the bottom half. Called from
+*  work_run.
+*
+* Parameters:
+*  posted: stats_now() when the work item was posted
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_work_latency(uint32_t posted)
+{
+    stats_timing_add(&stats.work_latency, stats_now() - posted);
+}
+
+/*******************************************************************************
+* Function Name: stats_rx_line_error
+********************************************************************************
+*
+* Summary:
+*  Records the framing, parity and break conditions of UART RX. A break also
+*  ends with a framing error, which is not counted. Called from uart_isr.
+*
+* Parameters:
+*  rx_status: UART RX interrupt sources
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_rx_line_error(uint32_t rx_status)
+{
+    if (0u != (rx_status & CY_SCB_UART_RX_BREAK_DETECT))
+    {
+        stats.rx_breaks++;
+    }
+    else if (0u != (rx_status & CY_SCB_UART_RX_ERR_FRAME))
+    {
+        stats.rx_frame_errors++;
+    }
+    if (0u != (rx_status & CY_SCB_UART_RX_ERR_PARITY))
+    {
+        stats.rx_parity_errors++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: stats_serial_state_sent
+********************************************************************************
+*
+* Summary:
+*  Records a SERIAL_STATE notification handed to the interrupt endpoint and
+*  the time since its first line event. Called from dma_work_isr.
+*
+* Parameters:
+*  event_time: stats_now() at the first line event of the notification
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_serial_state_sent(uint32_t event_time)
+{
+    stats.serial_states++;
+    stats_timing_add(&stats.serial_state_latency, stats_now() - event_time);
+}
+
+/*******************************************************************************
+* Function Name: stats_break_sent
+********************************************************************************
+*
+* Summary:
+*  Records a break started on UART TX. Called from the main loop.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_break_sent(void)
+{
+    stats.breaks_sent++;
+}
+
+/*******************************************************************************
+* Function Name: stats_sniffed
+********************************************************************************
+*
+* Summary:
+*  Records a sniff record sent to the host. Must be called from dma_work_isr
+*  or with interrupts masked.
+*
+* Parameters:
+*  length: captured bytes in the record
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_sniffed(uint32_t length)
+{
+    stats.sniff_records++;
+    stats.sniff_bytes += length;
+}
+
+/*******************************************************************************
+* Function Name: stats_sniff_dropped
+********************************************************************************
+*
+* Summary:
+*  Records a sniff record dropped because rx_queue was full. Must be called
+*  from dma_work_isr or with interrupts masked.
+*
+* Parameters:
+*  length: captured bytes in the record
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_sniff_dropped(uint32_t length)
+{
+    stats.sniff_dropped_records++;
+    stats.sniff_dropped_bytes += length;
+}
+
+/*******************************************************************************
+* Function Name: stats_pool_level
+********************************************************************************
+*
+* Summary:
+*  Records the number of blocks a direction holds after pool_get or pool_put.
+*  Called by the pool with interrupts masked.
+*
+* Parameters:
+*  dir: direction
+*  in_use: blocks the direction holds
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_pool_level(pool_dir_t dir, uint32_t in_use)
+{
+    stats.pool[dir].in_use = in_use;
+    if (in_use > stats.pool[dir].high_water)
+    {
+        stats.pool[dir].high_water = in_use;
+    }
+}
+
+/*******************************************************************************
+* Function Name: stats_pool_denied
+********************************************************************************
+*
+* Summary:
+*  Records a block refused to a direction. Called by the pool with interrupts
+*  masked.
+*
+* Parameters:
+*  dir: direction
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_pool_denied(pool_dir_t dir)
+{
+    stats.pool[dir].denied++;
+}
+
+/*******************************************************************************
+* Function Name: stats_usb_link_down
+********************************************************************************
+*
+* Summary:
+*  Records that the host dropped the configuration, by a bus reset or by
+*  SET_CONFIGURATION 0, and restarts the replug timing. Must be called with
+*  interrupts masked.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_usb_link_down(void)
+{
+    stats.usb_link_downs++;
+    stats.replug.configured_us = 0u;
+    stats.replug.first_in_us = 0u;
+    stats.replug.first_out_us = 0u;
+    stats_connect = &stats.replug;
+    stats_connect_start = tick_count;
+}
+
+/*******************************************************************************
+* Function Name: stats_usb_configured
+********************************************************************************
+*
+* Summary:
+*  Records that the host configured the device. Must be called with interrupts
+*  masked.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_usb_configured(void)
+{
+    if (stats_connect->configured_us == 0u)
+    {
+        stats_connect->configured_us = stats_connect_time();
+    }
+}
+
+/*******************************************************************************
+* Function Name: stats_snapshot
+********************************************************************************
+*
+* Summary:
+*  Copies the statistics for STATS_VENDOR_REQ_GET. Called from the USB
+*  interrupt, so the data path keeps running; counters updated during the
+*  copy may be one event apart.
+*
+* Parameters:
+*  length: returns the size of the copy in bytes
+*
+* Return:
+*  const uint8_t *: the copy
+*
+*******************************************************************************/
+const uint8_t *stats_snapshot(uint32_t *length)
+{
+    stats_copy = stats;
+    *length = sizeof(stats_copy);
+
+    return (const uint8_t *) &stats_copy;
+}
+
+/*******************************************************************************
+* Function Name: stats_request_reset
+********************************************************************************
+*
+* Summary:
+*  Requests a reset of all statistics for STATS_VENDOR_REQ_RESET. The reset is
+*  applied by stats_task.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void stats_request_reset(void)
+{
+    stats_reset_pending = true;
+}
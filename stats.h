@@ -0,0 +1,202 @@
+/******************************************************************************
+* File Name: stats.h
+*
+* Description: This file contains the interface of the runtime statistics of the
+*              bridge and of the vendor request that reads them
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "pool.h"
+
+
+/*******************************************************************************
+*        Macros
+*******************************************************************************/
+/* Vendor requests on EP0, recipient device.
+ * STATS_VENDOR_REQ_GET (device to host): returns bridge_stats_t, truncated to
+ * wLength. STATS_VENDOR_REQ_RESET (host to device, no data): clears all
+ * statistics. */
+#define STATS_VENDOR_REQ_GET        (0x01u)
+#define STATS_VENDOR_REQ_RESET      (0x02u)
+
+/* Layout version reported in bridge_stats_t.version */
+#define STATS_VERSION               (10u)
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Interrupt handlers whose execution time is measured */
+typedef enum
+{
+    STATS_ISR_DMA,
+    STATS_ISR_UART,
+    STATS_ISR_USB_HIGH,
+    STATS_ISR_USB_MEDIUM,
+    STATS_ISR_USB_LOW,
+    STATS_ISR_DMA_WORK,
+    STATS_ISR_COUNT
+} stats_isr_t;
+
+/* Execution time or latency in CPU cycles. The average is total_cycles
+ * divided by count; min_cycles is 0xFFFFFFFF while count is 0. */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t total_cycles;
+} stats_timing_t;
+
+/* Throughput of one bridge port. The rates are the bytes moved during the
+ * last complete second, so that ports sharing the DMA and the bus can be
+ * compared. */
+typedef struct
+{
+    uint32_t out_bytes;             /* Bytes read from the OUT endpoint, once encoded in FRAME_MODE */
+    uint32_t out_packets;           /* Packets read, tx_ring slots filled in FRAME_MODE */
+    uint32_t out_naks;              /* OUT endpoint held off because tx_ring was full or the pool empty */
+    uint32_t in_bytes;              /* Bytes loaded into the IN endpoint */
+    uint32_t in_packets;            /* Packets loaded into the IN endpoint */
+    uint32_t in_naks;               /* Received data was queued instead of loaded right away */
+    uint32_t out_bytes_per_s;       /* out_bytes of the last second */
+    uint32_t in_bytes_per_s;        /* in_bytes of the last second */
+} stats_port_t;
+
+/* Time to bring the bridge up after power-on or after the host dropped the
+ * configuration, in microseconds of the SysTick time base and rounded up to
+ * the next tick. A field is 0 until its event has happened. */
+typedef struct
+{
+    uint32_t configured_us;         /* SET_CONFIGURATION by the host */
+    uint32_t first_in_us;           /* First UART RX byte loaded into an IN endpoint */
+    uint32_t first_out_us;          /* First byte read from an OUT endpoint */
+} stats_connect_t;
+
+/* Use of the buffer pool by one direction, in blocks */
+typedef struct
+{
+    uint32_t quota;                 /* POOL_OUT_QUOTA or POOL_IN_QUOTA */
+    uint32_t in_use;                /* Blocks held now, not cleared by a reset */
+    uint32_t high_water;            /* Most blocks held */
+    uint32_t denied;                /* Blocks refused because the pool was empty or the quota reached */
+} stats_pool_t;
+
+/* Runtime statistics. OUT is host to UART, IN is UART to host. All fields are
+ * 32-bit little-endian words, which is also the layout sent to the host. */
+typedef struct
+{
+    uint32_t version;               /* STATS_VERSION */
+    uint32_t cycles_per_us;         /* Time base of all cycle counts */
+    uint32_t out_bytes;             /* Bytes read from EP3, once encoded in FRAME_MODE */
+    uint32_t out_packets;           /* Packets read from EP3, tx_ring slots filled in FRAME_MODE */
+    uint32_t out_naks;              /* EP3 held off because tx_ring was full or the pool empty */
+    uint32_t in_bytes;              /* Bytes loaded into EP2 */
+    uint32_t in_packets;            /* Packets loaded into EP2 */
+    uint32_t in_naks;               /* Received data was queued instead of loaded into EP2 right away */
+    uint32_t ep_stalls;             /* EP2 or EP3 halted by the host */
+    uint32_t rx_fifo_overflows;     /* UART RX FIFO overflows */
+    uint32_t idle_flushes;          /* Partial RX buffers sent on receive idle */
+    uint32_t tx_ring_high_water;    /* Most tx_ring slots in use */
+    uint32_t rx_queue_high_water;   /* Most bytes in rx_queue */
+    uint32_t in_zlps;               /* Zero-length packets ending an IN transfer */
+    uint32_t out_frames;            /* Frames encoded onto UART TX in FRAME_MODE */
+    uint32_t in_frames;             /* Frames decoded from UART RX in FRAME_MODE */
+    uint32_t in_frame_errors;       /* Decoded frames that were malformed or merged with the next one */
+    uint32_t rs485_echo_bytes;      /* Echo of our own bytes dropped from UART RX in RS-485 mode */
+    uint32_t rx_frame_errors;       /* UART RX framing errors, breaks excluded */
+    uint32_t rx_parity_errors;      /* UART RX parity errors */
+    uint32_t rx_breaks;             /* Breaks detected on UART RX */
+    uint32_t serial_states;         /* CDC SERIAL_STATE notifications sent */
+    uint32_t breaks_sent;           /* Breaks sent on UART TX for CDC SEND_BREAK */
+    uint32_t sniff_records;         /* Records sent in SNIFFER_MODE */
+    uint32_t sniff_bytes;           /* Captured bytes sent in SNIFFER_MODE */
+    uint32_t sniff_dropped_records; /* Records dropped in SNIFFER_MODE because the host fell behind */
+    uint32_t sniff_dropped_bytes;   /* Captured bytes in the dropped records */
+    stats_timing_t isr[STATS_ISR_COUNT];
+    stats_timing_t out_latency;     /* EP3 packet arrival to its last byte written to the UART TX FIFO */
+    stats_timing_t rs485_turnaround; /* UART TX done interrupt to release of the RS-485 driver, guard included */
+    stats_timing_t work_latency;    /* Work item posted to the start of its handler in the bottom half */
+    stats_timing_t serial_state_latency; /* UART line event to its SERIAL_STATE notification */
+    uint32_t pool_blocks;           /* POOL_BLOCKS */
+    uint32_t pool_block_size;       /* POOL_BLOCK_SIZE */
+    stats_pool_t pool[POOL_DIRS];   /* By pool_dir_t: OUT, then IN */
+    uint32_t usb_link_downs;        /* Configuration lost to a bus reset or to the host */
+    stats_connect_t boot;           /* From power-on, not cleared by a reset */
+    stats_connect_t replug;         /* From the last link down, not cleared by a reset */
+    uint32_t ports;                 /* BRIDGE_PORTS, entries in port */
+    stats_port_t port[BRIDGE_PORTS]; /* Throughput per bridge port, the totals above cover all ports */
+} bridge_stats_t;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void stats_init(void);
+void stats_task(void);
+uint32_t stats_now(void);
+uint32_t stats_isr_start(stats_isr_t isr);
+void stats_isr_done(stats_isr_t isr, uint32_t start);
+void stats_out_received(uint32_t port, uint32_t slot, uint32_t length, uint32_t slots_used);
+void stats_out_sent(uint32_t port, uint32_t slot);
+void stats_out_paused(uint32_t port);
+void stats_in_queued(uint32_t port, uint32_t length, uint32_t queue_level);
+void stats_in_sent(uint32_t port, uint32_t length, bool from_queue);
+void stats_ep_stall(void);
+void stats_rx_fifo_overflow(void);
+void stats_idle_flush(void);
+void stats_out_frame(void);
+void stats_in_frame(bool valid);
+void stats_rs485_echo(uint32_t length);
+void stats_rs485_turnaround(uint32_t start);
+void stats_work_latency(uint32_t posted);
+void stats_rx_line_error(uint32_t rx_status);
+void stats_serial_state_sent(uint32_t event_time);
+void stats_break_sent(void);
+void stats_sniffed(uint32_t length);
+void stats_sniff_dropped(uint32_t length);
+void stats_pool_level(pool_dir_t dir, uint32_t in_use);
+void stats_pool_denied(pool_dir_t dir);
+void stats_usb_link_down(void);
+void stats_usb_configured(void);
+const uint8_t *stats_snapshot(uint32_t *length);
+void stats_request_reset(void);
+
+
+#endif /* STATS_H_ */
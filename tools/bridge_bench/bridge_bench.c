@@ -0,0 +1,932 @@
+/******************************************************************************
+* File Name: bridge_bench.c
+*
+* Description: Host-side benchmark for the USB-UART bridge. Streams a pattern
+*              through the CDC ACM port with UART TX wired to RX and measures
+*              throughput, round-trip latency and data integrity
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+#define CHUNK_MAX               (65536u)
+
+/* Written chunks whose round trip is still being timed */
+#define RECORD_SLOTS            (65536u)
+
+/* Latency samples kept for the percentiles */
+#define SAMPLES_MAX             (4u * 1024u * 1024u)
+
+/* Time the reader waits for the last bytes after the writer has stopped */
+#define DRAIN_TIMEOUT_MS        (1000u)
+
+
+/*******************************************************************************
+*            Enumerated Types and Structures
+*******************************************************************************/
+typedef enum
+{
+    PATTERN_COUNTER,
+    PATTERN_PRBS15,
+    PATTERN_ZEROS,
+    PATTERN_ONES,
+    PATTERN_ALTERNATING
+} pattern_type_t;
+
+/* Byte stream generator. The reader runs a second copy to check the data. */
+typedef struct
+{
+    pattern_type_t type;
+    uint64_t offset;
+    uint32_t lfsr;
+} pattern_t;
+
+/* End offset of a written chunk and the time its write started */
+typedef struct
+{
+    uint64_t end;
+    uint64_t time_ns;
+} record_t;
+
+typedef struct
+{
+    const char *device;
+    bool pty;
+    uint32_t pty_baud;
+    uint32_t baud;
+    uint32_t chunk;
+    uint32_t window;
+    double duration;
+    pattern_type_t pattern;
+    const char *output;
+} options_t;
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+static options_t opt =
+{
+    .device = NULL,
+    .pty = false,
+    .pty_baud = 0u,
+    .baud = 115200u,
+    .chunk = 64u,
+    .window = 4096u,
+    .duration = 10.0,
+    .pattern = PATTERN_PRBS15,
+    .output = NULL,
+};
+
+static const char *const pattern_names[] =
+{
+    "counter", "prbs15", "zeros", "ones", "alternating"
+};
+
+static int port_fd = -1;
+static int pty_master = -1;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t progress = PTHREAD_COND_INITIALIZER;
+
+/* Shared between the writer and the reader, protected by lock */
+static uint64_t tx_bytes;
+static uint64_t rx_bytes;
+static bool writer_done;
+static bool reader_done;
+static record_t records[RECORD_SLOTS];
+static uint32_t record_head;
+static uint32_t record_count;
+
+/* Owned by the reader */
+static uint64_t rx_errors;
+static int64_t first_error_offset = -1;
+static uint32_t *samples;
+static uint32_t sample_count;
+static uint32_t sample_capacity;
+
+static uint64_t start_ns;
+static uint64_t tx_end_ns;
+static uint64_t rx_end_ns;
+
+
+/*******************************************************************************
+* Function Name: now_ns
+********************************************************************************
+*
+* Summary:
+*  Returns the monotonic time.
+*
+* Return:
+*  uint64_t: time in nanoseconds
+*
+*******************************************************************************/
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+}
+
+/*******************************************************************************
+* Function Name: pattern_init
+********************************************************************************
+*
+* Summary:
+*  Starts a pattern at offset 0.
+*
+* Parameters:
+*  pattern: generator to initialize
+*  type: pattern to generate
+*
+*******************************************************************************/
+static void pattern_init(pattern_t *pattern, pattern_type_t type)
+{
+    pattern->type = type;
+    pattern->offset = 0u;
+    pattern->lfsr = 0x7FFFu;
+}
+
+/*******************************************************************************
+* Function Name: pattern_fill
+********************************************************************************
+*
+* Summary:
+*  Writes the next bytes of the pattern. PRBS-15 uses x^15 + x^14 + 1, sent
+*  LSB first, the same sequence as the firmware self-test.
+*
+* Parameters:
+*  pattern: generator
+*  data: buffer to fill
+*  length: number of bytes
+*
+*******************************************************************************/
+static void pattern_fill(pattern_t *pattern, uint8_t *data, size_t length)
+{
+    size_t index;
+    uint32_t bit;
+    uint32_t shift;
+    uint32_t byte;
+
+    for (index = 0u; index < length; index++)
+    {
+        switch (pattern->type)
+        {
+            case PATTERN_COUNTER:
+                byte = (uint32_t) (pattern->offset & 0xFFu);
+                break;
+
+            case PATTERN_PRBS15:
+                byte = 0u;
+                for (shift = 0u; shift < 8u; shift++)
+                {
+                    bit = ((pattern->lfsr >> 14u) ^ (pattern->lfsr >> 13u)) & 1u;
+                    pattern->lfsr = ((pattern->lfsr << 1u) | bit) & 0x7FFFu;
+                    byte |= bit << shift;
+                }
+                break;
+
+            case PATTERN_ZEROS:
+                byte = 0x00u;
+                break;
+
+            case PATTERN_ONES:
+                byte = 0xFFu;
+                break;
+
+            default:
+                byte = ((pattern->offset & 1u) == 0u) ? 0x55u : 0xAAu;
+                break;
+        }
+        data[index] = (uint8_t) byte;
+        pattern->offset++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: baud_constant
+********************************************************************************
+*
+* Summary:
+*  Maps a baud rate to its termios speed constant.
+*
+* Parameters:
+*  baud: baud rate
+*
+* Return:
+*  speed_t: termios constant, B0 if the rate is not supported
+*
+*******************************************************************************/
+static speed_t baud_constant(uint32_t baud)
+{
+    static const struct
+    {
+        uint32_t baud;
+        speed_t speed;
+    } rates[] =
+    {
+        { 9600u, B9600 }, { 19200u, B19200 }, { 38400u, B38400 }, { 57600u, B57600 },
+        { 115200u, B115200 }, { 230400u, B230400 }, { 460800u, B460800 }, { 500000u, B500000 },
+        { 921600u, B921600 }, { 1000000u, B1000000 }, { 1500000u, B1500000 },
+        { 2000000u, B2000000 }, { 3000000u, B3000000 }, { 4000000u, B4000000 },
+    };
+    size_t index;
+
+    for (index = 0u; index < (sizeof(rates) / sizeof(rates[0])); index++)
+    {
+        if (rates[index].baud == baud)
+        {
+            return rates[index].speed;
+        }
+    }
+
+    return B0;
+}
+
+/*******************************************************************************
+* Function Name: open_port
+********************************************************************************
+*
+* Summary:
+*  Opens the tty in raw mode. On the CDC ACM port the baud rate becomes the
+*  SET_LINE_CODING request that reconfigures the bridge UART.
+*
+* Parameters:
+*  path: tty to open
+*
+* Return:
+*  int: file descriptor, -1 on error
+*
+*******************************************************************************/
+static int open_port(const char *path)
+{
+    struct termios tio;
+    speed_t speed = baud_constant(opt.baud);
+    int fd;
+
+    if (speed == B0)
+    {
+        fprintf(stderr, "unsupported baud rate %u\n", opt.baud);
+        return -1;
+    }
+
+    fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (tcgetattr(fd, &tio) != 0)
+    {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+
+    return fd;
+}
+
+/*******************************************************************************
+* Function Name: pty_echo_thread
+********************************************************************************
+*
+* Summary:
+*  Stand-in for the bridge with UART TX wired to RX: echoes everything written
+*  to the pseudo-terminal back to it, optionally limited to the byte rate of
+*  a UART at pty_baud with 8N1 framing.
+*
+*******************************************************************************/
+static void *pty_echo_thread(void *arg)
+{
+    uint8_t buffer[4096];
+    uint64_t next_ns = 0u;
+    uint64_t now;
+    ssize_t length;
+    ssize_t written;
+    ssize_t result;
+    struct timespec delay;
+
+    (void) arg;
+
+    for (;;)
+    {
+        length = read(pty_master, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            if ((length < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            break;
+        }
+
+        if (opt.pty_baud != 0u)
+        {
+            now = now_ns();
+            if (next_ns < now)
+            {
+                next_ns = now;
+            }
+            next_ns += ((uint64_t) length * 10u * 1000000000u) / opt.pty_baud;
+            delay.tv_sec = (time_t) ((next_ns - now) / 1000000000u);
+            delay.tv_nsec = (long) ((next_ns - now) % 1000000000u);
+            nanosleep(&delay, NULL);
+        }
+
+        for (written = 0; written < length; written += result)
+        {
+            result = write(pty_master, &buffer[written], (size_t) (length - written));
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                {
+                    result = 0;
+                    continue;
+                }
+                return NULL;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: open_pty
+********************************************************************************
+*
+* Summary:
+*  Creates a pseudo-terminal with an echo thread on its master side.
+*
+* Parameters:
+*  thread: returns the echo thread
+*
+* Return:
+*  const char *: path of the slave tty, NULL on error
+*
+*******************************************************************************/
+static const char *open_pty(pthread_t *thread)
+{
+    const char *path;
+
+    pty_master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((pty_master < 0) || (grantpt(pty_master) != 0) || (unlockpt(pty_master) != 0))
+    {
+        fprintf(stderr, "pty: %s\n", strerror(errno));
+        return NULL;
+    }
+
+    path = ptsname(pty_master);
+    if ((path == NULL) || (pthread_create(thread, NULL, pty_echo_thread, NULL) != 0))
+    {
+        fprintf(stderr, "pty: %s\n", strerror(errno));
+        return NULL;
+    }
+
+    return path;
+}
+
+/*******************************************************************************
+* Function Name: add_sample
+********************************************************************************
+*
+* Summary:
+*  Stores a round-trip latency sample.
+*
+* Parameters:
+*  latency_ns: latency in nanoseconds
+*
+*******************************************************************************/
+static void add_sample(uint64_t latency_ns)
+{
+    uint32_t *grown;
+    uint64_t latency_us = latency_ns / 1000u;
+
+    if (sample_count == sample_capacity)
+    {
+        if (sample_capacity == SAMPLES_MAX)
+        {
+            return;
+        }
+        sample_capacity = (sample_capacity == 0u) ? 4096u : (sample_capacity * 2u);
+        grown = realloc(samples, sample_capacity * sizeof(samples[0]));
+        if (grown == NULL)
+        {
+            sample_capacity = sample_count;
+            return;
+        }
+        samples = grown;
+    }
+
+    samples[sample_count++] = (latency_us > UINT32_MAX) ? UINT32_MAX : (uint32_t) latency_us;
+}
+
+/*******************************************************************************
+* Function Name: writer_thread
+********************************************************************************
+*
+* Summary:
+*  Streams the pattern in chunks of opt.chunk bytes for opt.duration seconds,
+*  keeping at most opt.window bytes in flight.
+*
+*******************************************************************************/
+static void *writer_thread(void *arg)
+{
+    static uint8_t chunk[CHUNK_MAX];
+    pattern_t pattern;
+    uint64_t deadline = start_ns + (uint64_t) (opt.duration * 1e9);
+    uint64_t time_ns;
+    size_t written;
+    ssize_t result;
+
+    (void) arg;
+
+    pattern_init(&pattern, opt.pattern);
+
+    while (now_ns() < deadline)
+    {
+        pthread_mutex_lock(&lock);
+        while (!reader_done && (((tx_bytes - rx_bytes) + opt.chunk > opt.window) ||
+                                (record_count == RECORD_SLOTS)))
+        {
+            pthread_cond_wait(&progress, &lock);
+        }
+        if (reader_done)
+        {
+            pthread_mutex_unlock(&lock);
+            break;
+        }
+        pthread_mutex_unlock(&lock);
+
+        pattern_fill(&pattern, chunk, opt.chunk);
+        time_ns = now_ns();
+
+        pthread_mutex_lock(&lock);
+        records[(record_head + record_count) % RECORD_SLOTS].end = tx_bytes + opt.chunk;
+        records[(record_head + record_count) % RECORD_SLOTS].time_ns = time_ns;
+        record_count++;
+        pthread_mutex_unlock(&lock);
+
+        for (written = 0u; written < opt.chunk; written += (size_t) result)
+        {
+            result = write(port_fd, &chunk[written], opt.chunk - written);
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                {
+                    result = 0;
+                    continue;
+                }
+                fprintf(stderr, "write: %s\n", strerror(errno));
+                goto done;
+            }
+        }
+
+        pthread_mutex_lock(&lock);
+        tx_bytes += opt.chunk;
+        pthread_mutex_unlock(&lock);
+    }
+
+done:
+    pthread_mutex_lock(&lock);
+    tx_end_ns = now_ns();
+    writer_done = true;
+    pthread_cond_broadcast(&progress);
+    pthread_mutex_unlock(&lock);
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: reader_thread
+********************************************************************************
+*
+* Summary:
+*  Receives the looped-back data, checks it against a second copy of the
+*  pattern and times the round trip of every chunk.
+*
+*******************************************************************************/
+static void *reader_thread(void *arg)
+{
+    static uint8_t buffer[CHUNK_MAX];
+    static uint8_t expected[CHUNK_MAX];
+    pattern_t pattern;
+    struct pollfd pfd = { .fd = port_fd, .events = POLLIN };
+    uint64_t drain_start = 0u;
+    uint64_t time_ns;
+    uint64_t received;
+    ssize_t length;
+    ssize_t index;
+    bool stop = false;
+
+    (void) arg;
+
+    pattern_init(&pattern, opt.pattern);
+
+    while (!stop)
+    {
+        if ((poll(&pfd, 1, 10) > 0) && ((length = read(port_fd, buffer, sizeof(buffer))) > 0))
+        {
+            time_ns = now_ns();
+            pattern_fill(&pattern, expected, (size_t) length);
+            for (index = 0; index < length; index++)
+            {
+                if (buffer[index] != expected[index])
+                {
+                    if (first_error_offset < 0)
+                    {
+                        first_error_offset = (int64_t) (pattern.offset - (uint64_t) length) + index;
+                    }
+                    rx_errors++;
+                }
+            }
+
+            pthread_mutex_lock(&lock);
+            rx_bytes += (uint64_t) length;
+            received = rx_bytes;
+            while ((record_count != 0u) && (records[record_head].end <= received))
+            {
+                add_sample(time_ns - records[record_head].time_ns);
+                record_head = (record_head + 1u) % RECORD_SLOTS;
+                record_count--;
+            }
+            rx_end_ns = time_ns;
+            pthread_cond_broadcast(&progress);
+            pthread_mutex_unlock(&lock);
+        }
+
+        pthread_mutex_lock(&lock);
+        if (writer_done)
+        {
+            if (rx_bytes >= tx_bytes)
+            {
+                stop = true;
+            }
+            else if (drain_start == 0u)
+            {
+                drain_start = now_ns();
+            }
+            else if ((now_ns() - drain_start) > (DRAIN_TIMEOUT_MS * 1000000u))
+            {
+                stop = true;
+            }
+        }
+        pthread_mutex_unlock(&lock);
+    }
+
+    pthread_mutex_lock(&lock);
+    reader_done = true;
+    pthread_cond_broadcast(&progress);
+    pthread_mutex_unlock(&lock);
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: compare_u32
+********************************************************************************
+*
+* Summary:
+*  qsort comparison of two latency samples.
+*
+*******************************************************************************/
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *) a;
+    uint32_t y = *(const uint32_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*******************************************************************************
+* Function Name: percentile
+********************************************************************************
+*
+* Summary:
+*  Returns a percentile of the sorted latency samples.
+*
+* Parameters:
+*  permille: percentile in 1/1000, for example 999 for p99.9
+*
+* Return:
+*  uint32_t: latency in microseconds, 0 without samples
+*
+*******************************************************************************/
+static uint32_t percentile(uint32_t permille)
+{
+    uint64_t rank;
+
+    if (sample_count == 0u)
+    {
+        return 0u;
+    }
+
+    rank = (((uint64_t) sample_count * permille) + 999u) / 1000u;
+
+    return samples[(rank == 0u) ? 0u : (rank - 1u)];
+}
+
+/*******************************************************************************
+* Function Name: rate
+********************************************************************************
+*
+* Summary:
+*  Returns bytes per second over a time span.
+*
+*******************************************************************************/
+static double rate(uint64_t bytes, uint64_t end_ns)
+{
+    return (end_ns > start_ns) ? ((double) bytes * 1e9) / (double) (end_ns - start_ns) : 0.0;
+}
+
+/*******************************************************************************
+* Function Name: write_results
+********************************************************************************
+*
+* Summary:
+*  Writes the results as one JSON object.
+*
+* Parameters:
+*  out: stream to write to
+*  device: tty that was tested
+*
+*******************************************************************************/
+static void write_results(FILE *out, const char *device)
+{
+    fprintf(out, "{\n");
+    fprintf(out, "  \"device\": \"%s\",\n", device);
+    fprintf(out, "  \"backend\": \"%s\",\n", opt.pty ? "pty" : "tty");
+    fprintf(out, "  \"baud\": %u,\n", opt.baud);
+    fprintf(out, "  \"pattern\": \"%s\",\n", pattern_names[opt.pattern]);
+    fprintf(out, "  \"chunk_bytes\": %u,\n", opt.chunk);
+    fprintf(out, "  \"window_bytes\": %u,\n", opt.window);
+    fprintf(out, "  \"duration_s\": %.3f,\n", (double) (tx_end_ns - start_ns) / 1e9);
+    fprintf(out, "  \"tx_bytes\": %llu,\n", (unsigned long long) tx_bytes);
+    fprintf(out, "  \"rx_bytes\": %llu,\n", (unsigned long long) rx_bytes);
+    fprintf(out, "  \"tx_bytes_per_s\": %.0f,\n", rate(tx_bytes, tx_end_ns));
+    fprintf(out, "  \"rx_bytes_per_s\": %.0f,\n", rate(rx_bytes, rx_end_ns));
+    fprintf(out, "  \"lost_bytes\": %llu,\n", (unsigned long long) ((tx_bytes > rx_bytes) ? (tx_bytes - rx_bytes) : 0u));
+    fprintf(out, "  \"byte_errors\": %llu,\n", (unsigned long long) rx_errors);
+    fprintf(out, "  \"first_error_offset\": %lld,\n", (long long) first_error_offset);
+    fprintf(out, "  \"latency_us\": {\n");
+    fprintf(out, "    \"samples\": %u,\n", sample_count);
+    fprintf(out, "    \"min\": %u,\n", (sample_count == 0u) ? 0u : samples[0]);
+    fprintf(out, "    \"p50\": %u,\n", percentile(500u));
+    fprintf(out, "    \"p99\": %u,\n", percentile(990u));
+    fprintf(out, "    \"p999\": %u,\n", percentile(999u));
+    fprintf(out, "    \"max\": %u\n", (sample_count == 0u) ? 0u : samples[sample_count - 1u]);
+    fprintf(out, "  }\n");
+    fprintf(out, "}\n");
+}
+
+/*******************************************************************************
+* Function Name: usage
+********************************************************************************
+*
+* Summary:
+*  Prints the command line help.
+*
+*******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s (-d TTY | --pty) [options]\n"
+            "  -d, --device TTY     CDC ACM port of the bridge, UART TX wired to RX\n"
+            "      --pty            test against a local pseudo-terminal that echoes\n"
+            "      --pty-baud RATE  limit the pseudo-terminal echo to a UART at RATE\n"
+            "  -b, --baud RATE      line coding sent to the bridge (default 115200)\n"
+            "  -s, --size BYTES     bytes per write (default 64)\n"
+            "  -w, --window BYTES   most bytes in flight (default 4096); set to --size\n"
+            "                       to time single round trips\n"
+            "  -t, --time SECONDS   test duration (default 10)\n"
+            "  -p, --pattern NAME   counter, prbs15, zeros, ones or alternating\n"
+            "  -o, --output FILE    write the JSON results to FILE instead of stdout\n",
+            name);
+}
+
+/*******************************************************************************
+* Function Name: parse_options
+********************************************************************************
+*
+* Summary:
+*  Parses the command line into opt.
+*
+* Return:
+*  bool: false if the command line is invalid
+*
+*******************************************************************************/
+static bool parse_options(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "device", required_argument, NULL, 'd' },
+        { "pty", no_argument, NULL, 'P' },
+        { "pty-baud", required_argument, NULL, 'R' },
+        { "baud", required_argument, NULL, 'b' },
+        { "size", required_argument, NULL, 's' },
+        { "window", required_argument, NULL, 'w' },
+        { "time", required_argument, NULL, 't' },
+        { "pattern", required_argument, NULL, 'p' },
+        { "output", required_argument, NULL, 'o' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    size_t index;
+    bool found;
+    int c;
+
+    while ((c = getopt_long(argc, argv, "d:b:s:w:t:p:o:h", long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'd':
+                opt.device = optarg;
+                break;
+
+            case 'P':
+                opt.pty = true;
+                break;
+
+            case 'R':
+                opt.pty_baud = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            case 'b':
+                opt.baud = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                opt.chunk = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            case 'w':
+                opt.window = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            case 't':
+                opt.duration = strtod(optarg, NULL);
+                break;
+
+            case 'p':
+                found = false;
+                for (index = 0u; index < (sizeof(pattern_names) / sizeof(pattern_names[0])); index++)
+                {
+                    if (strcmp(optarg, pattern_names[index]) == 0)
+                    {
+                        opt.pattern = (pattern_type_t) index;
+                        found = true;
+                    }
+                }
+                if (!found)
+                {
+                    fprintf(stderr, "unknown pattern %s\n", optarg);
+                    return false;
+                }
+                break;
+
+            case 'o':
+                opt.output = optarg;
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    if ((opt.pty == (opt.device != NULL)) || (opt.chunk == 0u) || (opt.chunk > CHUNK_MAX) ||
+        (opt.window < opt.chunk) || (opt.duration <= 0.0))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    pthread_t echo;
+    pthread_t writer;
+    pthread_t reader;
+    const char *device;
+    FILE *out = stdout;
+
+    if (!parse_options(argc, argv))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    device = opt.pty ? open_pty(&echo) : opt.device;
+    if (device == NULL)
+    {
+        return 1;
+    }
+
+    port_fd = open_port(device);
+    if (port_fd < 0)
+    {
+        return 1;
+    }
+
+    start_ns = now_ns();
+    rx_end_ns = start_ns;
+    if ((pthread_create(&reader, NULL, reader_thread, NULL) != 0) ||
+        (pthread_create(&writer, NULL, writer_thread, NULL) != 0))
+    {
+        fprintf(stderr, "pthread_create failed\n");
+        return 1;
+    }
+    pthread_join(writer, NULL);
+    pthread_join(reader, NULL);
+
+    qsort(samples, sample_count, sizeof(samples[0]), compare_u32);
+
+    if (opt.output != NULL)
+    {
+        out = fopen(opt.output, "w");
+        if (out == NULL)
+        {
+            fprintf(stderr, "%s: %s\n", opt.output, strerror(errno));
+            return 1;
+        }
+    }
+    write_results(out, device);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    fprintf(stderr, "%s: %.0f B/s out, %.0f B/s in, latency p50 %u us p99 %u us p99.9 %u us, %llu byte errors, %llu lost\n",
+            device, rate(tx_bytes, tx_end_ns), rate(rx_bytes, rx_end_ns), percentile(500u), percentile(990u),
+            percentile(999u), (unsigned long long) rx_errors,
+            (unsigned long long) ((tx_bytes > rx_bytes) ? (tx_bytes - rx_bytes) : 0u));
+
+    close(port_fd);
+
+    return ((rx_errors == 0u) && (rx_bytes >= tx_bytes)) ? 0 : 1;
+}
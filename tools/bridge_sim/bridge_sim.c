@@ -0,0 +1,1015 @@
+/******************************************************************************
+* File Name: bridge_sim.c
+*
+* Description: Host simulation of the USB-UART bridge. Runs the firmware
+*              sources against the device model of tools/host_pdl, every UART
+*              TX wired to its RX, and checks a pattern streamed per CDC port
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_pdl.h"
+#include "cy_usb_dev_cdc.h"
+#include "usb_uart_config.h"
+#include "stats.h"
+
+/* The firmware is built with main renamed to bridge_main, this file keeps
+ * the process entry */
+#undef main
+
+#if (SNIFFER_MODE != 0u) || (UART_RS485 != 0u)
+#error "bridge_sim checks looped-back data: SNIFFER_MODE sends records and UART_RS485 drops its own echo"
+#endif
+
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+#define CHUNK_MAX               (65536u)
+#define WINDOW_MAX              (65536u)
+
+/* OUT packets whose round trip is still being timed, one per byte at most */
+#define RECORD_SLOTS            (WINDOW_MAX)
+
+/* Latency samples kept for the percentiles */
+#define SAMPLES_MAX             (4u * 1024u * 1024u)
+
+#define PACKET_SIZE             (CY_USB_DEV_EP_BUF_SIZE)
+
+/* Full-speed bus timing in CPU cycles of the model. A transaction with n data
+ * bytes takes about n + 13 byte times at 12 Mbit/s with token, CRC, handshake
+ * and bit stuffing; an IN transaction the device NAKs takes about 6. An OUT
+ * transaction that is NAKed has sent its data all the same. */
+#define BUS_BYTE_CYCLES         (SIM_CLK_HZ / 1500000u)
+#define TRANSACTION_CYCLES(n)   (((uint64_t) (n) + 13u) * BUS_BYTE_CYCLES)
+#define NAK_CYCLES              (6u * BUS_BYTE_CYCLES)
+
+/* The host schedules bulk transactions in the first 90% of each frame */
+#define FRAME_CYCLES            (SIM_US(1000u))
+#define FRAME_BULK_CYCLES       (SIM_US(900u))
+
+/* Time before the host starts enumeration, once the firmware has booted */
+#define ATTACH_CYCLES           (SIM_US(10000u))
+
+/* Vendor request of the bridge firmware, see stats.h */
+#define SETUP_VENDOR_IN(request, length) \
+    { { CY_USB_DEV_DIR_DEVICE_TO_HOST, CY_USB_DEV_VENDOR_TYPE, CY_USB_DEV_RECIPIENT_DEVICE }, (request), 0u, 0u, (length) }
+
+
+/*******************************************************************************
+*            Enumerated Types and Structures
+*******************************************************************************/
+typedef enum
+{
+    PHASE_ATTACH,
+    PHASE_SETUP,
+    PHASE_STREAM,
+    PHASE_STATS,
+} phase_t;
+
+/* PRBS-15 byte stream. The IN side runs a second copy to check the data. */
+typedef struct
+{
+    uint64_t offset;
+    uint32_t lfsr;
+} pattern_t;
+
+/* End offset of an OUT packet and the time the host got its ACK */
+typedef struct
+{
+    uint64_t end;
+    uint64_t time;
+} record_t;
+
+/* Host side of one CDC ACM port */
+typedef struct
+{
+    uint32_t comm_interface;
+    uint32_t notification;
+    uint32_t ep_in;
+    uint32_t ep_out;
+    pattern_t out_pattern;
+    pattern_t in_pattern;
+    uint8_t packet[PACKET_SIZE];
+    uint32_t packet_length;         /* Packet being sent, 0 if none */
+    uint32_t write_left;            /* Bytes left of the current write */
+    uint64_t generated;             /* Bytes put into packets */
+    uint64_t tx_bytes;              /* Bytes the device has ACKed */
+    uint64_t rx_bytes;
+    uint64_t rx_end;
+    uint64_t errors;
+    int64_t first_error_offset;
+    uint32_t serial_states;
+    record_t records[RECORD_SLOTS];
+    uint32_t record_head;
+    uint32_t record_count;
+} host_port_t;
+
+typedef struct
+{
+    uint32_t baud;
+    uint32_t bytes;
+    uint32_t chunk;
+    uint32_t window;
+    uint32_t timeout_ms;
+    const char *output;
+} options_t;
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+static options_t opt =
+{
+    .baud = 1000000u,
+    .bytes = 65536u,
+    .chunk = 4096u,
+    .window = 4096u,
+    .timeout_ms = 10000u,
+    .output = NULL,
+};
+
+static host_port_t ports[BRIDGE_PORTS];
+
+static phase_t phase = PHASE_ATTACH;
+static uint32_t setup_step;
+static uint8_t control_buffer[CY_USB_DEV_CDC_LINE_CODING_SIZE];
+static bridge_stats_t device_stats;
+static bool device_stats_valid;
+
+static uint64_t frame_time;
+static uint32_t bulk_next;
+
+static uint64_t start_time;
+static uint64_t end_time;
+static uint64_t start_sleep;
+static uint64_t end_sleep;
+static uint32_t start_irqs[SIM_IRQS];
+static uint32_t end_irqs[SIM_IRQS];
+static bool timed_out;
+
+static uint32_t *samples;
+static uint32_t sample_count;
+static uint32_t sample_capacity;
+
+
+/*******************************************************************************
+*            Function Prototypes
+*******************************************************************************/
+extern int bridge_main(void);
+
+static void bus_run(void);
+
+
+/*******************************************************************************
+* Function Name: pattern_init
+********************************************************************************
+*
+* Summary:
+*  Starts a PRBS-15 stream at offset 0, each port from its own seed so that
+*  data crossing to the wrong port is caught.
+*
+* Parameters:
+*  pattern: generator to initialize
+*  seed: non-zero 15-bit start value
+*
+*******************************************************************************/
+static void pattern_init(pattern_t *pattern, uint32_t seed)
+{
+    pattern->offset = 0u;
+    pattern->lfsr = seed & 0x7FFFu;
+}
+
+/*******************************************************************************
+* Function Name: pattern_fill
+********************************************************************************
+*
+* Summary:
+*  Writes the next bytes of the stream, x^15 + x^14 + 1 sent LSB first as in
+*  bridge_bench.
+*
+* Parameters:
+*  pattern: generator
+*  data: buffer to fill
+*  length: number of bytes
+*
+*******************************************************************************/
+static void pattern_fill(pattern_t *pattern, uint8_t *data, uint32_t length)
+{
+    uint32_t index;
+    uint32_t bit;
+    uint32_t shift;
+    uint32_t byte;
+
+    for (index = 0u; index < length; index++)
+    {
+        byte = 0u;
+        for (shift = 0u; shift < 8u; shift++)
+        {
+            bit = ((pattern->lfsr >> 14u) ^ (pattern->lfsr >> 13u)) & 1u;
+            pattern->lfsr = ((pattern->lfsr << 1u) | bit) & 0x7FFFu;
+            byte |= bit << shift;
+        }
+        data[index] = (uint8_t) byte;
+        pattern->offset++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: add_sample
+********************************************************************************
+*
+* Summary:
+*  Stores a round-trip latency sample.
+*
+* Parameters:
+*  cycles: latency in CPU cycles of the model
+*
+*******************************************************************************/
+static void add_sample(uint64_t cycles)
+{
+    uint32_t *grown;
+    uint64_t latency_us = cycles / SIM_US(1u);
+
+    if (sample_count == sample_capacity)
+    {
+        if (sample_capacity == SAMPLES_MAX)
+        {
+            return;
+        }
+        sample_capacity = (sample_capacity == 0u) ? 4096u : (sample_capacity * 2u);
+        grown = realloc(samples, sample_capacity * sizeof(samples[0]));
+        if (grown == NULL)
+        {
+            sample_capacity = sample_count;
+            return;
+        }
+        samples = grown;
+    }
+
+    samples[sample_count++] = (latency_us > UINT32_MAX) ? UINT32_MAX : (uint32_t) latency_us;
+}
+
+/*******************************************************************************
+* Function Name: compare_u32
+********************************************************************************
+*
+* Summary:
+*  qsort comparison of two latency samples.
+*
+*******************************************************************************/
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *) a;
+    uint32_t y = *(const uint32_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*******************************************************************************
+* Function Name: percentile
+********************************************************************************
+*
+* Summary:
+*  Returns a percentile of the sorted latency samples.
+*
+* Parameters:
+*  permille: percentile in 1/1000, for example 999 for p99.9
+*
+* Return:
+*  uint32_t: latency in microseconds, 0 without samples
+*
+*******************************************************************************/
+static uint32_t percentile(uint32_t permille)
+{
+    uint64_t rank;
+
+    if (sample_count == 0u)
+    {
+        return 0u;
+    }
+
+    rank = (((uint64_t) sample_count * permille) + 999u) / 1000u;
+
+    return samples[(rank == 0u) ? 0u : (rank - 1u)];
+}
+
+/*******************************************************************************
+* Function Name: port_out
+********************************************************************************
+*
+* Summary:
+*  Sends the next OUT packet of a port. The pattern is cut into writes of
+*  opt.chunk bytes, each sent as full packets and a short last one, with at
+*  most opt.window bytes in flight.
+*
+* Parameters:
+*  port: host port
+*
+* Return:
+*  uint64_t: bus time used, 0 if the port has nothing to send
+*
+*******************************************************************************/
+static uint64_t port_out(host_port_t *port)
+{
+    uint32_t length;
+    record_t *record;
+
+    if (port->packet_length == 0u)
+    {
+        if ((port->generated == opt.bytes) || ((port->generated - port->rx_bytes) >= opt.window) ||
+            (port->record_count == RECORD_SLOTS))
+        {
+            return 0u;
+        }
+        if (port->write_left == 0u)
+        {
+            port->write_left = opt.chunk;
+        }
+
+        length = PACKET_SIZE;
+        if (length > port->write_left)
+        {
+            length = port->write_left;
+        }
+        if (length > (opt.bytes - port->generated))
+        {
+            length = (uint32_t) (opt.bytes - port->generated);
+        }
+        if (length > (opt.window - (port->generated - port->rx_bytes)))
+        {
+            length = (uint32_t) (opt.window - (port->generated - port->rx_bytes));
+        }
+
+        pattern_fill(&port->out_pattern, port->packet, length);
+        port->packet_length = length;
+        port->write_left -= length;
+        port->generated += length;
+    }
+
+    length = port->packet_length;
+    if (sim_usb_out(port->ep_out, port->packet, length))
+    {
+        port->tx_bytes += length;
+        port->packet_length = 0u;
+        record = &port->records[(port->record_head + port->record_count) % RECORD_SLOTS];
+        record->end = port->tx_bytes;
+        record->time = sim_now();
+        port->record_count++;
+    }
+
+    return TRANSACTION_CYCLES(length);
+}
+
+/*******************************************************************************
+* Function Name: port_in
+********************************************************************************
+*
+* Summary:
+*  Polls the IN endpoint of a port, checks the data against the pattern and
+*  times the OUT packets it completes.
+*
+* Parameters:
+*  port: host port
+*
+* Return:
+*  uint64_t: bus time used
+*
+*******************************************************************************/
+static uint64_t port_in(host_port_t *port)
+{
+    uint8_t data[PACKET_SIZE];
+    uint8_t expected[PACKET_SIZE];
+    int32_t length;
+    int32_t index;
+    record_t *record;
+
+    length = sim_usb_in(port->ep_in, data);
+    if (length < 0)
+    {
+        return NAK_CYCLES;
+    }
+
+    if ((port->rx_bytes + (uint64_t) length) > opt.bytes)
+    {
+        /* Anything past the stream is an error, counted without a pattern */
+        port->errors += (uint64_t) length;
+        if (port->first_error_offset < 0)
+        {
+            port->first_error_offset = (int64_t) port->rx_bytes;
+        }
+        return TRANSACTION_CYCLES(length);
+    }
+
+    pattern_fill(&port->in_pattern, expected, (uint32_t) length);
+    for (index = 0; index < length; index++)
+    {
+        if (data[index] != expected[index])
+        {
+            if (port->first_error_offset < 0)
+            {
+                port->first_error_offset = (int64_t) port->rx_bytes + index;
+            }
+            port->errors++;
+        }
+    }
+
+    port->rx_bytes += (uint64_t) length;
+    port->rx_end = sim_now();
+    while (port->record_count != 0u)
+    {
+        record = &port->records[port->record_head];
+        if (record->end > port->rx_bytes)
+        {
+            break;
+        }
+        add_sample(port->rx_end - record->time);
+        port->record_head = (port->record_head + 1u) % RECORD_SLOTS;
+        port->record_count--;
+    }
+
+    return TRANSACTION_CYCLES(length);
+}
+
+/*******************************************************************************
+* Function Name: setup_request
+********************************************************************************
+*
+* Summary:
+*  Starts the control request of an enumeration step: SET_CONFIGURATION, then
+*  SET_LINE_CODING and SET_CONTROL_LINE_STATE with DTR and RTS on every port,
+*  then a reset of the device statistics.
+*
+* Parameters:
+*  step: request to start
+*
+* Return:
+*  bool: false once all steps are done
+*
+*******************************************************************************/
+static bool setup_request(uint32_t step)
+{
+    cy_stc_usb_dev_setup_packet_t setup;
+    host_port_t *port;
+
+    memset(&setup, 0, sizeof(setup));
+    if (step == 0u)
+    {
+        setup.bmRequestType.type = CY_USB_DEV_STANDARD_TYPE;
+        setup.bRequest = CY_USB_DEV_RQST_SET_CONFIGURATION;
+        setup.wValue = 1u;
+    }
+    else if (step <= BRIDGE_PORTS)
+    {
+        port = &ports[step - 1u];
+        setup.bmRequestType.type = CY_USB_DEV_CLASS_TYPE;
+        setup.bmRequestType.recipient = CY_USB_DEV_RECIPIENT_INTERFACE;
+        setup.bRequest = CY_USB_DEV_CDC_RQST_SET_LINE_CODING;
+        setup.wIndex = (uint16_t) port->comm_interface;
+        setup.wLength = CY_USB_DEV_CDC_LINE_CODING_SIZE;
+        control_buffer[0] = (uint8_t) opt.baud;
+        control_buffer[1] = (uint8_t) (opt.baud >> 8u);
+        control_buffer[2] = (uint8_t) (opt.baud >> 16u);
+        control_buffer[3] = (uint8_t) (opt.baud >> 24u);
+        control_buffer[4] = CY_USB_DEV_CDC_STOPBIT_1;
+        control_buffer[5] = CY_USB_DEV_CDC_PARITY_NONE;
+        control_buffer[6] = 8u;
+    }
+    else if (step <= (2u * BRIDGE_PORTS))
+    {
+        port = &ports[step - BRIDGE_PORTS - 1u];
+        setup.bmRequestType.type = CY_USB_DEV_CLASS_TYPE;
+        setup.bmRequestType.recipient = CY_USB_DEV_RECIPIENT_INTERFACE;
+        setup.bRequest = CY_USB_DEV_CDC_RQST_SET_CONTROL_LINE_STATE;
+        setup.wValue = CY_USB_DEV_CDC_LINE_CONTROL_DTR | CY_USB_DEV_CDC_LINE_CONTROL_RTS;
+        setup.wIndex = (uint16_t) port->comm_interface;
+    }
+    else if (step == ((2u * BRIDGE_PORTS) + 1u))
+    {
+        setup.bmRequestType.type = CY_USB_DEV_VENDOR_TYPE;
+        setup.bRequest = STATS_VENDOR_REQ_RESET;
+    }
+    else
+    {
+        return false;
+    }
+
+    sim_usb_control(&setup, control_buffer);
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: stream_start
+********************************************************************************
+*
+* Summary:
+*  Starts the measured part of the run once the bridge is set up.
+*
+*******************************************************************************/
+static void stream_start(void)
+{
+    uint32_t index;
+
+    phase = PHASE_STREAM;
+    start_time = sim_now();
+    start_sleep = sim_sleep_cycles();
+    for (index = 0u; index < SIM_IRQS; index++)
+    {
+        start_irqs[index] = sim_irq_count(index);
+    }
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        ports[index].rx_end = start_time;
+    }
+}
+
+/*******************************************************************************
+* Function Name: stream_done
+********************************************************************************
+*
+* Summary:
+*  Ends the measured part of the run and asks the device for its statistics.
+*
+*******************************************************************************/
+static void stream_done(void)
+{
+    static const cy_stc_usb_dev_setup_packet_t get_stats =
+        SETUP_VENDOR_IN(STATS_VENDOR_REQ_GET, sizeof(bridge_stats_t));
+    uint32_t index;
+
+    end_time = sim_now();
+    end_sleep = sim_sleep_cycles();
+    for (index = 0u; index < SIM_IRQS; index++)
+    {
+        end_irqs[index] = sim_irq_count(index);
+    }
+
+    phase = PHASE_STATS;
+    sim_usb_control(&get_stats, (uint8_t *) &device_stats);
+}
+
+/*******************************************************************************
+* Function Name: write_results
+********************************************************************************
+*
+* Summary:
+*  Writes the results as one JSON object.
+*
+* Parameters:
+*  out: stream to write to
+*
+*******************************************************************************/
+static void write_results(FILE *out)
+{
+    static const char *const isr_names[STATS_ISR_COUNT] =
+    {
+        "dma", "uart", "usb_high", "usb_medium", "usb_low", "dma_work"
+    };
+    uint64_t elapsed = end_time - start_time;
+    uint64_t rx_total = 0u;
+    uint64_t errors = 0u;
+    uint64_t lost = 0u;
+    const stats_timing_t *timing;
+    uint32_t count;
+    uint32_t index;
+    bool first;
+
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        rx_total += ports[index].rx_bytes;
+        errors += ports[index].errors;
+        lost += ports[index].tx_bytes - ((ports[index].rx_bytes < ports[index].tx_bytes) ?
+                                         ports[index].rx_bytes : ports[index].tx_bytes);
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"backend\": \"sim\",\n");
+    fprintf(out, "  \"baud\": %u,\n", opt.baud);
+    fprintf(out, "  \"ports\": %u,\n", BRIDGE_PORTS);
+    fprintf(out, "  \"chunk_bytes\": %u,\n", opt.chunk);
+    fprintf(out, "  \"window_bytes\": %u,\n", opt.window);
+    fprintf(out, "  \"timed_out\": %s,\n", timed_out ? "true" : "false");
+    fprintf(out, "  \"duration_s\": %.6f,\n", (double) elapsed / SIM_CLK_HZ);
+    fprintf(out, "  \"rx_bytes\": %llu,\n", (unsigned long long) rx_total);
+    fprintf(out, "  \"rx_bytes_per_s\": %.0f,\n",
+            (elapsed != 0u) ? ((double) rx_total * SIM_CLK_HZ) / (double) elapsed : 0.0);
+    fprintf(out, "  \"lost_bytes\": %llu,\n", (unsigned long long) lost);
+    fprintf(out, "  \"byte_errors\": %llu,\n", (unsigned long long) errors);
+    fprintf(out, "  \"cpu_busy_permille\": %llu,\n", (unsigned long long) ((elapsed != 0u) ?
+            ((elapsed - (end_sleep - start_sleep)) * 1000u) / elapsed : 0u));
+
+    fprintf(out, "  \"port\": [\n");
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        fprintf(out, "    { \"tx_bytes\": %llu, \"rx_bytes\": %llu, \"byte_errors\": %llu, "
+                "\"first_error_offset\": %lld, \"serial_states\": %u }%s\n",
+                (unsigned long long) ports[index].tx_bytes, (unsigned long long) ports[index].rx_bytes,
+                (unsigned long long) ports[index].errors, (long long) ports[index].first_error_offset,
+                ports[index].serial_states, ((index + 1u) < BRIDGE_PORTS) ? "," : "");
+    }
+    fprintf(out, "  ],\n");
+
+    fprintf(out, "  \"latency_us\": {\n");
+    fprintf(out, "    \"samples\": %u,\n", sample_count);
+    fprintf(out, "    \"min\": %u,\n", (sample_count == 0u) ? 0u : samples[0]);
+    fprintf(out, "    \"p50\": %u,\n", percentile(500u));
+    fprintf(out, "    \"p99\": %u,\n", percentile(990u));
+    fprintf(out, "    \"p999\": %u,\n", percentile(999u));
+    fprintf(out, "    \"max\": %u\n", (sample_count == 0u) ? 0u : samples[sample_count - 1u]);
+    fprintf(out, "  },\n");
+
+    /* Interrupts taken while streaming, and per KB looped back */
+    fprintf(out, "  \"interrupts\": {");
+    first = true;
+    for (index = 0u; index < SIM_IRQS; index++)
+    {
+        count = end_irqs[index] - start_irqs[index];
+        if (count != 0u)
+        {
+            fprintf(out, "%s\n    \"%s\": { \"count\": %u, \"per_kb\": %.2f }", first ? "" : ",",
+                    sim_irq_name(index), count, (rx_total != 0u) ? ((double) count * 1024.0) / (double) rx_total : 0.0);
+            first = false;
+        }
+    }
+    fprintf(out, "\n  },\n");
+
+    fprintf(out, "  \"device\": {\n");
+    fprintf(out, "    \"valid\": %s,\n", device_stats_valid ? "true" : "false");
+    fprintf(out, "    \"out_naks\": %u,\n", device_stats.out_naks);
+    fprintf(out, "    \"in_naks\": %u,\n", device_stats.in_naks);
+    fprintf(out, "    \"in_zlps\": %u,\n", device_stats.in_zlps);
+    fprintf(out, "    \"rx_fifo_overflows\": %u,\n", device_stats.rx_fifo_overflows);
+    fprintf(out, "    \"idle_flushes\": %u,\n", device_stats.idle_flushes);
+    fprintf(out, "    \"tx_ring_high_water\": %u,\n", device_stats.tx_ring_high_water);
+    fprintf(out, "    \"rx_queue_high_water\": %u,\n", device_stats.rx_queue_high_water);
+    fprintf(out, "    \"pool_out_denied\": %u,\n", device_stats.pool[POOL_OUT].denied);
+    fprintf(out, "    \"pool_in_denied\": %u,\n", device_stats.pool[POOL_IN].denied);
+    fprintf(out, "    \"isr_cycles\": {\n");
+    for (index = 0u; index < STATS_ISR_COUNT; index++)
+    {
+        timing = &device_stats.isr[index];
+        fprintf(out, "      \"%s\": { \"count\": %u, \"avg\": %u, \"max\": %u }%s\n", isr_names[index],
+                timing->count, (timing->count != 0u) ? (timing->total_cycles / timing->count) : 0u,
+                timing->max_cycles, ((index + 1u) < STATS_ISR_COUNT) ? "," : "");
+    }
+    fprintf(out, "    }\n");
+    fprintf(out, "  }\n");
+    fprintf(out, "}\n");
+}
+
+/*******************************************************************************
+* Function Name: finish
+********************************************************************************
+*
+* Summary:
+*  Writes the results and ends the process, as the firmware never returns.
+*  The run fails on a timeout, on wrong or lost data, on an RX FIFO overflow
+*  or if the statistics could not be read.
+*
+*******************************************************************************/
+static void finish(void)
+{
+    FILE *out = stdout;
+    uint64_t errors = 0u;
+    uint32_t index;
+    bool passed;
+
+    qsort(samples, sample_count, sizeof(samples[0]), compare_u32);
+
+    passed = !timed_out && device_stats_valid && (device_stats.rx_fifo_overflows == 0u);
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        errors += ports[index].errors;
+        passed = passed && (ports[index].errors == 0u) && (ports[index].rx_bytes == opt.bytes);
+    }
+
+    if (opt.output != NULL)
+    {
+        out = fopen(opt.output, "w");
+        if (out == NULL)
+        {
+            perror(opt.output);
+            exit(1);
+        }
+    }
+    write_results(out);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    fprintf(stderr, "%s: %u port(s) at %u baud, %.0f B/s per port, p99 %u us, %llu byte errors%s\n",
+            passed ? "PASS" : "FAIL", BRIDGE_PORTS, opt.baud,
+            (end_time > start_time) ? ((double) opt.bytes * SIM_CLK_HZ) / (double) (end_time - start_time) : 0.0,
+            percentile(990u), (unsigned long long) errors, timed_out ? ", timed out" : "");
+
+    exit(passed ? 0 : 1);
+}
+
+/*******************************************************************************
+* Function Name: frame_start
+********************************************************************************
+*
+* Summary:
+*  Starts a bus frame: sends the SOF, moves the control requests on and polls
+*  the notification endpoints.
+*
+* Return:
+*  uint64_t: bus time used
+*
+*******************************************************************************/
+static uint64_t frame_start(void)
+{
+    uint8_t data[PACKET_SIZE];
+    sim_usb_control_t status;
+    uint32_t length;
+    uint64_t cycles = 0u;
+    bool done = true;
+    uint32_t index;
+
+    sim_usb_sof();
+
+    if (sim_now() > SIM_US((uint64_t) opt.timeout_ms * 1000u))
+    {
+        timed_out = true;
+        if (phase == PHASE_STREAM)
+        {
+            end_time = sim_now();
+            end_sleep = sim_sleep_cycles();
+            for (index = 0u; index < SIM_IRQS; index++)
+            {
+                end_irqs[index] = sim_irq_count(index);
+            }
+        }
+        finish();
+    }
+
+    status = sim_usb_control_status(&length);
+    if (status == SIM_USB_CONTROL_STALL)
+    {
+        fprintf(stderr, "control request %u stalled\n", setup_step);
+        timed_out = true;
+        finish();
+    }
+
+    switch (phase)
+    {
+        case PHASE_ATTACH:
+            phase = PHASE_SETUP;
+            setup_step = 0u;
+            (void) setup_request(setup_step);
+            cycles += 3u * TRANSACTION_CYCLES(8u);
+            break;
+
+        case PHASE_SETUP:
+            if (status == SIM_USB_CONTROL_DONE)
+            {
+                setup_step++;
+                if (setup_request(setup_step))
+                {
+                    cycles += 3u * TRANSACTION_CYCLES(8u);
+                }
+                else
+                {
+                    stream_start();
+                }
+            }
+            break;
+
+        case PHASE_STREAM:
+            for (index = 0u; index < BRIDGE_PORTS; index++)
+            {
+                done = done && (ports[index].rx_bytes == opt.bytes);
+            }
+            if (done)
+            {
+                stream_done();
+                cycles += 3u * TRANSACTION_CYCLES(8u);
+            }
+            break;
+
+        default:
+            if (status == SIM_USB_CONTROL_DONE)
+            {
+                device_stats_valid = (length == sizeof(bridge_stats_t)) && (device_stats.version == STATS_VERSION);
+                finish();
+            }
+            break;
+    }
+
+    if (phase >= PHASE_STREAM)
+    {
+        for (index = 0u; index < BRIDGE_PORTS; index++)
+        {
+            if (sim_usb_in(ports[index].notification, data) >= 0)
+            {
+                ports[index].serial_states++;
+                cycles += TRANSACTION_CYCLES(10u);
+            }
+            else
+            {
+                cycles += NAK_CYCLES;
+            }
+        }
+    }
+
+    return cycles;
+}
+
+/*******************************************************************************
+* Function Name: bus_run
+********************************************************************************
+*
+* Summary:
+*  Host timer handler, one bus transaction per call. Bulk transactions go
+*  round robin over the IN and OUT endpoints of all ports in the bulk part of
+*  each frame.
+*
+*******************************************************************************/
+static void bus_run(void)
+{
+    uint64_t now = sim_now();
+    uint64_t cycles = 0u;
+    uint32_t tries;
+    host_port_t *port;
+
+    if (now >= (frame_time + FRAME_CYCLES))
+    {
+        frame_time += FRAME_CYCLES * ((now - frame_time) / FRAME_CYCLES);
+        cycles = frame_start();
+    }
+    else if ((phase == PHASE_STREAM) && ((now + TRANSACTION_CYCLES(PACKET_SIZE)) < (frame_time + FRAME_BULK_CYCLES)))
+    {
+        for (tries = 0u; (cycles == 0u) && (tries < (2u * BRIDGE_PORTS)); tries++)
+        {
+            port = &ports[bulk_next / 2u];
+            cycles = ((bulk_next & 1u) == 0u) ? port_in(port) : port_out(port);
+            bulk_next = (bulk_next + 1u) % (2u * BRIDGE_PORTS);
+        }
+    }
+
+    sim_timer_start((cycles != 0u) ? (now + cycles) : (frame_time + FRAME_CYCLES), bus_run);
+}
+
+/*******************************************************************************
+* Function Name: usage
+********************************************************************************
+*
+* Summary:
+*  Prints the command line help.
+*
+*******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -b, --baud RATE      line coding sent to every port (default 1000000)\n"
+            "  -n, --bytes BYTES    bytes streamed through every port (default 65536)\n"
+            "  -s, --size BYTES     bytes per write (default 4096)\n"
+            "  -w, --window BYTES   most bytes in flight per port (default 4096)\n"
+            "  -t, --timeout MS     virtual time limit of the run (default 10000)\n"
+            "  -o, --output FILE    write the JSON results to FILE instead of stdout\n",
+            name);
+}
+
+/*******************************************************************************
+* Function Name: parse_options
+********************************************************************************
+*
+* Summary:
+*  Parses the command line into opt.
+*
+* Return:
+*  bool: false if the command line is invalid
+*
+*******************************************************************************/
+static bool parse_options(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "baud", required_argument, NULL, 'b' },
+        { "bytes", required_argument, NULL, 'n' },
+        { "size", required_argument, NULL, 's' },
+        { "window", required_argument, NULL, 'w' },
+        { "timeout", required_argument, NULL, 't' },
+        { "output", required_argument, NULL, 'o' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+
+    while ((c = getopt_long(argc, argv, "b:n:s:w:t:o:h", long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'b':
+                opt.baud = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                opt.bytes = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                opt.chunk = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            case 'w':
+                opt.window = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            case 't':
+                opt.timeout_ms = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            case 'o':
+                opt.output = optarg;
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    if ((opt.baud == 0u) || (opt.bytes == 0u) || (opt.chunk == 0u) || (opt.chunk > CHUNK_MAX) ||
+        (opt.window == 0u) || (opt.window > WINDOW_MAX) || (opt.timeout_ms == 0u) || (optind != argc))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    static const uint8_t port_endpoints[2u][4u] =
+    {
+        { 0u, 1u, 2u, 3u },
+        { BRIDGE_PORT1_COMM_INTERFACE, 4u, BRIDGE_PORT1_EP_IN, BRIDGE_PORT1_EP_OUT },
+    };
+    uint32_t index;
+
+    if (!parse_options(argc, argv))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    for (index = 0u; index < BRIDGE_PORTS; index++)
+    {
+        ports[index].comm_interface = port_endpoints[index][0];
+        ports[index].notification = port_endpoints[index][1];
+        ports[index].ep_in = port_endpoints[index][2];
+        ports[index].ep_out = port_endpoints[index][3];
+        ports[index].first_error_offset = -1;
+        pattern_init(&ports[index].out_pattern, 0x7FFFu - index);
+        pattern_init(&ports[index].in_pattern, 0x7FFFu - index);
+    }
+
+    /* The firmware runs on this thread from reset; the host acts from the
+     * timer handler of the model until finish() ends the process */
+    frame_time = ATTACH_CYCLES - FRAME_CYCLES;
+    sim_timer_start(ATTACH_CYCLES, bus_run);
+
+    return bridge_main();
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,38 @@
+################################################################################
+# \file common.mk
+# \version 1.0
+#
+# \brief
+# Rules shared by the host-side tools, built with the native Linux toolchain.
+# A tool's Makefile sets TOOL, and SRCS and LDLIBS if it needs them, then
+# includes this file. The tools directory is listed in .cyignore, so the
+# firmware build does not pick it up.
+#
+# \copyright
+# Copyright 2018-2023, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+# 
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# 
+#     http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+CC ?= cc
+CFLAGS ?= -O2 -Wall -Wextra -std=c99
+SRCS ?= $(TOOL).c
+
+$(TOOL): $(SRCS)
+	$(CC) $(CPPFLAGS) $(CFLAGS) -o $@ $(SRCS) $(LDLIBS)
+
+clean:
+	rm -f $(TOOL) $(CLEANFILES)
+
+.PHONY: clean
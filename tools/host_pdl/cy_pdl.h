@@ -0,0 +1,479 @@
+/******************************************************************************
+* File Name: cy_pdl.h
+*
+* Description: Host stand-in for the subset of the PDL and CMSIS used by the
+*              bridge firmware. The functions are implemented by the device model
+*              in host_pdl.c.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CY_PDL_H_
+#define CY_PDL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/*******************************************************************************
+*        Toolchain and CMSIS
+*******************************************************************************/
+#define __STATIC_INLINE             static inline
+#define CY_ALIGN(align)             __attribute__((aligned(align)))
+#define CY_NOINIT
+#define CY_SECTION_RAMFUNC_BEGIN
+#define CY_SECTION_RAMFUNC_END
+#define CY_UNUSED_PARAMETER(x)      ((void) (x))
+#define CY_LO8(x)                   ((uint8_t) ((x) & 0xFFu))
+#define CY_HI8(x)                   ((uint8_t) (((x) >> 8u) & 0xFFu))
+#define CY_LO16(x)                  ((uint16_t) ((x) & 0xFFFFu))
+#define CY_HI16(x)                  ((uint16_t) (((x) >> 16u) & 0xFFFFu))
+
+/* A failed assertion ends the simulation */
+#define CY_ASSERT(x)                do { if (!(x)) { sim_assert_failed(__FILE__, __LINE__); } } while (0)
+
+typedef uint32_t cy_rslt_t;
+#define CY_RSLT_SUCCESS             (0u)
+
+/* Exceptions and interrupts of the modelled device. The numbers only need to
+ * be distinct; host_pdl.c indexes its tables with IRQn + 2. */
+typedef enum
+{
+    PendSV_IRQn = -2,
+    SysTick_IRQn = -1,
+    ioss_interrupts_gpio_0_IRQn = 0,
+    ioss_interrupts_gpio_1_IRQn = 1,
+    ioss_interrupts_gpio_2_IRQn = 2,
+    ioss_interrupts_gpio_3_IRQn = 3,
+    ioss_interrupts_gpio_4_IRQn = 4,
+    ioss_interrupts_gpio_5_IRQn = 5,
+    ioss_interrupts_gpio_6_IRQn = 6,
+    ioss_interrupts_gpio_7_IRQn = 7,
+    ioss_interrupts_gpio_8_IRQn = 8,
+    scb_0_interrupt_IRQn = 9,
+    scb_1_interrupt_IRQn = 10,
+    cpuss_interrupt_dma_IRQn = 11,
+    usb_interrupt_hi_IRQn = 12,
+    usb_interrupt_med_IRQn = 13,
+    usb_interrupt_lo_IRQn = 14,
+    tcpwm_interrupts_0_IRQn = 15,
+    tcpwm_interrupts_1_IRQn = 16,
+    SIM_IRQ_LAST = 16
+} IRQn_Type;
+
+/* System control block: only the bits the firmware uses */
+typedef struct
+{
+    volatile uint32_t ICSR;
+    volatile uint32_t SCR;
+} SCB_Type;
+
+extern SCB_Type sim_scb_regs;
+#define SCB                         (&sim_scb_regs)
+#define SCB_ICSR_PENDSVSET_Msk      (1UL << 28u)
+#define SCB_ICSR_PENDSTSET_Msk      (1UL << 26u)
+#define SCB_SCR_SLEEPONEXIT_Msk     (1UL << 1u)
+
+void __enable_irq(void);
+void __disable_irq(void);
+void __WFI(void);
+#define __DSB()                     do { } while (0)
+#define __NOP()                     do { } while (0)
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+
+
+/*******************************************************************************
+*        SysLib, SysInt, SysTick, SysClk, SysPm
+*******************************************************************************/
+uint32_t Cy_SysLib_EnterCriticalSection(void);
+void Cy_SysLib_ExitCriticalSection(uint32_t savedIntrStatus);
+void Cy_SysLib_Delay(uint32_t milliseconds);
+void Cy_SysLib_DelayUs(uint16_t microseconds);
+
+typedef void (*cy_israddress)(void);
+
+typedef struct
+{
+    IRQn_Type intrSrc;
+    uint32_t intrPriority;
+} cy_stc_sysint_t;
+
+typedef enum
+{
+    CY_SYSINT_SUCCESS,
+    CY_SYSINT_BAD_PARAM
+} cy_en_sysint_status_t;
+
+cy_en_sysint_status_t Cy_SysInt_Init(const cy_stc_sysint_t *config, cy_israddress userIsr);
+
+typedef enum
+{
+    CY_SYSTICK_CLOCK_SOURCE_CLK_LF,
+    CY_SYSTICK_CLOCK_SOURCE_CLK_CPU
+} cy_en_systick_clock_source_t;
+
+typedef void (*Cy_SysTick_Callback)(void);
+
+void Cy_SysTick_Init(cy_en_systick_clock_source_t clockSource, uint32_t interval);
+Cy_SysTick_Callback Cy_SysTick_SetCallback(uint32_t number, Cy_SysTick_Callback function);
+uint32_t Cy_SysTick_GetValue(void);
+uint32_t Cy_SysTick_GetReload(void);
+
+typedef enum
+{
+    CY_SYSCLK_DIV_8_BIT,
+    CY_SYSCLK_DIV_16_BIT,
+    CY_SYSCLK_DIV_16_5_BIT,
+    CY_SYSCLK_DIV_24_5_BIT
+} cy_en_divider_types_t;
+
+typedef enum
+{
+    CY_SYSCLK_SUCCESS,
+    CY_SYSCLK_BAD_PARAM
+} cy_en_sysclk_status_t;
+
+cy_en_sysclk_status_t Cy_SysClk_PeriphSetDivider(cy_en_divider_types_t dividerType, uint32_t dividerNum,
+                                                 uint32_t dividerValue);
+cy_en_sysclk_status_t Cy_SysClk_PeriphEnableDivider(cy_en_divider_types_t dividerType, uint32_t dividerNum);
+cy_en_sysclk_status_t Cy_SysClk_PeriphDisableDivider(cy_en_divider_types_t dividerType, uint32_t dividerNum);
+uint32_t Cy_SysClk_ClkHfGetFrequency(void);
+uint32_t Cy_SysClk_ClkSysGetFrequency(void);
+
+typedef enum
+{
+    CY_SYSPM_SUCCESS,
+    CY_SYSPM_FAIL
+} cy_en_syspm_status_t;
+
+cy_en_syspm_status_t Cy_SysPm_CpuEnterSleep(void);
+cy_en_syspm_status_t Cy_SysPm_CpuEnterDeepSleep(void);
+
+
+/*******************************************************************************
+*        GPIO
+*******************************************************************************/
+typedef struct
+{
+    volatile uint32_t DR;
+    volatile uint32_t PS;
+} GPIO_PRT_Type;
+
+typedef uint32_t en_hsiom_sel_t;
+#define HSIOM_SEL_GPIO              (0u)
+
+#define CY_GPIO_INTR_DISABLE        (0u)
+#define CY_GPIO_INTR_RISING         (1u)
+#define CY_GPIO_INTR_FALLING        (2u)
+#define CY_GPIO_INTR_BOTH           (3u)
+
+/* Drive modes below CY_GPIO_DM_HIGHZ have the input buffer off */
+#define CY_GPIO_DM_ANALOG           (0x00u)
+#define CY_GPIO_DM_STRONG_IN_OFF    (0x06u)
+#define CY_GPIO_DM_HIGHZ            (0x08u)
+#define CY_GPIO_DM_STRONG           (0x0Eu)
+
+void Cy_GPIO_Write(GPIO_PRT_Type *base, uint32_t pinNum, uint32_t value);
+uint32_t Cy_GPIO_Read(GPIO_PRT_Type *base, uint32_t pinNum);
+void Cy_GPIO_Set(GPIO_PRT_Type *base, uint32_t pinNum);
+void Cy_GPIO_Clr(GPIO_PRT_Type *base, uint32_t pinNum);
+void Cy_GPIO_Inv(GPIO_PRT_Type *base, uint32_t pinNum);
+void Cy_GPIO_SetHSIOM(GPIO_PRT_Type *base, uint32_t pinNum, en_hsiom_sel_t value);
+en_hsiom_sel_t Cy_GPIO_GetHSIOM(GPIO_PRT_Type *base, uint32_t pinNum);
+void Cy_GPIO_SetDrivemode(GPIO_PRT_Type *base, uint32_t pinNum, uint32_t value);
+uint32_t Cy_GPIO_GetDrivemode(GPIO_PRT_Type *base, uint32_t pinNum);
+void Cy_GPIO_SetInterruptEdge(GPIO_PRT_Type *base, uint32_t pinNum, uint32_t value);
+uint32_t Cy_GPIO_GetInterruptStatus(GPIO_PRT_Type *base, uint32_t pinNum);
+void Cy_GPIO_ClearInterrupt(GPIO_PRT_Type *base, uint32_t pinNum);
+
+
+/*******************************************************************************
+*        DMAC
+*******************************************************************************/
+typedef struct
+{
+    volatile uint32_t CTL;
+} DMAC_Type;
+
+extern DMAC_Type sim_dmac;
+#define DMAC                        (&sim_dmac)
+#define CY_DMAC_CHANNELS            (16u)
+#define CY_DMAC_MAX_DATA_COUNT      (65536u)
+
+typedef enum
+{
+    CY_DMAC_DESCRIPTOR_PING = 0,
+    CY_DMAC_DESCRIPTOR_PONG = 1
+} cy_en_dmac_descriptor_t;
+
+typedef enum
+{
+    CY_DMAC_SUCCESS,
+    CY_DMAC_BAD_PARAM
+} cy_en_dmac_status_t;
+
+typedef enum
+{
+    CY_DMAC_NO_ERROR,
+    CY_DMAC_DONE,
+    CY_DMAC_SRC_BUS_ERROR,
+    CY_DMAC_DST_BUS_ERROR,
+    CY_DMAC_SRC_MISAL,
+    CY_DMAC_DST_MISAL,
+    CY_DMAC_CURR_PTR_NULL,
+    CY_DMAC_ACTIVE_CH_DISABLED,
+    CY_DMAC_DESCR_BUS_ERROR,
+    CY_DMAC_INVALID_DESCR
+} cy_en_dmac_response_t;
+
+typedef enum
+{
+    CY_DMAC_SINGLE_ELEMENT,
+    CY_DMAC_SINGLE_DESCR
+} cy_en_dmac_trigger_type_t;
+
+typedef enum
+{
+    CY_DMAC_RETRIG_IM,
+    CY_DMAC_RETRIG_4CYC,
+    CY_DMAC_RETRIG_16CYC,
+    CY_DMAC_WAIT_FOR_REACT
+} cy_en_dmac_retrigger_t;
+
+typedef enum
+{
+    CY_DMAC_BYTE_BYTE,
+    CY_DMAC_BYTE_HALFWORD,
+    CY_DMAC_BYTE_WORD,
+    CY_DMAC_HALFWORD_BYTE,
+    CY_DMAC_HALFWORD_HALFWORD,
+    CY_DMAC_HALFWORD_WORD,
+    CY_DMAC_WORD_BYTE,
+    CY_DMAC_WORD_HALFWORD,
+    CY_DMAC_WORD_WORD
+} cy_en_dmac_data_transfer_width_t;
+
+/* cpltState true invalidates the descriptor once it has completed */
+typedef struct
+{
+    void *srcAddress;
+    void *dstAddress;
+    uint32_t dataCount;
+    cy_en_dmac_data_transfer_width_t dataTransferWidth;
+    bool srcAddrIncrement;
+    bool dstAddrIncrement;
+    cy_en_dmac_retrigger_t retrigger;
+    bool cpltState;
+    bool interrupt;
+    bool preemptable;
+    bool flipping;
+    cy_en_dmac_trigger_type_t triggerType;
+} cy_stc_dmac_descriptor_config_t;
+
+typedef struct
+{
+    cy_en_dmac_descriptor_t descriptor;
+    uint32_t priority;
+    bool enable;
+} cy_stc_dmac_channel_config_t;
+
+cy_en_dmac_status_t Cy_DMAC_Descriptor_Init(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor,
+                                            const cy_stc_dmac_descriptor_config_t *config);
+cy_en_dmac_status_t Cy_DMAC_Channel_Init(DMAC_Type *base, uint32_t channel,
+                                         const cy_stc_dmac_channel_config_t *config);
+void Cy_DMAC_Descriptor_SetSrcAddress(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor,
+                                      const void *srcAddress);
+void Cy_DMAC_Descriptor_SetDstAddress(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor,
+                                      const void *dstAddress);
+void Cy_DMAC_Descriptor_SetDataCount(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor,
+                                     uint32_t dataCount);
+void Cy_DMAC_Descriptor_SetState(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor, bool state);
+uint32_t Cy_DMAC_Descriptor_GetCurrentIndex(DMAC_Type const *base, uint32_t channel,
+                                            cy_en_dmac_descriptor_t descriptor);
+cy_en_dmac_response_t Cy_DMAC_Descriptor_GetResponse(DMAC_Type const *base, uint32_t channel,
+                                                     cy_en_dmac_descriptor_t descriptor);
+void Cy_DMAC_Channel_SetCurrentDescriptor(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor);
+cy_en_dmac_descriptor_t Cy_DMAC_Channel_GetCurrentDescriptor(DMAC_Type const *base, uint32_t channel);
+void Cy_DMAC_Channel_Enable(DMAC_Type *base, uint32_t channel);
+void Cy_DMAC_Channel_Disable(DMAC_Type *base, uint32_t channel);
+uint32_t Cy_DMAC_GetActiveChannel(DMAC_Type const *base);
+void Cy_DMAC_Enable(DMAC_Type *base);
+void Cy_DMAC_Disable(DMAC_Type *base);
+uint32_t Cy_DMAC_GetInterruptStatus(DMAC_Type const *base);
+uint32_t Cy_DMAC_GetInterruptStatusMasked(DMAC_Type const *base);
+void Cy_DMAC_ClearInterrupt(DMAC_Type *base, uint32_t interrupt);
+void Cy_DMAC_SetInterruptMask(DMAC_Type *base, uint32_t interrupt);
+uint32_t Cy_DMAC_GetInterruptMask(DMAC_Type const *base);
+
+
+/*******************************************************************************
+*        SCB UART
+*******************************************************************************/
+/* The DMA channels address the FIFO registers, the rest of the SCB state is
+ * kept by host_pdl.c */
+typedef struct
+{
+    volatile uint32_t TX_FIFO_WR;
+    volatile uint32_t RX_FIFO_RD;
+} CySCB_Type;
+
+typedef enum
+{
+    CY_SCB_UART_SUCCESS,
+    CY_SCB_UART_BAD_PARAM
+} cy_en_scb_uart_status_t;
+
+typedef enum
+{
+    CY_SCB_UART_STANDARD,
+    CY_SCB_UART_SMARTCARD,
+    CY_SCB_UART_IRDA
+} cy_en_scb_uart_mode_t;
+
+typedef enum
+{
+    CY_SCB_UART_PARITY_NONE = 0,
+    CY_SCB_UART_PARITY_EVEN = 2,
+    CY_SCB_UART_PARITY_ODD = 3
+} cy_en_scb_uart_parity_t;
+
+typedef enum
+{
+    CY_SCB_UART_STOP_BITS_1 = 2,
+    CY_SCB_UART_STOP_BITS_1_5 = 3,
+    CY_SCB_UART_STOP_BITS_2 = 4
+} cy_en_scb_uart_stop_bits_t;
+
+typedef enum
+{
+    CY_SCB_UART_ACTIVE_LOW,
+    CY_SCB_UART_ACTIVE_HIGH
+} cy_en_scb_uart_polarity_t;
+
+typedef struct
+{
+    cy_en_scb_uart_mode_t uartMode;
+    uint32_t oversample;
+    uint32_t dataWidth;
+    bool enableMsbFirst;
+    cy_en_scb_uart_stop_bits_t stopBits;
+    cy_en_scb_uart_parity_t parity;
+    bool enableInputFilter;
+    bool dropOnParityError;
+    bool dropOnFrameError;
+    bool enableMutliProcessorMode;
+    uint32_t receiverAddress;
+    uint32_t receiverAddressMask;
+    bool acceptAddrInFifo;
+    uint32_t breakWidth;
+    bool enableCts;
+    cy_en_scb_uart_polarity_t ctsPolarity;
+    uint32_t rtsRxFifoLevel;
+    cy_en_scb_uart_polarity_t rtsPolarity;
+    uint32_t rxFifoTriggerLevel;
+    uint32_t rxFifoIntEnableMask;
+    uint32_t txFifoTriggerLevel;
+    uint32_t txFifoIntEnableMask;
+} cy_stc_scb_uart_config_t;
+
+typedef struct
+{
+    uint32_t txStatus;
+    uint32_t rxStatus;
+} cy_stc_scb_uart_context_t;
+
+#define CY_SCB_UART_RX_TRIGGER      (1UL << 0u)
+#define CY_SCB_UART_RX_NOT_EMPTY    (1UL << 2u)
+#define CY_SCB_UART_RX_FULL         (1UL << 3u)
+#define CY_SCB_UART_RX_OVERFLOW     (1UL << 5u)
+#define CY_SCB_UART_RX_UNDERFLOW    (1UL << 6u)
+#define CY_SCB_UART_RX_ERR_FRAME    (1UL << 8u)
+#define CY_SCB_UART_RX_ERR_PARITY   (1UL << 9u)
+#define CY_SCB_UART_RX_BREAK_DETECT (1UL << 10u)
+
+#define CY_SCB_UART_TX_TRIGGER      (1UL << 0u)
+#define CY_SCB_UART_TX_NOT_FULL     (1UL << 1u)
+#define CY_SCB_UART_TX_EMPTY        (1UL << 4u)
+#define CY_SCB_UART_TX_OVERFLOW     (1UL << 5u)
+#define CY_SCB_UART_TX_UNDERFLOW    (1UL << 6u)
+#define CY_SCB_UART_TX_NACK         (1UL << 7u)
+#define CY_SCB_UART_TX_ARB_LOST     (1UL << 8u)
+#define CY_SCB_UART_TX_DONE         (1UL << 9u)
+
+cy_en_scb_uart_status_t Cy_SCB_UART_Init(CySCB_Type *base, const cy_stc_scb_uart_config_t *config,
+                                         cy_stc_scb_uart_context_t *context);
+void Cy_SCB_UART_DeInit(CySCB_Type *base);
+void Cy_SCB_UART_Enable(CySCB_Type *base);
+void Cy_SCB_UART_Disable(CySCB_Type *base, cy_stc_scb_uart_context_t *context);
+uint32_t Cy_SCB_UART_GetRxFifoStatus(CySCB_Type const *base);
+void Cy_SCB_UART_ClearRxFifoStatus(CySCB_Type *base, uint32_t clearMask);
+uint32_t Cy_SCB_UART_GetTxFifoStatus(CySCB_Type const *base);
+void Cy_SCB_UART_ClearTxFifoStatus(CySCB_Type *base, uint32_t clearMask);
+uint32_t Cy_SCB_UART_GetNumInRxFifo(CySCB_Type const *base);
+uint32_t Cy_SCB_UART_GetNumInTxFifo(CySCB_Type const *base);
+void Cy_SCB_UART_ClearRxFifo(CySCB_Type *base);
+void Cy_SCB_UART_ClearTxFifo(CySCB_Type *base);
+bool Cy_SCB_UART_IsTxComplete(CySCB_Type const *base);
+uint32_t Cy_SCB_UART_Put(CySCB_Type *base, uint32_t data);
+uint32_t Cy_SCB_UART_Get(CySCB_Type const *base);
+void Cy_SCB_SetRxInterruptMask(CySCB_Type *base, uint32_t interruptMask);
+uint32_t Cy_SCB_GetRxInterruptMask(CySCB_Type const *base);
+void Cy_SCB_SetTxInterruptMask(CySCB_Type *base, uint32_t interruptMask);
+uint32_t Cy_SCB_GetTxInterruptMask(CySCB_Type const *base);
+void Cy_SCB_SetRxFifoLevel(CySCB_Type *base, uint32_t level);
+void Cy_SCB_SetTxFifoLevel(CySCB_Type *base, uint32_t level);
+
+
+/*******************************************************************************
+*        TCPWM
+*******************************************************************************/
+typedef struct
+{
+    volatile uint32_t CTRL;
+} TCPWM_Type;
+
+
+/*******************************************************************************
+*        Simulation
+*******************************************************************************/
+void sim_assert_failed(const char *file, uint32_t line);
+
+#endif /* CY_PDL_H_ */
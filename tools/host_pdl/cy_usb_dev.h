@@ -0,0 +1,220 @@
+/******************************************************************************
+* File Name: cy_usb_dev.h
+*
+* Description: Host stand-in for the USBFS driver and the USB Device middleware
+*              used by the bridge firmware, implemented by host_pdl.c
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CY_USB_DEV_H_
+#define CY_USB_DEV_H_
+
+#include "cy_pdl.h"
+
+
+/*******************************************************************************
+*        USBFS driver
+*******************************************************************************/
+#define CY_USBFS_DEV_DRV_NUM_EPS_MAX    (8u)
+#define CY_USB_DEV_EP_BUF_SIZE          (64u)
+
+typedef struct
+{
+    volatile uint32_t CR0;
+} USBFS_Type;
+
+typedef struct
+{
+    uint32_t mode;
+} cy_stc_usbfs_dev_drv_config_t;
+
+typedef struct cy_stc_usbfs_dev_drv_context
+{
+    uint32_t reserved;
+} cy_stc_usbfs_dev_drv_context_t;
+
+typedef enum
+{
+    CY_USBFS_DEV_DRV_SUCCESS,
+    CY_USBFS_DEV_DRV_BAD_PARAM,
+    CY_USBFS_DEV_DRV_EP_DMA_WRITE_TIMEOUT,
+    CY_USBFS_DEV_DRV_EP_DMA_READ_TIMEOUT,
+    CY_USBFS_DEV_DRV_BUF_ALLOC_FAILED
+} cy_en_usbfs_dev_drv_status_t;
+
+typedef enum
+{
+    CY_USB_DEV_EP_IDLE,
+    CY_USB_DEV_EP_PENDING,
+    CY_USB_DEV_EP_COMPLETED,
+    CY_USB_DEV_EP_STALLED,
+    CY_USB_DEV_EP_DISABLED,
+    CY_USB_DEV_EP_INVALID
+} cy_en_usb_dev_ep_state_t;
+
+typedef void (*cy_cb_usbfs_dev_drv_sof_t)(USBFS_Type *base, struct cy_stc_usbfs_dev_drv_context *context);
+typedef void (*cy_cb_usbfs_dev_drv_ep_callback_t)(USBFS_Type *base, uint32_t endpointAddr, uint32_t errorType,
+                                                  struct cy_stc_usbfs_dev_drv_context *context);
+typedef uint8_t *(*cy_fn_usbfs_dev_drv_memcpy_ptr_t)(uint8_t *dest, const uint8_t *src, uint32_t size);
+
+cy_en_usbfs_dev_drv_status_t Cy_USBFS_Dev_Drv_ReadOutEndpoint(USBFS_Type *base, uint32_t endpoint, uint8_t *buffer,
+                                                               uint32_t size, uint32_t *actSize,
+                                                               cy_stc_usbfs_dev_drv_context_t *context);
+cy_en_usbfs_dev_drv_status_t Cy_USBFS_Dev_Drv_LoadInEndpoint(USBFS_Type *base, uint32_t endpoint,
+                                                              const uint8_t *buffer, uint32_t size,
+                                                              cy_stc_usbfs_dev_drv_context_t *context);
+cy_en_usbfs_dev_drv_status_t Cy_USBFS_Dev_Drv_EnableOutEndpoint(USBFS_Type *base, uint32_t endpoint,
+                                                                 cy_stc_usbfs_dev_drv_context_t *context);
+cy_en_usb_dev_ep_state_t Cy_USBFS_Dev_Drv_GetEndpointState(USBFS_Type const *base, uint32_t endpoint,
+                                                           cy_stc_usbfs_dev_drv_context_t const *context);
+void Cy_USBFS_Dev_Drv_RegisterSofCallback(USBFS_Type *base, cy_cb_usbfs_dev_drv_sof_t callback,
+                                          cy_stc_usbfs_dev_drv_context_t *context);
+void Cy_USBFS_Dev_Drv_RegisterEndpointCallback(USBFS_Type *base, uint32_t endpoint,
+                                               cy_cb_usbfs_dev_drv_ep_callback_t callback,
+                                               cy_stc_usbfs_dev_drv_context_t *context);
+void Cy_USBFS_Dev_Drv_OverwriteMemcpy(USBFS_Type const *base, uint32_t endpoint,
+                                      cy_fn_usbfs_dev_drv_memcpy_ptr_t memcpyFunc,
+                                      cy_stc_usbfs_dev_drv_context_t *context);
+void Cy_USBFS_Dev_Drv_Interrupt(USBFS_Type *base, uint32_t intrCause, cy_stc_usbfs_dev_drv_context_t *context);
+uint32_t Cy_USBFS_Dev_Drv_GetInterruptCauseHi(USBFS_Type const *base);
+uint32_t Cy_USBFS_Dev_Drv_GetInterruptCauseMed(USBFS_Type const *base);
+uint32_t Cy_USBFS_Dev_Drv_GetInterruptCauseLo(USBFS_Type const *base);
+bool Cy_USBFS_Dev_Drv_CheckActivity(USBFS_Type *base);
+void Cy_USBFS_Dev_Drv_Suspend(USBFS_Type *base, cy_stc_usbfs_dev_drv_context_t *context);
+void Cy_USBFS_Dev_Drv_Resume(USBFS_Type *base, cy_stc_usbfs_dev_drv_context_t *context);
+
+
+/*******************************************************************************
+*        USB Device middleware
+*******************************************************************************/
+#define CY_USB_DEV_WAIT_FOREVER         (0)
+
+#define CY_USB_DEV_DIR_HOST_TO_DEVICE   (0u)
+#define CY_USB_DEV_DIR_DEVICE_TO_HOST   (1u)
+
+#define CY_USB_DEV_STANDARD_TYPE        (0u)
+#define CY_USB_DEV_CLASS_TYPE           (1u)
+#define CY_USB_DEV_VENDOR_TYPE          (2u)
+
+#define CY_USB_DEV_RECIPIENT_DEVICE     (0u)
+#define CY_USB_DEV_RECIPIENT_INTERFACE  (1u)
+#define CY_USB_DEV_RECIPIENT_ENDPOINT   (2u)
+
+#define CY_USB_DEV_RQST_SET_CONFIGURATION   (9u)
+#define CY_USB_DEV_RQST_SET_INTERFACE       (11u)
+
+typedef enum
+{
+    CY_USB_DEV_SUCCESS,
+    CY_USB_DEV_BAD_PARAM,
+    CY_USB_DEV_REQUEST_NOT_HANDLED,
+    CY_USB_DEV_TIMEOUT,
+    CY_USB_DEV_DRV_HW_ERROR
+} cy_en_usb_dev_status_t;
+
+typedef enum
+{
+    CY_USB_DEV_EVENT_BUS_RESET,
+    CY_USB_DEV_EVENT_SET_CONFIG,
+    CY_USB_DEV_EVENT_SET_INTERFACE
+} cy_en_usb_dev_callback_events_t;
+
+typedef struct
+{
+    uint8_t direction;
+    uint8_t type;
+    uint8_t recipient;
+} cy_stc_usb_dev_bm_request_t;
+
+typedef struct
+{
+    cy_stc_usb_dev_bm_request_t bmRequestType;
+    uint8_t bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} cy_stc_usb_dev_setup_packet_t;
+
+typedef struct
+{
+    uint8_t *ptr;
+    uint8_t *buffer;
+    uint32_t size;
+    uint32_t remaining;
+    uint16_t bufferSize;
+    bool zlp;
+    bool notify;
+    cy_stc_usb_dev_setup_packet_t setup;
+    uint8_t direction;
+} cy_stc_usb_dev_control_transfer_t;
+
+typedef struct
+{
+    uint32_t reserved;
+} cy_stc_usb_dev_device_t;
+
+typedef struct
+{
+    uint32_t reserved;
+} cy_stc_usb_dev_config_t;
+
+typedef struct cy_stc_usb_dev_context
+{
+    uint32_t reserved;
+} cy_stc_usb_dev_context_t;
+
+typedef cy_en_usb_dev_status_t (*cy_cb_usb_dev_events_t)(cy_en_usb_dev_callback_events_t event, uint32_t wValue,
+                                                         uint32_t wIndex, struct cy_stc_usb_dev_context *devContext);
+typedef cy_en_usb_dev_status_t (*cy_cb_usb_dev_request_received_t)(cy_stc_usb_dev_control_transfer_t *transfer,
+                                                                   cy_stc_usb_dev_context_t *context);
+typedef cy_en_usb_dev_status_t (*cy_cb_usb_dev_request_cmplt_t)(cy_stc_usb_dev_control_transfer_t *transfer,
+                                                                cy_stc_usb_dev_context_t *context);
+typedef cy_en_usb_dev_status_t (*cy_cb_usb_dev_class_request_t)(cy_stc_usb_dev_control_transfer_t *transfer,
+                                                                void *classContext,
+                                                                cy_stc_usb_dev_context_t *devContext);
+
+cy_en_usb_dev_status_t Cy_USB_Dev_Init(USBFS_Type *base, const cy_stc_usbfs_dev_drv_config_t *drvConfig,
+                                       cy_stc_usbfs_dev_drv_context_t *drvContext,
+                                       const cy_stc_usb_dev_device_t *device, const cy_stc_usb_dev_config_t *config,
+                                       cy_stc_usb_dev_context_t *context);
+cy_en_usb_dev_status_t Cy_USB_Dev_Connect(bool blocking, int32_t timeout, cy_stc_usb_dev_context_t *context);
+void Cy_USB_Dev_Disconnect(cy_stc_usb_dev_context_t *context);
+uint32_t Cy_USB_Dev_GetConfiguration(cy_stc_usb_dev_context_t const *context);
+bool Cy_USB_Dev_IsConfigurationChanged(cy_stc_usb_dev_context_t *context);
+void Cy_USB_Dev_RegisterEventsCallback(cy_cb_usb_dev_events_t callback, cy_stc_usb_dev_context_t *context);
+void Cy_USB_Dev_RegisterVendorCallbacks(cy_cb_usb_dev_request_received_t requestReceivedHandle,
+                                        cy_cb_usb_dev_request_cmplt_t requestCompletedHandle,
+                                        cy_stc_usb_dev_context_t *context);
+
+#endif /* CY_USB_DEV_H_ */
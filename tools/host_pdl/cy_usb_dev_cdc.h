@@ -0,0 +1,104 @@
+/******************************************************************************
+* File Name: cy_usb_dev_cdc.h
+*
+* Description: Host stand-in for the CDC class of the USB Device middleware,
+*              implemented by host_pdl.c
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CY_USB_DEV_CDC_H_
+#define CY_USB_DEV_CDC_H_
+
+#include "cy_usb_dev.h"
+
+
+/*******************************************************************************
+*        CDC class
+*******************************************************************************/
+#define CY_USB_DEV_CDC_COMPORT_NUMBER       (2u)
+#define CY_USB_DEV_CDC_LINE_CODING_SIZE     (7u)
+
+#define CY_USB_DEV_CDC_LINE_CODING_CHANGED  (1u)
+#define CY_USB_DEV_CDC_LINE_CONTROL_CHANGED (2u)
+
+#define CY_USB_DEV_CDC_LINE_CONTROL_DTR     (1u)
+#define CY_USB_DEV_CDC_LINE_CONTROL_RTS     (2u)
+
+#define CY_USB_DEV_CDC_STOPBIT_1            (0u)
+#define CY_USB_DEV_CDC_STOPBITS_1_5         (1u)
+#define CY_USB_DEV_CDC_STOPBITS_2           (2u)
+
+#define CY_USB_DEV_CDC_PARITY_NONE          (0u)
+#define CY_USB_DEV_CDC_PARITY_ODD           (1u)
+#define CY_USB_DEV_CDC_PARITY_EVEN          (2u)
+#define CY_USB_DEV_CDC_PARITY_MARK          (3u)
+#define CY_USB_DEV_CDC_PARITY_SPACE         (4u)
+
+#define CY_USB_DEV_CDC_RQST_SET_LINE_CODING         (0x20u)
+#define CY_USB_DEV_CDC_RQST_GET_LINE_CODING         (0x21u)
+#define CY_USB_DEV_CDC_RQST_SET_CONTROL_LINE_STATE  (0x22u)
+
+typedef struct
+{
+    uint32_t reserved;
+} cy_stc_usb_dev_cdc_config_t;
+
+/* The layout is private to the middleware; the firmware only uses the
+ * accessors below */
+typedef struct
+{
+    uint8_t linesCoding[CY_USB_DEV_CDC_COMPORT_NUMBER][CY_USB_DEV_CDC_LINE_CODING_SIZE];
+    uint8_t linesChanged[CY_USB_DEV_CDC_COMPORT_NUMBER];
+    uint8_t linesControlBitmap[CY_USB_DEV_CDC_COMPORT_NUMBER];
+    cy_cb_usb_dev_class_request_t requestReceived;
+    cy_cb_usb_dev_class_request_t requestCompleted;
+} cy_stc_usb_dev_cdc_context_t;
+
+cy_en_usb_dev_status_t Cy_USB_Dev_CDC_Init(const cy_stc_usb_dev_cdc_config_t *config,
+                                           cy_stc_usb_dev_cdc_context_t *context,
+                                           cy_stc_usb_dev_context_t *devContext);
+void Cy_USB_Dev_CDC_RegisterUserCallback(cy_cb_usb_dev_class_request_t requestReceivedHandle,
+                                         cy_cb_usb_dev_class_request_t requestCompletedHandle,
+                                         cy_stc_usb_dev_cdc_context_t *context);
+uint32_t Cy_USB_Dev_CDC_IsReady(uint32_t port, cy_stc_usb_dev_cdc_context_t *context);
+uint32_t Cy_USB_Dev_CDC_IsLineChanged(uint32_t port, cy_stc_usb_dev_cdc_context_t *context);
+uint32_t Cy_USB_Dev_CDC_GetDTERate(uint32_t port, cy_stc_usb_dev_cdc_context_t const *context);
+uint32_t Cy_USB_Dev_CDC_GetCharFormat(uint32_t port, cy_stc_usb_dev_cdc_context_t const *context);
+uint32_t Cy_USB_Dev_CDC_GetParityType(uint32_t port, cy_stc_usb_dev_cdc_context_t const *context);
+uint32_t Cy_USB_Dev_CDC_GetDataBits(uint32_t port, cy_stc_usb_dev_cdc_context_t const *context);
+uint32_t Cy_USB_Dev_CDC_GetLineControl(uint32_t port, cy_stc_usb_dev_cdc_context_t const *context);
+cy_en_usb_dev_status_t Cy_USB_Dev_CDC_SendSerialState(uint32_t port, uint32_t serialState,
+                                                      cy_stc_usb_dev_cdc_context_t *context);
+
+#endif /* CY_USB_DEV_CDC_H_ */
@@ -0,0 +1,308 @@
+/******************************************************************************
+* File Name: cybsp.c
+*
+* Description: Configurations of the device model, in place of the code that
+*              the configurators generate from design.modus and
+*              design.cyusbdev, and the wiring of its blocks.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cybsp.h"
+#include "cycfg_usbdev.h"
+#include "usb_uart_config.h"
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+const cy_stc_scb_uart_config_t CYBSP_UART_config =
+{
+    .uartMode = CY_SCB_UART_STANDARD,
+    .oversample = 8u,
+    .dataWidth = 8u,
+    .enableMsbFirst = false,
+    .stopBits = CY_SCB_UART_STOP_BITS_1,
+    .parity = CY_SCB_UART_PARITY_NONE,
+    .enableInputFilter = false,
+    .dropOnParityError = false,
+    .dropOnFrameError = false,
+    .enableMutliProcessorMode = false,
+    .receiverAddress = 0u,
+    .receiverAddressMask = 255u,
+    .acceptAddrInFifo = false,
+    .breakWidth = 11u,
+    .enableCts = false,
+    .ctsPolarity = CY_SCB_UART_ACTIVE_LOW,
+    .rtsRxFifoLevel = 7u,
+    .rtsPolarity = CY_SCB_UART_ACTIVE_LOW,
+    .rxFifoTriggerLevel = 0u,
+    .rxFifoIntEnableMask = CY_SCB_UART_RX_OVERFLOW | CY_SCB_UART_RX_UNDERFLOW,
+    .txFifoTriggerLevel = 15u,
+    .txFifoIntEnableMask = CY_SCB_UART_TX_OVERFLOW,
+};
+
+const cy_stc_scb_uart_config_t CYBSP_UART1_config =
+{
+    .uartMode = CY_SCB_UART_STANDARD,
+    .oversample = 8u,
+    .dataWidth = 8u,
+    .enableMsbFirst = false,
+    .stopBits = CY_SCB_UART_STOP_BITS_1,
+    .parity = CY_SCB_UART_PARITY_NONE,
+    .enableInputFilter = false,
+    .dropOnParityError = false,
+    .dropOnFrameError = false,
+    .enableMutliProcessorMode = false,
+    .receiverAddress = 0u,
+    .receiverAddressMask = 255u,
+    .acceptAddrInFifo = false,
+    .breakWidth = 11u,
+    .enableCts = false,
+    .ctsPolarity = CY_SCB_UART_ACTIVE_LOW,
+    .rtsRxFifoLevel = 7u,
+    .rtsPolarity = CY_SCB_UART_ACTIVE_LOW,
+    .rxFifoTriggerLevel = 0u,
+    .rxFifoIntEnableMask = CY_SCB_UART_RX_OVERFLOW | CY_SCB_UART_RX_UNDERFLOW,
+    .txFifoTriggerLevel = 15u,
+    .txFifoIntEnableMask = CY_SCB_UART_TX_OVERFLOW,
+};
+
+/* UART_TX_DMA: one tx_ring slot per descriptor, invalid once sent */
+const cy_stc_dmac_descriptor_config_t UART_TX_DMA_ping_config =
+{
+    .srcAddress = NULL,
+    .dstAddress = NULL,
+    .dataCount = 64u,
+    .dataTransferWidth = CY_DMAC_BYTE_WORD,
+    .srcAddrIncrement = true,
+    .dstAddrIncrement = false,
+    .retrigger = CY_DMAC_RETRIG_IM,
+    .cpltState = true,
+    .interrupt = true,
+    .preemptable = false,
+    .flipping = false,
+    .triggerType = CY_DMAC_SINGLE_ELEMENT,
+};
+
+const cy_stc_dmac_descriptor_config_t UART_TX_DMA_pong_config =
+{
+    .srcAddress = NULL,
+    .dstAddress = NULL,
+    .dataCount = 1u,
+    .dataTransferWidth = CY_DMAC_WORD_WORD,
+    .srcAddrIncrement = true,
+    .dstAddrIncrement = true,
+    .retrigger = CY_DMAC_RETRIG_IM,
+    .cpltState = false,
+    .interrupt = true,
+    .preemptable = true,
+    .flipping = false,
+    .triggerType = CY_DMAC_SINGLE_ELEMENT,
+};
+
+const cy_stc_dmac_channel_config_t UART_TX_DMA_channel_config =
+{
+    .descriptor = CY_DMAC_DESCRIPTOR_PING,
+    .priority = 3u,
+    .enable = false,
+};
+
+/* UART_RX_DMA: ping and pong buffers that flip to each other */
+const cy_stc_dmac_descriptor_config_t UART_RX_DMA_ping_config =
+{
+    .srcAddress = NULL,
+    .dstAddress = NULL,
+    .dataCount = 64u,
+    .dataTransferWidth = CY_DMAC_WORD_BYTE,
+    .srcAddrIncrement = false,
+    .dstAddrIncrement = true,
+    .retrigger = CY_DMAC_RETRIG_4CYC,
+    .cpltState = false,
+    .interrupt = true,
+    .preemptable = false,
+    .flipping = true,
+    .triggerType = CY_DMAC_SINGLE_ELEMENT,
+};
+
+const cy_stc_dmac_descriptor_config_t UART_RX_DMA_pong_config =
+{
+    .srcAddress = NULL,
+    .dstAddress = NULL,
+    .dataCount = 64u,
+    .dataTransferWidth = CY_DMAC_WORD_BYTE,
+    .srcAddrIncrement = false,
+    .dstAddrIncrement = true,
+    .retrigger = CY_DMAC_RETRIG_4CYC,
+    .cpltState = false,
+    .interrupt = true,
+    .preemptable = false,
+    .flipping = true,
+    .triggerType = CY_DMAC_SINGLE_ELEMENT,
+};
+
+const cy_stc_dmac_channel_config_t UART_RX_DMA_channel_config =
+{
+    .descriptor = CY_DMAC_DESCRIPTOR_PING,
+    .priority = 3u,
+    .enable = false,
+};
+
+/* Port 1 uses the same channel setups as port 0 */
+const cy_stc_dmac_descriptor_config_t UART1_TX_DMA_ping_config =
+{
+    .srcAddress = NULL,
+    .dstAddress = NULL,
+    .dataCount = 64u,
+    .dataTransferWidth = CY_DMAC_BYTE_WORD,
+    .srcAddrIncrement = true,
+    .dstAddrIncrement = false,
+    .retrigger = CY_DMAC_RETRIG_IM,
+    .cpltState = true,
+    .interrupt = true,
+    .preemptable = false,
+    .flipping = false,
+    .triggerType = CY_DMAC_SINGLE_ELEMENT,
+};
+
+const cy_stc_dmac_channel_config_t UART1_TX_DMA_channel_config =
+{
+    .descriptor = CY_DMAC_DESCRIPTOR_PING,
+    .priority = 3u,
+    .enable = false,
+};
+
+const cy_stc_dmac_descriptor_config_t UART1_RX_DMA_ping_config =
+{
+    .srcAddress = NULL,
+    .dstAddress = NULL,
+    .dataCount = 64u,
+    .dataTransferWidth = CY_DMAC_WORD_BYTE,
+    .srcAddrIncrement = false,
+    .dstAddrIncrement = true,
+    .retrigger = CY_DMAC_RETRIG_4CYC,
+    .cpltState = false,
+    .interrupt = true,
+    .preemptable = false,
+    .flipping = true,
+    .triggerType = CY_DMAC_SINGLE_ELEMENT,
+};
+
+const cy_stc_dmac_descriptor_config_t UART1_RX_DMA_pong_config =
+{
+    .srcAddress = NULL,
+    .dstAddress = NULL,
+    .dataCount = 64u,
+    .dataTransferWidth = CY_DMAC_WORD_BYTE,
+    .srcAddrIncrement = false,
+    .dstAddrIncrement = true,
+    .retrigger = CY_DMAC_RETRIG_4CYC,
+    .cpltState = false,
+    .interrupt = true,
+    .preemptable = false,
+    .flipping = true,
+    .triggerType = CY_DMAC_SINGLE_ELEMENT,
+};
+
+const cy_stc_dmac_channel_config_t UART1_RX_DMA_channel_config =
+{
+    .descriptor = CY_DMAC_DESCRIPTOR_PING,
+    .priority = 3u,
+    .enable = false,
+};
+
+const cy_stc_usbfs_dev_drv_config_t CYBSP_USB_config =
+{
+    .mode = 0u,
+};
+
+const cy_stc_usb_dev_device_t usb_devices[1];
+const cy_stc_usb_dev_config_t usb_devConfig;
+const cy_stc_usb_dev_cdc_config_t usb_cdcConfig;
+
+
+/*******************************************************************************
+* Function Name: cybsp_init
+********************************************************************************
+*
+* Summary:
+*  Sets up the pins and clocks as the generated init code does, and connects
+*  the blocks of the model: SCB triggers to their DMA channels, each UART TX
+*  looped back to its own RX pin, endpoints to their DMA channels and the CDC
+*  interfaces to their endpoints.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  cy_rslt_t: CY_RSLT_SUCCESS
+*
+*******************************************************************************/
+cy_rslt_t cybsp_init(void)
+{
+    uint32_t endpoint;
+
+    Cy_GPIO_SetDrivemode(CYBSP_UART_RX_PORT, CYBSP_UART_RX_PIN, CY_GPIO_DM_HIGHZ);
+    Cy_GPIO_SetDrivemode(CYBSP_UART_TX_PORT, CYBSP_UART_TX_PIN, CY_GPIO_DM_STRONG_IN_OFF);
+    Cy_GPIO_SetHSIOM(CYBSP_UART_TX_PORT, CYBSP_UART_TX_PIN, CYBSP_UART_TX_HSIOM);
+    Cy_GPIO_SetDrivemode(CYBSP_UART1_RX_PORT, CYBSP_UART1_RX_PIN, CY_GPIO_DM_HIGHZ);
+    Cy_GPIO_SetDrivemode(CYBSP_UART1_TX_PORT, CYBSP_UART1_TX_PIN, CY_GPIO_DM_STRONG_IN_OFF);
+    Cy_GPIO_SetHSIOM(CYBSP_UART1_TX_PORT, CYBSP_UART1_TX_PIN, CYBSP_UART1_TX_HSIOM);
+    Cy_GPIO_SetDrivemode(CYBSP_USB_DP_PORT, CYBSP_USB_DP_PIN, CY_GPIO_DM_ANALOG);
+    Cy_GPIO_SetDrivemode(CYBSP_USB_DM_PORT, CYBSP_USB_DM_PIN, CY_GPIO_DM_ANALOG);
+    Cy_GPIO_SetDrivemode(CYBSP_USER_LED_PORT, CYBSP_USER_LED_PIN, CY_GPIO_DM_STRONG_IN_OFF);
+
+    (void) Cy_SysClk_PeriphSetDivider(CYBSP_UART_CLK_HW, CYBSP_UART_CLK_NUM, CYBSP_UART_CLK_DIV - 1u);
+    (void) Cy_SysClk_PeriphEnableDivider(CYBSP_UART_CLK_HW, CYBSP_UART_CLK_NUM);
+    (void) Cy_SysClk_PeriphSetDivider(CYBSP_UART1_CLK_HW, CYBSP_UART1_CLK_NUM, CYBSP_UART_CLK_DIV - 1u);
+    (void) Cy_SysClk_PeriphEnableDivider(CYBSP_UART1_CLK_HW, CYBSP_UART1_CLK_NUM);
+
+    sim_scb_connect(CYBSP_UART_HW, CYBSP_UART_CLK_NUM, CYBSP_UART_IRQ, UART_TX_DMA_CHANNEL, UART_RX_DMA_CHANNEL,
+                    CYBSP_UART_RX_PORT, CYBSP_UART_RX_PIN);
+    sim_scb_connect(CYBSP_UART1_HW, CYBSP_UART1_CLK_NUM, CYBSP_UART1_IRQ, UART1_TX_DMA_CHANNEL,
+                    UART1_RX_DMA_CHANNEL, CYBSP_UART1_RX_PORT, CYBSP_UART1_RX_PIN);
+
+    /* usb[0].dma_req[n] drives channel n + 8 for endpoint n + 1 */
+    for (endpoint = 1u; endpoint <= CY_USBFS_DEV_DRV_NUM_EPS_MAX; endpoint++)
+    {
+        sim_usb_connect(endpoint, endpoint + 7u);
+    }
+    /* The second CDC interface takes the endpoints of the port 1 settings,
+     * with its notifications on EP4 */
+    sim_usb_cdc(0u, 0u, 1u, 2u, 3u);
+    sim_usb_cdc(1u, BRIDGE_PORT1_COMM_INTERFACE, 4u, BRIDGE_PORT1_EP_IN, BRIDGE_PORT1_EP_OUT);
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/* [] END OF FILE */
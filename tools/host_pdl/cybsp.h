@@ -0,0 +1,145 @@
+/******************************************************************************
+* File Name: cybsp.h
+*
+* Description: Board support of the device model. Port 0 follows design.modus;
+*              UART1 and the optional pins stand for a board with the
+*              hardware of BRIDGE_PORTS=2, flow control, DTR and RS-485.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CYBSP_H_
+#define CYBSP_H_
+
+#include "cy_pdl.h"
+#include "cy_usb_dev.h"
+#include "host_pdl.h"
+
+
+/*******************************************************************************
+*        Port 0: scb[0], design.modus
+*******************************************************************************/
+#define CYBSP_UART_HW               (&sim_scb[0])
+#define CYBSP_UART_IRQ              scb_0_interrupt_IRQn
+#define CYBSP_UART_CLK_HW           CY_SYSCLK_DIV_16_BIT
+#define CYBSP_UART_CLK_NUM          (3u)
+#define CYBSP_UART_CLK_DIV          (52u)
+
+#define CYBSP_UART_RX_PORT          (&sim_gpio_prt[4])
+#define CYBSP_UART_RX_PIN           (0u)
+#define CYBSP_UART_RX_IRQ           ioss_interrupts_gpio_4_IRQn
+#define CYBSP_UART_TX_PORT          (&sim_gpio_prt[4])
+#define CYBSP_UART_TX_PIN           (1u)
+#define CYBSP_UART_TX_HSIOM         (9u)
+#define CYBSP_UART_RTS_PORT         (&sim_gpio_prt[2])
+#define CYBSP_UART_RTS_PIN          (0u)
+#define CYBSP_UART_CTS_PORT         (&sim_gpio_prt[2])
+#define CYBSP_UART_CTS_PIN          (1u)
+#define CYBSP_UART_DTR_PORT         (&sim_gpio_prt[2])
+#define CYBSP_UART_DTR_PIN          (2u)
+#define CYBSP_UART_DE_PORT          (&sim_gpio_prt[2])
+#define CYBSP_UART_DE_PIN           (3u)
+
+#define UART_TX_DMA_HW              DMAC
+#define UART_TX_DMA_CHANNEL         (0u)
+#define UART_RX_DMA_HW              DMAC
+#define UART_RX_DMA_CHANNEL         (1u)
+
+extern const cy_stc_scb_uart_config_t CYBSP_UART_config;
+extern const cy_stc_dmac_descriptor_config_t UART_TX_DMA_ping_config;
+extern const cy_stc_dmac_descriptor_config_t UART_TX_DMA_pong_config;
+extern const cy_stc_dmac_channel_config_t UART_TX_DMA_channel_config;
+extern const cy_stc_dmac_descriptor_config_t UART_RX_DMA_ping_config;
+extern const cy_stc_dmac_descriptor_config_t UART_RX_DMA_pong_config;
+extern const cy_stc_dmac_channel_config_t UART_RX_DMA_channel_config;
+
+
+/*******************************************************************************
+*        Port 1: scb[1]
+*******************************************************************************/
+#define CYBSP_UART1_HW              (&sim_scb[1])
+#define CYBSP_UART1_IRQ             scb_1_interrupt_IRQn
+#define CYBSP_UART1_CLK_HW          CY_SYSCLK_DIV_16_BIT
+#define CYBSP_UART1_CLK_NUM         (4u)
+
+#define CYBSP_UART1_RX_PORT         (&sim_gpio_prt[3])
+#define CYBSP_UART1_RX_PIN          (0u)
+#define CYBSP_UART1_RX_IRQ          ioss_interrupts_gpio_3_IRQn
+#define CYBSP_UART1_TX_PORT         (&sim_gpio_prt[3])
+#define CYBSP_UART1_TX_PIN          (1u)
+#define CYBSP_UART1_TX_HSIOM        (9u)
+#define CYBSP_UART1_RTS_PORT        (&sim_gpio_prt[3])
+#define CYBSP_UART1_RTS_PIN         (2u)
+#define CYBSP_UART1_CTS_PORT        (&sim_gpio_prt[3])
+#define CYBSP_UART1_CTS_PIN         (3u)
+#define CYBSP_UART1_DTR_PORT        (&sim_gpio_prt[3])
+#define CYBSP_UART1_DTR_PIN         (4u)
+#define CYBSP_UART1_DE_PORT         (&sim_gpio_prt[3])
+#define CYBSP_UART1_DE_PIN          (5u)
+
+#define UART1_TX_DMA_HW             DMAC
+#define UART1_TX_DMA_CHANNEL        (2u)
+#define UART1_RX_DMA_HW             DMAC
+#define UART1_RX_DMA_CHANNEL        (3u)
+
+extern const cy_stc_scb_uart_config_t CYBSP_UART1_config;
+extern const cy_stc_dmac_descriptor_config_t UART1_TX_DMA_ping_config;
+extern const cy_stc_dmac_channel_config_t UART1_TX_DMA_channel_config;
+extern const cy_stc_dmac_descriptor_config_t UART1_RX_DMA_ping_config;
+extern const cy_stc_dmac_descriptor_config_t UART1_RX_DMA_pong_config;
+extern const cy_stc_dmac_channel_config_t UART1_RX_DMA_channel_config;
+
+
+/*******************************************************************************
+*        USB and LED
+*******************************************************************************/
+#define CYBSP_USB_HW                (&sim_usbfs)
+#define CYBSP_USB_DP_PORT           (&sim_gpio_prt[8])
+#define CYBSP_USB_DP_PIN            (0u)
+#define CYBSP_USB_DP_IRQ            ioss_interrupts_gpio_8_IRQn
+#define CYBSP_USB_DM_PORT           (&sim_gpio_prt[8])
+#define CYBSP_USB_DM_PIN            (1u)
+
+#define CYBSP_USER_LED_PORT         (&sim_gpio_prt[5])
+#define CYBSP_USER_LED_PIN          (5u)
+
+extern const cy_stc_usbfs_dev_drv_config_t CYBSP_USB_config;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+cy_rslt_t cybsp_init(void);
+
+
+#endif /* CYBSP_H_ */
@@ -0,0 +1,1407 @@
+/******************************************************************************
+* File Name: host_pdl.c
+*
+* Description: Device model behind the host PDL headers: CPU time, NVIC,
+*              SysTick, clocks, GPIO, DMAC and the SCB UARTs. Firmware code
+*              runs on the host; interrupts are taken at PDL calls.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_pdl.h"
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* CPU cycles charged to every PDL call, standing for the firmware code that
+ * runs between two calls */
+#define SIM_CALL_CYCLES             (20u)
+
+/* Cortex-M0 exception entry and exit */
+#define SIM_ISR_CYCLES              (16u)
+
+/* Priority of thread mode, below every interrupt */
+#define SIM_THREAD_LEVEL            (4u)
+
+/* Priority of SysTick, which the firmware leaves at the lowest level */
+#define SIM_SYSTICK_PRIORITY        (3u)
+
+#define SIM_NO_EVENT                (UINT64_MAX)
+
+/* SCB FIFO depth in bytes */
+#define SIM_FIFO_SIZE               (16u)
+
+#define SIM_PINS                    (8u)
+#define SIM_DIVIDERS                (8u)
+
+/* Input buffer bit of the GPIO drive modes */
+#define SIM_DM_INPUT_ON             (0x08u)
+
+/*******************************************************************************
+*            Enumerated Types and Structures
+*******************************************************************************/
+typedef struct
+{
+    cy_israddress isr;
+    uint32_t priority;
+    bool enabled;
+    bool pending;                   /* Software pending, the lines are level sensitive */
+    uint32_t count;
+} sim_irq_t;
+
+typedef struct
+{
+    void *src;
+    void *dst;
+    uint32_t count;
+    uint32_t index;
+    cy_en_dmac_data_transfer_width_t width;
+    bool src_increment;
+    bool dst_increment;
+    bool cplt_state;
+    bool interrupt;
+    bool flipping;
+    bool valid;
+    cy_en_dmac_response_t response;
+} sim_descr_t;
+
+typedef struct
+{
+    sim_descr_t descr[2];
+    uint32_t current;
+    bool enabled;
+} sim_channel_t;
+
+typedef struct
+{
+    uint8_t data[SIM_FIFO_SIZE];
+    uint32_t head;
+    uint32_t count;
+} sim_fifo_t;
+
+typedef struct
+{
+    bool connected;
+    uint32_t clk_num;
+    IRQn_Type irq;
+    uint32_t tx_channel;
+    uint32_t rx_channel;
+    GPIO_PRT_Type *rx_port;
+    uint32_t rx_pin;
+    bool enabled;
+    cy_stc_scb_uart_config_t config;
+    sim_fifo_t tx;
+    sim_fifo_t rx;
+    uint32_t tx_status;
+    uint32_t rx_status;
+    uint32_t tx_mask;
+    uint32_t rx_mask;
+    uint32_t tx_level;
+    uint32_t rx_level;
+    bool shifting;                  /* A frame is on TX, looped back to RX */
+    uint8_t shift_data;
+    uint64_t shift_start;
+    uint64_t shift_done;
+    uint64_t bit_cycles;
+} sim_scb_t;
+
+typedef struct
+{
+    uint8_t out;
+    uint8_t input;                  /* Level driven from outside, idle high */
+    uint8_t drive;
+    uint8_t edge;
+    bool intr;
+    uint32_t hsiom;
+    sim_scb_t *wire;                /* SCB whose TX drives the pin */
+} sim_pin_t;
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+SCB_Type sim_scb_regs;
+DMAC_Type sim_dmac;
+GPIO_PRT_Type sim_gpio_prt[SIM_GPIO_PORTS];
+CySCB_Type sim_scb[SIM_SCBS];
+
+static uint64_t sim_time;
+static uint64_t sim_sleep;
+static bool sim_primask = true;
+static uint32_t sim_level = SIM_THREAD_LEVEL;
+static sim_irq_t sim_irqs[SIM_IRQS];
+
+static uint64_t sim_timer_time = SIM_NO_EVENT;
+static sim_timer_handler_t sim_timer_handler;
+
+static bool systick_running;
+static uint32_t systick_reload;
+static uint64_t systick_next = SIM_NO_EVENT;
+static Cy_SysTick_Callback systick_callbacks[5];
+
+static uint32_t sim_dividers[SIM_DIVIDERS];
+
+static sim_channel_t sim_channels[CY_DMAC_CHANNELS];
+static uint32_t dmac_intr_status;
+static uint32_t dmac_intr_mask;
+
+static sim_scb_t sim_scbs[SIM_SCBS];
+static sim_pin_t sim_pins[SIM_GPIO_PORTS][SIM_PINS];
+
+static const char *const sim_irq_names[SIM_IRQS] =
+{
+    "pendsv", "systick", "gpio0", "gpio1", "gpio2", "gpio3", "gpio4", "gpio5", "gpio6", "gpio7", "gpio8",
+    "scb0", "scb1", "dma", "usb_hi", "usb_med", "usb_lo", "tcpwm0", "tcpwm1"
+};
+
+static void sim_deliver(void);
+static void sim_advance(uint64_t until);
+static void dma_service(void);
+static void scb_shift_start(sim_scb_t *scb);
+
+
+/*******************************************************************************
+*        Model helpers
+*******************************************************************************/
+static sim_scb_t *scb_of(CySCB_Type const *base)
+{
+    uint32_t index = (uint32_t) (base - sim_scb);
+
+    CY_ASSERT(index < SIM_SCBS);
+    return &sim_scbs[index];
+}
+
+static sim_pin_t *pin_of(GPIO_PRT_Type const *base, uint32_t pin)
+{
+    uint32_t port = (uint32_t) (base - sim_gpio_prt);
+
+    CY_ASSERT((port < SIM_GPIO_PORTS) && (pin < SIM_PINS));
+    return &sim_pins[port][pin];
+}
+
+static void fifo_push(sim_fifo_t *fifo, uint8_t data)
+{
+    fifo->data[(fifo->head + fifo->count) % SIM_FIFO_SIZE] = data;
+    fifo->count++;
+}
+
+static uint8_t fifo_pop(sim_fifo_t *fifo)
+{
+    uint8_t data = fifo->data[fifo->head];
+
+    fifo->head = (fifo->head + 1u) % SIM_FIFO_SIZE;
+    fifo->count--;
+    return data;
+}
+
+/* Level of the UART line of an SCB at a time of the current frame */
+static uint32_t wire_level(const sim_scb_t *scb, uint64_t time)
+{
+    uint32_t bit;
+    uint32_t data_bits = scb->config.dataWidth;
+    uint32_t parity;
+
+    if (!scb->shifting || (time < scb->shift_start))
+    {
+        return 1u;
+    }
+    bit = (uint32_t) ((time - scb->shift_start) / scb->bit_cycles);
+    if (bit == 0u)
+    {
+        return 0u;
+    }
+    if (bit <= data_bits)
+    {
+        return (scb->shift_data >> (bit - 1u)) & 1u;
+    }
+    if ((bit == (data_bits + 1u)) && (scb->config.parity != CY_SCB_UART_PARITY_NONE))
+    {
+        parity = (uint32_t) __builtin_popcount(scb->shift_data) & 1u;
+        return (scb->config.parity == CY_SCB_UART_PARITY_ODD) ? (parity ^ 1u) : parity;
+    }
+    return 1u;
+}
+
+/* Next level change of the UART line within the current frame */
+static uint64_t wire_next_edge(const sim_scb_t *scb)
+{
+    uint64_t time;
+    uint32_t level;
+
+    if (!scb->shifting)
+    {
+        return SIM_NO_EVENT;
+    }
+    level = wire_level(scb, sim_time);
+    time = scb->shift_start + ((((sim_time - scb->shift_start) / scb->bit_cycles) + 1u) * scb->bit_cycles);
+    for (; time < scb->shift_done; time += scb->bit_cycles)
+    {
+        if (wire_level(scb, time) != level)
+        {
+            return time;
+        }
+    }
+    return SIM_NO_EVENT;
+}
+
+static uint32_t pin_level(const sim_pin_t *pin, uint64_t time)
+{
+    return (pin->wire != NULL) ? wire_level(pin->wire, time) : pin->input;
+}
+
+/* Latches the edge interrupt of a pin for a level change */
+static void pin_edge(sim_pin_t *pin, uint32_t from, uint32_t to)
+{
+    if (((pin->drive & SIM_DM_INPUT_ON) == 0u) || (from == to))
+    {
+        return;
+    }
+    if (((to == 0u) && ((pin->edge & CY_GPIO_INTR_FALLING) != 0u)) ||
+        ((to != 0u) && ((pin->edge & CY_GPIO_INTR_RISING) != 0u)))
+    {
+        pin->intr = true;
+    }
+}
+
+/* Next wire edge that one of the pins with an edge interrupt waits for */
+static uint64_t pin_next_event(void)
+{
+    uint64_t next = SIM_NO_EVENT;
+    uint64_t edge;
+    uint32_t port;
+    uint32_t pin;
+
+    for (port = 0u; port < SIM_GPIO_PORTS; port++)
+    {
+        for (pin = 0u; pin < SIM_PINS; pin++)
+        {
+            if ((sim_pins[port][pin].wire != NULL) && (sim_pins[port][pin].edge != CY_GPIO_INTR_DISABLE))
+            {
+                edge = wire_next_edge(sim_pins[port][pin].wire);
+                next = (edge < next) ? edge : next;
+            }
+        }
+    }
+    return next;
+}
+
+static void pin_wire_edges(uint64_t time)
+{
+    uint32_t port;
+    uint32_t pin;
+    sim_pin_t *p;
+
+    for (port = 0u; port < SIM_GPIO_PORTS; port++)
+    {
+        for (pin = 0u; pin < SIM_PINS; pin++)
+        {
+            p = &sim_pins[port][pin];
+            if ((p->wire != NULL) && (p->edge != CY_GPIO_INTR_DISABLE) && (time > 0u))
+            {
+                pin_edge(p, wire_level(p->wire, time - 1u), wire_level(p->wire, time));
+            }
+        }
+    }
+}
+
+/* Time of one UART frame on an SCB, from its clock divider and configuration */
+static void scb_timing(sim_scb_t *scb)
+{
+    uint32_t divider = sim_dividers[scb->clk_num];
+
+    scb->bit_cycles = (uint64_t) ((divider != 0u) ? divider : 1u) * scb->config.oversample;
+}
+
+static uint64_t scb_frame_cycles(const sim_scb_t *scb)
+{
+    uint32_t bits = 1u + scb->config.dataWidth + ((scb->config.parity != CY_SCB_UART_PARITY_NONE) ? 1u : 0u);
+
+    /* stopBits counts half bits */
+    return (scb->bit_cycles * bits) + ((scb->bit_cycles * (uint32_t) scb->config.stopBits) / 2u);
+}
+
+/* Loads the next byte of the TX FIFO into the shifter */
+static void scb_shift_start(sim_scb_t *scb)
+{
+    sim_pin_t *rx_pin;
+
+    if (!scb->enabled || scb->shifting || (scb->tx.count == 0u))
+    {
+        return;
+    }
+    scb->shift_data = fifo_pop(&scb->tx);
+    scb->shifting = true;
+    scb->shift_start = sim_time;
+    scb->shift_done = sim_time + scb_frame_cycles(scb);
+    scb->tx_status &= ~CY_SCB_UART_TX_DONE;
+
+    /* The start bit is a falling edge on the looped back RX line */
+    if (scb->rx_port != NULL)
+    {
+        rx_pin = pin_of(scb->rx_port, scb->rx_pin);
+        pin_edge(rx_pin, 1u, 0u);
+    }
+}
+
+/* End of the frame on the shifter: the byte arrives in the RX FIFO */
+static void scb_shift_done(sim_scb_t *scb)
+{
+    scb->shifting = false;
+    if (scb->enabled)
+    {
+        if (scb->rx.count < SIM_FIFO_SIZE)
+        {
+            fifo_push(&scb->rx, scb->shift_data);
+        }
+        else
+        {
+            scb->rx_status |= CY_SCB_UART_RX_OVERFLOW;
+        }
+    }
+    scb_shift_start(scb);
+    if (!scb->shifting)
+    {
+        scb->tx_status |= CY_SCB_UART_TX_DONE;
+    }
+}
+
+static void scb_reset(sim_scb_t *scb)
+{
+    scb->tx.count = 0u;
+    scb->rx.count = 0u;
+    scb->shifting = false;
+}
+
+/* Reads one element for a DMA transfer, from memory or an SCB RX FIFO */
+static uint32_t dma_read(void *address, uint32_t size)
+{
+    uint32_t index;
+    uint32_t value = 0u;
+
+    for (index = 0u; index < SIM_SCBS; index++)
+    {
+        if (address == (void *) &sim_scb[index].RX_FIFO_RD)
+        {
+            sim_scb_t *scb = &sim_scbs[index];
+
+            if (scb->rx.count == 0u)
+            {
+                scb->rx_status |= CY_SCB_UART_RX_UNDERFLOW;
+                return 0u;
+            }
+            return fifo_pop(&scb->rx);
+        }
+    }
+    memcpy(&value, address, size);
+    return value;
+}
+
+/* Writes one element for a DMA transfer, to memory or an SCB TX FIFO */
+static void dma_write(void *address, uint32_t size, uint32_t value)
+{
+    uint32_t index;
+
+    for (index = 0u; index < SIM_SCBS; index++)
+    {
+        if (address == (void *) &sim_scb[index].TX_FIFO_WR)
+        {
+            sim_scb_t *scb = &sim_scbs[index];
+
+            if (scb->tx.count == SIM_FIFO_SIZE)
+            {
+                scb->tx_status |= CY_SCB_UART_TX_OVERFLOW;
+                return;
+            }
+            fifo_push(&scb->tx, (uint8_t) value);
+            scb_shift_start(scb);
+            return;
+        }
+    }
+    memcpy(address, &value, size);
+}
+
+/* Moves one element on a channel and completes its descriptor at the end */
+static void dma_element(uint32_t channel)
+{
+    static const uint8_t src_size[] = { 1u, 1u, 1u, 2u, 2u, 2u, 4u, 4u, 4u };
+    static const uint8_t dst_size[] = { 1u, 2u, 4u, 1u, 2u, 4u, 1u, 2u, 4u };
+    sim_channel_t *chan = &sim_channels[channel];
+    sim_descr_t *descr = &chan->descr[chan->current];
+    uint32_t ssize = src_size[descr->width];
+    uint32_t dsize = dst_size[descr->width];
+    uint32_t value;
+
+    value = dma_read((uint8_t *) descr->src + (descr->src_increment ? (descr->index * ssize) : 0u), ssize);
+    dma_write((uint8_t *) descr->dst + (descr->dst_increment ? (descr->index * dsize) : 0u), dsize, value);
+    descr->index++;
+    if (descr->index < descr->count)
+    {
+        return;
+    }
+
+    descr->index = 0u;
+    descr->response = CY_DMAC_DONE;
+    if (descr->cplt_state)
+    {
+        descr->valid = false;
+    }
+    if (descr->interrupt)
+    {
+        dmac_intr_status |= (1UL << channel);
+    }
+    if (descr->flipping)
+    {
+        chan->current ^= 1u;
+    }
+}
+
+/* Runs the enabled channels while their SCB trigger is active. Transfers
+ * take no time: the DMAC is much faster than the UART. */
+static void dma_service(void)
+{
+    uint32_t index;
+    sim_scb_t *scb;
+    sim_channel_t *chan;
+    bool moved = true;
+
+    while (moved)
+    {
+        moved = false;
+        for (index = 0u; index < SIM_SCBS; index++)
+        {
+            scb = &sim_scbs[index];
+            if (!scb->connected || !scb->enabled)
+            {
+                continue;
+            }
+            chan = &sim_channels[scb->tx_channel];
+            if (chan->enabled && chan->descr[chan->current].valid && (scb->tx.count < scb->tx_level))
+            {
+                dma_element(scb->tx_channel);
+                moved = true;
+            }
+            chan = &sim_channels[scb->rx_channel];
+            if (chan->enabled && chan->descr[chan->current].valid && (scb->rx.count > scb->rx_level))
+            {
+                dma_element(scb->rx_channel);
+                moved = true;
+            }
+        }
+    }
+}
+
+/* Whether the line of a peripheral interrupt is asserted */
+bool sim_irq_line(IRQn_Type irq)
+{
+    uint32_t index;
+    uint32_t pin;
+
+    if ((irq >= ioss_interrupts_gpio_0_IRQn) && (irq <= ioss_interrupts_gpio_8_IRQn))
+    {
+        for (pin = 0u; pin < SIM_PINS; pin++)
+        {
+            if (sim_pins[irq - ioss_interrupts_gpio_0_IRQn][pin].intr)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    for (index = 0u; index < SIM_SCBS; index++)
+    {
+        if (sim_scbs[index].connected && (sim_scbs[index].irq == irq))
+        {
+            return ((sim_scbs[index].tx_status & sim_scbs[index].tx_mask) != 0u) ||
+                   ((sim_scbs[index].rx_status & sim_scbs[index].rx_mask) != 0u);
+        }
+    }
+    if (irq == cpuss_interrupt_dma_IRQn)
+    {
+        return (dmac_intr_status & dmac_intr_mask) != 0u;
+    }
+    return sim_usb_line(irq);
+}
+
+static bool irq_active(uint32_t index)
+{
+    sim_irq_t *irq = &sim_irqs[index];
+
+    if (!irq->enabled)
+    {
+        return false;
+    }
+    return irq->pending || ((index >= SIM_IRQ_INDEX(0)) && sim_irq_line((IRQn_Type) ((int32_t) index - 2)));
+}
+
+/* Takes the highest priority active interrupt above the running level, the
+ * lowest exception number first among equal priorities */
+static void sim_deliver(void)
+{
+    uint32_t index;
+    uint32_t best;
+    uint32_t saved;
+
+    for (;;)
+    {
+        if (sim_primask)
+        {
+            return;
+        }
+        best = SIM_IRQS;
+        for (index = 0u; index < SIM_IRQS; index++)
+        {
+            if ((sim_irqs[index].priority < sim_level) && irq_active(index) &&
+                ((best == SIM_IRQS) || (sim_irqs[index].priority < sim_irqs[best].priority)))
+            {
+                best = index;
+            }
+        }
+        if (best == SIM_IRQS)
+        {
+            return;
+        }
+
+        saved = sim_level;
+        sim_level = sim_irqs[best].priority;
+        sim_irqs[best].pending = false;
+        sim_irqs[best].count++;
+        sim_advance(sim_time + SIM_ISR_CYCLES);
+        if (sim_irqs[best].isr != NULL)
+        {
+            sim_irqs[best].isr();
+        }
+        sim_advance(sim_time + SIM_ISR_CYCLES);
+        sim_level = saved;
+    }
+}
+
+static void systick_isr(void)
+{
+    uint32_t index;
+
+    for (index = 0u; index < (sizeof(systick_callbacks) / sizeof(systick_callbacks[0])); index++)
+    {
+        if (systick_callbacks[index] != NULL)
+        {
+            systick_callbacks[index]();
+        }
+    }
+}
+
+static uint64_t next_event(void)
+{
+    uint64_t next = systick_next;
+    uint32_t index;
+    uint64_t edge;
+
+    next = (sim_timer_time < next) ? sim_timer_time : next;
+    for (index = 0u; index < SIM_SCBS; index++)
+    {
+        if (sim_scbs[index].shifting && (sim_scbs[index].shift_done < next))
+        {
+            next = sim_scbs[index].shift_done;
+        }
+    }
+    edge = pin_next_event();
+    return (edge < next) ? edge : next;
+}
+
+/* Moves the time forward to until, running the events due on the way */
+static void sim_advance(uint64_t until)
+{
+    uint64_t next;
+    uint32_t index;
+    sim_timer_handler_t handler;
+
+    while ((next = next_event()) <= until)
+    {
+        sim_time = (next > sim_time) ? next : sim_time;
+        pin_wire_edges(sim_time);
+        if (systick_next <= sim_time)
+        {
+            systick_next += (uint64_t) systick_reload + 1u;
+            sim_irqs[SIM_IRQ_INDEX(SysTick_IRQn)].pending = true;
+        }
+        for (index = 0u; index < SIM_SCBS; index++)
+        {
+            if (sim_scbs[index].shifting && (sim_scbs[index].shift_done <= sim_time))
+            {
+                scb_shift_done(&sim_scbs[index]);
+            }
+        }
+        dma_service();
+        if (sim_timer_time <= sim_time)
+        {
+            handler = sim_timer_handler;
+            sim_timer_time = SIM_NO_EVENT;
+            handler();
+        }
+    }
+    sim_time = (until > sim_time) ? until : sim_time;
+}
+
+/* Whether an enabled interrupt waits, whatever PRIMASK and the running level */
+static bool wake_pending(bool deep)
+{
+    uint32_t index;
+
+    for (index = 0u; index < SIM_IRQS; index++)
+    {
+        if (deep && ((index < SIM_IRQ_INDEX(ioss_interrupts_gpio_0_IRQn)) ||
+                     (index > SIM_IRQ_INDEX(ioss_interrupts_gpio_8_IRQn))))
+        {
+            continue;
+        }
+        if (irq_active(index))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sim_wait(bool deep)
+{
+    uint64_t start = sim_time;
+    uint64_t next;
+    uint64_t systick_left = 0u;
+
+    if (deep && (systick_next != SIM_NO_EVENT))
+    {
+        /* SysTick stops in Deep Sleep */
+        systick_left = systick_next - sim_time;
+        systick_next = SIM_NO_EVENT;
+    }
+    while (!wake_pending(deep))
+    {
+        next = next_event();
+        if (next == SIM_NO_EVENT)
+        {
+            fprintf(stderr, "sim: CPU sleeps with no event left\n");
+            exit(2);
+        }
+        sim_advance(next);
+    }
+    if (deep && systick_running)
+    {
+        systick_next = sim_time + systick_left;
+    }
+    sim_sleep += sim_time - start;
+}
+
+/* Mirrors the ICSR writes of the firmware into the pending state */
+static void icsr_sync(void)
+{
+    if ((SCB->ICSR & SCB_ICSR_PENDSVSET_Msk) != 0u)
+    {
+        sim_irqs[SIM_IRQ_INDEX(PendSV_IRQn)].pending = true;
+    }
+    SCB->ICSR = sim_irqs[SIM_IRQ_INDEX(SysTick_IRQn)].pending ? SCB_ICSR_PENDSTSET_Msk : 0u;
+}
+
+void sim_step(void)
+{
+    icsr_sync();
+    sim_advance(sim_time + SIM_CALL_CYCLES);
+    dma_service();
+    sim_deliver();
+    icsr_sync();
+}
+
+
+/*******************************************************************************
+*        Simulation interface
+*******************************************************************************/
+uint64_t sim_now(void)
+{
+    return sim_time;
+}
+
+uint64_t sim_sleep_cycles(void)
+{
+    return sim_sleep;
+}
+
+void sim_timer_start(uint64_t time, sim_timer_handler_t handler)
+{
+    sim_timer_time = time;
+    sim_timer_handler = handler;
+}
+
+uint32_t sim_irq_count(uint32_t index)
+{
+    return (index < SIM_IRQS) ? sim_irqs[index].count : 0u;
+}
+
+const char *sim_irq_name(uint32_t index)
+{
+    return (index < SIM_IRQS) ? sim_irq_names[index] : "";
+}
+
+void sim_scb_connect(CySCB_Type *base, uint32_t clk_num, IRQn_Type irq, uint32_t tx_channel, uint32_t rx_channel,
+                     GPIO_PRT_Type *rx_port, uint32_t rx_pin)
+{
+    sim_scb_t *scb = scb_of(base);
+
+    scb->connected = true;
+    scb->clk_num = clk_num;
+    scb->irq = irq;
+    scb->tx_channel = tx_channel;
+    scb->rx_channel = rx_channel;
+    scb->rx_port = rx_port;
+    scb->rx_pin = rx_pin;
+    pin_of(rx_port, rx_pin)->wire = scb;
+}
+
+void sim_gpio_drive(GPIO_PRT_Type *base, uint32_t pinNum, uint32_t value)
+{
+    sim_pin_t *pin = pin_of(base, pinNum);
+
+    pin_edge(pin, pin->input, value);
+    pin->input = (uint8_t) value;
+}
+
+void sim_dmac_complete(uint32_t channel)
+{
+    dmac_intr_status |= (1UL << channel);
+}
+
+void sim_assert_failed(const char *file, uint32_t line)
+{
+    fprintf(stderr, "sim: assertion failed at %s:%u, %.3f ms\n", file, (unsigned) line,
+            (double) sim_time / (double) SIM_US(1000u));
+    exit(2);
+}
+
+
+/*******************************************************************************
+*        CMSIS
+*******************************************************************************/
+void __enable_irq(void)
+{
+    sim_primask = false;
+    sim_step();
+}
+
+void __disable_irq(void)
+{
+    sim_primask = true;
+}
+
+void __WFI(void)
+{
+    sim_wait(false);
+    sim_step();
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    sim_irqs[SIM_IRQ_INDEX(irq)].enabled = true;
+    sim_step();
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    sim_irqs[SIM_IRQ_INDEX(irq)].enabled = false;
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq)
+{
+    sim_irqs[SIM_IRQ_INDEX(irq)].pending = true;
+    sim_step();
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+    sim_irqs[SIM_IRQ_INDEX(irq)].pending = false;
+}
+
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irq)
+{
+    return irq_active(SIM_IRQ_INDEX(irq)) ? 1u : 0u;
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+    sim_irqs[SIM_IRQ_INDEX(irq)].priority = priority;
+}
+
+
+/*******************************************************************************
+*        SysLib, SysInt, SysTick, SysClk, SysPm
+*******************************************************************************/
+uint32_t Cy_SysLib_EnterCriticalSection(void)
+{
+    uint32_t state;
+
+    sim_step();
+    state = sim_primask ? 1u : 0u;
+    sim_primask = true;
+    return state;
+}
+
+void Cy_SysLib_ExitCriticalSection(uint32_t savedIntrStatus)
+{
+    sim_primask = (savedIntrStatus != 0u);
+    sim_step();
+}
+
+void Cy_SysLib_Delay(uint32_t milliseconds)
+{
+    uint64_t end = sim_time + SIM_US(milliseconds * 1000u);
+
+    while (sim_time < end)
+    {
+        sim_step();
+    }
+}
+
+void Cy_SysLib_DelayUs(uint16_t microseconds)
+{
+    uint64_t end = sim_time + SIM_US(microseconds);
+
+    while (sim_time < end)
+    {
+        sim_step();
+    }
+}
+
+cy_en_sysint_status_t Cy_SysInt_Init(const cy_stc_sysint_t *config, cy_israddress userIsr)
+{
+    sim_irq_t *irq = &sim_irqs[SIM_IRQ_INDEX(config->intrSrc)];
+
+    irq->isr = userIsr;
+    irq->priority = config->intrPriority;
+    if (config->intrSrc == PendSV_IRQn)
+    {
+        irq->enabled = true;
+    }
+    sim_step();
+    return CY_SYSINT_SUCCESS;
+}
+
+void Cy_SysTick_Init(cy_en_systick_clock_source_t clockSource, uint32_t interval)
+{
+    sim_irq_t *irq = &sim_irqs[SIM_IRQ_INDEX(SysTick_IRQn)];
+
+    CY_ASSERT(clockSource == CY_SYSTICK_CLOCK_SOURCE_CLK_CPU);
+    systick_reload = interval;
+    systick_running = true;
+    systick_next = sim_time + (uint64_t) interval + 1u;
+    irq->isr = &systick_isr;
+    irq->priority = SIM_SYSTICK_PRIORITY;
+    irq->enabled = true;
+    sim_step();
+}
+
+Cy_SysTick_Callback Cy_SysTick_SetCallback(uint32_t number, Cy_SysTick_Callback function)
+{
+    Cy_SysTick_Callback old = systick_callbacks[number];
+
+    systick_callbacks[number] = function;
+    return old;
+}
+
+uint32_t Cy_SysTick_GetValue(void)
+{
+    sim_step();
+    return (uint32_t) (systick_next - sim_time - 1u);
+}
+
+uint32_t Cy_SysTick_GetReload(void)
+{
+    return systick_reload;
+}
+
+cy_en_sysclk_status_t Cy_SysClk_PeriphSetDivider(cy_en_divider_types_t dividerType, uint32_t dividerNum,
+                                                 uint32_t dividerValue)
+{
+    (void) dividerType;
+    CY_ASSERT(dividerNum < SIM_DIVIDERS);
+    sim_dividers[dividerNum] = dividerValue + 1u;
+    sim_step();
+    return CY_SYSCLK_SUCCESS;
+}
+
+cy_en_sysclk_status_t Cy_SysClk_PeriphEnableDivider(cy_en_divider_types_t dividerType, uint32_t dividerNum)
+{
+    (void) dividerType;
+    (void) dividerNum;
+    sim_step();
+    return CY_SYSCLK_SUCCESS;
+}
+
+cy_en_sysclk_status_t Cy_SysClk_PeriphDisableDivider(cy_en_divider_types_t dividerType, uint32_t dividerNum)
+{
+    (void) dividerType;
+    (void) dividerNum;
+    sim_step();
+    return CY_SYSCLK_SUCCESS;
+}
+
+uint32_t Cy_SysClk_ClkHfGetFrequency(void)
+{
+    return SIM_CLK_HZ;
+}
+
+uint32_t Cy_SysClk_ClkSysGetFrequency(void)
+{
+    return SIM_CLK_HZ;
+}
+
+cy_en_syspm_status_t Cy_SysPm_CpuEnterSleep(void)
+{
+    sim_wait(false);
+    sim_step();
+    return CY_SYSPM_SUCCESS;
+}
+
+cy_en_syspm_status_t Cy_SysPm_CpuEnterDeepSleep(void)
+{
+    sim_wait(true);
+    sim_step();
+    return CY_SYSPM_SUCCESS;
+}
+
+
+/*******************************************************************************
+*        GPIO
+*******************************************************************************/
+void Cy_GPIO_Write(GPIO_PRT_Type *base, uint32_t pinNum, uint32_t value)
+{
+    pin_of(base, pinNum)->out = (uint8_t) (value & 1u);
+    sim_step();
+}
+
+uint32_t Cy_GPIO_Read(GPIO_PRT_Type *base, uint32_t pinNum)
+{
+    sim_pin_t *pin = pin_of(base, pinNum);
+
+    sim_step();
+    if ((pin->drive & SIM_DM_INPUT_ON) == 0u)
+    {
+        return 0u;
+    }
+    return pin_level(pin, sim_time);
+}
+
+void Cy_GPIO_Set(GPIO_PRT_Type *base, uint32_t pinNum)
+{
+    Cy_GPIO_Write(base, pinNum, 1u);
+}
+
+void Cy_GPIO_Clr(GPIO_PRT_Type *base, uint32_t pinNum)
+{
+    Cy_GPIO_Write(base, pinNum, 0u);
+}
+
+void Cy_GPIO_Inv(GPIO_PRT_Type *base, uint32_t pinNum)
+{
+    Cy_GPIO_Write(base, pinNum, pin_of(base, pinNum)->out ^ 1u);
+}
+
+void Cy_GPIO_SetHSIOM(GPIO_PRT_Type *base, uint32_t pinNum, en_hsiom_sel_t value)
+{
+    pin_of(base, pinNum)->hsiom = value;
+    sim_step();
+}
+
+en_hsiom_sel_t Cy_GPIO_GetHSIOM(GPIO_PRT_Type *base, uint32_t pinNum)
+{
+    return pin_of(base, pinNum)->hsiom;
+}
+
+void Cy_GPIO_SetDrivemode(GPIO_PRT_Type *base, uint32_t pinNum, uint32_t value)
+{
+    pin_of(base, pinNum)->drive = (uint8_t) value;
+    sim_step();
+}
+
+uint32_t Cy_GPIO_GetDrivemode(GPIO_PRT_Type *base, uint32_t pinNum)
+{
+    return pin_of(base, pinNum)->drive;
+}
+
+void Cy_GPIO_SetInterruptEdge(GPIO_PRT_Type *base, uint32_t pinNum, uint32_t value)
+{
+    pin_of(base, pinNum)->edge = (uint8_t) value;
+    sim_step();
+}
+
+uint32_t Cy_GPIO_GetInterruptStatus(GPIO_PRT_Type *base, uint32_t pinNum)
+{
+    sim_step();
+    return pin_of(base, pinNum)->intr ? 1u : 0u;
+}
+
+void Cy_GPIO_ClearInterrupt(GPIO_PRT_Type *base, uint32_t pinNum)
+{
+    pin_of(base, pinNum)->intr = false;
+    sim_step();
+}
+
+
+/*******************************************************************************
+*        DMAC
+*******************************************************************************/
+cy_en_dmac_status_t Cy_DMAC_Descriptor_Init(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor,
+                                            const cy_stc_dmac_descriptor_config_t *config)
+{
+    sim_descr_t *descr = &sim_channels[channel].descr[descriptor];
+
+    (void) base;
+    descr->src = config->srcAddress;
+    descr->dst = config->dstAddress;
+    descr->count = config->dataCount;
+    descr->index = 0u;
+    descr->width = config->dataTransferWidth;
+    descr->src_increment = config->srcAddrIncrement;
+    descr->dst_increment = config->dstAddrIncrement;
+    descr->cplt_state = config->cpltState;
+    descr->interrupt = config->interrupt;
+    descr->flipping = config->flipping;
+    descr->valid = true;
+    descr->response = CY_DMAC_NO_ERROR;
+    sim_step();
+    return CY_DMAC_SUCCESS;
+}
+
+cy_en_dmac_status_t Cy_DMAC_Channel_Init(DMAC_Type *base, uint32_t channel, const cy_stc_dmac_channel_config_t *config)
+{
+    (void) base;
+    sim_channels[channel].current = (uint32_t) config->descriptor;
+    sim_channels[channel].enabled = config->enable;
+    sim_step();
+    return CY_DMAC_SUCCESS;
+}
+
+void Cy_DMAC_Descriptor_SetSrcAddress(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor,
+                                      const void *srcAddress)
+{
+    (void) base;
+    sim_channels[channel].descr[descriptor].src = (void *) (uintptr_t) srcAddress;
+    sim_step();
+}
+
+void Cy_DMAC_Descriptor_SetDstAddress(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor,
+                                      const void *dstAddress)
+{
+    (void) base;
+    sim_channels[channel].descr[descriptor].dst = (void *) (uintptr_t) dstAddress;
+    sim_step();
+}
+
+void Cy_DMAC_Descriptor_SetDataCount(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor,
+                                     uint32_t dataCount)
+{
+    (void) base;
+    CY_ASSERT((dataCount > 0u) && (dataCount <= CY_DMAC_MAX_DATA_COUNT));
+    sim_channels[channel].descr[descriptor].count = dataCount;
+    sim_step();
+}
+
+void Cy_DMAC_Descriptor_SetState(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor, bool state)
+{
+    (void) base;
+    sim_channels[channel].descr[descriptor].valid = state;
+    sim_step();
+}
+
+uint32_t Cy_DMAC_Descriptor_GetCurrentIndex(DMAC_Type const *base, uint32_t channel,
+                                            cy_en_dmac_descriptor_t descriptor)
+{
+    (void) base;
+    sim_step();
+    return sim_channels[channel].descr[descriptor].index;
+}
+
+cy_en_dmac_response_t Cy_DMAC_Descriptor_GetResponse(DMAC_Type const *base, uint32_t channel,
+                                                     cy_en_dmac_descriptor_t descriptor)
+{
+    (void) base;
+    sim_step();
+    return sim_channels[channel].descr[descriptor].response;
+}
+
+void Cy_DMAC_Channel_SetCurrentDescriptor(DMAC_Type *base, uint32_t channel, cy_en_dmac_descriptor_t descriptor)
+{
+    (void) base;
+    sim_channels[channel].current = (uint32_t) descriptor;
+    sim_step();
+}
+
+cy_en_dmac_descriptor_t Cy_DMAC_Channel_GetCurrentDescriptor(DMAC_Type const *base, uint32_t channel)
+{
+    (void) base;
+    sim_step();
+    return (cy_en_dmac_descriptor_t) sim_channels[channel].current;
+}
+
+void Cy_DMAC_Channel_Enable(DMAC_Type *base, uint32_t channel)
+{
+    (void) base;
+    sim_channels[channel].enabled = true;
+    sim_step();
+}
+
+void Cy_DMAC_Channel_Disable(DMAC_Type *base, uint32_t channel)
+{
+    (void) base;
+    sim_channels[channel].enabled = false;
+    sim_step();
+}
+
+uint32_t Cy_DMAC_GetActiveChannel(DMAC_Type const *base)
+{
+    (void) base;
+    sim_step();
+    return 0u;
+}
+
+void Cy_DMAC_Enable(DMAC_Type *base)
+{
+    (void) base;
+    sim_step();
+}
+
+void Cy_DMAC_Disable(DMAC_Type *base)
+{
+    (void) base;
+    sim_step();
+}
+
+uint32_t Cy_DMAC_GetInterruptStatus(DMAC_Type const *base)
+{
+    (void) base;
+    sim_step();
+    return dmac_intr_status;
+}
+
+uint32_t Cy_DMAC_GetInterruptStatusMasked(DMAC_Type const *base)
+{
+    (void) base;
+    sim_step();
+    return dmac_intr_status & dmac_intr_mask;
+}
+
+void Cy_DMAC_ClearInterrupt(DMAC_Type *base, uint32_t interrupt)
+{
+    (void) base;
+    dmac_intr_status &= ~interrupt;
+    sim_step();
+}
+
+void Cy_DMAC_SetInterruptMask(DMAC_Type *base, uint32_t interrupt)
+{
+    (void) base;
+    dmac_intr_mask = interrupt;
+    sim_step();
+}
+
+uint32_t Cy_DMAC_GetInterruptMask(DMAC_Type const *base)
+{
+    (void) base;
+    return dmac_intr_mask;
+}
+
+
+/*******************************************************************************
+*        SCB UART
+*******************************************************************************/
+cy_en_scb_uart_status_t Cy_SCB_UART_Init(CySCB_Type *base, const cy_stc_scb_uart_config_t *config,
+                                         cy_stc_scb_uart_context_t *context)
+{
+    sim_scb_t *scb = scb_of(base);
+
+    (void) context;
+    scb->config = *config;
+    scb->rx_mask = config->rxFifoIntEnableMask;
+    scb->tx_mask = config->txFifoIntEnableMask;
+    scb->rx_level = config->rxFifoTriggerLevel;
+    scb->tx_level = config->txFifoTriggerLevel;
+    scb->rx_status = 0u;
+    scb->tx_status = 0u;
+    scb_reset(scb);
+    scb_timing(scb);
+    sim_step();
+    return CY_SCB_UART_SUCCESS;
+}
+
+void Cy_SCB_UART_DeInit(CySCB_Type *base)
+{
+    sim_scb_t *scb = scb_of(base);
+
+    scb->enabled = false;
+    scb_reset(scb);
+    sim_step();
+}
+
+void Cy_SCB_UART_Enable(CySCB_Type *base)
+{
+    sim_scb_t *scb = scb_of(base);
+
+    scb->enabled = true;
+    scb_timing(scb);
+    scb_shift_start(scb);
+    sim_step();
+}
+
+void Cy_SCB_UART_Disable(CySCB_Type *base, cy_stc_scb_uart_context_t *context)
+{
+    sim_scb_t *scb = scb_of(base);
+
+    (void) context;
+    scb->enabled = false;
+    scb_reset(scb);
+    sim_step();
+}
+
+uint32_t Cy_SCB_UART_GetRxFifoStatus(CySCB_Type const *base)
+{
+    sim_step();
+    return scb_of(base)->rx_status;
+}
+
+void Cy_SCB_UART_ClearRxFifoStatus(CySCB_Type *base, uint32_t clearMask)
+{
+    scb_of(base)->rx_status &= ~clearMask;
+    sim_step();
+}
+
+uint32_t Cy_SCB_UART_GetTxFifoStatus(CySCB_Type const *base)
+{
+    sim_step();
+    return scb_of(base)->tx_status;
+}
+
+void Cy_SCB_UART_ClearTxFifoStatus(CySCB_Type *base, uint32_t clearMask)
+{
+    scb_of(base)->tx_status &= ~clearMask;
+    sim_step();
+}
+
+uint32_t Cy_SCB_UART_GetNumInRxFifo(CySCB_Type const *base)
+{
+    sim_step();
+    return scb_of(base)->rx.count;
+}
+
+uint32_t Cy_SCB_UART_GetNumInTxFifo(CySCB_Type const *base)
+{
+    sim_step();
+    return scb_of(base)->tx.count;
+}
+
+void Cy_SCB_UART_ClearRxFifo(CySCB_Type *base)
+{
+    scb_of(base)->rx.count = 0u;
+    sim_step();
+}
+
+void Cy_SCB_UART_ClearTxFifo(CySCB_Type *base)
+{
+    scb_of(base)->tx.count = 0u;
+    sim_step();
+}
+
+bool Cy_SCB_UART_IsTxComplete(CySCB_Type const *base)
+{
+    sim_scb_t *scb = scb_of(base);
+
+    sim_step();
+    return (scb->tx.count == 0u) && !scb->shifting;
+}
+
+uint32_t Cy_SCB_UART_Put(CySCB_Type *base, uint32_t data)
+{
+    sim_scb_t *scb = scb_of(base);
+
+    sim_step();
+    if (scb->tx.count == SIM_FIFO_SIZE)
+    {
+        return 0u;
+    }
+    fifo_push(&scb->tx, (uint8_t) data);
+    scb_shift_start(scb);
+    return 1u;
+}
+
+uint32_t Cy_SCB_UART_Get(CySCB_Type const *base)
+{
+    sim_scb_t *scb = scb_of(base);
+
+    sim_step();
+    if (scb->rx.count == 0u)
+    {
+        return 0xFFFFFFFFu;
+    }
+    return fifo_pop(&scb->rx);
+}
+
+void Cy_SCB_SetRxInterruptMask(CySCB_Type *base, uint32_t interruptMask)
+{
+    scb_of(base)->rx_mask = interruptMask;
+    sim_step();
+}
+
+uint32_t Cy_SCB_GetRxInterruptMask(CySCB_Type const *base)
+{
+    return scb_of(base)->rx_mask;
+}
+
+void Cy_SCB_SetTxInterruptMask(CySCB_Type *base, uint32_t interruptMask)
+{
+    scb_of(base)->tx_mask = interruptMask;
+    sim_step();
+}
+
+uint32_t Cy_SCB_GetTxInterruptMask(CySCB_Type const *base)
+{
+    return scb_of(base)->tx_mask;
+}
+
+void Cy_SCB_SetRxFifoLevel(CySCB_Type *base, uint32_t level)
+{
+    scb_of(base)->rx_level = level;
+    sim_step();
+}
+
+void Cy_SCB_SetTxFifoLevel(CySCB_Type *base, uint32_t level)
+{
+    scb_of(base)->tx_level = level;
+    sim_step();
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,121 @@
+/******************************************************************************
+* File Name: host_pdl.h
+*
+* Description: Interface of the device model behind the host PDL headers. The
+*              bridge_sim harness drives the modelled USB host and the virtual
+*              time with these functions
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef HOST_PDL_H_
+#define HOST_PDL_H_
+
+#include "cy_pdl.h"
+#include "cy_usb_dev.h"
+
+
+/*******************************************************************************
+*        Macros
+*******************************************************************************/
+/* CPU, HF and SYS clock of the model, the IMO setting of design.modus */
+#define SIM_CLK_HZ                  (48000000u)
+
+/* Virtual time in CPU cycles */
+#define SIM_US(us)                  ((uint64_t) (us) * (SIM_CLK_HZ / 1000000u))
+
+/* GPIO ports of the model, P0 to P8 */
+#define SIM_GPIO_PORTS              (9u)
+
+/* SCBs of the model */
+#define SIM_SCBS                    (2u)
+
+/* Interrupts the model keeps counts for, PendSV and SysTick included */
+#define SIM_IRQS                    ((uint32_t) SIM_IRQ_LAST + 3u)
+#define SIM_IRQ_INDEX(irq)          ((uint32_t) ((int32_t) (irq) + 2))
+
+/* Result of a control transfer started with sim_usb_control */
+typedef enum
+{
+    SIM_USB_CONTROL_PENDING,        /* Not handled by the device yet */
+    SIM_USB_CONTROL_DONE,           /* Status stage completed */
+    SIM_USB_CONTROL_STALL           /* Request refused */
+} sim_usb_control_t;
+
+/* Called when the time set with sim_timer_start is reached */
+typedef void (*sim_timer_handler_t)(void);
+
+
+/*******************************************************************************
+*        Global Variables
+*******************************************************************************/
+extern GPIO_PRT_Type sim_gpio_prt[SIM_GPIO_PORTS];
+extern CySCB_Type sim_scb[SIM_SCBS];
+extern USBFS_Type sim_usbfs;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+/* Time and interrupts */
+uint64_t sim_now(void);
+uint64_t sim_sleep_cycles(void);
+void sim_timer_start(uint64_t time, sim_timer_handler_t handler);
+uint32_t sim_irq_count(uint32_t index);
+const char *sim_irq_name(uint32_t index);
+void sim_step(void);
+bool sim_irq_line(IRQn_Type irq);
+
+/* Wiring done by cybsp_init, as the nets of design.modus */
+void sim_scb_connect(CySCB_Type *base, uint32_t clk_num, IRQn_Type irq, uint32_t tx_channel, uint32_t rx_channel,
+                     GPIO_PRT_Type *rx_port, uint32_t rx_pin);
+void sim_usb_connect(uint32_t endpoint, uint32_t channel);
+void sim_usb_cdc(uint32_t com_port, uint32_t comm_interface, uint32_t notification, uint32_t ep_in, uint32_t ep_out);
+
+/* DMA completion of the endpoint channels, raised by the USB model */
+void sim_dmac_complete(uint32_t channel);
+
+/* Level driven on a GPIO input from outside, such as the USB host on D+ */
+void sim_gpio_drive(GPIO_PRT_Type *base, uint32_t pinNum, uint32_t value);
+
+/* USB model, host side */
+bool sim_usb_line(IRQn_Type irq);
+void sim_usb_control(const cy_stc_usb_dev_setup_packet_t *setup, uint8_t *data);
+sim_usb_control_t sim_usb_control_status(uint32_t *length);
+bool sim_usb_out(uint32_t endpoint, const uint8_t *data, uint32_t length);
+int32_t sim_usb_in(uint32_t endpoint, uint8_t *data);
+void sim_usb_sof(void);
+void sim_usb_bus_reset(void);
+
+
+#endif /* HOST_PDL_H_ */
@@ -0,0 +1,784 @@
+/******************************************************************************
+* File Name: host_usb.c
+*
+* Description: USBFS device driver, USB device middleware and CDC class of
+*              the device model. The host side of the bus is driven by the
+*              bridge_sim harness through the sim_usb functions.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "host_pdl.h"
+#include "cy_usb_dev_cdc.h"
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Interrupt cause bits, as in the USBFS INTR_CAUSE registers */
+#define SIM_USB_CAUSE_SOF           (1UL << 0u)
+#define SIM_USB_CAUSE_BUS_RESET     (1UL << 1u)
+#define SIM_USB_CAUSE_EP0           (1UL << 2u)
+#define SIM_USB_CAUSE_EP(ep)        (1UL << ((ep) + 7u))
+
+/* Routing of design.modus: SOF and the data endpoints on the medium
+ * interrupt, EP0 control and bus reset on the low one */
+#define SIM_USB_CAUSE_MED           (SIM_USB_CAUSE_SOF | (0xFFUL << 8u))
+#define SIM_USB_CAUSE_LO            (SIM_USB_CAUSE_BUS_RESET | SIM_USB_CAUSE_EP0)
+
+#define SIM_USB_EPS                 (CY_USBFS_DEV_DRV_NUM_EPS_MAX + 1u)
+#define SIM_CONTROL_BUF_SIZE        (512u)
+
+/* CDC SERIAL_STATE notification: 8-byte header and the 16-bit state */
+#define SIM_SERIAL_STATE_SIZE       (10u)
+#define SIM_SERIAL_STATE_REQUEST    (0x20u)
+
+/*******************************************************************************
+*            Enumerated Types and Structures
+*******************************************************************************/
+typedef struct
+{
+    bool used;
+    bool in;
+    uint32_t channel;
+    cy_en_usb_dev_ep_state_t state;
+    uint8_t buffer[CY_USB_DEV_EP_BUF_SIZE];
+    uint32_t length;
+    cy_fn_usbfs_dev_drv_memcpy_ptr_t copy;
+    cy_cb_usbfs_dev_drv_ep_callback_t callback;
+} sim_ep_t;
+
+typedef struct
+{
+    bool used;
+    uint32_t comm_interface;
+    uint32_t notification;
+    uint32_t ep_in;
+} sim_cdc_t;
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+USBFS_Type sim_usbfs;
+
+static sim_ep_t sim_eps[SIM_USB_EPS];
+static sim_cdc_t sim_cdcs[CY_USB_DEV_CDC_COMPORT_NUMBER];
+static uint32_t usb_cause;
+static bool usb_activity;
+static bool usb_connected;
+static bool usb_suspended;
+
+static cy_cb_usbfs_dev_drv_sof_t sof_callback;
+static cy_cb_usb_dev_events_t events_callback;
+static cy_cb_usb_dev_request_received_t vendor_received;
+static cy_cb_usb_dev_request_cmplt_t vendor_completed;
+static cy_stc_usbfs_dev_drv_context_t *drv_context;
+static cy_stc_usb_dev_context_t *dev_context;
+static cy_stc_usb_dev_cdc_context_t *cdc_context;
+
+static uint32_t configuration;
+static bool configuration_changed;
+
+/* Control transfer started by the host */
+static cy_stc_usb_dev_setup_packet_t control_setup;
+static uint8_t *control_data;
+static uint32_t control_length;
+static sim_usb_control_t control_status = SIM_USB_CONTROL_DONE;
+static uint8_t control_buffer[SIM_CONTROL_BUF_SIZE];
+
+
+/*******************************************************************************
+*        Model helpers
+*******************************************************************************/
+static sim_ep_t *ep_of(uint32_t endpoint)
+{
+    endpoint &= 0x0Fu;
+    CY_ASSERT((endpoint > 0u) && (endpoint < SIM_USB_EPS) && sim_eps[endpoint].used);
+    return &sim_eps[endpoint];
+}
+
+static void set_endpoints(bool enable)
+{
+    uint32_t endpoint;
+    sim_ep_t *ep;
+
+    for (endpoint = 1u; endpoint < SIM_USB_EPS; endpoint++)
+    {
+        ep = &sim_eps[endpoint];
+        ep->length = 0u;
+        ep->state = !enable ? CY_USB_DEV_EP_DISABLED : (ep->in ? CY_USB_DEV_EP_IDLE : CY_USB_DEV_EP_PENDING);
+    }
+}
+
+static sim_cdc_t *cdc_of_interface(uint32_t comm_interface, uint32_t *port)
+{
+    uint32_t index;
+
+    for (index = 0u; index < CY_USB_DEV_CDC_COMPORT_NUMBER; index++)
+    {
+        if (sim_cdcs[index].used && (sim_cdcs[index].comm_interface == comm_interface))
+        {
+            *port = index;
+            return &sim_cdcs[index];
+        }
+    }
+    return NULL;
+}
+
+/* The CDC requests the class serves itself */
+static cy_en_usb_dev_status_t cdc_request(cy_stc_usb_dev_control_transfer_t *transfer, uint32_t port)
+{
+    switch (transfer->setup.bRequest)
+    {
+        case CY_USB_DEV_CDC_RQST_SET_LINE_CODING:
+            memcpy(cdc_context->linesCoding[port], control_data, CY_USB_DEV_CDC_LINE_CODING_SIZE);
+            cdc_context->linesChanged[port] |= CY_USB_DEV_CDC_LINE_CODING_CHANGED;
+            return CY_USB_DEV_SUCCESS;
+
+        case CY_USB_DEV_CDC_RQST_GET_LINE_CODING:
+            transfer->ptr = cdc_context->linesCoding[port];
+            transfer->remaining = CY_USB_DEV_CDC_LINE_CODING_SIZE;
+            return CY_USB_DEV_SUCCESS;
+
+        case CY_USB_DEV_CDC_RQST_SET_CONTROL_LINE_STATE:
+            cdc_context->linesControlBitmap[port] = (uint8_t) transfer->setup.wValue;
+            cdc_context->linesChanged[port] |= CY_USB_DEV_CDC_LINE_CONTROL_CHANGED;
+            return CY_USB_DEV_SUCCESS;
+
+        default:
+            break;
+    }
+
+    if (cdc_context->requestReceived == NULL)
+    {
+        return CY_USB_DEV_REQUEST_NOT_HANDLED;
+    }
+    return cdc_context->requestReceived(transfer, cdc_context, dev_context);
+}
+
+/* SET_CONFIGURATION and SET_INTERFACE: the endpoints are set up, then the
+ * events callback runs, all before the status stage reaches the host */
+static cy_en_usb_dev_status_t standard_request(const cy_stc_usb_dev_control_transfer_t *transfer)
+{
+    switch (transfer->setup.bRequest)
+    {
+        case CY_USB_DEV_RQST_SET_CONFIGURATION:
+            configuration = transfer->setup.wValue;
+            configuration_changed = true;
+            set_endpoints(configuration != 0u);
+            if (events_callback != NULL)
+            {
+                return events_callback(CY_USB_DEV_EVENT_SET_CONFIG, transfer->setup.wValue, 0u, dev_context);
+            }
+            return CY_USB_DEV_SUCCESS;
+
+        case CY_USB_DEV_RQST_SET_INTERFACE:
+            if (events_callback != NULL)
+            {
+                return events_callback(CY_USB_DEV_EVENT_SET_INTERFACE, transfer->setup.wValue,
+                                       transfer->setup.wIndex, dev_context);
+            }
+            return CY_USB_DEV_SUCCESS;
+
+        default:
+            return CY_USB_DEV_REQUEST_NOT_HANDLED;
+    }
+}
+
+/* Serves the control transfer the host has started, from the EP0 interrupt */
+static void control_request(void)
+{
+    cy_stc_usb_dev_control_transfer_t transfer;
+    cy_en_usb_dev_status_t status = CY_USB_DEV_REQUEST_NOT_HANDLED;
+    sim_cdc_t *cdc;
+    uint32_t port;
+    uint32_t length;
+
+    memset(&transfer, 0, sizeof(transfer));
+    transfer.setup = control_setup;
+    transfer.direction = control_setup.bmRequestType.direction;
+    transfer.buffer = control_buffer;
+    transfer.bufferSize = SIM_CONTROL_BUF_SIZE;
+    if (transfer.direction == CY_USB_DEV_DIR_HOST_TO_DEVICE)
+    {
+        CY_ASSERT(control_setup.wLength <= SIM_CONTROL_BUF_SIZE);
+        memcpy(control_buffer, control_data, control_setup.wLength);
+        transfer.ptr = control_buffer;
+        transfer.size = control_setup.wLength;
+    }
+
+    switch (control_setup.bmRequestType.type)
+    {
+        case CY_USB_DEV_STANDARD_TYPE:
+            status = standard_request(&transfer);
+            break;
+
+        case CY_USB_DEV_CLASS_TYPE:
+            cdc = cdc_of_interface(control_setup.wIndex, &port);
+            if ((cdc != NULL) && (cdc_context != NULL) &&
+                (control_setup.bmRequestType.recipient == CY_USB_DEV_RECIPIENT_INTERFACE))
+            {
+                status = cdc_request(&transfer, port);
+            }
+            break;
+
+        case CY_USB_DEV_VENDOR_TYPE:
+            if (vendor_received != NULL)
+            {
+                status = vendor_received(&transfer, dev_context);
+            }
+            if ((status == CY_USB_DEV_SUCCESS) && (vendor_completed != NULL))
+            {
+                (void) vendor_completed(&transfer, dev_context);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    control_length = 0u;
+    if (status != CY_USB_DEV_SUCCESS)
+    {
+        control_status = SIM_USB_CONTROL_STALL;
+        return;
+    }
+    if ((transfer.direction == CY_USB_DEV_DIR_DEVICE_TO_HOST) && (transfer.ptr != NULL))
+    {
+        length = (transfer.remaining < control_setup.wLength) ? transfer.remaining : control_setup.wLength;
+        memcpy(control_data, transfer.ptr, length);
+        control_length = length;
+    }
+    control_status = SIM_USB_CONTROL_DONE;
+}
+
+static void usb_bus_reset(void)
+{
+    configuration = 0u;
+    configuration_changed = true;
+    set_endpoints(false);
+    if (events_callback != NULL)
+    {
+        (void) events_callback(CY_USB_DEV_EVENT_BUS_RESET, 0u, 0u, dev_context);
+    }
+}
+
+
+/*******************************************************************************
+*        Simulation interface
+*******************************************************************************/
+void sim_usb_connect(uint32_t endpoint, uint32_t channel)
+{
+    CY_ASSERT((endpoint > 0u) && (endpoint < SIM_USB_EPS));
+    sim_eps[endpoint].channel = channel;
+}
+
+void sim_usb_cdc(uint32_t com_port, uint32_t comm_interface, uint32_t notification, uint32_t ep_in, uint32_t ep_out)
+{
+    CY_ASSERT(com_port < CY_USB_DEV_CDC_COMPORT_NUMBER);
+    sim_cdcs[com_port].used = true;
+    sim_cdcs[com_port].comm_interface = comm_interface;
+    sim_cdcs[com_port].notification = notification;
+    sim_cdcs[com_port].ep_in = ep_in;
+    sim_eps[notification].used = true;
+    sim_eps[notification].in = true;
+    sim_eps[ep_in].used = true;
+    sim_eps[ep_in].in = true;
+    sim_eps[ep_out].used = true;
+    sim_eps[ep_out].in = false;
+    sim_eps[notification].state = CY_USB_DEV_EP_DISABLED;
+    sim_eps[ep_in].state = CY_USB_DEV_EP_DISABLED;
+    sim_eps[ep_out].state = CY_USB_DEV_EP_DISABLED;
+}
+
+bool sim_usb_line(IRQn_Type irq)
+{
+    switch (irq)
+    {
+        case usb_interrupt_med_IRQn:
+            return (usb_cause & SIM_USB_CAUSE_MED) != 0u;
+        case usb_interrupt_lo_IRQn:
+            return (usb_cause & SIM_USB_CAUSE_LO) != 0u;
+        default:
+            return false;
+    }
+}
+
+/* Starts a control transfer. data holds wLength bytes for the device, or
+ * receives up to wLength bytes from it. */
+void sim_usb_control(const cy_stc_usb_dev_setup_packet_t *setup, uint8_t *data)
+{
+    CY_ASSERT(control_status != SIM_USB_CONTROL_PENDING);
+    control_setup = *setup;
+    control_data = data;
+    control_status = SIM_USB_CONTROL_PENDING;
+    usb_activity = true;
+    if (usb_connected)
+    {
+        usb_cause |= SIM_USB_CAUSE_EP0;
+    }
+}
+
+sim_usb_control_t sim_usb_control_status(uint32_t *length)
+{
+    if (length != NULL)
+    {
+        *length = control_length;
+    }
+    return control_status;
+}
+
+/* OUT transaction: false if the device NAKs it */
+bool sim_usb_out(uint32_t endpoint, const uint8_t *data, uint32_t length)
+{
+    sim_ep_t *ep = ep_of(endpoint);
+
+    usb_activity = true;
+    CY_ASSERT(!ep->in && (length <= CY_USB_DEV_EP_BUF_SIZE));
+    if (ep->state != CY_USB_DEV_EP_PENDING)
+    {
+        return false;
+    }
+    memcpy(ep->buffer, data, length);
+    ep->length = length;
+    ep->state = CY_USB_DEV_EP_COMPLETED;
+    sim_dmac_complete(ep->channel);
+    if (ep->callback != NULL)
+    {
+        usb_cause |= SIM_USB_CAUSE_EP(endpoint);
+    }
+    return true;
+}
+
+/* IN transaction: the packet length, or -1 if the device NAKs it */
+int32_t sim_usb_in(uint32_t endpoint, uint8_t *data)
+{
+    sim_ep_t *ep = ep_of(endpoint);
+
+    usb_activity = true;
+    CY_ASSERT(ep->in);
+    if (ep->state != CY_USB_DEV_EP_PENDING)
+    {
+        return -1;
+    }
+    memcpy(data, ep->buffer, ep->length);
+    ep->state = CY_USB_DEV_EP_COMPLETED;
+    usb_cause |= SIM_USB_CAUSE_EP(endpoint);
+    return (int32_t) ep->length;
+}
+
+void sim_usb_sof(void)
+{
+    usb_activity = true;
+    if (usb_connected && !usb_suspended)
+    {
+        usb_cause |= SIM_USB_CAUSE_SOF;
+    }
+}
+
+void sim_usb_bus_reset(void)
+{
+    usb_activity = true;
+    if (usb_connected)
+    {
+        usb_cause |= SIM_USB_CAUSE_BUS_RESET;
+    }
+}
+
+
+/*******************************************************************************
+*        USBFS driver
+*******************************************************************************/
+cy_en_usbfs_dev_drv_status_t Cy_USBFS_Dev_Drv_ReadOutEndpoint(USBFS_Type *base, uint32_t endpoint, uint8_t *buffer,
+                                                               uint32_t size, uint32_t *actSize,
+                                                               cy_stc_usbfs_dev_drv_context_t *context)
+{
+    sim_ep_t *ep = ep_of(endpoint);
+    uint32_t length;
+
+    (void) base;
+    (void) context;
+    sim_step();
+    if (ep->state != CY_USB_DEV_EP_COMPLETED)
+    {
+        return CY_USBFS_DEV_DRV_BAD_PARAM;
+    }
+    length = (ep->length < size) ? ep->length : size;
+    if (ep->copy != NULL)
+    {
+        (void) ep->copy(buffer, ep->buffer, length);
+    }
+    else
+    {
+        memcpy(buffer, ep->buffer, length);
+    }
+    *actSize = length;
+    ep->state = CY_USB_DEV_EP_IDLE;
+    return CY_USBFS_DEV_DRV_SUCCESS;
+}
+
+cy_en_usbfs_dev_drv_status_t Cy_USBFS_Dev_Drv_LoadInEndpoint(USBFS_Type *base, uint32_t endpoint,
+                                                              const uint8_t *buffer, uint32_t size,
+                                                              cy_stc_usbfs_dev_drv_context_t *context)
+{
+    sim_ep_t *ep = ep_of(endpoint);
+
+    (void) base;
+    (void) context;
+    sim_step();
+    if ((ep->state == CY_USB_DEV_EP_PENDING) || (ep->state == CY_USB_DEV_EP_DISABLED) ||
+        (size > CY_USB_DEV_EP_BUF_SIZE))
+    {
+        return CY_USBFS_DEV_DRV_BAD_PARAM;
+    }
+    if ((ep->copy != NULL) && (size > 0u))
+    {
+        (void) ep->copy(ep->buffer, buffer, size);
+    }
+    else if (size > 0u)
+    {
+        memcpy(ep->buffer, buffer, size);
+    }
+    ep->length = size;
+    ep->state = CY_USB_DEV_EP_PENDING;
+    return CY_USBFS_DEV_DRV_SUCCESS;
+}
+
+cy_en_usbfs_dev_drv_status_t Cy_USBFS_Dev_Drv_EnableOutEndpoint(USBFS_Type *base, uint32_t endpoint,
+                                                                 cy_stc_usbfs_dev_drv_context_t *context)
+{
+    sim_ep_t *ep = ep_of(endpoint);
+
+    (void) base;
+    (void) context;
+    sim_step();
+    if (ep->state == CY_USB_DEV_EP_DISABLED)
+    {
+        return CY_USBFS_DEV_DRV_BAD_PARAM;
+    }
+    ep->state = CY_USB_DEV_EP_PENDING;
+    return CY_USBFS_DEV_DRV_SUCCESS;
+}
+
+cy_en_usb_dev_ep_state_t Cy_USBFS_Dev_Drv_GetEndpointState(USBFS_Type const *base, uint32_t endpoint,
+                                                           cy_stc_usbfs_dev_drv_context_t const *context)
+{
+    (void) base;
+    (void) context;
+    sim_step();
+    return ep_of(endpoint)->state;
+}
+
+void Cy_USBFS_Dev_Drv_RegisterSofCallback(USBFS_Type *base, cy_cb_usbfs_dev_drv_sof_t callback,
+                                          cy_stc_usbfs_dev_drv_context_t *context)
+{
+    (void) base;
+    (void) context;
+    sof_callback = callback;
+    sim_step();
+}
+
+void Cy_USBFS_Dev_Drv_RegisterEndpointCallback(USBFS_Type *base, uint32_t endpoint,
+                                               cy_cb_usbfs_dev_drv_ep_callback_t callback,
+                                               cy_stc_usbfs_dev_drv_context_t *context)
+{
+    (void) base;
+    (void) context;
+    ep_of(endpoint)->callback = callback;
+    sim_step();
+}
+
+void Cy_USBFS_Dev_Drv_OverwriteMemcpy(USBFS_Type const *base, uint32_t endpoint,
+                                      cy_fn_usbfs_dev_drv_memcpy_ptr_t memcpyFunc,
+                                      cy_stc_usbfs_dev_drv_context_t *context)
+{
+    (void) base;
+    (void) context;
+    ep_of(endpoint)->copy = memcpyFunc;
+    sim_step();
+}
+
+void Cy_USBFS_Dev_Drv_Interrupt(USBFS_Type *base, uint32_t intrCause, cy_stc_usbfs_dev_drv_context_t *context)
+{
+    uint32_t endpoint;
+
+    sim_step();
+    usb_cause &= ~intrCause;
+    if ((intrCause & SIM_USB_CAUSE_BUS_RESET) != 0u)
+    {
+        usb_bus_reset();
+    }
+    if ((intrCause & SIM_USB_CAUSE_EP0) != 0u)
+    {
+        control_request();
+    }
+    if (((intrCause & SIM_USB_CAUSE_SOF) != 0u) && (sof_callback != NULL))
+    {
+        sof_callback(base, context);
+    }
+    for (endpoint = 1u; endpoint < SIM_USB_EPS; endpoint++)
+    {
+        if (((intrCause & SIM_USB_CAUSE_EP(endpoint)) != 0u) && (sim_eps[endpoint].callback != NULL))
+        {
+            sim_eps[endpoint].callback(base, sim_eps[endpoint].in ? (0x80u | endpoint) : endpoint, 0u, context);
+        }
+    }
+}
+
+uint32_t Cy_USBFS_Dev_Drv_GetInterruptCauseHi(USBFS_Type const *base)
+{
+    (void) base;
+    return 0u;
+}
+
+uint32_t Cy_USBFS_Dev_Drv_GetInterruptCauseMed(USBFS_Type const *base)
+{
+    (void) base;
+    return usb_cause & SIM_USB_CAUSE_MED;
+}
+
+uint32_t Cy_USBFS_Dev_Drv_GetInterruptCauseLo(USBFS_Type const *base)
+{
+    (void) base;
+    return usb_cause & SIM_USB_CAUSE_LO;
+}
+
+bool Cy_USBFS_Dev_Drv_CheckActivity(USBFS_Type *base)
+{
+    bool activity = usb_activity;
+
+    (void) base;
+    sim_step();
+    usb_activity = false;
+    return activity;
+}
+
+void Cy_USBFS_Dev_Drv_Suspend(USBFS_Type *base, cy_stc_usbfs_dev_drv_context_t *context)
+{
+    (void) base;
+    (void) context;
+    usb_suspended = true;
+    sim_step();
+}
+
+void Cy_USBFS_Dev_Drv_Resume(USBFS_Type *base, cy_stc_usbfs_dev_drv_context_t *context)
+{
+    (void) base;
+    (void) context;
+    usb_suspended = false;
+    sim_step();
+}
+
+
+/*******************************************************************************
+*        USB device middleware
+*******************************************************************************/
+cy_en_usb_dev_status_t Cy_USB_Dev_Init(USBFS_Type *base, const cy_stc_usbfs_dev_drv_config_t *drvConfig,
+                                       cy_stc_usbfs_dev_drv_context_t *drvContext,
+                                       const cy_stc_usb_dev_device_t *device, const cy_stc_usb_dev_config_t *config,
+                                       cy_stc_usb_dev_context_t *context)
+{
+    (void) base;
+    (void) drvConfig;
+    (void) device;
+    (void) config;
+    drv_context = drvContext;
+    dev_context = context;
+    sim_step();
+    return CY_USB_DEV_SUCCESS;
+}
+
+cy_en_usb_dev_status_t Cy_USB_Dev_Connect(bool blocking, int32_t timeout, cy_stc_usb_dev_context_t *context)
+{
+    (void) timeout;
+    (void) context;
+    CY_ASSERT(!blocking);
+    usb_connected = true;
+    if (control_status == SIM_USB_CONTROL_PENDING)
+    {
+        usb_cause |= SIM_USB_CAUSE_EP0;
+    }
+    sim_step();
+    return CY_USB_DEV_SUCCESS;
+}
+
+void Cy_USB_Dev_Disconnect(cy_stc_usb_dev_context_t *context)
+{
+    (void) context;
+    usb_connected = false;
+    usb_cause = 0u;
+    configuration = 0u;
+    set_endpoints(false);
+    sim_step();
+}
+
+uint32_t Cy_USB_Dev_GetConfiguration(cy_stc_usb_dev_context_t const *context)
+{
+    (void) context;
+    sim_step();
+    return configuration;
+}
+
+bool Cy_USB_Dev_IsConfigurationChanged(cy_stc_usb_dev_context_t *context)
+{
+    bool changed = configuration_changed;
+
+    (void) context;
+    sim_step();
+    configuration_changed = false;
+    return changed;
+}
+
+void Cy_USB_Dev_RegisterEventsCallback(cy_cb_usb_dev_events_t callback, cy_stc_usb_dev_context_t *context)
+{
+    (void) context;
+    events_callback = callback;
+    sim_step();
+}
+
+void Cy_USB_Dev_RegisterVendorCallbacks(cy_cb_usb_dev_request_received_t requestReceivedHandle,
+                                        cy_cb_usb_dev_request_cmplt_t requestCompletedHandle,
+                                        cy_stc_usb_dev_context_t *context)
+{
+    (void) context;
+    vendor_received = requestReceivedHandle;
+    vendor_completed = requestCompletedHandle;
+    sim_step();
+}
+
+
+/*******************************************************************************
+*        CDC class
+*******************************************************************************/
+cy_en_usb_dev_status_t Cy_USB_Dev_CDC_Init(const cy_stc_usb_dev_cdc_config_t *config,
+                                           cy_stc_usb_dev_cdc_context_t *context,
+                                           cy_stc_usb_dev_context_t *devContext)
+{
+    static const uint8_t default_coding[CY_USB_DEV_CDC_LINE_CODING_SIZE] = { 0x00u, 0xC2u, 0x01u, 0x00u, 0u, 0u, 8u };
+    uint32_t port;
+
+    (void) config;
+    (void) devContext;
+    memset(context, 0, sizeof(*context));
+    for (port = 0u; port < CY_USB_DEV_CDC_COMPORT_NUMBER; port++)
+    {
+        memcpy(context->linesCoding[port], default_coding, CY_USB_DEV_CDC_LINE_CODING_SIZE);
+    }
+    cdc_context = context;
+    sim_step();
+    return CY_USB_DEV_SUCCESS;
+}
+
+void Cy_USB_Dev_CDC_RegisterUserCallback(cy_cb_usb_dev_class_request_t requestReceivedHandle,
+                                         cy_cb_usb_dev_class_request_t requestCompletedHandle,
+                                         cy_stc_usb_dev_cdc_context_t *context)
+{
+    context->requestReceived = requestReceivedHandle;
+    context->requestCompleted = requestCompletedHandle;
+    sim_step();
+}
+
+uint32_t Cy_USB_Dev_CDC_IsReady(uint32_t port, cy_stc_usb_dev_cdc_context_t *context)
+{
+    cy_en_usb_dev_ep_state_t state;
+
+    (void) context;
+    sim_step();
+    state = sim_eps[sim_cdcs[port].ep_in].state;
+    return ((state == CY_USB_DEV_EP_IDLE) || (state == CY_USB_DEV_EP_COMPLETED)) ? 1u : 0u;
+}
+
+uint32_t Cy_USB_Dev_CDC_IsLineChanged(uint32_t port, cy_stc_usb_dev_cdc_context_t *context)
+{
+    uint32_t changed;
+
+    sim_step();
+    changed = context->linesChanged[port];
+    context->linesChanged[port] = 0u;
+    return changed;
+}
+
+uint32_t Cy_USB_Dev_CDC_GetDTERate(uint32_t port, cy_stc_usb_dev_cdc_context_t const *context)
+{
+    const uint8_t *coding = context->linesCoding[port];
+
+    sim_step();
+    return (uint32_t) coding[0] | ((uint32_t) coding[1] << 8u) | ((uint32_t) coding[2] << 16u) |
+           ((uint32_t) coding[3] << 24u);
+}
+
+uint32_t Cy_USB_Dev_CDC_GetCharFormat(uint32_t port, cy_stc_usb_dev_cdc_context_t const *context)
+{
+    sim_step();
+    return context->linesCoding[port][4];
+}
+
+uint32_t Cy_USB_Dev_CDC_GetParityType(uint32_t port, cy_stc_usb_dev_cdc_context_t const *context)
+{
+    sim_step();
+    return context->linesCoding[port][5];
+}
+
+uint32_t Cy_USB_Dev_CDC_GetDataBits(uint32_t port, cy_stc_usb_dev_cdc_context_t const *context)
+{
+    sim_step();
+    return context->linesCoding[port][6];
+}
+
+uint32_t Cy_USB_Dev_CDC_GetLineControl(uint32_t port, cy_stc_usb_dev_cdc_context_t const *context)
+{
+    sim_step();
+    return context->linesControlBitmap[port];
+}
+
+cy_en_usb_dev_status_t Cy_USB_Dev_CDC_SendSerialState(uint32_t port, uint32_t serialState,
+                                                      cy_stc_usb_dev_cdc_context_t *context)
+{
+    uint8_t notification[SIM_SERIAL_STATE_SIZE] =
+    {
+        0xA1u, SIM_SERIAL_STATE_REQUEST, 0u, 0u, 0u, 0u, 2u, 0u, 0u, 0u
+    };
+
+    (void) context;
+    notification[4] = (uint8_t) sim_cdcs[port].comm_interface;
+    notification[8] = CY_LO8(serialState);
+    notification[9] = CY_HI8(serialState);
+    if (Cy_USBFS_Dev_Drv_LoadInEndpoint(&sim_usbfs, sim_cdcs[port].notification, notification, sizeof(notification),
+                                        drv_context) != CY_USBFS_DEV_DRV_SUCCESS)
+    {
+        return CY_USB_DEV_DRV_HW_ERROR;
+    }
+    return CY_USB_DEV_SUCCESS;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,556 @@
+/******************************************************************************
+* File Name: pool_test.c
+*
+* Description: Randomized host test of the buffer pool and the paged rx_queue.
+*              Runs pool.c and rx_queue.c against the host PDL headers and
+*              checks every operation against a byte model of each queue
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "pool.h"
+#include "rx_queue.h"
+#include "stats.h"
+
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Blocks the test takes for the OUT path, as tx_ring slots would */
+#define OUT_HELD_MAX            (POOL_BLOCKS)
+
+/* Largest put, so that a put can cross several pages */
+#define PUT_MAX                 ((2u * POOL_BLOCK_SIZE) + USB_EP_PACKET_SIZE)
+
+/* Stops the test with the seed and step that reproduce the failure */
+#define CHECK(condition) \
+    do { if (!(condition)) { fail(__LINE__, #condition); } } while (0)
+
+
+/*******************************************************************************
+*            Enumerated Types and Structures
+*******************************************************************************/
+/* Bytes a queue should hold, read and write counting as in rx_queue_t */
+typedef struct
+{
+    uint8_t data[RX_QUEUE_SIZE];
+    uint64_t read;
+    uint64_t write;
+} model_t;
+
+typedef struct
+{
+    uint32_t seed;
+    uint32_t steps;
+} options_t;
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+static options_t opt =
+{
+    .seed = 1u,
+    .steps = 1000000u,
+};
+
+static rx_queue_t queues[BRIDGE_PORTS];
+static model_t models[BRIDGE_PORTS];
+
+static uint8_t *out_held[OUT_HELD_MAX];
+static uint32_t out_count;
+
+static uint32_t rng_state;
+static uint32_t step;
+
+/* Stub state: critical section nesting, and the pool levels reported */
+static uint32_t critical_depth;
+static uint32_t reported_level[POOL_DIRS];
+static uint32_t reported_denied[POOL_DIRS];
+
+/* Operations that ran into each limit, so a run shows what it covered */
+static uint32_t hits_full;
+static uint32_t hits_starved;
+static uint32_t hits_quota;
+static uint32_t hits_split_peek;
+static uint32_t hits_out_denied;
+
+
+/*******************************************************************************
+* Function Name: fail
+********************************************************************************
+*
+* Summary:
+*  Reports a failed check and ends the test.
+*
+*******************************************************************************/
+static void fail(int line, const char *condition)
+{
+    fprintf(stderr, "FAIL: line %d, step %u, seed %u: %s\n", line, step, opt.seed, condition);
+    exit(1);
+}
+
+/*******************************************************************************
+* Function Name: rng
+********************************************************************************
+*
+* Summary:
+*  Returns a pseudo-random number below limit, xorshift32.
+*
+*******************************************************************************/
+static uint32_t rng(uint32_t limit)
+{
+    rng_state ^= rng_state << 13u;
+    rng_state ^= rng_state >> 17u;
+    rng_state ^= rng_state << 5u;
+
+    return (limit != 0u) ? (rng_state % limit) : 0u;
+}
+
+/*******************************************************************************
+*        Stubs of the firmware and PDL functions pool.c uses
+*******************************************************************************/
+uint32_t Cy_SysLib_EnterCriticalSection(void)
+{
+    critical_depth++;
+
+    return critical_depth;
+}
+
+void Cy_SysLib_ExitCriticalSection(uint32_t savedIntrStatus)
+{
+    CHECK(savedIntrStatus == critical_depth);
+    critical_depth--;
+}
+
+void stats_pool_level(pool_dir_t dir, uint32_t in_use)
+{
+    CHECK(critical_depth != 0u);
+    reported_level[dir] = in_use;
+}
+
+void stats_pool_denied(pool_dir_t dir)
+{
+    CHECK(critical_depth != 0u);
+    reported_denied[dir]++;
+}
+
+/*******************************************************************************
+* Function Name: compare_ptr
+********************************************************************************
+*
+* Summary:
+*  qsort comparison of two block addresses.
+*
+*******************************************************************************/
+static int compare_ptr(const void *a, const void *b)
+{
+    uintptr_t x = (uintptr_t) *(uint8_t *const *) a;
+    uintptr_t y = (uintptr_t) *(uint8_t *const *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*******************************************************************************
+* Function Name: check_state
+********************************************************************************
+*
+* Summary:
+*  Checks the invariants after every operation: each queue holds exactly the
+*  pages its bytes are in, no block is held twice, and the pool counts match
+*  the blocks held per direction.
+*
+*******************************************************************************/
+static void check_state(void)
+{
+    static uint8_t *held[POOL_BLOCKS + 1u];
+    bool needed[RX_QUEUE_PAGES];
+    uint32_t in_count = 0u;
+    uint32_t count = 0u;
+    uint32_t free_blocks;
+    uint32_t port;
+    uint32_t page;
+    uint32_t index;
+    uint64_t counter;
+
+    CHECK(critical_depth == 0u);
+
+    for (port = 0u; port < BRIDGE_PORTS; port++)
+    {
+        CHECK(rx_queue_count(&queues[port]) == (uint32_t) (models[port].write - models[port].read));
+        CHECK(queues[port].read == (uint32_t) models[port].read);
+
+        memset(needed, 0, sizeof(needed));
+        for (counter = models[port].read; counter < models[port].write; counter++)
+        {
+            needed[(counter / POOL_BLOCK_SIZE) % RX_QUEUE_PAGES] = true;
+        }
+        for (page = 0u; page < RX_QUEUE_PAGES; page++)
+        {
+            CHECK(needed[page] == (queues[port].page[page] != NULL));
+            if (queues[port].page[page] != NULL)
+            {
+                CHECK(count < POOL_BLOCKS);
+                held[count++] = queues[port].page[page];
+                in_count++;
+            }
+        }
+    }
+
+    for (index = 0u; index < out_count; index++)
+    {
+        CHECK(count < POOL_BLOCKS);
+        held[count++] = out_held[index];
+    }
+
+    qsort(held, count, sizeof(held[0]), compare_ptr);
+    for (index = 0u; index < count; index++)
+    {
+        CHECK(((uintptr_t) held[index] % sizeof(void *)) == 0u);
+        CHECK((index == 0u) || ((uintptr_t) held[index] >= ((uintptr_t) held[index - 1u] + POOL_BLOCK_SIZE)));
+    }
+
+    CHECK(in_count <= POOL_IN_QUOTA);
+    CHECK(out_count <= POOL_OUT_QUOTA);
+    CHECK(reported_level[POOL_IN] == in_count);
+    CHECK(reported_level[POOL_OUT] == out_count);
+
+    free_blocks = POOL_BLOCKS - count;
+    CHECK(pool_available(POOL_IN) == (((POOL_IN_QUOTA - in_count) < free_blocks) ? (POOL_IN_QUOTA - in_count) : free_blocks));
+    CHECK(pool_available(POOL_OUT) ==
+          (((POOL_OUT_QUOTA - out_count) < free_blocks) ? (POOL_OUT_QUOTA - out_count) : free_blocks));
+}
+
+/*******************************************************************************
+* Function Name: test_put
+********************************************************************************
+*
+* Summary:
+*  Appends random bytes to a queue. All bytes up to rx_queue_room must be
+*  taken; a short put must be due to a full queue or be reported as starved.
+*
+*******************************************************************************/
+static void test_put(uint32_t port)
+{
+    uint8_t data[PUT_MAX];
+    rx_queue_t *queue = &queues[port];
+    model_t *model = &models[port];
+    uint32_t length = rng(PUT_MAX + 1u);
+    uint32_t free_space = RX_QUEUE_SIZE - (uint32_t) (model->write - model->read);
+    uint32_t denied = reported_denied[POOL_IN];
+    uint32_t room = rx_queue_room(queue);
+    uint32_t accepted;
+    uint32_t index;
+    bool starved;
+
+    for (index = 0u; index < length; index++)
+    {
+        data[index] = (uint8_t) rng(256u);
+    }
+
+    (void) pool_take_starved(POOL_IN);
+    CHECK(room <= free_space);
+    accepted = rx_queue_put(queue, data, length);
+    starved = pool_take_starved(POOL_IN);
+
+    CHECK(accepted <= length);
+    CHECK(accepted <= free_space);
+    CHECK(accepted >= ((length < room) ? length : room));
+    CHECK(starved == ((accepted < length) && (accepted < free_space)));
+    CHECK(reported_denied[POOL_IN] == (denied + (starved ? 1u : 0u)));
+
+    if (accepted < length)
+    {
+        if (starved)
+        {
+            hits_starved++;
+            if (pool_available(POOL_IN) == 0u)
+            {
+                hits_quota += (reported_level[POOL_IN] == POOL_IN_QUOTA) ? 1u : 0u;
+            }
+        }
+        else
+        {
+            hits_full++;
+        }
+    }
+
+    for (index = 0u; index < accepted; index++)
+    {
+        model->data[model->write % RX_QUEUE_SIZE] = data[index];
+        model->write++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: test_peek_drop
+********************************************************************************
+*
+* Summary:
+*  Peeks at a queue, checks the bytes against the model and drops a random
+*  part of them, or more than a packet to cross pages at once.
+*
+*******************************************************************************/
+static void test_peek_drop(uint32_t port)
+{
+    rx_queue_t *queue = &queues[port];
+    model_t *model = &models[port];
+    uint32_t count = (uint32_t) (model->write - model->read);
+    uint32_t expected = (count < USB_EP_PACKET_SIZE) ? count : USB_EP_PACKET_SIZE;
+    uint32_t length;
+    uint32_t index;
+    uint8_t *data = NULL;
+
+    length = rx_queue_peek(queue, &data);
+    CHECK(length == expected);
+    CHECK(data != NULL);
+    for (index = 0u; index < length; index++)
+    {
+        CHECK(data[index] == model->data[(model->read + index) % RX_QUEUE_SIZE]);
+    }
+    if ((length != 0u) && (((model->read % POOL_BLOCK_SIZE) + length) > POOL_BLOCK_SIZE))
+    {
+        hits_split_peek++;
+    }
+
+    switch (rng(4u))
+    {
+        case 0u:
+            length = rng(length + 1u);
+            break;
+
+        case 1u:
+            length = rng(count + 1u);
+            break;
+
+        default:
+            break;
+    }
+
+    rx_queue_drop(queue, length);
+    model->read += length;
+}
+
+/*******************************************************************************
+* Function Name: test_out
+********************************************************************************
+*
+* Summary:
+*  Takes or returns a block for the OUT path. Each one is filled with a tag
+*  that must still be there when it is returned.
+*
+*******************************************************************************/
+static void test_out(void)
+{
+    uint32_t available = pool_available(POOL_OUT);
+    uint32_t slot;
+    uint32_t index;
+    uint8_t *block;
+
+    if ((out_count != 0u) && (rng(2u) == 0u))
+    {
+        slot = rng(out_count);
+        block = out_held[slot];
+        for (index = 0u; index < POOL_BLOCK_SIZE; index++)
+        {
+            CHECK(block[index] == (uint8_t) ((uintptr_t) block + index));
+        }
+        out_held[slot] = out_held[--out_count];
+        pool_put(POOL_OUT, block);
+        return;
+    }
+
+    (void) pool_take_starved(POOL_OUT);
+    block = pool_get(POOL_OUT);
+    CHECK((block == NULL) == (available == 0u));
+    CHECK(pool_take_starved(POOL_OUT) == (block == NULL));
+    if (block == NULL)
+    {
+        hits_out_denied++;
+        return;
+    }
+
+    for (index = 0u; index < POOL_BLOCK_SIZE; index++)
+    {
+        block[index] = (uint8_t) ((uintptr_t) block + index);
+    }
+    out_held[out_count++] = block;
+}
+
+/*******************************************************************************
+* Function Name: usage
+********************************************************************************
+*
+* Summary:
+*  Prints the command line help.
+*
+*******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -s, --seed N         seed of the random operations (default 1)\n"
+            "  -n, --steps N        operations to run (default 1000000)\n",
+            name);
+}
+
+/*******************************************************************************
+* Function Name: parse_options
+********************************************************************************
+*
+* Summary:
+*  Parses the command line into opt.
+*
+* Return:
+*  bool: false if the command line is invalid
+*
+*******************************************************************************/
+static bool parse_options(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "seed", required_argument, NULL, 's' },
+        { "steps", required_argument, NULL, 'n' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+
+    while ((c = getopt_long(argc, argv, "s:n:h", long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 's':
+                opt.seed = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                opt.steps = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return (opt.seed != 0u) && (optind == argc);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t port;
+
+    if (!parse_options(argc, argv))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    rng_state = opt.seed;
+    pool_init();
+
+    /* Start close to the wrap of the 32-bit counters */
+    for (port = 0u; port < BRIDGE_PORTS; port++)
+    {
+        queues[port].read = 0u - (RX_QUEUE_SIZE * 8u);
+        queues[port].write = queues[port].read;
+        models[port].read = queues[port].read;
+        models[port].write = queues[port].read;
+    }
+    check_state();
+
+    for (step = 0u; step < opt.steps; step++)
+    {
+        port = rng(BRIDGE_PORTS);
+        switch (rng(16u))
+        {
+            case 0u:
+            case 1u:
+            case 2u:
+            case 3u:
+            case 4u:
+            case 5u:
+                test_put(port);
+                break;
+
+            case 6u:
+            case 7u:
+            case 8u:
+            case 9u:
+            case 10u:
+                test_peek_drop(port);
+                break;
+
+            case 11u:
+            case 12u:
+            case 13u:
+                test_out();
+                break;
+
+            case 14u:
+                /* Drain a queue completely, then start it at a new offset */
+                test_peek_drop(port);
+                rx_queue_drop(&queues[port], rx_queue_count(&queues[port]));
+                models[port].read = models[port].write;
+                break;
+
+            default:
+                if (rng(64u) == 0u)
+                {
+                    rx_queue_reset(&queues[port]);
+                    models[port].read = 0u;
+                    models[port].write = 0u;
+                }
+                break;
+        }
+        check_state();
+    }
+
+    printf("PASS: %u steps, RX_QUEUE_SIZE %u, POOL_BLOCK_SIZE %u, POOL_BLOCKS %u, quotas %u/%u, "
+           "%u full, %u starved (%u at quota), %u split peeks, %u OUT denied\n",
+           opt.steps, RX_QUEUE_SIZE, POOL_BLOCK_SIZE, POOL_BLOCKS, POOL_OUT_QUOTA, POOL_IN_QUOTA,
+           hits_full, hits_starved, hits_quota, hits_split_peek, hits_out_denied);
+
+    return 0;
+}
+
+/* [] END OF FILE */
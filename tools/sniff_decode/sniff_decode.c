@@ -0,0 +1,444 @@
+/******************************************************************************
+* File Name: tools/sniff_decode/sniff_decode.c
+*
+* Description: Host-side decoder for the sniffer mode of the USB-UART bridge.
+*              Turns the record stream read from the COM port of port 0 into a
+*              timeline of both line directions and a summary of the capture
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Layout of sniff_header_t and the record types in sniffer.h */
+#define SNIFF_HEADER_SIZE       (8u)
+#define SNIFF_REC_DATA          (1u)
+#define SNIFF_REC_IDLE          (2u)
+#define SNIFF_REC_LINE          (3u)
+#define SNIFF_REC_DROP          (4u)
+#define SNIFF_REC_TIME          (5u)
+#define SNIFF_DROP_SIZE         (8u)
+
+/* Channels of the bridge, BRIDGE_PORTS at most */
+#define CHANNELS                (2u)
+
+/* Captured bytes printed per line of the timeline */
+#define BYTES_PER_LINE          (16u)
+
+
+/*******************************************************************************
+*            Enumerated Types and Structures
+*******************************************************************************/
+/* Totals of one channel */
+typedef struct
+{
+    uint64_t bytes;
+    uint64_t data_records;
+    uint64_t idle_gaps;
+    uint64_t line_errors;
+    uint64_t dropped_bytes;
+    uint64_t dropped_records;
+} channel_t;
+
+typedef struct
+{
+    const char *input;
+    bool timeline;
+} options_t;
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+static options_t opt =
+{
+    .input = NULL,
+    .timeline = true
+};
+
+static const char channel_names[CHANNELS] = { 'A', 'B' };
+
+static channel_t channels[CHANNELS];
+static uint64_t records;
+
+
+/*******************************************************************************
+* Function Name: read_u32
+********************************************************************************
+*
+* Summary:
+*  Reads a little-endian 32-bit word.
+*
+* Parameters:
+*  data: first byte
+*
+* Return:
+*  uint32_t: the word
+*
+*******************************************************************************/
+static uint32_t read_u32(const uint8_t *data)
+{
+    return (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+/*******************************************************************************
+* Function Name: line_error_text
+********************************************************************************
+*
+* Summary:
+*  Names the UART line errors of SERIAL_STATE bits.
+*
+* Parameters:
+*  state: SERIAL_STATE bits
+*
+* Return:
+*  const char *: names separated by spaces, valid until the next call
+*
+*******************************************************************************/
+static const char *line_error_text(uint32_t state)
+{
+    static char text[48];
+
+    snprintf(text, sizeof(text), "%s%s%s%s", ((state & 0x04u) != 0u) ? " break" : "",
+             ((state & 0x10u) != 0u) ? " framing" : "", ((state & 0x20u) != 0u) ? " parity" : "",
+             ((state & 0x40u) != 0u) ? " overrun" : "");
+    return text;
+}
+
+/*******************************************************************************
+* Function Name: print_data
+********************************************************************************
+*
+* Summary:
+*  Prints captured bytes in hex and ASCII, BYTES_PER_LINE per line.
+*
+* Parameters:
+*  data: captured bytes
+*  length: number of bytes
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void print_data(const uint8_t *data, uint32_t length)
+{
+    uint32_t line;
+    uint32_t index;
+    uint32_t count;
+
+    for (line = 0u; line < length; line += BYTES_PER_LINE)
+    {
+        count = ((length - line) < BYTES_PER_LINE) ? (length - line) : BYTES_PER_LINE;
+
+        printf("%s", (line == 0u) ? " " : "                      ");
+        for (index = 0u; index < BYTES_PER_LINE; index++)
+        {
+            if (index < count)
+            {
+                printf(" %02x", data[line + index]);
+            }
+            else
+            {
+                printf("   ");
+            }
+        }
+        printf("  |");
+        for (index = 0u; index < count; index++)
+        {
+            printf("%c", ((data[line + index] >= 0x20u) && (data[line + index] < 0x7Fu)) ? data[line + index] : '.');
+        }
+        printf("|\n");
+    }
+}
+
+/*******************************************************************************
+* Function Name: decode
+********************************************************************************
+*
+* Summary:
+*  Reads the record stream and prints the timeline. The 32-bit timestamps are
+*  unwrapped; the channels are timestamped independently, so a record may be
+*  stamped slightly before the one ahead of it.
+*
+* Parameters:
+*  path: capture file, or "-" for standard input
+*
+* Return:
+*  bool: true if the stream ended at a record boundary
+*
+*******************************************************************************/
+static bool decode(const char *path)
+{
+    FILE *in = stdin;
+    uint8_t header[SNIFF_HEADER_SIZE];
+    uint8_t payload[255];
+    uint64_t offset = 0u;
+    uint32_t previous = 0u;
+    int64_t time = 0;
+    uint32_t type;
+    uint32_t channel;
+    uint32_t length;
+    size_t got;
+    bool valid = true;
+    channel_t *totals;
+
+    if (strcmp(path, "-") != 0)
+    {
+        in = fopen(path, "rb");
+        if (in == NULL)
+        {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            return false;
+        }
+    }
+
+    for (;;)
+    {
+        got = fread(header, 1u, sizeof(header), in);
+        if (got == 0u)
+        {
+            break;
+        }
+
+        type = header[0];
+        channel = header[1];
+        length = header[2];
+        if ((got != sizeof(header)) || (fread(payload, 1u, length, in) != length))
+        {
+            fprintf(stderr, "%s: the capture ends within a record at offset %llu\n", path,
+                    (unsigned long long) offset);
+            valid = false;
+            break;
+        }
+        if ((type < SNIFF_REC_DATA) || (type > SNIFF_REC_TIME) || (channel >= CHANNELS) ||
+            ((type == SNIFF_REC_DROP) && (length != SNIFF_DROP_SIZE)) || ((type != SNIFF_REC_DATA) &&
+            (type != SNIFF_REC_DROP) && (length != 0u)))
+        {
+            fprintf(stderr, "%s: not a record at offset %llu, the capture must start with the stream\n", path,
+                    (unsigned long long) offset);
+            valid = false;
+            break;
+        }
+
+        if (records != 0u)
+        {
+            time += (int32_t) (read_u32(&header[4]) - previous);
+        }
+        previous = read_u32(&header[4]);
+        offset += sizeof(header) + length;
+        records++;
+
+        totals = &channels[channel];
+        if (opt.timeline && (type != SNIFF_REC_TIME))
+        {
+            printf("%6lld.%06lld  %c", (long long) (time / 1000000), (long long) (time % 1000000),
+                   channel_names[channel]);
+        }
+
+        switch (type)
+        {
+            case SNIFF_REC_DATA:
+                totals->bytes += length;
+                totals->data_records++;
+                if (opt.timeline)
+                {
+                    printf("  %3u", length);
+                    print_data(payload, length);
+                }
+                break;
+            case SNIFF_REC_IDLE:
+                totals->idle_gaps++;
+                if (opt.timeline)
+                {
+                    printf("  idle\n");
+                }
+                break;
+            case SNIFF_REC_LINE:
+                totals->line_errors++;
+                if (opt.timeline)
+                {
+                    printf("  line error%s\n", line_error_text(header[3]));
+                }
+                break;
+            case SNIFF_REC_DROP:
+                totals->dropped_bytes += read_u32(&payload[0]);
+                totals->dropped_records += read_u32(&payload[4]);
+                if (opt.timeline)
+                {
+                    printf("  DROPPED %u bytes in %u records, the host fell behind\n", read_u32(&payload[0]),
+                           read_u32(&payload[4]));
+                }
+                break;
+            default:
+                /* SNIFF_REC_TIME only keeps the timestamps unwrapped */
+                break;
+        }
+    }
+
+    if (in != stdin)
+    {
+        fclose(in);
+    }
+
+    return valid;
+}
+
+/*******************************************************************************
+* Function Name: print_summary
+********************************************************************************
+*
+* Summary:
+*  Prints the totals of each channel.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool: false if records were dropped
+*
+*******************************************************************************/
+static bool print_summary(void)
+{
+    uint32_t channel;
+    bool complete = true;
+
+    printf("\n%llu records\n", (unsigned long long) records);
+    printf("channel        bytes    data  idle gaps  line errors  dropped bytes  dropped records\n");
+    for (channel = 0u; channel < CHANNELS; channel++)
+    {
+        printf("%c        %12llu %7llu %10llu %12llu %14llu %16llu\n", channel_names[channel],
+               (unsigned long long) channels[channel].bytes, (unsigned long long) channels[channel].data_records,
+               (unsigned long long) channels[channel].idle_gaps, (unsigned long long) channels[channel].line_errors,
+               (unsigned long long) channels[channel].dropped_bytes,
+               (unsigned long long) channels[channel].dropped_records);
+        if (channels[channel].dropped_records != 0u)
+        {
+            complete = false;
+        }
+    }
+
+    return complete;
+}
+
+/*******************************************************************************
+* Function Name: usage
+********************************************************************************
+*
+* Summary:
+*  Prints the command line options.
+*
+* Parameters:
+*  name: program name
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [options] FILE\n"
+            "  FILE                 record stream read from the COM port of port 0,\n"
+            "                       - for standard input\n"
+            "  -q, --quiet          leave out the timeline, print the summary only\n",
+            name);
+}
+
+/*******************************************************************************
+* Function Name: parse_options
+********************************************************************************
+*
+* Summary:
+*  Parses the command line into opt.
+*
+* Parameters:
+*  argc, argv: command line
+*
+* Return:
+*  bool: true if the command line is valid
+*
+*******************************************************************************/
+static bool parse_options(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "quiet",   no_argument,       NULL, 'q' },
+        { NULL,      0,                 NULL, 0   }
+    };
+    int c;
+
+    while ((c = getopt_long(argc, argv, "q", long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'q':
+                opt.timeline = false;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (optind != (argc - 1))
+    {
+        return false;
+    }
+    opt.input = argv[optind];
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool valid;
+
+    if (!parse_options(argc, argv))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    valid = decode(opt.input);
+
+    return (print_summary() && valid) ? 0 : 1;
+}
@@ -0,0 +1,734 @@
+/******************************************************************************
+* File Name: tools/sram_report/sram_report.c
+*
+* Description: Host-side SRAM report of the USB-UART bridge. Reads the linker
+*              map file of a firmware build and shows the SRAM taken by the
+*              bridge modules, the stack and heap and the platform libraries
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Longest line of the map file that is parsed, longer ones are cut */
+#define LINE_SIZE               (1024u)
+
+/* Memory regions and input sections kept from the map file */
+#define MAX_REGIONS             (16u)
+#define MAX_SECTIONS            (4096u)
+
+/* Length of the names kept */
+#define NAME_SIZE               (128u)
+
+/* Object of the bridge whose directory holds all bridge modules */
+#define BRIDGE_MAIN_OBJECT      "main.o"
+
+
+/*******************************************************************************
+*            Enumerated Types and Structures
+*******************************************************************************/
+/* Memory region of the MEMORY command of the linker script */
+typedef struct
+{
+    char name[NAME_SIZE];
+    uint64_t origin;
+    uint64_t length;
+    bool writable;
+    uint64_t used;
+} region_t;
+
+/* Groups of the report */
+typedef enum
+{
+    GROUP_BRIDGE,           /* Modules of this repository */
+    GROUP_STACK_HEAP,       /* .stack and .heap sections */
+    GROUP_PLATFORM,         /* PDL, USB middleware, BSP, generated configuration, C library */
+    GROUP_COUNT
+} group_t;
+
+/* Input section placed in a writable region */
+typedef struct
+{
+    char object[NAME_SIZE];         /* Object file, with its path */
+    char symbol[NAME_SIZE];         /* Variable, taken from the section name */
+    uint64_t size;
+    group_t group;
+} section_t;
+
+typedef struct
+{
+    const char *input;
+    uint64_t budget;
+    bool all;
+} options_t;
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+static options_t opt =
+{
+    .input = NULL,
+    .budget = 0u,
+    .all = false
+};
+
+static const char *const group_titles[GROUP_COUNT] =
+{
+    "Bridge",
+    "Stack and heap",
+    "Platform (drivers, middleware, BSP, C library)"
+};
+
+static region_t regions[MAX_REGIONS];
+static uint32_t region_count;
+
+static section_t sections[MAX_SECTIONS];
+static uint32_t section_count;
+
+/* Bytes of output sections that no input section accounts for: alignment
+ * and space reserved by the linker script itself */
+static uint64_t padding;
+
+
+/*******************************************************************************
+* Function Name: region_of
+********************************************************************************
+*
+* Summary:
+*  Finds the writable region an address belongs to.
+*
+* Parameters:
+*  address: address of an output section
+*
+* Return:
+*  region_t *: the region, NULL if the address is not in a writable region
+*
+*******************************************************************************/
+static region_t *region_of(uint64_t address)
+{
+    uint32_t index;
+
+    for (index = 0u; index < region_count; index++)
+    {
+        if (regions[index].writable && (address >= regions[index].origin) &&
+            (address < (regions[index].origin + regions[index].length)))
+        {
+            return &regions[index];
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: parse_region
+********************************************************************************
+*
+* Summary:
+*  Parses a line of the Memory Configuration table.
+*
+* Parameters:
+*  line: line of the map file
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void parse_region(const char *line)
+{
+    region_t *region;
+    char name[NAME_SIZE];
+    char attributes[NAME_SIZE] = "";
+    unsigned long long origin;
+    unsigned long long length;
+
+    if ((sscanf(line, "%127s %llx %llx %127s", name, &origin, &length, attributes) < 3) ||
+        (strcmp(name, "*default*") == 0) || (region_count == MAX_REGIONS))
+    {
+        return;
+    }
+
+    region = &regions[region_count++];
+    snprintf(region->name, sizeof(region->name), "%s", name);
+    region->origin = origin;
+    region->length = length;
+    region->writable = (strchr(attributes, 'w') != NULL);
+    region->used = 0u;
+}
+
+/*******************************************************************************
+* Function Name: add_section
+********************************************************************************
+*
+* Summary:
+*  Records an input section of an output section in a writable region.
+*
+* Parameters:
+*  name: input section name, such as .bss.bridge_ports or COMMON
+*  object: object file it comes from
+*  size: size in bytes
+*
+* Return:
+*  bool: false if there are too many sections
+*
+*******************************************************************************/
+static bool add_section(const char *name, const char *object, uint64_t size)
+{
+    section_t *section;
+    const char *symbol = name;
+
+    if (section_count == MAX_SECTIONS)
+    {
+        return false;
+    }
+
+    /* -fdata-sections puts each variable into .bss.<name> or .data.<name> */
+    if ((name[0] == '.') && (strchr(&name[1], '.') != NULL))
+    {
+        symbol = strchr(&name[1], '.') + 1;
+    }
+
+    section = &sections[section_count++];
+    snprintf(section->object, sizeof(section->object), "%s", object);
+    /* Archive members read libc.a(lib_a-malloc.o), object_name() needs no ')' */
+    if ((strchr(section->object, '(') != NULL) && (section->object[strlen(section->object) - 1u] == ')'))
+    {
+        section->object[strlen(section->object) - 1u] = '\0';
+    }
+    snprintf(section->symbol, sizeof(section->symbol), "%s", symbol);
+    section->size = size;
+    section->group = ((strncmp(name, ".stack", 6u) == 0) || (strncmp(name, ".heap", 5u) == 0)) ?
+                     GROUP_STACK_HEAP : GROUP_PLATFORM;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: parse_map
+********************************************************************************
+*
+* Summary:
+*  Reads the memory regions and the input sections placed in writable regions
+*  from a GNU ld map file.
+*
+* Parameters:
+*  path: map file
+*
+* Return:
+*  bool: false if the file cannot be read or is not a map file
+*
+*******************************************************************************/
+static bool parse_map(const char *path)
+{
+    FILE *in = fopen(path, "r");
+    char line[LINE_SIZE];
+    char name[NAME_SIZE] = "";
+    char object[NAME_SIZE];
+    char pending[NAME_SIZE] = "";
+    unsigned long long address;
+    unsigned long long size;
+    region_t *region = NULL;
+    uint64_t out_size = 0u;
+    uint64_t in_size = 0u;
+    bool in_regions = false;
+    bool in_map = false;
+    bool out_pending = false;
+
+    if (in == NULL)
+    {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), in) != NULL)
+    {
+        if (strncmp(line, "Memory Configuration", 20u) == 0)
+        {
+            in_regions = true;
+            continue;
+        }
+        if (strncmp(line, "Linker script and memory map", 28u) == 0)
+        {
+            in_regions = false;
+            in_map = true;
+            continue;
+        }
+        if (in_regions)
+        {
+            parse_region(line);
+            continue;
+        }
+        if (!in_map)
+        {
+            continue;
+        }
+
+        /* Output section, its address and size on the same or the next line */
+        if ((line[0] != ' ') && (line[0] != '\n'))
+        {
+            if (region != NULL)
+            {
+                padding += out_size - in_size;
+            }
+            region = NULL;
+            pending[0] = '\0';
+            out_pending = false;
+            if (line[0] != '.')
+            {
+                continue;
+            }
+            if (sscanf(line, "%127s %llx %llx", name, &address, &size) == 3)
+            {
+                region = region_of(address);
+                out_size = size;
+                in_size = 0u;
+                if (region != NULL)
+                {
+                    region->used += size;
+                }
+            }
+            else
+            {
+                out_pending = true;
+            }
+            continue;
+        }
+
+        if (out_pending)
+        {
+            out_pending = false;
+            if (sscanf(line, " %llx %llx", &address, &size) == 2)
+            {
+                region = region_of(address);
+                out_size = size;
+                in_size = 0u;
+                if (region != NULL)
+                {
+                    region->used += size;
+                }
+            }
+            continue;
+        }
+
+        if (region == NULL)
+        {
+            continue;
+        }
+
+        /* Input section, its address, size and object on the same or the
+         * next line. Symbol and assignment lines start deeper. */
+        if ((line[1] != ' ') && (pending[0] == '\0'))
+        {
+            if ((sscanf(line, " %127s", name) != 1) || (strchr(name, '(') != NULL) || (name[0] == '*'))
+            {
+                continue;
+            }
+            if (sscanf(line, " %*s %llx %llx %127s", &address, &size, object) == 3)
+            {
+                if ((size != 0u) && !add_section(name, object, size))
+                {
+                    fprintf(stderr, "%s: more than %u sections in SRAM\n", path, MAX_SECTIONS);
+                    fclose(in);
+                    return false;
+                }
+                in_size += size;
+            }
+            else
+            {
+                snprintf(pending, sizeof(pending), "%s", name);
+            }
+        }
+        else if (pending[0] != '\0')
+        {
+            if (sscanf(line, " %llx %llx %127s", &address, &size, object) == 3)
+            {
+                if ((size != 0u) && !add_section(pending, object, size))
+                {
+                    fprintf(stderr, "%s: more than %u sections in SRAM\n", path, MAX_SECTIONS);
+                    fclose(in);
+                    return false;
+                }
+                in_size += size;
+            }
+            pending[0] = '\0';
+        }
+    }
+    if (region != NULL)
+    {
+        padding += out_size - in_size;
+    }
+    fclose(in);
+
+    if (!in_map || (region_count == 0u))
+    {
+        fprintf(stderr, "%s: not a GNU ld map file with a memory configuration\n", path);
+        return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: object_name
+********************************************************************************
+*
+* Summary:
+*  Strips the directories from an object file, and the archive from a member
+*  such as libc.a(lib_a-malloc.o, stored without the closing parenthesis.
+*
+* Parameters:
+*  object: object file, with its path
+*
+* Return:
+*  const char *: the object name within object
+*
+*******************************************************************************/
+static const char *object_name(const char *object)
+{
+    const char *member = strchr(object, '(');
+    const char *slash;
+
+    if (member != NULL)
+    {
+        return member + 1;
+    }
+
+    slash = strrchr(object, '/');
+    if (slash == NULL)
+    {
+        slash = strrchr(object, '\\');
+    }
+
+    return (slash != NULL) ? (slash + 1) : object;
+}
+
+/*******************************************************************************
+* Function Name: classify
+********************************************************************************
+*
+* Summary:
+*  Moves the sections of the bridge modules, the objects in the directory of
+*  main.o, into GROUP_BRIDGE. Libraries are built into subdirectories of it
+*  or come from archives.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void classify(void)
+{
+    const char *main_object = NULL;
+    size_t dir_length = 0u;
+    uint32_t index;
+
+    for (index = 0u; index < section_count; index++)
+    {
+        if ((strchr(sections[index].object, '(') == NULL) &&
+            (strcmp(object_name(sections[index].object), BRIDGE_MAIN_OBJECT) == 0))
+        {
+            main_object = sections[index].object;
+            dir_length = (size_t) (object_name(main_object) - main_object);
+            break;
+        }
+    }
+
+    if (main_object == NULL)
+    {
+        fprintf(stderr, "warning: %s has no SRAM in the map file, all objects are counted as platform\n",
+                BRIDGE_MAIN_OBJECT);
+        return;
+    }
+
+    for (index = 0u; index < section_count; index++)
+    {
+        if ((sections[index].group == GROUP_PLATFORM) && (strchr(sections[index].object, '(') == NULL) &&
+            (strncmp(sections[index].object, main_object, dir_length) == 0) &&
+            (strpbrk(&sections[index].object[dir_length], "/\\") == NULL))
+        {
+            sections[index].group = GROUP_BRIDGE;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: compare_sections
+********************************************************************************
+*
+* Summary:
+*  qsort order: by group, then by object, then largest first.
+*
+* Parameters:
+*  a, b: sections
+*
+* Return:
+*  int: comparison result
+*
+*******************************************************************************/
+static int compare_sections(const void *a, const void *b)
+{
+    const section_t *left = a;
+    const section_t *right = b;
+    int order;
+
+    if (left->group != right->group)
+    {
+        return (left->group < right->group) ? -1 : 1;
+    }
+
+    order = strcmp(object_name(left->object), object_name(right->object));
+    if (order != 0)
+    {
+        return order;
+    }
+
+    return (left->size > right->size) ? -1 : ((left->size < right->size) ? 1 : 0);
+}
+
+/*******************************************************************************
+* Function Name: print_group
+********************************************************************************
+*
+* Summary:
+*  Prints the SRAM of one group per object and, except for the platform
+*  without --all, per variable.
+*
+* Parameters:
+*  group: group to print
+*
+* Return:
+*  uint64_t: bytes of the group
+*
+*******************************************************************************/
+static uint64_t print_group(group_t group)
+{
+    uint64_t total = 0u;
+    uint64_t object_total;
+    uint32_t first;
+    uint32_t index;
+    uint32_t next;
+    bool symbols = opt.all || (group != GROUP_PLATFORM);
+
+    printf("\n%-52s %8s\n", group_titles[group], "bytes");
+
+    for (first = 0u; first < section_count; first = next)
+    {
+        if (sections[first].group != group)
+        {
+            next = first + 1u;
+            continue;
+        }
+
+        object_total = 0u;
+        for (next = first; (next < section_count) && (sections[next].group == group) &&
+             (strcmp(object_name(sections[next].object), object_name(sections[first].object)) == 0); next++)
+        {
+            object_total += sections[next].size;
+        }
+        total += object_total;
+
+        printf("  %-50s %8llu\n", object_name(sections[first].object), (unsigned long long) object_total);
+        for (index = first; symbols && (index < next); index++)
+        {
+            printf("    %-48s %8llu\n", sections[index].symbol, (unsigned long long) sections[index].size);
+        }
+    }
+
+    printf("  %-50s %8llu\n", "total", (unsigned long long) total);
+
+    return total;
+}
+
+/*******************************************************************************
+* Function Name: print_report
+********************************************************************************
+*
+* Summary:
+*  Prints the writable regions and the SRAM of each group.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool: false if the bridge exceeds the budget
+*
+*******************************************************************************/
+static bool print_report(void)
+{
+    uint64_t bridge = 0u;
+    uint32_t index;
+    group_t group;
+
+    for (index = 0u; index < region_count; index++)
+    {
+        if (regions[index].writable)
+        {
+            printf("Region %s: %llu bytes at 0x%08llx, %llu used (%.1f %%), %lld free\n", regions[index].name,
+                   (unsigned long long) regions[index].length, (unsigned long long) regions[index].origin,
+                   (unsigned long long) regions[index].used,
+                   (regions[index].length != 0u) ? ((100.0 * regions[index].used) / regions[index].length) : 0.0,
+                   (long long) regions[index].length - (long long) regions[index].used);
+        }
+    }
+
+    qsort(sections, section_count, sizeof(sections[0]), compare_sections);
+    for (group = GROUP_BRIDGE; group < GROUP_COUNT; group++)
+    {
+        if (group == GROUP_BRIDGE)
+        {
+            bridge = print_group(group);
+        }
+        else
+        {
+            (void) print_group(group);
+        }
+    }
+    printf("\n%-52s %8llu\n", "Alignment and linker script reservations", (unsigned long long) padding);
+
+    if ((opt.budget != 0u) && (bridge > opt.budget))
+    {
+        printf("\nThe bridge takes %llu bytes, %llu more than the budget of %llu\n", (unsigned long long) bridge,
+               (unsigned long long) (bridge - opt.budget), (unsigned long long) opt.budget);
+        return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: usage
+********************************************************************************
+*
+* Summary:
+*  Prints the command line options.
+*
+* Parameters:
+*  name: program name
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [options] FILE\n"
+            "  FILE                 linker map file of the firmware build\n"
+            "  -a, --all            list the variables of the platform objects too\n"
+            "  -b, --budget BYTES   fail if the bridge takes more than BYTES of SRAM\n",
+            name);
+}
+
+/*******************************************************************************
+* Function Name: parse_options
+********************************************************************************
+*
+* Summary:
+*  Parses the command line into opt.
+*
+* Parameters:
+*  argc, argv: command line
+*
+* Return:
+*  bool: true if the command line is valid
+*
+*******************************************************************************/
+static bool parse_options(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "all",     no_argument,       NULL, 'a' },
+        { "budget",  required_argument, NULL, 'b' },
+        { NULL,      0,                 NULL, 0   }
+    };
+    char *end;
+    int c;
+
+    while ((c = getopt_long(argc, argv, "ab:", long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'a':
+                opt.all = true;
+                break;
+            case 'b':
+                opt.budget = strtoull(optarg, &end, 0);
+                if ((*end != '\0') || (opt.budget == 0u))
+                {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (optind != (argc - 1))
+    {
+        return false;
+    }
+    opt.input = argv[optind];
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (!parse_options(argc, argv))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (!parse_map(opt.input))
+    {
+        return 2;
+    }
+
+    classify();
+
+    return print_report() ? 0 : 1;
+}
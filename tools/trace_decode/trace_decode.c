@@ -0,0 +1,987 @@
+/******************************************************************************
+* File Name: tools/trace_decode/trace_decode.c
+*
+* Description: Host-side decoder for the ISR event trace of the USB-UART bridge.
+*              Turns a dump of trace_buffer_t into a timeline, a flame-style
+*              summary of the interrupt time and per-packet latencies
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Layout of trace_buffer_t in trace.h */
+#define TRACE_VERSION           (1u)
+#define TRACE_HEADER_SIZE       (20u)
+#define TRACE_ENTRY_SIZE        (8u)
+#define TRACE_SIZE_MAX          (4096u)
+
+/* Interrupt handlers, in the order of stats_isr_t in stats.h */
+#define ISR_COUNT               (6u)
+
+/* Nested handlers tracked. The bridge has three preemption levels. */
+#define NEST_MAX                (8u)
+
+/* Distinct handler stacks in the flame summary */
+#define STACKS_MAX              (64u)
+
+/* tx_ring slots tracked by the OUT packet path */
+#define SLOTS_MAX               (256u)
+
+/* Width of the flame summary bars */
+#define BAR_WIDTH               (40u)
+
+
+/*******************************************************************************
+*            Enumerated Types and Structures
+*******************************************************************************/
+/* Events of trace_id_t in trace.h */
+typedef enum
+{
+    TRACE_ISR_ENTER = 1,
+    TRACE_ISR_EXIT,
+    TRACE_RX_DESCR_DONE,
+    TRACE_RX_IDLE_FLUSH,
+    TRACE_EP3_READ,
+    TRACE_EP3_ENABLE,
+    TRACE_EP3_PAUSE,
+    TRACE_TX_START,
+    TRACE_TX_DONE,
+    TRACE_EP2_LOAD,
+    TRACE_FAULT,
+    TRACE_RECOVER,
+    TRACE_WORK,
+    TRACE_LINE_EVENT,
+    TRACE_SERIAL_STATE,
+    TRACE_LINE_BREAK,
+    TRACE_USB_CONFIG,
+    TRACE_ID_COUNT
+} trace_id_t;
+
+/* Work items of work_t in work.h */
+#define WORK_COUNT              (4u)
+
+/* Errors of trace_fault_t in trace.h */
+#define FAULT_COUNT             (10u)
+
+typedef struct
+{
+    uint64_t time;              /* CPU cycles since the first event, unwrapped */
+    uint8_t id;
+    uint8_t arg;
+    uint16_t value;
+} event_t;
+
+/* A running interrupt handler */
+typedef struct
+{
+    uint32_t isr;
+    uint64_t enter;
+    uint64_t children;          /* Time spent in handlers that preempted it */
+    int32_t stack;              /* Index into stacks */
+} frame_t;
+
+/* A chain of nested handlers and the time spent in its innermost one */
+typedef struct
+{
+    char name[96];
+    uint64_t self;
+} isr_stack_t;
+
+typedef struct
+{
+    uint64_t calls;
+    uint64_t self;
+    uint64_t inclusive;
+    uint64_t max;
+} isr_time_t;
+
+/* Latency samples of one stage of a packet path */
+typedef struct
+{
+    const char *name;
+    uint64_t samples[TRACE_SIZE_MAX];
+    uint32_t count;
+} stage_t;
+
+/* Received bytes waiting for EP2 */
+typedef struct
+{
+    uint64_t time;
+    uint32_t bytes;
+} rx_chunk_t;
+
+typedef struct
+{
+    const char *input;
+    const char *folded;
+    bool timeline;
+    bool packets;
+} options_t;
+
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+static options_t opt =
+{
+    .input = NULL,
+    .folded = NULL,
+    .timeline = true,
+    .packets = false
+};
+
+static const char *const isr_names[ISR_COUNT] =
+{
+    "dma_isr", "uart_isr", "usb_high_isr", "usb_medium_isr", "usb_low_isr", "dma_work_isr"
+};
+
+static const char *const work_names[WORK_COUNT] =
+{
+    "rx", "tx_done", "out", "in"
+};
+
+static const char *const fault_names[FAULT_COUNT] =
+{
+    "unknown", "EP3 read", "DMA fatal response", "UART_RX_DMA response", "UART_TX_DMA response",
+    "EP2 load", "rx_queue overrun", "UART RX FIFO overflow", "UART RX FIFO underflow",
+    "UART TX FIFO overflow"
+};
+
+static event_t events[TRACE_SIZE_MAX];
+static uint32_t event_count;
+static uint32_t cycles_per_us;
+
+static isr_time_t isr_time[ISR_COUNT];
+static isr_stack_t stacks[STACKS_MAX];
+static uint32_t stack_count;
+
+static stage_t out_queue = { .name = "OUT  EP3 read to UART_TX_DMA start" };
+static stage_t out_drain = { .name = "OUT  UART_TX_DMA start to TX FIFO" };
+static stage_t out_total = { .name = "OUT  EP3 read to TX FIFO (total)" };
+static stage_t ep3_hold = { .name = "OUT  EP3 held off" };
+static stage_t in_total = { .name = "IN   UART RX to EP2 load" };
+static stage_t serial_state = { .name = "IN   line event to SERIAL_STATE" };
+
+static uint64_t fault_count[FAULT_COUNT];
+static uint64_t recover_count;
+
+
+/*******************************************************************************
+* Function Name: read_u32
+********************************************************************************
+*
+* Summary:
+*  Reads a little-endian 32-bit word.
+*
+* Parameters:
+*  data: first byte
+*
+* Return:
+*  uint32_t: the word
+*
+*******************************************************************************/
+static uint32_t read_u32(const uint8_t *data)
+{
+    return (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+/*******************************************************************************
+* Function Name: load_trace
+********************************************************************************
+*
+* Summary:
+*  Reads a dump of trace_buffer_t and puts its events in time order. The
+*  32-bit timestamps are unwrapped. An event recorded while SysTick reloads
+*  can be stamped up to one tick early; such a step back is taken as 0.
+*
+* Parameters:
+*  path: dump file, or "-" for standard input
+*
+* Return:
+*  bool: true if the dump is valid
+*
+*******************************************************************************/
+static bool load_trace(const char *path)
+{
+    static uint8_t data[TRACE_HEADER_SIZE + (TRACE_SIZE_MAX * TRACE_ENTRY_SIZE)];
+    FILE *in = stdin;
+    size_t length;
+    uint32_t size;
+    uint32_t written;
+    uint32_t first;
+    uint32_t index;
+    uint32_t previous = 0u;
+    uint64_t time = 0u;
+    int32_t step;
+    const uint8_t *entry;
+
+    if (strcmp(path, "-") != 0)
+    {
+        in = fopen(path, "rb");
+        if (in == NULL)
+        {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            return false;
+        }
+    }
+    length = fread(data, 1u, sizeof(data), in);
+    if (in != stdin)
+    {
+        fclose(in);
+    }
+
+    if ((length < TRACE_HEADER_SIZE) || (read_u32(&data[0]) != TRACE_VERSION))
+    {
+        fprintf(stderr, "%s: not a trace of version %u\n", path, TRACE_VERSION);
+        return false;
+    }
+
+    cycles_per_us = read_u32(&data[4]);
+    size = read_u32(&data[8]);
+    written = read_u32(&data[12]);
+    if ((cycles_per_us == 0u) || (size == 0u) || (size > TRACE_SIZE_MAX) ||
+        (length < (TRACE_HEADER_SIZE + (size * TRACE_ENTRY_SIZE))))
+    {
+        fprintf(stderr, "%s: truncated or corrupt trace\n", path);
+        return false;
+    }
+    if (read_u32(&data[16]) != 0u)
+    {
+        fprintf(stderr, "%s: the trace was read while running, the oldest events may be overwritten\n", path);
+    }
+
+    event_count = (written < size) ? written : size;
+    first = (written < size) ? 0u : (written % size);
+
+    for (index = 0u; index < event_count; index++)
+    {
+        entry = &data[TRACE_HEADER_SIZE + (((first + index) % size) * TRACE_ENTRY_SIZE)];
+        step = (int32_t) (read_u32(entry) - previous);
+        if ((index != 0u) && (step > 0))
+        {
+            time += (uint64_t) step;
+        }
+        previous = read_u32(entry);
+
+        events[index].time = time;
+        events[index].id = entry[4];
+        events[index].arg = entry[5];
+        events[index].value = (uint16_t) (entry[6] | (entry[7] << 8));
+    }
+
+    if (written > size)
+    {
+        fprintf(stderr, "%s: %u events recorded, the oldest %u were overwritten\n", path, written, written - size);
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: to_us
+********************************************************************************
+*
+* Summary:
+*  Converts CPU cycles to microseconds.
+*
+* Parameters:
+*  cycles: CPU cycles
+*
+* Return:
+*  double: microseconds
+*
+*******************************************************************************/
+static double to_us(uint64_t cycles)
+{
+    return (double) cycles / (double) cycles_per_us;
+}
+
+/*******************************************************************************
+* Function Name: serial_state_text
+********************************************************************************
+*
+* Summary:
+*  Names the SERIAL_STATE bits of a line event or notification.
+*
+* Parameters:
+*  state: SERIAL_STATE bits
+*
+* Return:
+*  const char *: the names, each with a leading space, in a static buffer
+*
+*******************************************************************************/
+static const char *serial_state_text(uint32_t state)
+{
+    static char text[40];
+
+    snprintf(text, sizeof(text), "%s%s%s%s", ((state & 0x04u) != 0u) ? " break" : "",
+             ((state & 0x10u) != 0u) ? " framing" : "", ((state & 0x20u) != 0u) ? " parity" : "",
+             ((state & 0x40u) != 0u) ? " overrun" : "");
+
+    return text;
+}
+
+/*******************************************************************************
+* Function Name: describe
+********************************************************************************
+*
+* Summary:
+*  Formats an event for the timeline.
+*
+* Parameters:
+*  event: the event
+*  text: output
+*  size: size of text
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void describe(const event_t *event, char *text, size_t size)
+{
+    const char *isr = (event->arg < ISR_COUNT) ? isr_names[event->arg] : "?";
+    const char *fault = (event->arg < FAULT_COUNT) ? fault_names[event->arg] : fault_names[0];
+
+    switch (event->id)
+    {
+        case TRACE_ISR_ENTER:
+            snprintf(text, size, "> %s", isr);
+            break;
+        case TRACE_ISR_EXIT:
+            snprintf(text, size, "< %s", isr);
+            break;
+        case TRACE_RX_DESCR_DONE:
+            snprintf(text, size, "UART_RX_DMA %s done, %u bytes", (event->arg == 0u) ? "ping" : "pong", event->value);
+            break;
+        case TRACE_RX_IDLE_FLUSH:
+            snprintf(text, size, "UART_RX_DMA %s idle flush, %u bytes", (event->arg == 0u) ? "ping" : "pong",
+                     event->value);
+            break;
+        case TRACE_EP3_READ:
+            snprintf(text, size, "EP3 read into slot %u, %u bytes", event->arg, event->value);
+            break;
+        case TRACE_EP3_ENABLE:
+            snprintf(text, size, "EP3 enabled");
+            break;
+        case TRACE_EP3_PAUSE:
+            snprintf(text, size, "EP3 held off, tx_ring full");
+            break;
+        case TRACE_TX_START:
+            snprintf(text, size, "UART_TX_DMA start slot %u, %u bytes", event->arg, event->value);
+            break;
+        case TRACE_TX_DONE:
+            snprintf(text, size, "UART_TX_DMA done slot %u, %u bytes", event->arg, event->value);
+            break;
+        case TRACE_EP2_LOAD:
+            snprintf(text, size, "EP2 load %u bytes%s", event->value, (event->arg != 0u) ? " from rx_queue" : "");
+            break;
+        case TRACE_FAULT:
+            snprintf(text, size, "FAULT %s", fault);
+            break;
+        case TRACE_WORK:
+            /* value is the bridge port, port 0 is left out */
+            if (event->value != 0u)
+            {
+                snprintf(text, size, "work %s port %u", (event->arg < WORK_COUNT) ? work_names[event->arg] : "?",
+                         event->value);
+            }
+            else
+            {
+                snprintf(text, size, "work %s", (event->arg < WORK_COUNT) ? work_names[event->arg] : "?");
+            }
+            break;
+        case TRACE_LINE_EVENT:
+            snprintf(text, size, "UART line event%s", serial_state_text(event->arg));
+            break;
+        case TRACE_SERIAL_STATE:
+            snprintf(text, size, "SERIAL_STATE sent%s", serial_state_text(event->arg));
+            break;
+        case TRACE_LINE_BREAK:
+            snprintf(text, size, "UART TX break %s", (event->arg != 0u) ? "start" : "end");
+            break;
+        case TRACE_USB_CONFIG:
+            if (event->arg != 0u)
+            {
+                snprintf(text, size, "USB configuration %u", event->arg);
+            }
+            else
+            {
+                snprintf(text, size, "USB configuration lost");
+            }
+            break;
+        case TRACE_RECOVER:
+            snprintf(text, size, "recover%s%s", ((event->arg & 1u) != 0u) ? " RX path" : "",
+                     ((event->arg & 2u) != 0u) ? " TX path" : "");
+            break;
+        default:
+            snprintf(text, size, "unknown event %u", event->id);
+            break;
+    }
+}
+
+/*******************************************************************************
+* Function Name: find_stack
+********************************************************************************
+*
+* Summary:
+*  Returns the flame summary entry of a handler running on top of another.
+*
+* Parameters:
+*  parent: entry of the preempted handler, -1 for the main loop
+*  isr: handler
+*
+* Return:
+*  int32_t: entry, -1 if the table is full
+*
+*******************************************************************************/
+static int32_t find_stack(int32_t parent, uint32_t isr)
+{
+    char name[sizeof(stacks[0].name)];
+    uint32_t index;
+
+    snprintf(name, sizeof(name), "%s;%s", (parent < 0) ? "main" : stacks[parent].name,
+             (isr < ISR_COUNT) ? isr_names[isr] : "?");
+
+    for (index = 0u; index < stack_count; index++)
+    {
+        if (strcmp(stacks[index].name, name) == 0)
+        {
+            return (int32_t) index;
+        }
+    }
+    if (stack_count == STACKS_MAX)
+    {
+        return -1;
+    }
+    strcpy(stacks[stack_count].name, name);
+    stacks[stack_count].self = 0u;
+
+    return (int32_t) stack_count++;
+}
+
+/*******************************************************************************
+* Function Name: add_sample
+********************************************************************************
+*
+* Summary:
+*  Adds a latency sample to a stage.
+*
+* Parameters:
+*  stage: packet path stage
+*  cycles: latency in CPU cycles
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void add_sample(stage_t *stage, uint64_t cycles)
+{
+    if (stage->count < TRACE_SIZE_MAX)
+    {
+        stage->samples[stage->count++] = cycles;
+    }
+}
+
+/*******************************************************************************
+* Function Name: analyze
+********************************************************************************
+*
+* Summary:
+*  Walks the events once. Prints the timeline, indented by the interrupt
+*  nesting, and collects the handler times and the packet latencies.
+*
+*  OUT packets are followed by tx_ring slot from the EP3 read through the
+*  start of UART_TX_DMA to the slot reaching the TX FIFO. IN bytes are
+*  followed in order from the UART_RX_DMA descriptor or idle flush that
+*  delivered them to the EP2 load that sent them. The latency of an IN packet
+*  is that of its oldest byte.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void analyze(void)
+{
+    static rx_chunk_t rx_chunks[TRACE_SIZE_MAX];
+    uint64_t out_read[SLOTS_MAX];
+    uint64_t out_start[SLOTS_MAX];
+    bool out_read_valid[SLOTS_MAX] = { false };
+    bool out_start_valid[SLOTS_MAX] = { false };
+    frame_t nest[NEST_MAX];
+    uint32_t depth = 0u;
+    uint32_t rx_head = 0u;
+    uint32_t rx_tail = 0u;
+    uint64_t pause_time = 0u;
+    bool paused = false;
+    uint64_t line_event_time = 0u;
+    bool line_event = false;
+    uint64_t previous = 0u;
+    uint64_t inclusive;
+    uint32_t remaining;
+    uint32_t index;
+    uint32_t level;
+    const event_t *event;
+    char text[96];
+
+    for (index = 0u; index < event_count; index++)
+    {
+        event = &events[index];
+
+        if (opt.timeline)
+        {
+            describe(event, text, sizeof(text));
+            printf("%12.2f us %+9.2f  %*s%s\n", to_us(event->time), to_us(event->time - previous),
+                   (int) (2u * ((event->id == TRACE_ISR_EXIT) && (depth != 0u) ? depth - 1u : depth)), "", text);
+            previous = event->time;
+        }
+
+        switch (event->id)
+        {
+            case TRACE_ISR_ENTER:
+                if (depth < NEST_MAX)
+                {
+                    nest[depth].isr = event->arg;
+                    nest[depth].enter = event->time;
+                    nest[depth].children = 0u;
+                    nest[depth].stack = find_stack((depth == 0u) ? -1 : nest[depth - 1u].stack, event->arg);
+                    depth++;
+                }
+                break;
+
+            case TRACE_ISR_EXIT:
+                /* Handlers that entered before the trace started have no frame */
+                for (level = depth; level != 0u; level--)
+                {
+                    if (nest[level - 1u].isr == event->arg)
+                    {
+                        break;
+                    }
+                }
+                if (level == 0u)
+                {
+                    break;
+                }
+                depth = level - 1u;
+                inclusive = event->time - nest[depth].enter;
+                if (event->arg < ISR_COUNT)
+                {
+                    isr_time[event->arg].calls++;
+                    isr_time[event->arg].inclusive += inclusive;
+                    isr_time[event->arg].self += inclusive - nest[depth].children;
+                    if (inclusive > isr_time[event->arg].max)
+                    {
+                        isr_time[event->arg].max = inclusive;
+                    }
+                }
+                if (nest[depth].stack >= 0)
+                {
+                    stacks[nest[depth].stack].self += inclusive - nest[depth].children;
+                }
+                if (depth != 0u)
+                {
+                    nest[depth - 1u].children += inclusive;
+                }
+                break;
+
+            case TRACE_RX_DESCR_DONE:
+            case TRACE_RX_IDLE_FLUSH:
+                if ((event->value != 0u) && (rx_head - rx_tail < TRACE_SIZE_MAX))
+                {
+                    rx_chunks[rx_head % TRACE_SIZE_MAX].time = event->time;
+                    rx_chunks[rx_head % TRACE_SIZE_MAX].bytes = event->value;
+                    rx_head++;
+                }
+                break;
+
+            case TRACE_EP2_LOAD:
+                /* Bytes received before the trace started are not timed */
+                if ((event->value != 0u) && (rx_head != rx_tail))
+                {
+                    add_sample(&in_total, event->time - rx_chunks[rx_tail % TRACE_SIZE_MAX].time);
+                }
+                remaining = event->value;
+                while ((remaining != 0u) && (rx_head != rx_tail))
+                {
+                    if (rx_chunks[rx_tail % TRACE_SIZE_MAX].bytes > remaining)
+                    {
+                        rx_chunks[rx_tail % TRACE_SIZE_MAX].bytes -= remaining;
+                        remaining = 0u;
+                    }
+                    else
+                    {
+                        remaining -= rx_chunks[rx_tail % TRACE_SIZE_MAX].bytes;
+                        rx_tail++;
+                    }
+                }
+                break;
+
+            case TRACE_EP3_READ:
+                out_read[event->arg] = event->time;
+                out_read_valid[event->arg] = true;
+                out_start_valid[event->arg] = false;
+                break;
+
+            case TRACE_TX_START:
+                out_start[event->arg] = event->time;
+                out_start_valid[event->arg] = true;
+                break;
+
+            case TRACE_TX_DONE:
+                if (out_read_valid[event->arg] && out_start_valid[event->arg])
+                {
+                    add_sample(&out_queue, out_start[event->arg] - out_read[event->arg]);
+                    add_sample(&out_drain, event->time - out_start[event->arg]);
+                    add_sample(&out_total, event->time - out_read[event->arg]);
+                    if (opt.packets)
+                    {
+                        printf("OUT slot %3u: %9.2f us queued, %9.2f us UART_TX_DMA, %9.2f us total\n",
+                               event->arg, to_us(out_start[event->arg] - out_read[event->arg]),
+                               to_us(event->time - out_start[event->arg]), to_us(event->time - out_read[event->arg]));
+                    }
+                }
+                out_read_valid[event->arg] = false;
+                out_start_valid[event->arg] = false;
+                break;
+
+            case TRACE_EP3_PAUSE:
+                pause_time = event->time;
+                paused = true;
+                break;
+
+            case TRACE_EP3_ENABLE:
+                if (paused)
+                {
+                    add_sample(&ep3_hold, event->time - pause_time);
+                    paused = false;
+                }
+                break;
+
+            case TRACE_LINE_EVENT:
+                /* Events merged into one notification are timed from the first */
+                if (!line_event)
+                {
+                    line_event_time = event->time;
+                    line_event = true;
+                }
+                break;
+
+            case TRACE_SERIAL_STATE:
+                if (line_event)
+                {
+                    add_sample(&serial_state, event->time - line_event_time);
+                    line_event = false;
+                }
+                break;
+
+            case TRACE_FAULT:
+                fault_count[(event->arg < FAULT_COUNT) ? event->arg : 0u]++;
+                break;
+
+            case TRACE_RECOVER:
+                recover_count++;
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: compare_u64
+********************************************************************************
+*
+* Summary:
+*  qsort comparison of two uint64_t.
+*
+* Parameters:
+*  a, b: values to compare
+*
+* Return:
+*  int: -1, 0 or 1
+*
+*******************************************************************************/
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*******************************************************************************
+* Function Name: print_stage
+********************************************************************************
+*
+* Summary:
+*  Prints the latency distribution of a packet path stage.
+*
+* Parameters:
+*  stage: packet path stage
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void print_stage(stage_t *stage)
+{
+    uint64_t total = 0u;
+    uint32_t index;
+
+    if (stage->count == 0u)
+    {
+        printf("%-38s %8u\n", stage->name, 0u);
+        return;
+    }
+
+    qsort(stage->samples, stage->count, sizeof(stage->samples[0]), compare_u64);
+    for (index = 0u; index < stage->count; index++)
+    {
+        total += stage->samples[index];
+    }
+
+    printf("%-38s %8u %9.2f %9.2f %9.2f %9.2f %9.2f\n", stage->name, stage->count,
+           to_us(stage->samples[0]), to_us(stage->samples[(stage->count - 1u) / 2u]),
+           to_us(stage->samples[((stage->count - 1u) * 99u) / 100u]),
+           to_us(stage->samples[stage->count - 1u]), to_us(total) / (double) stage->count);
+}
+
+/*******************************************************************************
+* Function Name: print_summary
+********************************************************************************
+*
+* Summary:
+*  Prints the handler times, the flame summary of the handler stacks and the
+*  packet latencies, and writes the folded stacks if requested.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool: false if the folded stacks could not be written
+*
+*******************************************************************************/
+static bool print_summary(void)
+{
+    uint64_t span = (event_count != 0u) ? events[event_count - 1u].time : 0u;
+    uint64_t busy = 0u;
+    uint64_t top = 0u;
+    uint32_t index;
+    uint32_t fault;
+    FILE *out;
+
+    for (index = 0u; index < ISR_COUNT; index++)
+    {
+        busy += isr_time[index].self;
+    }
+    for (index = 0u; index < stack_count; index++)
+    {
+        if (stacks[index].self > top)
+        {
+            top = stacks[index].self;
+        }
+    }
+
+    printf("\n%u events over %.2f us, %.1f %% in interrupt handlers\n", event_count, to_us(span),
+           (span != 0u) ? ((100.0 * (double) busy) / (double) span) : 0.0);
+
+    printf("\n%-16s %8s %10s %10s %9s %9s\n", "handler", "calls", "self us", "incl us", "avg us", "max us");
+    for (index = 0u; index < ISR_COUNT; index++)
+    {
+        if (isr_time[index].calls != 0u)
+        {
+            printf("%-16s %8llu %10.2f %10.2f %9.2f %9.2f\n", isr_names[index],
+                   (unsigned long long) isr_time[index].calls, to_us(isr_time[index].self),
+                   to_us(isr_time[index].inclusive),
+                   to_us(isr_time[index].inclusive) / (double) isr_time[index].calls, to_us(isr_time[index].max));
+        }
+    }
+
+    printf("\n%-48s %10s %6s\n", "stack (self time)", "us", "%");
+    for (index = 0u; index < stack_count; index++)
+    {
+        printf("%-48s %10.2f %6.1f  %.*s\n", stacks[index].name, to_us(stacks[index].self),
+               (span != 0u) ? ((100.0 * (double) stacks[index].self) / (double) span) : 0.0,
+               (int) ((top != 0u) ? ((stacks[index].self * BAR_WIDTH + top - 1u) / top) : 0u),
+               "########################################");
+    }
+
+    printf("\n%-38s %8s %9s %9s %9s %9s %9s\n", "packet path (us)", "count", "min", "p50", "p99", "max", "avg");
+    print_stage(&out_queue);
+    print_stage(&out_drain);
+    print_stage(&out_total);
+    print_stage(&ep3_hold);
+    print_stage(&in_total);
+    print_stage(&serial_state);
+
+    for (fault = 1u; fault < FAULT_COUNT; fault++)
+    {
+        if (fault_count[fault] != 0u)
+        {
+            printf("fault: %s x%llu\n", fault_names[fault], (unsigned long long) fault_count[fault]);
+        }
+    }
+    if (recover_count != 0u)
+    {
+        printf("recoveries: %llu\n", (unsigned long long) recover_count);
+    }
+
+    if (opt.folded != NULL)
+    {
+        out = fopen(opt.folded, "w");
+        if (out == NULL)
+        {
+            fprintf(stderr, "%s: %s\n", opt.folded, strerror(errno));
+            return false;
+        }
+        /* Time outside the handlers is the main loop's own */
+        fprintf(out, "main %llu\n", (unsigned long long) (span - busy));
+        for (index = 0u; index < stack_count; index++)
+        {
+            fprintf(out, "%s %llu\n", stacks[index].name, (unsigned long long) stacks[index].self);
+        }
+        fclose(out);
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: usage
+********************************************************************************
+*
+* Summary:
+*  Prints the command line options.
+*
+* Parameters:
+*  name: program name
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [options] FILE\n"
+            "  FILE                 dump of trace_buffer_t, - for standard input\n"
+            "  -q, --quiet          leave out the timeline, print the summary only\n"
+            "  -p, --packets        list the path of every OUT packet\n"
+            "  -f, --folded FILE    write the handler stacks in folded format for\n"
+            "                       flamegraph.pl, in CPU cycles\n",
+            name);
+}
+
+/*******************************************************************************
+* Function Name: parse_options
+********************************************************************************
+*
+* Summary:
+*  Parses the command line into opt.
+*
+* Parameters:
+*  argc, argv: command line
+*
+* Return:
+*  bool: true if the command line is valid
+*
+*******************************************************************************/
+static bool parse_options(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "quiet",   no_argument,       NULL, 'q' },
+        { "packets", no_argument,       NULL, 'p' },
+        { "folded",  required_argument, NULL, 'f' },
+        { NULL,      0,                 NULL, 0   }
+    };
+    int c;
+
+    while ((c = getopt_long(argc, argv, "qpf:", long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'q':
+                opt.timeline = false;
+                break;
+            case 'p':
+                opt.packets = true;
+                break;
+            case 'f':
+                opt.folded = optarg;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (optind != (argc - 1))
+    {
+        return false;
+    }
+    opt.input = argv[optind];
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (!parse_options(argc, argv))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (!load_trace(opt.input))
+    {
+        return 1;
+    }
+
+    analyze();
+
+    return print_summary() ? 0 : 1;
+}
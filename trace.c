@@ -0,0 +1,173 @@
+/******************************************************************************
+* File Name: trace.c
+*
+* Description: This file contains the ISR event trace. Handlers and data path
+*              hooks record timestamped events into a fixed-size ring that the
+*              host reads with a vendor request or from the debugger
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+#include "stats.h"
+#include "trace.h"
+
+#if (TRACE_ENABLE != 0u)
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+/* Trace ring. The debugger can dump it with, for example,
+ * "dump binary value trace.bin trace" in GDB. */
+trace_buffer_t trace;
+
+
+/*******************************************************************************
+* Function Name: trace_init
+********************************************************************************
+*
+* Summary:
+*  Starts the trace. Must be called once the SysTick time base has been
+*  started and before the interrupts are enabled.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void trace_init(void)
+{
+    trace.version = TRACE_VERSION;
+    trace.cycles_per_us = Cy_SysClk_ClkSysGetFrequency() / 1000000u;
+    trace.size = TRACE_SIZE;
+    trace_control(true);
+}
+
+/*******************************************************************************
+* Function Name: trace_event
+********************************************************************************
+*
+* Summary:
+*  Records an event. Can be called from any interrupt priority. Handlers never
+*  wait for each other: the Cortex-M0 has no exclusive access instructions, so
+*  interrupts are only masked while the slot is claimed and timestamped. The
+*  ring therefore holds the events in time order. The oldest events are
+*  overwritten once the ring is full.
+*
+* Parameters:
+*  id: event
+*  arg: event argument, truncated to 8 bits
+*  value: event value, saturated to 16 bits
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void trace_event(trace_id_t id, uint32_t arg, uint32_t value)
+{
+    trace_entry_t *entry;
+    uint32_t int_state;
+    uint32_t time;
+
+    if (trace.running == 0u)
+    {
+        return;
+    }
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    entry = &trace.entries[trace.written % TRACE_SIZE];
+    trace.written++;
+    time = stats_now();
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    entry->time = time;
+    entry->id = (uint8_t) id;
+    entry->arg = (uint8_t) arg;
+    entry->value = (uint16_t) ((value > 0xFFFFu) ? 0xFFFFu : value);
+}
+
+/*******************************************************************************
+* Function Name: trace_control
+********************************************************************************
+*
+* Summary:
+*  Stops the trace, or clears and restarts it. Handles
+*  TRACE_VENDOR_REQ_CONTROL.
+*
+* Parameters:
+*  run: false to stop, true to clear and restart
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void trace_control(bool run)
+{
+    uint32_t int_state;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    if (run)
+    {
+        trace.written = 0u;
+    }
+    trace.running = run ? 1u : 0u;
+    Cy_SysLib_ExitCriticalSection(int_state);
+}
+
+/*******************************************************************************
+* Function Name: trace_snapshot
+********************************************************************************
+*
+* Summary:
+*  Returns the trace ring for TRACE_VENDOR_REQ_READ. The ring is not copied,
+*  so while the trace runs the oldest events may be overwritten during the
+*  transfer.
+*
+* Parameters:
+*  length: returns the size of the ring in bytes
+*
+* Return:
+*  const uint8_t *: the ring
+*
+*******************************************************************************/
+const uint8_t *trace_snapshot(uint32_t *length)
+{
+    *length = sizeof(trace);
+
+    return (const uint8_t *) &trace;
+}
+
+#endif /* TRACE_ENABLE */
@@ -0,0 +1,144 @@
+/******************************************************************************
+* File Name: trace.h
+*
+* Description: This file contains the interface of the ISR event trace and of
+*              the vendor requests that read it
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+
+
+/*******************************************************************************
+*        Macros
+*******************************************************************************/
+/* Vendor requests on EP0, recipient device.
+ * TRACE_VENDOR_REQ_CONTROL (host to device, no data): stops the trace if
+ * wValue is 0, otherwise clears and restarts it.
+ * TRACE_VENDOR_REQ_READ (device to host): returns trace_buffer_t, truncated
+ * to wLength. Stop the trace first to read a consistent buffer. */
+#define TRACE_VENDOR_REQ_CONTROL    (0x06u)
+#define TRACE_VENDOR_REQ_READ       (0x07u)
+
+/* Layout version reported in trace_buffer_t.version */
+#define TRACE_VERSION               (1u)
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Trace events. The meaning of arg and value depends on the event. */
+typedef enum
+{
+    TRACE_ISR_ENTER = 1,        /* arg: stats_isr_t */
+    TRACE_ISR_EXIT,             /* arg: stats_isr_t */
+    TRACE_RX_DESCR_DONE,        /* arg: UART_RX_DMA descriptor, value: bytes forwarded */
+    TRACE_RX_IDLE_FLUSH,        /* arg: UART_RX_DMA descriptor, value: bytes forwarded */
+    TRACE_EP3_READ,             /* arg: tx_ring slot, value: bytes */
+    TRACE_EP3_ENABLE,           /* EP3 re-armed for the next OUT packet */
+    TRACE_EP3_PAUSE,            /* EP3 held off, tx_ring full */
+    TRACE_TX_START,             /* arg: tx_ring slot, value: bytes handed to UART_TX_DMA */
+    TRACE_TX_DONE,              /* arg: tx_ring slot written to the UART TX FIFO, value: bytes */
+    TRACE_EP2_LOAD,             /* arg: 1 if taken from rx_queue, value: bytes loaded into EP2 */
+    TRACE_FAULT,                /* arg: trace_fault_t */
+    TRACE_RECOVER,              /* arg: bit 0 RX path reset, bit 1 TX path reset */
+    TRACE_WORK,                 /* arg: work_t started by the bottom half, value: bridge port */
+    TRACE_LINE_EVENT,           /* arg: SERIAL_STATE bits of a UART line event */
+    TRACE_SERIAL_STATE,         /* arg: SERIAL_STATE bits sent on the interrupt endpoint */
+    TRACE_LINE_BREAK,           /* arg: 1 when a break starts on UART TX, 0 when it ends */
+    TRACE_USB_CONFIG            /* arg: configuration set by the host, 0 when it was lost */
+} trace_id_t;
+
+/* Error flags recorded with TRACE_FAULT */
+typedef enum
+{
+    TRACE_FAULT_EP3_READ = 1,
+    TRACE_FAULT_DMA_FATAL,
+    TRACE_FAULT_RX_DMA,
+    TRACE_FAULT_TX_DMA,
+    TRACE_FAULT_EP2_LOAD,
+    TRACE_FAULT_RX_QUEUE_OVERRUN,
+    TRACE_FAULT_UART_RX_OVERFLOW,
+    TRACE_FAULT_UART_RX_UNDERFLOW,
+    TRACE_FAULT_UART_TX_OVERFLOW
+} trace_fault_t;
+
+/* One event, 8 bytes */
+typedef struct
+{
+    uint32_t time;              /* stats_now() in CPU cycles */
+    uint8_t id;                 /* trace_id_t */
+    uint8_t arg;
+    uint16_t value;             /* Saturates at 0xFFFF */
+} trace_entry_t;
+
+/* Trace ring, sent to the host as is. All fields are little-endian. The
+ * oldest event is entries[written % TRACE_SIZE] once the ring has wrapped,
+ * entries[0] before. */
+typedef struct
+{
+    uint32_t version;           /* TRACE_VERSION */
+    uint32_t cycles_per_us;     /* Time base of trace_entry_t.time */
+    uint32_t size;              /* TRACE_SIZE */
+    uint32_t written;           /* Events recorded since the trace was started */
+    uint32_t running;           /* 1 while events are recorded */
+    trace_entry_t entries[TRACE_SIZE];
+} trace_buffer_t;
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+#if (TRACE_ENABLE != 0u)
+
+void trace_init(void);
+void trace_event(trace_id_t id, uint32_t arg, uint32_t value);
+void trace_control(bool run);
+const uint8_t *trace_snapshot(uint32_t *length);
+
+extern trace_buffer_t trace;
+
+#else
+
+#define trace_init()                ((void) 0)
+#define trace_event(id, arg, value) ((void) (id), (void) (arg), (void) (value))
+
+#endif /* TRACE_ENABLE */
+
+
+#endif /* TRACE_H_ */
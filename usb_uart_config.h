@@ -0,0 +1,608 @@
+/******************************************************************************
+* File Name: usb_uart_config.h
+*
+* Description: This file contains the build-time configuration of the USB/UART
+*              bridge. Every value can be overridden through DEFINES in the Makefile.
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef USB_UART_CONFIG_H_
+#define USB_UART_CONFIG_H_
+
+
+/*******************************************************************************
+*        Buffer and endpoint sizes
+*******************************************************************************/
+
+/* Max packet size of the CDC data endpoints EP2 (IN) and EP3 (OUT). Must match
+ * wMaxPacketSize of both endpoints in design.cyusbdev. Full-speed bulk
+ * endpoints allow 8, 16, 32 or 64 bytes. */
+#ifndef USB_EP_PACKET_SIZE
+#define USB_EP_PACKET_SIZE      (64u)
+#endif
+
+/* Size of one tx_ring slot. An OUT packet is read into a single slot, so a
+ * slot must hold a full EP3 packet. */
+#define USB_BUFFER_SIZE         (USB_EP_PACKET_SIZE)
+
+/* Depth of each UART_RX_DMA ping/pong buffer. UART_RX_DMA raises one interrupt
+ * per buffer, so a larger buffer takes fewer interrupts per KB received, and
+ * holds the bytes longer while the line is busy. A buffer up to EP2 is sent
+ * as one IN packet when EP2 is free, a larger one through rx_queue. */
+#ifndef PING_PONG_BUF_SIZE
+#define PING_PONG_BUF_SIZE      (USB_EP_PACKET_SIZE)
+#endif
+
+/* Number of USB_BUFFER_SIZE slots in the OUT (host to UART) ring. EP3 stays
+ * armed while at least one slot is free, so the host can keep sending while
+ * UART_TX_DMA drains the older slots. */
+#ifndef TX_RING_SLOTS
+#define TX_RING_SLOTS           (4u)
+#endif
+
+/* Set to 1 to feed UART_TX_DMA straight from the EP3 buffer of the USBFS
+ * driver instead of copying each OUT packet into tx_ring. EP3 then stays
+ * held off until UART_TX_DMA has sent the packet, so the buffer acts as a
+ * single slot. */
+#ifndef OUT_ZERO_COPY
+#define OUT_ZERO_COPY           (0u)
+#endif
+
+/* Slots of the OUT path in use */
+#if (OUT_ZERO_COPY != 0u)
+#define OUT_RING_SLOTS          (1u)
+#else
+#define OUT_RING_SLOTS          (TX_RING_SLOTS)
+#endif
+
+/* Set to 1 to let UART_TX_DMA flip between its PING and PONG descriptors.
+ * The slot after the one being sent is loaded into the idle descriptor, so
+ * the channel moves on to it in hardware and the TX FIFO does not run dry
+ * while dma_work_isr releases the previous slot. */
+#ifndef OUT_DMA_CHAIN
+#define OUT_DMA_CHAIN           (0u)
+#endif
+
+
+/* Size of the elastic queue that holds UART RX data while EP2 is busy. Must
+ * be a power of two. */
+#ifndef RX_QUEUE_SIZE
+#define RX_QUEUE_SIZE           (512u)
+#endif
+
+/* Queue levels, in bytes, at which the UART peer is throttled through RTS and
+ * released again. */
+#ifndef RX_QUEUE_THROTTLE_LEVEL
+#define RX_QUEUE_THROTTLE_LEVEL ((RX_QUEUE_SIZE * 3u) / 4u)
+#endif
+
+#ifndef RX_QUEUE_RELEASE_LEVEL
+#define RX_QUEUE_RELEASE_LEVEL  (RX_QUEUE_SIZE / 4u)
+#endif
+
+/* Size of a block of the buffer pool (pool.h). tx_ring slots and the pages
+ * of rx_queue are pool blocks, held only while they contain data. Must be a
+ * power of two from USB_BUFFER_SIZE to RX_QUEUE_SIZE. */
+#ifndef POOL_BLOCK_SIZE
+#define POOL_BLOCK_SIZE         (USB_BUFFER_SIZE)
+#endif
+
+/* Pages of rx_queue, each one pool block */
+#define RX_QUEUE_PAGES          (RX_QUEUE_SIZE / POOL_BLOCK_SIZE)
+
+/* Most blocks the OUT path (tx_ring) and the IN path (rx_queue) of all ports
+ * may hold at a time. The defaults let every tx_ring and rx_queue fill up
+ * completely. */
+#ifndef POOL_OUT_QUOTA
+#define POOL_OUT_QUOTA          (BRIDGE_PORTS * OUT_RING_SLOTS)
+#endif
+
+#ifndef POOL_IN_QUOTA
+#define POOL_IN_QUOTA           (BRIDGE_PORTS * RX_QUEUE_PAGES)
+#endif
+
+/* Blocks in the pool. The default serves both quotas at once, as separate
+ * buffers did. With fewer blocks the directions share the rest: a block one
+ * direction holds is not available to the other one. */
+#ifndef POOL_BLOCKS
+#define POOL_BLOCKS             (POOL_OUT_QUOTA + POOL_IN_QUOTA)
+#endif
+
+
+/*******************************************************************************
+*        UART line coding
+*******************************************************************************/
+
+/* UART baud rate configured for CYBSP_UART in design.modus. Used until the
+ * host sends CDC SET_LINE_CODING. */
+#ifndef UART_BAUD_RATE
+#define UART_BAUD_RATE          (115200u)
+#endif
+
+/* Largest deviation, in parts per million, between a baud rate requested by
+ * the host and the rate the SCB clock divider can produce. Requests outside
+ * this tolerance are rejected and the UART keeps its current settings. */
+#ifndef UART_BAUD_TOLERANCE_PPM
+#define UART_BAUD_TOLERANCE_PPM (20000u)
+#endif
+
+
+/*******************************************************************************
+*        UART flow control
+*******************************************************************************/
+
+/* Set to 1 to enable RTS/CTS hardware flow control on CYBSP_UART. CTS then
+ * gates the SCB transmitter, and the SCB deasserts RTS when the RX FIFO
+ * reaches UART_RTS_RX_FIFO_LEVEL. The CYBSP_UART_CTS and CYBSP_UART_RTS pins
+ * must be enabled and connected to the SCB in design.modus. */
+#ifndef UART_FLOW_CONTROL
+#define UART_FLOW_CONTROL       (0u)
+#endif
+
+/* RX FIFO level at which the SCB deasserts RTS. The FIFO entries above this
+ * level absorb the bytes the peer still sends after RTS is deasserted. */
+#ifndef UART_RTS_RX_FIFO_LEVEL
+#define UART_RTS_RX_FIFO_LEVEL  (4u)
+#endif
+
+
+/*******************************************************************************
+*        RS-485 half-duplex
+*******************************************************************************/
+
+/* Set to 1 to drive a half-duplex RS-485 transceiver. The CYBSP_UART_DE pin
+ * enables the transceiver's driver when UART_TX_DMA starts. It is released
+ * once the UART reports that the last stop bit has been sent, after
+ * UART_RS485_GUARD_BITS. The pin must be enabled as a strong-drive output in
+ * design.modus. */
+#ifndef UART_RS485
+#define UART_RS485              (0u)
+#endif
+
+/* Level of CYBSP_UART_DE that enables the driver */
+#ifndef UART_RS485_DE_ACTIVE
+#define UART_RS485_DE_ACTIVE    (1u)
+#endif
+
+/* Bit-times the driver stays enabled after the last stop bit. The guard time
+ * is counted by the SysTick interrupt, so the driver is released up to
+ * TICK_PERIOD_US after it. */
+#ifndef UART_RS485_GUARD_BITS
+#define UART_RS485_GUARD_BITS   (0u)
+#endif
+
+/* Set to 1 if the transceiver's receiver stays enabled while it drives the
+ * bus. The bridge then drops the echo of its own bytes from UART RX. Set to
+ * 0 when /RE is tied to DE. */
+#ifndef UART_RS485_ECHO
+#define UART_RS485_ECHO         (1u)
+#endif
+
+
+/*******************************************************************************
+*        UART receive-idle timeout
+*******************************************************************************/
+
+/* Period of the SysTick time base used for the receive-idle timeout */
+#ifndef TICK_PERIOD_US
+#define TICK_PERIOD_US          (100u)
+#endif
+
+/* Number of bit-times without a new byte after which a partially filled
+ * UART_RX_DMA descriptor is flushed to EP2. 40 bit-times are four 8N1
+ * characters. Set to 0 to only forward full ping/pong buffers. */
+#ifndef RX_IDLE_TIMEOUT_BITS
+#define RX_IDLE_TIMEOUT_BITS    (40u)
+#endif
+
+
+/*******************************************************************************
+*        IN packet coalescing
+*******************************************************************************/
+
+/* Longest time a partial IN packet waits for more UART data before it is
+ * loaded into EP2, in microseconds. Partial packets are also sent on the next
+ * SOF, so values of 1000 or more flush on SOF only. Set to 0 to load received
+ * data into EP2 right away. The host can change it at run time. */
+#ifndef IN_COALESCE_US
+#define IN_COALESCE_US          (1000u)
+#endif
+
+/* Longest time received data waits behind a CDC SERIAL_STATE notification
+ * that the host has not polled from the interrupt endpoint yet, in
+ * microseconds. The data then moves on and the notification follows it. */
+#ifndef SERIAL_STATE_HOLD_US
+#define SERIAL_STATE_HOLD_US    (2000u)
+#endif
+
+
+/*******************************************************************************
+*        Frame-aware forwarding
+*******************************************************************************/
+
+/* Framing of the UART byte stream */
+#define FRAME_MODE_NONE         (0u)    /* Bytes are forwarded as they arrive */
+#define FRAME_MODE_SLIP         (1u)    /* SLIP, RFC 1055 */
+#define FRAME_MODE_COBS         (2u)    /* Consistent Overhead Byte Stuffing */
+
+/* With SLIP or COBS, UART RX data is decoded and every complete frame is sent
+ * to the host as one IN transfer, ended by a short or zero-length packet. Every
+ * OUT transfer from the host is encoded and sent on UART TX as one frame. */
+#ifndef FRAME_MODE
+#define FRAME_MODE              (FRAME_MODE_NONE)
+#endif
+
+/* Byte that ends a frame on the UART. SLIP sends it in place of END (0xC0).
+ * COBS XORs all other bytes with it, so the usual 0x00 leaves them as is. */
+#ifndef FRAME_DELIMITER
+#if (FRAME_MODE == FRAME_MODE_COBS)
+#define FRAME_DELIMITER         (0x00u)
+#else
+#define FRAME_DELIMITER         (0xC0u)
+#endif
+#endif
+
+/* Complete frames that can wait in rx_queue for EP2 */
+#ifndef FRAME_RX_QUEUE_DEPTH
+#define FRAME_RX_QUEUE_DEPTH    (16u)
+#endif
+
+/* Most bytes one OUT packet can add to UART TX once encoded. SLIP escapes
+ * every byte at worst and adds a delimiter on each side. COBS may also send a
+ * block of up to 253 bytes held from earlier packets, a code byte and the
+ * delimiter. */
+#if (FRAME_MODE == FRAME_MODE_SLIP)
+#define FRAME_OUT_MAX_BYTES     ((2u * USB_EP_PACKET_SIZE) + 2u)
+#elif (FRAME_MODE == FRAME_MODE_COBS)
+#define FRAME_OUT_MAX_BYTES     (USB_EP_PACKET_SIZE + 257u)
+#else
+#define FRAME_OUT_MAX_BYTES     (USB_EP_PACKET_SIZE)
+#endif
+
+/* tx_ring slots that must be free before EP3 accepts another packet */
+#define OUT_PACKET_SLOTS        ((FRAME_OUT_MAX_BYTES + USB_BUFFER_SIZE - 1u) / USB_BUFFER_SIZE)
+
+
+/*******************************************************************************
+*        Low power
+*******************************************************************************/
+
+/* Set to 0 to keep the CPU running between interrupts. SysTick keeps running
+ * while the bus is not suspended, so an idle link still wakes the CPU
+ * 1000000 / TICK_PERIOD_US times per second (10000 by default), and each wake
+ * runs one pass of the main loop. sleep_permille counts the time in Sleep,
+ * not these wake-ups; a longer TICK_PERIOD_US makes fewer of them. */
+#ifndef LOW_POWER_SLEEP
+#define LOW_POWER_SLEEP         (1u)
+#endif
+
+/* Set to 0 to stay in Active mode while the USB bus is suspended. Otherwise
+ * the device enters Deep Sleep and wakes up on bus activity or on a falling
+ * edge on the UART RX line. */
+#ifndef USB_SUSPEND_DEEP_SLEEP
+#define USB_SUSPEND_DEEP_SLEEP  (1u)
+#endif
+
+/* Bus idle time after which the bus is treated as suspended. USB 2.0 devices
+ * must enter suspend after 3 ms without bus activity. */
+#ifndef USB_SUSPEND_TIMEOUT_MS
+#define USB_SUSPEND_TIMEOUT_MS  (3u)
+#endif
+
+
+/*******************************************************************************
+*        Loopback self-test
+*******************************************************************************/
+
+/* PRBS order (7, 15 or 31) of a self-test started at boot, with UART TX wired
+ * to RX. 0 leaves the bridge running until the host starts a test with a
+ * vendor request. */
+#ifndef SELFTEST_BOOT_PRBS
+#define SELFTEST_BOOT_PRBS      (0u)
+#endif
+
+
+/*******************************************************************************
+*        Benchmark instrumentation
+*******************************************************************************/
+
+/* Set to 1 to build the on-target benchmark in bench.c. It measures the
+ * throughput per direction, the byte latency inside the bridge and the
+ * interrupt load, and publishes them in bench_report. */
+#ifndef BRIDGE_BENCH
+#define BRIDGE_BENCH            (0u)
+#endif
+
+/* Width and number of the buckets of the latency histograms */
+#ifndef BENCH_LATENCY_BUCKET_US
+#define BENCH_LATENCY_BUCKET_US (50u)
+#endif
+
+#ifndef BENCH_LATENCY_BUCKETS
+#define BENCH_LATENCY_BUCKETS   (64u)
+#endif
+
+/* Interval at which bench_report is refreshed */
+#ifndef BENCH_REPORT_PERIOD_MS
+#define BENCH_REPORT_PERIOD_MS  (1000u)
+#endif
+
+
+/*******************************************************************************
+*        Event trace
+*******************************************************************************/
+
+/* Set to 1 to build the ISR event trace in trace.c. Handler entry and exit,
+ * DMA descriptor completions, endpoint activity and error flags are recorded
+ * with a cycle timestamp into a ring that tools/trace_decode turns into a
+ * timeline. Each event costs a few dozen cycles. */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE            (0u)
+#endif
+
+/* Number of events kept, 8 bytes each. Must be a power of two. */
+#ifndef TRACE_SIZE
+#define TRACE_SIZE              (256u)
+#endif
+
+
+/*******************************************************************************
+*        Multi-port bridge
+*******************************************************************************/
+
+/* Number of CDC interfaces, each bridged to its own SCB with its own pair of
+ * UART DMA channels. Port 0 is CYBSP_UART on the first CDC interface, port 1
+ * is CYBSP_UART1 on the second one. The design.cyusbdev and design.modus of
+ * this example only provide port 0; 2 needs a board design with the second
+ * CDC function, SCB, DMA channels and pins, as in the README. */
+#ifndef BRIDGE_PORTS
+#define BRIDGE_PORTS            (1u)
+#endif
+
+/* Bulk endpoints and communication interface of port 1 in design.cyusbdev.
+ * Port 0 uses EP2 IN and EP3 OUT on interface 0. The automatic DMA of
+ * endpoint n runs on DMA channel n + 7. */
+#ifndef BRIDGE_PORT1_EP_IN
+#define BRIDGE_PORT1_EP_IN      (5u)
+#endif
+
+#ifndef BRIDGE_PORT1_EP_OUT
+#define BRIDGE_PORT1_EP_OUT     (6u)
+#endif
+
+#ifndef BRIDGE_PORT1_COMM_INTERFACE
+#define BRIDGE_PORT1_COMM_INTERFACE (2u)
+#endif
+
+/* UART baud rate configured for CYBSP_UART1 in design.modus */
+#ifndef UART1_BAUD_RATE
+#define UART1_BAUD_RATE         (115200u)
+#endif
+
+
+/*******************************************************************************
+*        Sniffer mode
+*******************************************************************************/
+
+/* Set to 1 to use the board as a passive line analyzer. UART RX of port 0
+ * captures one direction of the monitored line and, with BRIDGE_PORTS=2,
+ * UART RX of port 1 the other one. The captured bytes, idle gaps and line
+ * errors are sent to the host as timestamped records (sniffer.h) on the IN
+ * endpoint of port 0. UART TX stays idle and OUT packets are discarded. */
+#ifndef SNIFFER_MODE
+#define SNIFFER_MODE            (0u)
+#endif
+
+/* Longest time without a record after which a time record is sent */
+#ifndef SNIFF_TIME_PERIOD_MS
+#define SNIFF_TIME_PERIOD_MS    (1000u)
+#endif
+
+
+/*******************************************************************************
+*        Automatic baud-rate detection
+*******************************************************************************/
+
+/* Set to 1 to build in the automatic baud-rate detection (autobaud.h). A
+ * detection times the edges of the next character on UART RX, sets the UART
+ * to the closest standard rate, or to the measured rate away from the
+ * standard ones, until the host sets a line coding again. The rate is
+ * reported to the host as the CDC line coding of the port. Received data is
+ * dropped until the UART runs at the detected rate. */
+#ifndef AUTOBAUD
+#define AUTOBAUD                (0u)
+#endif
+
+/* Set to 0 to detect only on request from the host, not at power-up */
+#ifndef AUTOBAUD_BOOT
+#define AUTOBAUD_BOOT           (1u)
+#endif
+
+/* Lowest rate that is detected. A measurement takes at most two characters
+ * at this rate (2.5 ms at 9600), and unmasks interrupts about once a
+ * bit-time at this rate, or once a SysTick period if that is longer. */
+#ifndef AUTOBAUD_MIN_RATE
+#define AUTOBAUD_MIN_RATE       (9600u)
+#endif
+
+/* Largest deviation, in parts per million, of a measured rate from a
+ * standard rate for which the standard rate is used */
+#ifndef AUTOBAUD_SNAP_PPM
+#define AUTOBAUD_SNAP_PPM       (30000u)
+#endif
+
+/* Time each step of the loopback benchmark waits for its detection */
+#ifndef AUTOBAUD_BENCH_TIMEOUT_MS
+#define AUTOBAUD_BENCH_TIMEOUT_MS (20u)
+#endif
+
+
+/*******************************************************************************
+*        Consistency checks
+*******************************************************************************/
+#if (USB_EP_PACKET_SIZE != 8u) && (USB_EP_PACKET_SIZE != 16u) && \
+    (USB_EP_PACKET_SIZE != 32u) && (USB_EP_PACKET_SIZE != 64u)
+#error "USB_EP_PACKET_SIZE must be 8, 16, 32 or 64 for a full-speed bulk endpoint"
+#endif
+
+/* USBDEV_BULK_PACKET_SIZE is set by the Makefile from design.cyusbdev */
+#if defined(USBDEV_BULK_PACKET_SIZE) && (USBDEV_BULK_PACKET_SIZE != USB_EP_PACKET_SIZE)
+#error "USB_EP_PACKET_SIZE must match wMaxPacketSize of every bulk endpoint in design.cyusbdev"
+#endif
+
+/* A UART_RX_DMA buffer up to EP2 is loaded as one IN packet when EP2 is
+ * free. A larger one is appended to rx_queue, which rx_drain sends in EP2
+ * packets, so the buffer is no longer bounded by USB_EP_PACKET_SIZE. A
+ * sniffer data record holds at most 255 bytes. */
+#if (PING_PONG_BUF_SIZE < 1u) || (PING_PONG_BUF_SIZE > 255u)
+#error "PING_PONG_BUF_SIZE must be between 1 and 255"
+#endif
+
+#if (TX_RING_SLOTS < 2u)
+#error "TX_RING_SLOTS must be at least 2 to overlap USB reception with UART transmission"
+#endif
+
+/* Slots alternate between the PING and PONG descriptors of UART_TX_DMA */
+#if (OUT_DMA_CHAIN != 0u) && ((OUT_ZERO_COPY != 0u) || ((TX_RING_SLOTS % 2u) != 0u))
+#error "OUT_DMA_CHAIN needs an even TX_RING_SLOTS and cannot be combined with OUT_ZERO_COPY"
+#endif
+
+#if ((RX_QUEUE_SIZE & (RX_QUEUE_SIZE - 1u)) != 0u) || (RX_QUEUE_SIZE < (2u * PING_PONG_BUF_SIZE))
+#error "RX_QUEUE_SIZE must be a power of two holding at least two ping/pong buffers"
+#endif
+
+#if (RX_QUEUE_RELEASE_LEVEL >= RX_QUEUE_THROTTLE_LEVEL) || (RX_QUEUE_THROTTLE_LEVEL > RX_QUEUE_SIZE)
+#error "RX_QUEUE_RELEASE_LEVEL must be below RX_QUEUE_THROTTLE_LEVEL, which must fit in RX_QUEUE_SIZE"
+#endif
+
+/* A block holds a whole OUT packet, and an IN packet spans at most two pages */
+#if ((POOL_BLOCK_SIZE & (POOL_BLOCK_SIZE - 1u)) != 0u) || (POOL_BLOCK_SIZE < USB_BUFFER_SIZE) || \
+    (POOL_BLOCK_SIZE > RX_QUEUE_SIZE)
+#error "POOL_BLOCK_SIZE must be a power of two from USB_BUFFER_SIZE to RX_QUEUE_SIZE"
+#endif
+
+#if (POOL_OUT_QUOTA > POOL_BLOCKS) || (POOL_IN_QUOTA > POOL_BLOCKS) || (POOL_IN_QUOTA < 1u)
+#error "POOL_OUT_QUOTA and POOL_IN_QUOTA must not exceed POOL_BLOCKS, and POOL_IN_QUOTA must be at least 1"
+#endif
+
+/* EP3 of every port can always take one more OUT packet, so a host that
+ * writes before it reads is not held off by the IN data it has not read */
+#if ((POOL_BLOCKS - POOL_IN_QUOTA) < (BRIDGE_PORTS * OUT_PACKET_SLOTS)) || (POOL_OUT_QUOTA < OUT_PACKET_SLOTS)
+#error "POOL_BLOCKS must exceed POOL_IN_QUOTA by the tx_ring slots of one OUT packet per port"
+#endif
+
+/* RTS only protects rx_queue if OUT cannot take its pages away */
+#if (UART_FLOW_CONTROL != 0u) && ((POOL_BLOCKS - POOL_OUT_QUOTA) < (BRIDGE_PORTS * RX_QUEUE_PAGES))
+#error "UART_FLOW_CONTROL needs POOL_BLOCKS to exceed POOL_OUT_QUOTA by the pages of every rx_queue"
+#endif
+
+#if (UART_FLOW_CONTROL != 0u) && ((UART_RTS_RX_FIFO_LEVEL < 1u) || (UART_RTS_RX_FIFO_LEVEL > 7u))
+#error "UART_RTS_RX_FIFO_LEVEL must be between 1 and 7"
+#endif
+
+#if (UART_RS485 != 0u) && ((UART_FLOW_CONTROL != 0u) || (UART_RS485_GUARD_BITS > 16u))
+#error "UART_RS485 cannot be combined with UART_FLOW_CONTROL and allows at most 16 UART_RS485_GUARD_BITS"
+#endif
+
+#if (BRIDGE_BENCH != 0u) && ((BENCH_LATENCY_BUCKET_US == 0u) || (BENCH_LATENCY_BUCKETS < 2u))
+#error "BENCH_LATENCY_BUCKET_US must not be 0 and BENCH_LATENCY_BUCKETS must be at least 2"
+#endif
+
+/* The ring is read with a single control transfer */
+#if (TRACE_ENABLE != 0u) && ((TRACE_SIZE < 2u) || (TRACE_SIZE > 4096u) || ((TRACE_SIZE & (TRACE_SIZE - 1u)) != 0u))
+#error "TRACE_SIZE must be a power of two of at most 4096"
+#endif
+
+/* An encoded OUT packet is spread over several tx_ring slots */
+#if (FRAME_MODE != FRAME_MODE_NONE) && ((OUT_ZERO_COPY != 0u) || (TX_RING_SLOTS < OUT_PACKET_SLOTS))
+#error "FRAME_MODE cannot be combined with OUT_ZERO_COPY and needs TX_RING_SLOTS of at least 3 for SLIP or 6 for COBS"
+#endif
+
+#if (FRAME_MODE > FRAME_MODE_COBS) || (FRAME_DELIMITER > 0xFFu) || \
+    ((FRAME_MODE == FRAME_MODE_SLIP) && (FRAME_DELIMITER == 0xDBu))
+#error "FRAME_MODE must be 0, 1 or 2 and FRAME_DELIMITER a byte other than the SLIP escape 0xDB"
+#endif
+
+#if (FRAME_RX_QUEUE_DEPTH < 1u)
+#error "FRAME_RX_QUEUE_DEPTH must be at least 1"
+#endif
+
+#if (SELFTEST_BOOT_PRBS != 0u) && (SELFTEST_BOOT_PRBS != 7u) && (SELFTEST_BOOT_PRBS != 15u) && (SELFTEST_BOOT_PRBS != 31u)
+#error "SELFTEST_BOOT_PRBS must be 0, 7, 15 or 31"
+#endif
+
+#if (TICK_PERIOD_US == 0u)
+#error "TICK_PERIOD_US must not be 0"
+#endif
+
+/* The CDC class of the USB device middleware serves two COM ports */
+#if (BRIDGE_PORTS < 1u) || (BRIDGE_PORTS > 2u)
+#error "BRIDGE_PORTS must be 1 or 2"
+#endif
+
+#if (BRIDGE_PORTS > 1u) && ((BRIDGE_PORT1_EP_IN < 1u) || (BRIDGE_PORT1_EP_IN > 8u) || \
+    (BRIDGE_PORT1_EP_OUT < 1u) || (BRIDGE_PORT1_EP_OUT > 8u) || (BRIDGE_PORT1_EP_IN == BRIDGE_PORT1_EP_OUT) || \
+    (BRIDGE_PORT1_EP_IN <= 3u) || (BRIDGE_PORT1_EP_OUT <= 3u))
+#error "BRIDGE_PORT1_EP_IN and BRIDGE_PORT1_EP_OUT must be two different endpoints from 4 to 8"
+#endif
+
+/* The monitored line is never driven, and the records carry the raw byte stream */
+#if (SNIFFER_MODE != 0u) && ((UART_FLOW_CONTROL != 0u) || (UART_RS485 != 0u) || \
+    (FRAME_MODE != FRAME_MODE_NONE) || (SELFTEST_BOOT_PRBS != 0u))
+#error "SNIFFER_MODE cannot be combined with UART_FLOW_CONTROL, UART_RS485, FRAME_MODE or SELFTEST_BOOT_PRBS"
+#endif
+
+/* The 32-bit microsecond timestamps wrap after about 71 minutes */
+#if (SNIFFER_MODE != 0u) && ((SNIFF_TIME_PERIOD_MS == 0u) || (SNIFF_TIME_PERIOD_MS > 60000u))
+#error "SNIFF_TIME_PERIOD_MS must be between 1 and 60000"
+#endif
+
+/* Both channels of the sniffer follow the line coding of port 0 */
+#if (AUTOBAUD != 0u) && (SNIFFER_MODE != 0u)
+#error "AUTOBAUD cannot be combined with SNIFFER_MODE"
+#endif
+
+/* The standard rates 921600 and 1000000 are 8.5% apart */
+#if (AUTOBAUD != 0u) && ((AUTOBAUD_MIN_RATE < 1200u) || (AUTOBAUD_MIN_RATE > 115200u) || \
+    (AUTOBAUD_SNAP_PPM >= 40000u) || (AUTOBAUD_BENCH_TIMEOUT_MS == 0u))
+#error "AUTOBAUD_MIN_RATE must be between 1200 and 115200, AUTOBAUD_SNAP_PPM below 40000 and AUTOBAUD_BENCH_TIMEOUT_MS at least 1"
+#endif
+
+/* Bus activity is sampled once per millisecond */
+#if (USB_SUSPEND_DEEP_SLEEP != 0u) && (TICK_PERIOD_US > 1000u)
+#error "USB_SUSPEND_DEEP_SLEEP requires TICK_PERIOD_US of 1000 or less"
+#endif
+
+
+#endif /* USB_UART_CONFIG_H_ */
@@ -39,7 +39,19 @@
 
 #include "cy_pdl.h"
 #include "cybsp.h"
+#include "usb_uart_config.h"
 #include "usb_uart_dma.h"
+#include "dma_alloc.h"
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Oversampling range of the SCB in standard UART mode */
+#define UART_OVERSAMPLE_MIN     (8u)
+#define UART_OVERSAMPLE_MAX     (16u)
+
+/* Largest divide ratio of the 16-bit peripheral clock divider */
+#define UART_CLK_DIVIDER_MAX    (65536u)
 
 /*******************************************************************************
 *            Forward declaration
@@ -52,45 +64,80 @@ extern void handle_error(void);
 ********************************************************************************
 *
 * Summary:
-* Configures DMA Tx channel for operation.
+* Configures a UART_TX_DMA channel for operation. With OUT_DMA_CHAIN both
+* descriptors are set up from the PING configuration and flip to each other
+* on completion.
 *
 * Parameters:
-*  None
+*  dma: UART_TX_DMA channel of the port
+*  rxBuffer: first tx_ring slot
+*  txBuffer: UART TX FIFO write register
 *
 * Return:
 *  None
 *
 *******************************************************************************/
-void configure_tx_dma(uint8_t *rxBuffer, uint8_t *txBuffer)
+void configure_tx_dma(const uart_dma_t *dma, uint8_t *rxBuffer, uint8_t *txBuffer)
 {
     cy_en_dmac_status_t dmac_init_status;
+    cy_stc_dmac_channel_config_t channel_config = *dma->channel_config;
+
+#if (OUT_DMA_CHAIN != 0u)
+    cy_stc_dmac_descriptor_config_t descr_config = *dma->ping_config;
+
+    descr_config.flipping = true;
+
+    /* Initialize PING and PONG descriptors */
+    dmac_init_status = Cy_DMAC_Descriptor_Init(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, &descr_config);
+    if (dmac_init_status != CY_DMAC_SUCCESS)
+    {
+        handle_error();
+    }
 
+    dmac_init_status = Cy_DMAC_Descriptor_Init(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PONG, &descr_config);
+    if (dmac_init_status != CY_DMAC_SUCCESS)
+    {
+        handle_error();
+    }
+#else
     /* Initialize PING descriptor */
-    dmac_init_status = Cy_DMAC_Descriptor_Init(UART_TX_DMA_HW, UART_TX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING, &UART_TX_DMA_ping_config);
+    dmac_init_status = Cy_DMAC_Descriptor_Init(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, dma->ping_config);
     if (dmac_init_status != CY_DMAC_SUCCESS)
     {
         handle_error();
     }
+#endif
 
-    /* Initialize UART_TX_DMA channel */
-    dmac_init_status = Cy_DMAC_Channel_Init(UART_TX_DMA_HW, UART_TX_DMA_CHANNEL, &UART_TX_DMA_channel_config);
+    /* Initialize UART_TX_DMA channel at the priority given by dma_alloc */
+    channel_config.priority = dma_alloc_priority(dma->channel);
+    dmac_init_status = Cy_DMAC_Channel_Init(dma->base, dma->channel, &channel_config);
     if (dmac_init_status != CY_DMAC_SUCCESS)
     {
         handle_error();
     }
 
+    /* Size the descriptors to one tx_ring slot. Each transfer sets its own
+     * length, so the count in design.modus is never used. */
+    Cy_DMAC_Descriptor_SetDataCount(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, USB_BUFFER_SIZE);
+#if (OUT_DMA_CHAIN != 0u)
+    Cy_DMAC_Descriptor_SetDataCount(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PONG, USB_BUFFER_SIZE);
+#endif
+
     /* Set source and destination for PING descriptor */
-    Cy_DMAC_Descriptor_SetSrcAddress(UART_TX_DMA_HW, UART_TX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING, (void *) rxBuffer);
-    Cy_DMAC_Descriptor_SetDstAddress(UART_TX_DMA_HW, UART_TX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING, (void *) txBuffer);
+    Cy_DMAC_Descriptor_SetSrcAddress(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, (void *) rxBuffer);
+    Cy_DMAC_Descriptor_SetDstAddress(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, (void *) txBuffer);
+#if (OUT_DMA_CHAIN != 0u)
+    Cy_DMAC_Descriptor_SetDstAddress(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PONG, (void *) txBuffer);
+#endif
 
     /* Validate the PING descriptor */
-    Cy_DMAC_Descriptor_SetState(UART_TX_DMA_HW, UART_TX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING, true);
+    Cy_DMAC_Descriptor_SetState(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, true);
 
     /* Set PING descriptor as current descriptor for UART_TX_DMA channel */
-    Cy_DMAC_Channel_SetCurrentDescriptor(UART_TX_DMA_HW, UART_TX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING);
+    Cy_DMAC_Channel_SetCurrentDescriptor(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING);
 
     /* Enable DMAC block */
-    Cy_DMAC_Enable(UART_TX_DMA_HW);
+    Cy_DMAC_Enable(dma->base);
 }
 
 
@@ -99,58 +146,210 @@ void configure_tx_dma(uint8_t *rxBuffer, uint8_t *txBuffer)
 ********************************************************************************
 *
 * Summary:
-* Configures DMA Rx channel for operation.
+* Configures a UART_RX_DMA channel for operation.
 *
 * Parameters:
-*  None
+*  dma: UART_RX_DMA channel of the port
+*  rxBuffer: UART RX FIFO read register
+*  txBuffer_a: ping buffer
+*  txBuffer_b: pong buffer
 *
 * Return:
 *  None
 *
 *******************************************************************************/
-void configure_rx_dma(uint8_t *rxBuffer, uint8_t *txBuffer_a, uint8_t *txBuffer_b)
+void configure_rx_dma(const uart_dma_t *dma, uint8_t *rxBuffer, uint8_t *txBuffer_a, uint8_t *txBuffer_b)
 {
     cy_en_dmac_status_t dmac_init_status;
+    cy_stc_dmac_channel_config_t channel_config = *dma->channel_config;
 
     /* Initialize PING descriptor */
-    dmac_init_status = Cy_DMAC_Descriptor_Init(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING, &UART_RX_DMA_ping_config);
+    dmac_init_status = Cy_DMAC_Descriptor_Init(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, dma->ping_config);
     if (dmac_init_status != CY_DMAC_SUCCESS)
     {
         handle_error();
     }
 
     /* Initialize PONG descriptor */
-    dmac_init_status = Cy_DMAC_Descriptor_Init(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PONG, &UART_RX_DMA_pong_config);
+    dmac_init_status = Cy_DMAC_Descriptor_Init(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PONG, dma->pong_config);
     if (dmac_init_status != CY_DMAC_SUCCESS)
     {
         handle_error();
     }
 
-    /* Initialize UART_RX_DMA channel */
-    dmac_init_status = Cy_DMAC_Channel_Init(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL, &UART_RX_DMA_channel_config);
+    /* Initialize UART_RX_DMA channel at the priority given by dma_alloc */
+    channel_config.priority = dma_alloc_priority(dma->channel);
+    dmac_init_status = Cy_DMAC_Channel_Init(dma->base, dma->channel, &channel_config);
     if (dmac_init_status != CY_DMAC_SUCCESS)
     {
         handle_error();
     }
 
+    /* Size both descriptors to the configured ping/pong depth */
+    Cy_DMAC_Descriptor_SetDataCount(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, PING_PONG_BUF_SIZE);
+    Cy_DMAC_Descriptor_SetDataCount(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PONG, PING_PONG_BUF_SIZE);
+
     /* Set source and destination for PING descriptor */
-    Cy_DMAC_Descriptor_SetSrcAddress(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING, (void *) rxBuffer);
-    Cy_DMAC_Descriptor_SetDstAddress(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING, (void *) txBuffer_a);
+    Cy_DMAC_Descriptor_SetSrcAddress(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, (void *) rxBuffer);
+    Cy_DMAC_Descriptor_SetDstAddress(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, (void *) txBuffer_a);
 
     /* Set source and destination for PONG descriptor */
-    Cy_DMAC_Descriptor_SetSrcAddress(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PONG, (void *) rxBuffer);
-    Cy_DMAC_Descriptor_SetDstAddress(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PONG, (void *) txBuffer_b);
+    Cy_DMAC_Descriptor_SetSrcAddress(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PONG, (void *) rxBuffer);
+    Cy_DMAC_Descriptor_SetDstAddress(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PONG, (void *) txBuffer_b);
 
     /* Validate the PING and PONG descriptors */
-    Cy_DMAC_Descriptor_SetState(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING, true);
-    Cy_DMAC_Descriptor_SetState(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PONG, true);
+    Cy_DMAC_Descriptor_SetState(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING, true);
+    Cy_DMAC_Descriptor_SetState(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PONG, true);
 
     /* Set PING descriptor as current descriptor for UART_RX_DMA channel */
-    Cy_DMAC_Channel_SetCurrentDescriptor(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL, CY_DMAC_DESCRIPTOR_PING);
+    Cy_DMAC_Channel_SetCurrentDescriptor(dma->base, dma->channel, CY_DMAC_DESCRIPTOR_PING);
 
     /* Enable DMAC block */
-    Cy_DMAC_Enable(UART_RX_DMA_HW);
+    Cy_DMAC_Enable(dma->base);
 
     /* Enable UART_RX_DMA channel */
-    Cy_DMAC_Channel_Enable(UART_RX_DMA_HW, UART_RX_DMA_CHANNEL);
+    Cy_DMAC_Channel_Enable(dma->base, dma->channel);
+}
+
+
+/*******************************************************************************
+* Function Name: calc_uart_clock
+********************************************************************************
+*
+* Summary:
+* Finds the integer clock divider and oversampling factor of a UART clock
+* that give the baud rate closest to the requested one.
+*
+* Parameters:
+*  baud_rate: requested baud rate
+*  divider: returns the divide ratio (1 to 65536) of the peripheral clock
+*  oversample: returns the SCB oversampling factor (8 to 16)
+*  actual_rate: returns the baud rate the settings produce
+*
+* Return:
+*  bool: true if actual_rate is within UART_BAUD_TOLERANCE_PPM of baud_rate
+*
+*******************************************************************************/
+bool calc_uart_clock(uint32_t baud_rate, uint32_t *divider, uint32_t *oversample, uint32_t *actual_rate)
+{
+    uint32_t clk_hz = Cy_SysClk_ClkHfGetFrequency();
+    uint32_t best_error = UINT32_MAX;
+    uint32_t ovs;
+    uint32_t div;
+    uint32_t rate;
+    uint32_t error;
+
+    /* Reject rates above what the minimum oversampling can produce */
+    if ((baud_rate == 0u) || (baud_rate > (clk_hz / UART_OVERSAMPLE_MIN)))
+    {
+        return false;
+    }
+
+    for (ovs = UART_OVERSAMPLE_MIN; ovs <= UART_OVERSAMPLE_MAX; ovs++)
+    {
+        /* Round to the nearest divider */
+        div = (clk_hz + ((baud_rate * ovs) / 2u)) / (baud_rate * ovs);
+        if ((div == 0u) || (div > UART_CLK_DIVIDER_MAX))
+        {
+            continue;
+        }
+
+        rate = clk_hz / (div * ovs);
+        error = (rate > baud_rate) ? (rate - baud_rate) : (baud_rate - rate);
+
+        if (error < best_error)
+        {
+            best_error = error;
+            *divider = div;
+            *oversample = ovs;
+            *actual_rate = rate;
+        }
+    }
+
+    if (best_error == UINT32_MAX)
+    {
+        return false;
+    }
+
+    return (((uint64_t)best_error * 1000000u) <= ((uint64_t)baud_rate * UART_BAUD_TOLERANCE_PPM));
+}
+
+
+/*******************************************************************************
+* Function Name: reconfigure_uart
+********************************************************************************
+*
+* Summary:
+* Re-initializes the SCB of a bridge port with a new configuration and clock
+* divider. The caller must make sure UART_TX_DMA and UART_RX_DMA are not moving
+* data, as re-initialization clears both SCB FIFOs.
+*
+* Parameters:
+*  uart: SCB and clock divider of the port
+*  config: UART configuration to apply
+*  divider: divide ratio of the clock divider returned by calc_uart_clock
+*  context: UART context
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void reconfigure_uart(const uart_hw_t *uart, const cy_stc_scb_uart_config_t *config, uint32_t divider,
+                      cy_stc_scb_uart_context_t *context)
+{
+    cy_en_scb_uart_status_t uart_status;
+
+    Cy_SCB_UART_Disable(uart->base, context);
+    Cy_SCB_UART_DeInit(uart->base);
+
+    /* Reprogram the peripheral clock divider feeding the SCB */
+    Cy_SysClk_PeriphDisableDivider(uart->clk_type, uart->clk_num);
+    Cy_SysClk_PeriphSetDivider(uart->clk_type, uart->clk_num, divider - 1u);
+    Cy_SysClk_PeriphEnableDivider(uart->clk_type, uart->clk_num);
+
+    uart_status = Cy_SCB_UART_Init(uart->base, config, context);
+    if (uart_status != CY_SCB_UART_SUCCESS)
+    {
+        handle_error();
+    }
+    Cy_SCB_UART_Enable(uart->base);
+}
+
+
+/*******************************************************************************
+* Function Name: usb_ep_memcpy
+********************************************************************************
+*
+* Summary:
+* Copy function for the USBFS driver, used between the driver endpoint buffers
+* and the application buffers. Moves whole 32-bit words when both buffers are
+* word-aligned, and single bytes otherwise and for the tail.
+*
+* Parameters:
+*  dest: destination buffer
+*  src: source buffer
+*  size: number of bytes to copy
+*
+* Return:
+*  uint8_t *: dest
+*
+*******************************************************************************/
+uint8_t *usb_ep_memcpy(uint8_t *dest, const uint8_t *src, uint32_t size)
+{
+    uint32_t index = 0u;
+
+    if (0u == (((uintptr_t) dest | (uintptr_t) src) & 3u))
+    {
+        for (; (index + 4u) <= size; index += 4u)
+        {
+            *(uint32_t *) (void *) &dest[index] = *(const uint32_t *) (const void *) &src[index];
+        }
+    }
+
+    for (; index < size; index++)
+    {
+        dest[index] = src[index];
+    }
+
+    return dest;
 }
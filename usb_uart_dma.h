@@ -44,11 +44,39 @@
 #include "cybsp.h"
 
 
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* DMA channel of a UART data path, with its design.modus configuration. The
+ * channel priority is assigned by dma_alloc. pong_config is only used by
+ * UART_RX_DMA. */
+typedef struct
+{
+    DMAC_Type *base;
+    uint32_t channel;
+    const cy_stc_dmac_descriptor_config_t *ping_config;
+    const cy_stc_dmac_descriptor_config_t *pong_config;
+    const cy_stc_dmac_channel_config_t *channel_config;
+} uart_dma_t;
+
+/* SCB of a bridge port and the peripheral clock divider feeding it */
+typedef struct
+{
+    CySCB_Type *base;
+    cy_en_divider_types_t clk_type;
+    uint32_t clk_num;
+} uart_hw_t;
+
+
 /*******************************************************************************
 *        Function Prototypes
 *******************************************************************************/
-void configure_tx_dma(uint8_t *rxBuffer, uint8_t *txBuffer);
-void configure_rx_dma(uint8_t *rxBuffer, uint8_t *txBuffer_a, uint8_t *txBuffer_b);
+void configure_tx_dma(const uart_dma_t *dma, uint8_t *rxBuffer, uint8_t *txBuffer);
+void configure_rx_dma(const uart_dma_t *dma, uint8_t *rxBuffer, uint8_t *txBuffer_a, uint8_t *txBuffer_b);
+bool calc_uart_clock(uint32_t baud_rate, uint32_t *divider, uint32_t *oversample, uint32_t *actual_rate);
+void reconfigure_uart(const uart_hw_t *uart, const cy_stc_scb_uart_config_t *config, uint32_t divider,
+                      cy_stc_scb_uart_context_t *context);
+uint8_t *usb_ep_memcpy(uint8_t *dest, const uint8_t *src, uint32_t size);
 
 
 
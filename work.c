@@ -0,0 +1,192 @@
+/******************************************************************************
+* File Name: work.c
+*
+* Description: This file contains the deferred-work queue. Interrupt handlers
+*              post work items, and the PendSV handler runs them at the lowest
+*              priority, highest priority item first
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "cy_pdl.h"
+#include "stats.h"
+#include "trace.h"
+#include "work.h"
+
+/*******************************************************************************
+*            Macros
+*******************************************************************************/
+/* Bit of a work item of a port in work_bits. The ports of one work_t are next
+ * to each other, so all of them rank above the next work_t. */
+#define WORK_BIT(work, port)    (((uint32_t) (work) * BRIDGE_PORTS) + (port))
+
+/*******************************************************************************
+*            Global Variables
+*******************************************************************************/
+static const work_handler_t *work_handlers;
+
+/* One bit per work_t and port, WORK_BIT order. A work item posted again
+ * before it runs runs once. */
+static volatile uint32_t work_bits;
+
+/* stats_now() at the first post of each pending work item, by bit */
+static uint32_t work_posted[WORK_COUNT * BRIDGE_PORTS];
+
+
+/*******************************************************************************
+* Function Name: work_init
+********************************************************************************
+*
+* Summary:
+*  Sets the handler of each work item and drops pending work.
+*
+* Parameters:
+*  handlers: handler per work_t, in work_t order
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void work_init(const work_handler_t handlers[WORK_COUNT])
+{
+    work_handlers = handlers;
+    work_bits = 0u;
+}
+
+/*******************************************************************************
+* Function Name: work_post
+********************************************************************************
+*
+* Summary:
+*  Queues a work item and pends PendSV to run it. Can be called from any
+*  interrupt priority and from the main loop.
+*
+* Parameters:
+*  work: work item
+*  port: index of the bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void work_post(work_t work, uint32_t port)
+{
+    uint32_t bit = WORK_BIT(work, port);
+    uint32_t int_state;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    if ((work_bits & (1UL << bit)) == 0u)
+    {
+        work_bits |= (1UL << bit);
+        work_posted[bit] = stats_now();
+    }
+    Cy_SysLib_ExitCriticalSection(int_state);
+
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/*******************************************************************************
+* Function Name: work_cancel
+********************************************************************************
+*
+* Summary:
+*  Drops a work item that has not run yet.
+*
+* Parameters:
+*  work: work item
+*  port: index of the bridge port
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void work_cancel(work_t work, uint32_t port)
+{
+    uint32_t int_state;
+
+    int_state = Cy_SysLib_EnterCriticalSection();
+    work_bits &= ~(1UL << WORK_BIT(work, port));
+    Cy_SysLib_ExitCriticalSection(int_state);
+}
+
+/*******************************************************************************
+* Function Name: work_run
+********************************************************************************
+*
+* Summary:
+*  Runs queued work items until none is left. Called from the PendSV handler.
+*  The highest priority item is taken first and the queue is checked again
+*  after every item, so that work posted meanwhile by a preempting handler
+*  keeps its rank.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void work_run(void)
+{
+    uint32_t int_state;
+    uint32_t bit;
+    uint32_t work;
+    uint32_t port;
+    uint32_t posted;
+
+    for (;;)
+    {
+        int_state = Cy_SysLib_EnterCriticalSection();
+        for (bit = 0u; bit < ((uint32_t) WORK_COUNT * BRIDGE_PORTS); bit++)
+        {
+            if ((work_bits & (1UL << bit)) != 0u)
+            {
+                break;
+            }
+        }
+        if (bit == ((uint32_t) WORK_COUNT * BRIDGE_PORTS))
+        {
+            Cy_SysLib_ExitCriticalSection(int_state);
+            return;
+        }
+        work_bits &= ~(1UL << bit);
+        posted = work_posted[bit];
+        Cy_SysLib_ExitCriticalSection(int_state);
+
+        work = bit / BRIDGE_PORTS;
+        port = bit % BRIDGE_PORTS;
+        stats_work_latency(posted);
+        trace_event(TRACE_WORK, work, port);
+        work_handlers[work](port);
+    }
+}
@@ -0,0 +1,76 @@
+/******************************************************************************
+* File Name: work.h
+*
+* Description: This file contains the interface of the deferred-work queue that
+*              moves the data path out of dma_isr into a PendSV bottom half
+*
+*******************************************************************************
+* Copyright 2021-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef WORK_H_
+#define WORK_H_
+
+#include "cy_pdl.h"
+#include "usb_uart_config.h"
+
+
+/*******************************************************************************
+*        Enumerated Types and Structures
+*******************************************************************************/
+/* Deferred work items, highest priority first. A received buffer is
+ * overwritten if it waits too long, an idle UART TX only costs throughput,
+ * and the host retries a NAKed endpoint. Each item is posted per bridge port,
+ * and an item ranks above the next item of every port. */
+typedef enum
+{
+    WORK_RX,            /* UART_RX_DMA has completed a ping or pong buffer */
+    WORK_TX_DONE,       /* UART_TX_DMA has written a tx_ring slot to the TX FIFO */
+    WORK_OUT,           /* EP3 has received an OUT packet */
+    WORK_IN,            /* EP2 is free or due, or the self-test needs the ring */
+    WORK_COUNT
+} work_t;
+
+/* Handler of a work item, called with the index of the bridge port */
+typedef void (*work_handler_t)(uint32_t port);
+
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void work_init(const work_handler_t handlers[WORK_COUNT]);
+void work_post(work_t work, uint32_t port);
+void work_cancel(work_t work, uint32_t port);
+void work_run(void);
+
+
+#endif /* WORK_H_ */